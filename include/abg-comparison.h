@@ -661,6 +661,9 @@ public:
   void
   do_log(bool);
 
+  void
+  get_memory_stats(metrics::memory_stats& stats) const;
+
   void
   set_corpus_diff(const corpus_diff_sptr&);
 
@@ -761,6 +764,9 @@ public:
   const suppr::suppressions_type&
   direct_suppressions() const;
 
+  const suppr::suppressions_index&
+  get_suppressions_index() const;
+
   void
   add_suppression(const suppr::suppression_sptr suppr);
 
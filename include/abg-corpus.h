@@ -278,6 +278,12 @@ public:
   exported_decls_builder_sptr
   get_exported_decls_builder() const;
 
+  void
+  drop_symbols_and_exported_decls();
+
+  void
+  get_memory_stats(metrics::memory_stats& stats) const;
+
   friend class type_base;
   friend class corpus_group;
 };// end class corpus.
@@ -23,11 +23,15 @@
 
 #include <cassert>
 #include <cstdlib>
+#include <iterator>
 #include <memory>
 #include <ostream>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include "abg-fwd.h"
 
@@ -2006,6 +2010,159 @@ compute_diff(RandomAccessOutputIterator a_begin,
 							       ses);
 }
 
+/// Compute an edit script for transforming a sequence A into a
+/// sequence B, in which the order of the elements is not
+/// significant, by matching the elements that have the same key.
+///
+/// Each element of A is matched with the first element of B that
+/// has the same key, that is not matched yet and that is equal to
+/// it.  An element of A whose key is the key of an element of B, but
+/// that is not equal to any of them, is deleted.  Likewise, an
+/// element of B whose key is the key of an element of A, but that
+/// is not matched, is inserted.
+///
+/// Only the elements of A and B whose key is not present in the
+/// other sequence are then compared with the core diffing algorithm
+/// used by compute_diff.  The comparison of elements that are not
+/// equal is thus limited to the elements that are the most likely
+/// to be equal.
+///
+/// The elements that end up matched might not be in the same order
+/// in A and in B.  The resulting edit script thus tells which
+/// elements of A are deleted and which elements of B are inserted,
+/// but applying it to A doesn't necessarily yield B.  The insertion
+/// point of an inserted element of B is the element of A matched
+/// with the closest preceding matched element of B, if any.
+///
+/// @tparm RandomAccessOutputIterator the type of iterators passed to
+/// this function.  It must be a random access output iterator kind.
+///
+/// @tparm KeyFunctor the type of the functor that computes the key
+/// of an element.  The key must be hashable by std::hash.
+///
+/// @tparm EqualityFunctor this must be a class that declares a
+/// public call operator member returning a boolean and taking two
+/// arguments that must be of the same type as the one of the
+/// elements of the sequences.
+///
+/// @param a_begin an iterator to the beginning of the first sequence
+/// to consider.
+///
+/// @param a_end an iterator to the end of the first sequence to
+/// consider.
+///
+/// @param b_begin an iterator to the beginning of the second
+/// sequence to consider.
+///
+/// @param b_end an iterator to the end of the second sequence to
+/// consider.
+///
+/// @param ses the resulting edit script.
+template<typename RandomAccessOutputIterator,
+	 typename KeyFunctor,
+	 typename EqualityFunctor>
+void
+compute_diff_by_key(RandomAccessOutputIterator a_begin,
+		    RandomAccessOutputIterator a_end,
+		    RandomAccessOutputIterator b_begin,
+		    RandomAccessOutputIterator b_end,
+		    edit_script& ses)
+{
+  typedef typename std::iterator_traits<RandomAccessOutputIterator>::value_type
+    value_type;
+  typedef typename std::decay<decltype(KeyFunctor()(*a_begin))>::type
+    key_type;
+
+  KeyFunctor key_of;
+  EqualityFunctor eq;
+  unsigned a_size = a_end - a_begin, b_size = b_end - b_begin;
+
+  // The indexes of the elements of B, per key.
+  vector<key_type> b_keys;
+  b_keys.reserve(b_size);
+  std::unordered_map<key_type, vector<unsigned>> b_indexes_per_key;
+  for (unsigned j = 0; j < b_size; ++j)
+    {
+      b_keys.push_back(key_of(b_begin[j]));
+      b_indexes_per_key[b_keys.back()].push_back(j);
+    }
+
+  // For each element of B, the index of the element of A it is
+  // matched with, or -1.
+  vector<int> a_index_of_b(b_size, -1);
+  vector<bool> a_is_matched(a_size, false);
+  // The indexes of the elements of A and B whose key is not present
+  // in the other sequence.
+  vector<unsigned> a_rest_indexes, b_rest_indexes;
+  std::unordered_set<key_type> a_keys;
+
+  for (unsigned i = 0; i < a_size; ++i)
+    {
+      key_type key = key_of(a_begin[i]);
+      typename std::unordered_map<key_type, vector<unsigned>>::const_iterator
+	b_indexes = b_indexes_per_key.find(key);
+      a_keys.insert(key);
+      if (b_indexes == b_indexes_per_key.end())
+	{
+	  a_rest_indexes.push_back(i);
+	  continue;
+	}
+      for (unsigned j : b_indexes->second)
+	if (a_index_of_b[j] < 0 && eq(a_begin[i], b_begin[j]))
+	  {
+	    a_index_of_b[j] = i;
+	    a_is_matched[i] = true;
+	    break;
+	  }
+    }
+
+  for (unsigned j = 0; j < b_size; ++j)
+    if (a_keys.find(b_keys[j]) == a_keys.end())
+      b_rest_indexes.push_back(j);
+
+  if (!a_rest_indexes.empty() && !b_rest_indexes.empty())
+    {
+      vector<value_type> a_rest, b_rest;
+      for (unsigned i : a_rest_indexes)
+	a_rest.push_back(a_begin[i]);
+      for (unsigned j : b_rest_indexes)
+	b_rest.push_back(b_begin[j]);
+
+      vector<point> lcs;
+      edit_script rest_ses;
+      compute_diff<typename vector<value_type>::const_iterator,
+		   EqualityFunctor>(a_rest.begin(), a_rest.end(),
+				    b_rest.begin(), b_rest.end(),
+				    lcs, rest_ses);
+      for (const point& p : lcs)
+	{
+	  unsigned i = a_rest_indexes[p.x()], j = b_rest_indexes[p.y()];
+	  a_index_of_b[j] = i;
+	  a_is_matched[i] = true;
+	}
+    }
+
+  for (unsigned i = 0; i < a_size; ++i)
+    if (!a_is_matched[i])
+      ses.deletions().push_back(deletion(i));
+
+  int insertion_point = -1;
+  bool previous_is_inserted = false;
+  for (unsigned j = 0; j < b_size; ++j)
+    {
+      if (a_index_of_b[j] >= 0)
+	{
+	  insertion_point = a_index_of_b[j];
+	  previous_is_inserted = false;
+	  continue;
+	}
+      if (!previous_is_inserted)
+	ses.insertions().push_back(insertion(insertion_point));
+      ses.insertions().back().inserted_indexes().push_back(j);
+      previous_is_inserted = true;
+    }
+}
+
 void
 compute_lcs(const char* str1, const char* str2, int &ses_len, string& lcs);
 
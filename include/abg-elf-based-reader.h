@@ -45,6 +45,15 @@ protected:
   elf_based_reader(const std::string& elf_path,
 		   const vector<char**>& debug_info_root_paths,
 		   environment& env);
+
+  ir::corpus_sptr
+  read_corpus_from_cache(ir::corpus::origin fe_origin,
+			 fe_iface::status& status);
+
+  bool
+  save_corpus_to_cache(ir::corpus::origin fe_origin,
+		       const ir::corpus_sptr& corp,
+		       fe_iface::status status);
 public:
 
   ~elf_based_reader();
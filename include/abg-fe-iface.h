@@ -66,6 +66,30 @@ protected:
     bool		do_log				= false;
     bool		leverage_dwarf_factorization	= true;
     bool		assume_odr_for_cplusplus	= true;
+    // If true, the DWARF front-end computes the canonical DIEs of
+    // all the type DIEs before building the IR, rather than while
+    // building it.
+    bool		precompute_canonical_dies	= false;
+    // If true and only the exported interfaces are analyzed, the
+    // DWARF front-end only walks the compilation units that have
+    // DIEs of exported declarations, and the DIEs reachable from
+    // them.
+    bool		read_exported_interfaces_lazily	= false;
+    // If true, the front-end records the hash of the content of each
+    // translation unit it reads.  See
+    // translation_unit::get_content_hash.
+    bool		hash_translation_units		= false;
+    // The path to the abixml of a previous version of the binary,
+    // emitted with hash_translation_units set.  If it's not empty,
+    // the DWARF front-end takes the translation units which content
+    // didn't change from there, rather than from the debug info.
+    std::string	baseline_abixml_path;
+    // The directory of the on-disk cache of ABI corpora.  If empty,
+    // the cache is not used.
+    std::string	corpus_cache_dir;
+    // The maximum size (in bytes) of the on-disk cache of ABI
+    // corpora.  A value of 0 means there is no limit.
+    uint64_t		corpus_cache_max_size		= 0;
     options_type(environment&);
 
   };// font_end_iface::options_type
@@ -145,6 +169,9 @@ protected:
 
   virtual ir::corpus_sptr
   read_corpus(status& status) = 0;
+
+  virtual void
+  get_memory_stats(metrics::memory_stats& stats) const;
 }; //end class fe_iface
 
 typedef shared_ptr<fe_iface> fe_iface_sptr;
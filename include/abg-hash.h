@@ -24,6 +24,12 @@ namespace hashing
 
   uint32_t
   fnv_hash(const std::string& str);
+
+  uint64_t
+  fnv_hash64(const std::string& str);
+
+  uint64_t
+  fnv_hash64(const std::string& str, uint64_t hash);
 }//end namespace hashing
 }//end namespace abigail
 
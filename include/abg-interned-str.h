@@ -16,6 +16,7 @@
 #ifndef __ABG_INTERNED_STR_H__
 #define __ABG_INTERNED_STR_H__
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <ostream>
@@ -223,6 +224,9 @@ struct hash_interned_string
 /// This is where all the distinct strings represented by the interned
 /// strings leave.  The pool is the actor responsible for creating
 /// interned strings.
+///
+/// Each distinct string is stored only once.  Several threads can
+/// create interned strings from the same pool concurrently.
 class interned_string_pool
 {
   struct priv;
@@ -230,6 +234,29 @@ class interned_string_pool
 
 public:
 
+  /// Statistics about the content and the use of an @ref
+  /// interned_string_pool.
+  struct stats
+  {
+    /// The number of distinct non-empty strings in the pool.
+    size_t	nb_strings;
+    /// The number of bytes of the characters of these strings,
+    /// including their terminating null characters.
+    size_t	nb_bytes;
+    /// The number of calls to interned_string_pool::create_string.
+    uint64_t	nb_lookups;
+    /// The number of these calls that found the string already in the
+    /// pool.
+    uint64_t	nb_hits;
+
+    stats()
+      : nb_strings(), nb_bytes(), nb_lookups(), nb_hits()
+    {}
+
+    double
+    hit_rate() const;
+  }; // end struct stats
+
   interned_string_pool();
 
   interned_string
@@ -241,6 +268,9 @@ public:
   const char*
   get_string(const char* s) const;
 
+  stats
+  get_stats() const;
+
   ~interned_string_pool();
 }; // end class interned_string_pool
 
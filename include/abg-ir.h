@@ -19,6 +19,7 @@
 #include <stdint.h>
 #include <cstdlib>
 #include <functional>
+#include <mutex>
 #include <set>
 #include <unordered_map>
 #include "abg-cxx-compat.h"
@@ -26,6 +27,7 @@
 #include "abg-hash.h"
 #include "abg-traverse.h"
 #include "abg-config.h"
+#include "abg-metrics.h"
 
 /// @file
 ///
@@ -143,10 +145,11 @@ public:
   std::unique_ptr<priv> priv_;
 
   /// A convenience typedef for a map of canonical types.  The key is
-  /// the pretty representation string of a particular type and the
-  /// value is the vector of canonical types that have the same pretty
-  /// representation string.
-  typedef std::unordered_map<string, std::vector<type_base_sptr> >
+  /// the hash value of the (internal) pretty representation string of
+  /// a particular type, as computed by
+  /// type_base::get_canonical_type_key().  The value is the vector of
+  /// canonical types that have that same hash value.
+  typedef std::unordered_map<uint64_t, std::vector<type_base_sptr> >
       canonical_types_map_type;
 
   environment();
@@ -186,6 +189,9 @@ public:
   void
   decl_only_class_equals_definition(bool f) const;
 
+  std::recursive_mutex&
+  get_canonicalization_lock() const;
+
   bool
   is_void_type(const type_base_sptr&) const;
 
@@ -213,6 +219,21 @@ public:
   bool
   analyze_exported_interfaces_only() const;
 
+  metrics::registry&
+  get_metrics() const;
+
+  interned_string_pool::stats
+  get_interned_string_pool_stats() const;
+
+  void
+  use_arena_allocation(bool f);
+
+  bool
+  use_arena_allocation() const;
+
+  void
+  get_memory_stats(metrics::memory_stats& stats) const;
+
 #ifdef WITH_DEBUG_SELF_COMPARISON
   void
   set_self_comparison_debug_input(const corpus_sptr& corpus);
@@ -435,7 +456,7 @@ class location_manager
 
 public:
 
-  location_manager();
+  location_manager(const environment&);
 
   ~location_manager();
 
@@ -445,6 +466,9 @@ public:
   void
   expand_location(const location& location, std::string& path,
 		  unsigned& line, unsigned& column) const;
+
+  void
+  get_memory_stats(metrics::memory_stats& stats) const;
 };
 
 /// The base of an entity of the intermediate representation that is
@@ -735,6 +759,12 @@ public:
   const std::string&
   get_absolute_path() const;
 
+  const std::string&
+  get_content_hash() const;
+
+  void
+  set_content_hash(const std::string&);
+
   void
   set_corpus(corpus*);
 
@@ -1417,6 +1447,12 @@ public:
 
   virtual ~type_or_decl_base();
 
+  static void*
+  operator new(size_t);
+
+  static void
+  operator delete(void*, size_t);
+
   bool
   get_is_artificial() const;
 
@@ -1484,6 +1520,9 @@ public:
 
   friend decl_base*
   is_decl(const type_or_decl_base* d);
+
+  friend void
+  record_memory_usage(const type_or_decl_base&, metrics::memory_stats&);
 }; // end class type_or_decl_base
 
 type_or_decl_base::type_or_decl_kind
@@ -1502,6 +1541,9 @@ type_or_decl_base::type_or_decl_kind&
 operator&=(type_or_decl_base::type_or_decl_kind&,
 	   type_or_decl_base::type_or_decl_kind);
 
+void
+record_memory_usage(const type_or_decl_base&, metrics::memory_stats&);
+
 bool
 operator==(const type_or_decl_base&, const type_or_decl_base&);
 
@@ -1759,6 +1801,9 @@ public:
   friend class class_or_union;
   friend class class_decl;
   friend class scope_decl;
+
+  friend void
+  record_memory_usage(const type_or_decl_base&, metrics::memory_stats&);
 };// end class decl_base
 
 bool
@@ -1903,6 +1948,9 @@ public:
 
   friend void
   remove_decl_from_scope(decl_base_sptr decl);
+
+  friend void
+  record_memory_usage(const type_or_decl_base&, metrics::memory_stats&);
 };//end class scope_decl
 
 bool
@@ -2001,6 +2049,9 @@ public:
   const interned_string&
   get_cached_pretty_representation(bool internal = false) const;
 
+  uint64_t
+  get_canonical_type_key() const;
+
   virtual bool
   operator==(const type_base&) const;
 
@@ -2023,6 +2074,9 @@ public:
 
   virtual size_t
   get_alignment_in_bits() const;
+
+  friend void
+  record_memory_usage(const type_or_decl_base&, metrics::memory_stats&);
 };//end class type_base
 
 /// Hash functor for instances of @ref type_base.
@@ -2269,6 +2323,9 @@ public:
   traverse(ir_node_visitor& v);
 
   virtual ~qualified_type_def();
+
+  friend void
+  record_memory_usage(const type_or_decl_base&, metrics::memory_stats&);
 }; // end class qualified_type_def.
 
 bool
@@ -2361,6 +2418,9 @@ public:
   traverse(ir_node_visitor& v);
 
   virtual ~pointer_type_def();
+
+  friend void
+  record_memory_usage(const type_or_decl_base&, metrics::memory_stats&);
 }; // end class pointer_type_def
 
 bool
@@ -2597,6 +2657,9 @@ public:
 
     virtual bool
     traverse(ir_node_visitor&);
+
+    friend void
+    record_memory_usage(const type_or_decl_base&, metrics::memory_stats&);
   }; // end class subrange_type
 
   array_type_def(const type_base_sptr type,
@@ -2656,6 +2719,8 @@ public:
 
   virtual ~array_type_def();
 
+  friend void
+  record_memory_usage(const type_or_decl_base&, metrics::memory_stats&);
 }; // end class array_type_def
 
 array_type_def::subrange_type*
@@ -2741,6 +2806,9 @@ public:
   enum_has_non_name_change(const enum_type_decl& l,
 			   const enum_type_decl& r,
 			   change_kind* k);
+
+  friend void
+  record_memory_usage(const type_or_decl_base&, metrics::memory_stats&);
 }; // end class enum_type_decl
 
 bool
@@ -2856,6 +2924,9 @@ public:
   traverse(ir_node_visitor&);
 
   virtual ~typedef_decl();
+
+  friend void
+  record_memory_usage(const type_or_decl_base&, metrics::memory_stats&);
 };// end class typedef_decl
 
 /// The abstraction for a data member context relationship.  This
@@ -3014,6 +3085,9 @@ public:
 
   friend bool
   get_data_member_is_laid_out(const var_decl_sptr m);
+
+  friend void
+  record_memory_usage(const type_or_decl_base&, metrics::memory_stats&);
 }; // end class var_decl
 
 bool
@@ -3133,6 +3207,9 @@ public:
   traverse(ir_node_visitor&);
 
   virtual ~function_decl();
+
+  friend void
+  record_memory_usage(const type_or_decl_base&, metrics::memory_stats&);
 }; // end class function_decl
 
 bool
@@ -3267,6 +3344,9 @@ public:
   virtual string
   get_pretty_representation(bool internal = false,
 			    bool qualified_name = true) const;
+
+  friend void
+  record_memory_usage(const type_or_decl_base&, metrics::memory_stats&);
 }; // end class function_decl::parameter
 
 bool
@@ -3445,6 +3525,9 @@ public:
 
   friend interned_string
   get_method_type_name(const method_type& fn_type, bool internal);
+
+  friend void
+  record_memory_usage(const type_or_decl_base&, metrics::memory_stats&);
 };// end class method_type.
 
 /// The base class of templates.
@@ -4279,6 +4362,9 @@ public:
 
   friend class method_decl;
   friend class class_or_union;
+
+  friend void
+  record_memory_usage(const type_or_decl_base&, metrics::memory_stats&);
 };// end class class_decl
 
 bool
@@ -4375,6 +4461,9 @@ public:
 
   virtual bool
   traverse(ir_node_visitor&);
+
+  friend void
+  record_memory_usage(const type_or_decl_base&, metrics::memory_stats&);
 };// end class class_decl::base_spec
 
 bool
@@ -0,0 +1,235 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2023 Red Hat, Inc.
+
+/// @file
+///
+/// This file declares the registry of performance metrics that the
+/// front-ends, the type canonicalizer, the comparison engine and the
+/// reporters of libabigail record into.
+///
+/// The registry is owned by the @ref ir::environment.  Tools can
+/// enable it and, at the end of their execution, emit its content as
+/// a JSON document.
+///
+/// It also declares the type of the reports of the memory used by
+/// the corpora, the readers and the comparison engine.
+
+#ifndef __ABG_METRICS_H__
+#define __ABG_METRICS_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace abigail
+{
+
+/// The namespace of the performance metrics recorded by libabigail.
+namespace metrics
+{
+
+/// A counter of a @ref registry.
+///
+/// Counters are created by registry::get_counter_handle.  Code that
+/// increments a counter on a hot path gets its handle once, and then
+/// increments it with a test of whether the registry is enabled and
+/// an atomic addition, without any lock or lookup by name.
+class counter
+{
+  const std::atomic<bool>&	enabled_;
+  std::atomic<uint64_t>		value_;
+
+public:
+  /// Constructor of the @ref counter type.
+  ///
+  /// @param enabled the flag telling whether the registry of the
+  /// counter is enabled.
+  counter(const std::atomic<bool>& enabled)
+    : enabled_(enabled), value_(0)
+  {}
+
+  /// Increment the counter, if its registry is enabled.
+  ///
+  /// @param delta the value to add to the counter.
+  void
+  increment(uint64_t delta = 1)
+  {
+    if (enabled_.load(std::memory_order_relaxed))
+      value_.fetch_add(delta, std::memory_order_relaxed);
+  }
+
+  /// Getter of the value of the counter.
+  ///
+  /// @return the value of the counter.
+  uint64_t
+  get_value() const
+  {return value_.load(std::memory_order_relaxed);}
+}; // end class counter
+
+/// A registry of performance metrics.
+///
+/// The registry records two kinds of metrics:
+///
+///   - phases, which are named steps of the processing.  For each
+///     phase, the number of times it was performed, the wall clock
+///     and CPU time spent in it and the high-water mark of the
+///     resident set size of the process at its end are recorded.
+///
+///   - counters, which are named monotonic integers, e.g, the number
+///     of types canonicalized.
+///
+/// Nothing is recorded unless the registry is enabled.  Recording
+/// into an enabled registry is thread-safe.
+class registry
+{
+  struct priv;
+  std::unique_ptr<priv> priv_;
+
+public:
+  registry();
+
+  bool
+  is_enabled() const;
+
+  void
+  enable(bool f);
+
+  void
+  record_phase(const std::string& name,
+	       double wall_time,
+	       double cpu_time);
+
+  counter&
+  get_counter_handle(const std::string& name);
+
+  void
+  increment_counter(const std::string& name, uint64_t delta = 1);
+
+  void
+  increment_counter(const char* name, uint64_t delta = 1);
+
+  uint64_t
+  get_counter(const std::string& name) const;
+
+  void
+  merge(const registry& other);
+
+  void
+  emit_json(std::ostream& out) const;
+
+  bool
+  emit_json(const std::string& path) const;
+
+  ~registry();
+}; // end class registry
+
+/// Records the time spent in a phase into a @ref registry.
+///
+/// The phase starts upon instantiation of this type and ends upon its
+/// destruction.  If the registry is not enabled, this does nothing.
+class scoped_phase
+{
+  registry&	registry_;
+  std::string	name_;
+  bool		active_;
+  std::chrono::steady_clock::time_point wall_start_;
+  double	cpu_start_;
+
+public:
+  scoped_phase(registry& r, const std::string& name);
+  ~scoped_phase();
+}; // end class scoped_phase
+
+/// The memory used by the objects of a category, as recorded into a
+/// @ref memory_stats.
+struct memory_usage
+{
+  std::string	category;
+  uint64_t	nb_objects;
+  uint64_t	nb_bytes;
+
+  memory_usage(const std::string& c)
+    : category(c), nb_objects(), nb_bytes()
+  {}
+}; // end struct memory_usage
+
+/// A report of the memory used by categories of objects, e.g, the
+/// kinds of IR nodes of a corpus or the maps of a reader.
+///
+/// The categories are named like the metrics of a @ref registry,
+/// prefixed by the name of the component that owns the objects:
+/// "ir.class-type", "dwarf.die-parent-maps", etc.
+///
+/// The byte counts are estimates.  They account for the objects and
+/// for the arrays and nodes of the containers they own directly, but
+/// not for the overhead of the memory allocator.
+class memory_stats
+{
+  struct priv;
+  std::unique_ptr<priv> priv_;
+
+public:
+  memory_stats();
+
+  void
+  record(const std::string& category, uint64_t nb_objects, uint64_t nb_bytes);
+
+  const memory_usage*
+  get_usage(const std::string& category) const;
+
+  const std::vector<memory_usage>&
+  get_usages() const;
+
+  uint64_t
+  get_total_bytes() const;
+
+  void
+  emit_report(std::ostream& out) const;
+
+  ~memory_stats();
+}; // end class memory_stats
+
+/// Estimate the number of bytes used by the array of a vector.
+///
+/// @param v the vector to consider.
+///
+/// @return the estimated number of bytes.
+template<typename T>
+uint64_t
+estimate_memory_usage(const std::vector<T>& v)
+{return v.capacity() * sizeof(T);}
+
+/// Estimate the number of bytes used by the buckets and the nodes of
+/// a hash table of the standard library, like std::unordered_map or
+/// std::unordered_set.
+///
+/// Each node is assumed to hold a pointer to the next node and the
+/// cached hash value of its element.
+///
+/// @param c the hash table to consider.
+///
+/// @return the estimated number of bytes.
+template<typename hash_table_type>
+uint64_t
+estimate_hash_table_memory_usage(const hash_table_type& c)
+{
+  return c.bucket_count() * sizeof(void*)
+    + c.size() * (sizeof(typename hash_table_type::value_type)
+		  + 2 * sizeof(void*));
+}
+
+double
+get_cpu_time();
+
+uint64_t
+get_peak_rss();
+
+}// end namespace metrics
+}// end namespace abigail
+#endif // __ABG_METRICS_H__
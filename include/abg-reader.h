@@ -15,6 +15,8 @@
 #define __ABG_READER_H__
 
 #include <istream>
+#include <unordered_map>
+#include <unordered_set>
 #include "abg-corpus.h"
 #include "abg-suppression.h"
 #include "abg-fe-iface.h"
@@ -56,6 +58,19 @@ corpus_sptr
 read_corpus_from_abixml_file(const string& path,
 			     environment&  env);
 
+corpus_sptr
+read_corpus_from_abixml_file(const string&			path,
+			     environment&			env,
+			     const std::unordered_set<string>&	unit_paths);
+
+bool
+find_reusable_translation_units
+(const string&						path,
+ const std::unordered_map<string, string>&		unit_hashes,
+ const std::unordered_map<string,
+			  std::unordered_set<string>>&	unit_type_names,
+ std::unordered_set<string>&				reusable_units);
+
 corpus_group_sptr
 read_corpus_group_from_input(fe_iface& ctxt);
 
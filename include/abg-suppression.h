@@ -82,6 +82,12 @@ public:
   void
   set_label(const string&);
 
+  uint64_t
+  get_source_hash() const;
+
+  void
+  set_source_hash(uint64_t);
+
   void
   set_file_name_regex_str(const string& regexp);
 
@@ -133,6 +139,12 @@ typedef shared_ptr<suppression_base> suppression_sptr;
 /// Convenience typedef for a vector of @ref suppression_sptr
 typedef vector<suppression_sptr> suppressions_type;
 
+class suppressions_index;
+
+/// Convenience typedef for a shared pointer to a @ref
+/// suppressions_index.
+typedef shared_ptr<suppressions_index> suppressions_index_sptr;
+
 void
 read_suppressions(std::istream& input,
 		  suppressions_type& suppressions);
@@ -8,6 +8,7 @@
 #ifndef __ABG_TOOLS_UTILS_H
 #define __ABG_TOOLS_UTILS_H
 
+#include <functional>
 #include <iostream>
 #include <istream>
 #include <memory>
@@ -114,6 +115,12 @@ get_default_system_suppression_file_path();
 string
 get_default_user_suppression_file_path();
 
+string
+get_corpus_cache_dir_path();
+
+uint64_t
+get_corpus_cache_max_size();
+
 void
 load_default_system_suppressions(suppr::suppressions_type&);
 
@@ -281,6 +288,20 @@ public:
 
 ostream& operator<<(ostream&, const timer&);
 
+/// Emits the content of a registry of performance metrics as a JSON
+/// document into a file, when it goes out of scope.
+///
+/// This is used by the tools to implement their --profile option.
+class scoped_profile_emitter
+{
+  metrics::registry&	registry_;
+  string		path_;
+
+public:
+  scoped_profile_emitter(metrics::registry& r, const string& path);
+  ~scoped_profile_emitter();
+}; // end class scoped_profile_emitter
+
 ostream&
 operator<<(ostream& output, file_type r);
 
@@ -315,6 +336,12 @@ make_path_absolute(const char*p);
 char*
 make_path_absolute_to_be_freed(const char*p);
 
+/// The type of the functions that are invoked each time a corpus is
+/// read and added to a corpus group that is being built.  The corpus
+/// group is passed to the function; the new corpus is the last one
+/// of the group.
+typedef std::function<void(const corpus_group_sptr&)> corpus_added_handler;
+
 corpus_group_sptr
 build_corpus_group_from_kernel_dist_under(const string&	root,
 					  const string		debug_info_root,
@@ -324,7 +351,9 @@ build_corpus_group_from_kernel_dist_under(const string&	root,
 					  suppr::suppressions_type&	supprs,
 					  bool				verbose,
 					  environment&			env,
-					  corpus::origin	requested_fe_kind = corpus::DWARF_ORIGIN);
+					  corpus::origin	requested_fe_kind = corpus::DWARF_ORIGIN,
+					  const corpus_added_handler&	on_corpus_added = nullptr,
+					  size_t			nb_opener_threads = 1);
 
 elf_based_reader_sptr
 create_best_elf_based_reader(const string& elf_file_path,
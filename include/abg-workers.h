@@ -16,6 +16,8 @@
 #ifndef __ABG_WORKERS_H__
 #define __ABG_WORKERS_H__
 
+#include <functional>
+#include <future>
 #include <memory>
 #include <vector>
 
@@ -50,6 +52,39 @@ public:
 
 typedef shared_ptr<task> task_sptr;
 
+/// A @ref task that invokes a function and makes the result of that
+/// invocation available through a std::future.
+///
+/// Instances of this type are created by queue::schedule_function.
+template<typename result_type>
+class function_task : public task
+{
+  std::packaged_task<result_type()> fn_;
+
+public:
+  /// Constructor of the @ref function_task type.
+  ///
+  /// @param f the function to invoke when the task is performed.
+  function_task(const std::function<result_type()>& f)
+    : fn_(f)
+  {}
+
+  /// Getter of the future holding the result of the function.
+  ///
+  /// This must be called at most once.
+  ///
+  /// @return the future holding the result of the function.
+  std::future<result_type>
+  get_future()
+  {return fn_.get_future();}
+
+  /// Invoke the function and store its result (or the exception it
+  /// threw) into the future.
+  virtual void
+  perform()
+  {fn_();}
+}; // end class function_task
+
 /// This represents a queue of tasks to be performed.
 ///
 /// Tasks are performed by a number of worker threads.
@@ -64,6 +99,12 @@ typedef shared_ptr<task> task_sptr;
 /// task to be added to the queue.
 ///
 /// Of course, several worker threads can execute tasks concurrently.
+///
+/// Each worker thread has its own queue of tasks to perform, ordered
+/// by priority.  When a worker thread runs out of tasks, it steals
+/// tasks from the queues of the other worker threads.  A task can
+/// schedule new tasks on the queue that is performing it; those are
+/// queued on the worker thread that performs the task.
 class queue
 {
 public:
@@ -83,7 +124,31 @@ public:
 	task_done_notify& notifier);
   size_t get_size() const;
   bool schedule_task(const task_sptr&);
+  bool schedule_task(const task_sptr&, size_t priority);
   bool schedule_tasks(const tasks_type&);
+
+  /// Schedule the invocation of a function on the queue.
+  ///
+  /// @param f the function to invoke.
+  ///
+  /// @param priority the priority of the invocation.  Tasks of
+  /// greater priority are performed first.
+  ///
+  /// @return the future holding the result of the invocation of @p
+  /// f.  If the invocation couldn't be scheduled, getting the result
+  /// from the future throws a std::future_error.
+  template<typename result_type>
+  std::future<result_type>
+  schedule_function(const std::function<result_type()>& f,
+		    size_t priority = 0)
+  {
+    shared_ptr<function_task<result_type> > t
+      (new function_task<result_type>(f));
+    std::future<result_type> result = t->get_future();
+    schedule_task(t, priority);
+    return result;
+  }
+
   void wait_for_workers_to_complete();
   tasks_type& get_completed_tasks() const;
   ~queue();
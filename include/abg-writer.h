@@ -127,6 +127,19 @@ write_corpus_group(write_context&	    ctx,
 		   const corpus_group_sptr& group,
 		   unsigned		    indent);
 
+bool
+write_corpus_group_header(write_context&	    ctxt,
+			  const corpus_group_sptr& group,
+			  unsigned		    indent);
+
+bool
+write_corpus_group_member(write_context&	ctxt,
+			  const corpus_sptr&	corpus,
+			  unsigned		indent);
+
+void
+write_corpus_group_footer(write_context& ctxt, unsigned indent);
+
 }// end namespace xml_writer
 
 #ifdef WITH_DEBUG_SELF_COMPARISON
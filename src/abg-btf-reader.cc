@@ -315,6 +315,8 @@ public:
   corpus_sptr
   read_corpus(status& status)
   {
+    metrics::scoped_phase phase(env().get_metrics(), "btf.read-corpus");
+    arena_allocation_scope arena_scope(env());
     // Read the properties of the ELF file.
     elf::reader::read_corpus(status);
 
@@ -18,12 +18,14 @@
 
 #include "abg-internal.h"
 // <headers defining libabigail's API go under here>
+#include <atomic>
 #include <memory>
 #include <unordered_set>
 ABG_BEGIN_EXPORT_DECLARATIONS
 
 #include "abg-hash.h"
 #include "abg-suppression.h"
+#include "abg-suppression-priv.h"
 #include "abg-comparison.h"
 #include "abg-comp-filter.h"
 #include "abg-sptr-utils.h"
@@ -185,7 +187,16 @@ struct diff_context::priv
   // suppressions_ are stored here.  Each time suppressions_ is
   // modified, this data member should be cleared.
   suppressions_type			direct_suppressions_;
+  // The index of the function and variable suppression
+  // specifications that are in suppressions_.  It's built lazily
+  // and each time suppressions_ or corpus_diff_ is modified, it
+  // should be reset.
+  suppressions_index_sptr		suppressions_index_;
   pointer_map				visited_diff_nodes_;
+  // The handle of the counter of the hits of the diff cache.  It's
+  // got from the metrics registry of the environment of the first
+  // cached diff that is looked up.
+  std::atomic<metrics::counter*>	diff_cache_hits_;
   corpus_diff_sptr			corpus_diff_;
   ostream*				default_output_stream_;
   ostream*				error_output_stream_;
@@ -218,6 +229,7 @@ struct diff_context::priv
   priv()
     : allowed_category_(EVERYTHING_CATEGORY),
       reporter_(),
+      diff_cache_hits_(),
       default_output_stream_(),
       error_output_stream_(),
       perform_change_categorization_(true),
@@ -1223,6 +1235,44 @@ struct function_comp
   {return operator()(f.get(), s.get());}
 }; // end function_comp
 
+/// A functor to get the key under which the functions of two corpora
+/// are matched when the corpora are compared.
+///
+/// This is the key under which corpus_diff records the functions
+/// that are deleted, added or changed.
+struct function_key
+{
+  /// Get the key of a function.
+  ///
+  /// @param f the function to consider.
+  ///
+  /// @return the ID of @p f, or its pretty representation if it has
+  /// no ID.
+  string
+  operator()(const function_decl* f) const
+  {
+    return get_function_id_or_pretty_representation
+      (const_cast<function_decl*>(f));
+  }
+}; // end struct function_key
+
+/// A functor to get the key under which the variables of two corpora
+/// are matched when the corpora are compared.
+///
+/// This is the key under which corpus_diff records the variables
+/// that are deleted, added or changed.
+struct var_key
+{
+  /// Get the key of a variable.
+  ///
+  /// @param v the variable to consider.
+  ///
+  /// @return the ID of @p v.
+  string
+  operator()(const var_decl* v) const
+  {return v->get_id();}
+}; // end struct var_key
+
 /// A "Less Than" functor to compare instance of @ref
 /// function_decl_diff.
 struct function_decl_diff_comp
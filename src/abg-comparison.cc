@@ -941,12 +941,41 @@ void
 diff_context::do_log(bool f)
 {priv_->do_log_ = f;}
 
+/// Record the memory used by the maps of diff nodes of the current
+/// context.
+///
+/// The diff nodes themselves are not accounted for.
+///
+/// @param stats the memory statistics to record into.
+void
+diff_context::get_memory_stats(metrics::memory_stats& stats) const
+{
+  stats.record("diff.types-or-decls-map",
+	       priv_->types_or_decls_diff_map.size(),
+	       metrics::estimate_hash_table_memory_usage
+	       (priv_->types_or_decls_diff_map));
+  stats.record("diff.live-diffs",
+	       priv_->live_diffs_.size(),
+	       metrics::estimate_hash_table_memory_usage(priv_->live_diffs_));
+  stats.record("diff.canonical-diffs",
+	       priv_->canonical_diffs.size(),
+	       metrics::estimate_memory_usage(priv_->canonical_diffs));
+
+  stats.record("diff.visited-nodes",
+	       priv_->visited_diff_nodes_.size(),
+	       metrics::estimate_hash_table_memory_usage
+	       (priv_->visited_diff_nodes_));
+}
+
 /// Set the corpus diff relevant to this context.
 ///
 /// @param d the corpus_diff we are interested in.
 void
 diff_context::set_corpus_diff(const corpus_diff_sptr& d)
-{priv_->corpus_diff_ = d;}
+{
+  priv_->corpus_diff_ = d;
+  priv_->suppressions_index_.reset();
+}
 
 /// Get the corpus diff for the current context.
 ///
@@ -1019,7 +1048,21 @@ diff_context::has_diff_for(const type_or_decl_base_sptr first,
   types_or_decls_diff_map_type::const_iterator i =
     priv_->types_or_decls_diff_map.find(std::make_pair(first, second));
   if (i != priv_->types_or_decls_diff_map.end())
-    return i->second;
+    {
+      if (first)
+	{
+	  metrics::counter* c =
+	    priv_->diff_cache_hits_.load(std::memory_order_relaxed);
+	  if (!c)
+	    {
+	      c = &first->get_environment().get_metrics().
+		get_counter_handle("comparison.diff-cache-hits");
+	      priv_->diff_cache_hits_.store(c, std::memory_order_relaxed);
+	    }
+	  c->increment();
+	}
+      return i->second;
+    }
   return diff_sptr();
 }
 
@@ -1464,6 +1507,7 @@ diff_context::suppressions()
   // from priv_->suppressions_;
   priv_->negated_suppressions_.clear();
   priv_->direct_suppressions_.clear();
+  priv_->suppressions_index_.reset();
   return priv_->suppressions_;
 }
 
@@ -1515,6 +1559,24 @@ diff_context::direct_suppressions() const
    return priv_->direct_suppressions_;
 }
 
+/// Getter of the index of the function and variable suppression
+/// specifications comprised in the general vector of suppression
+/// specifications returned by diff_context::suppressions().
+///
+/// The index is built by the first invocation of this function after
+/// the suppression specifications or the corpus diff of the context
+/// have changed.
+///
+/// @return the index of the suppression specifications.
+const suppr::suppressions_index&
+diff_context::get_suppressions_index() const
+{
+  if (!priv_->suppressions_index_)
+    priv_->suppressions_index_.reset
+      (new suppressions_index(suppressions(), *this));
+  return *priv_->suppressions_index_;
+}
+
 /// Add a new suppression specification that specifies which diff node
 /// reports should be dropped on the floor.
 ///
@@ -1528,6 +1590,7 @@ diff_context::add_suppression(const suppression_sptr suppr)
   // from priv_->suppressions_;
   priv_->negated_suppressions_.clear();
   priv_->direct_suppressions_.clear();
+  priv_->suppressions_index_.reset();
 }
 
 /// Add new suppression specifications that specify which diff node
@@ -1540,6 +1603,7 @@ diff_context::add_suppressions(const suppressions_type& supprs)
 {
   priv_->suppressions_.insert(priv_->suppressions_.end(),
 			      supprs.begin(), supprs.end());
+  priv_->suppressions_index_.reset();
 }
 
 /// Test if it's requested to perform diff node categorization.
@@ -9599,118 +9663,171 @@ corpus_diff::priv::ensure_lookup_tables_populated()
   }
 }
 
-/// Test if a change reports about a given @ref function_decl that is
-/// changed in a certain way is suppressed by a given suppression
-/// specifiation
-///
-/// @param fn the @ref function_decl to consider.
-///
-/// @param suppr the suppression specification to consider.
-///
-/// @param k the kind of change that happened to @p fn.
-///
-/// @param ctxt the context of the current diff.
-///
-/// @return true iff the suppression specification @p suppr suppresses
-/// change reports about function @p fn, if that function changes in
-/// the way expressed by @p k.
-static bool
-function_is_suppressed(const function_decl* fn,
-		       const suppression_sptr suppr,
-		       function_suppression::change_kind k,
-		       const diff_context_sptr ctxt)
-{
-  function_suppression_sptr fn_suppr = is_function_suppression(suppr);
-  if (!fn_suppr)
-    return false;
-  return fn_suppr->suppresses_function(fn, k, ctxt);
-}
-
-/// Test if a change reports about a given @ref var_decl that is
-/// changed in a certain way is suppressed by a given suppression
-/// specifiation
-///
-/// @param fn the @ref var_decl to consider.
-///
-/// @param suppr the suppression specification to consider.
-///
-/// @param k the kind of change that happened to @p fn.
-///
-/// @param ctxt the context of the current diff.
-///
-/// @return true iff the suppression specification @p suppr suppresses
-/// change reports about variable @p fn, if that variable changes in
-/// the way expressed by @p k.
-static bool
-variable_is_suppressed(const var_decl* var,
-		       const suppression_sptr suppr,
-		       variable_suppression::change_kind k,
-		       const diff_context_sptr ctxt)
-{
-  variable_suppression_sptr var_suppr = is_variable_suppression(suppr);
-  if (!var_suppr)
-    return false;
-  return var_suppr->suppresses_variable(var, k, ctxt);
-}
-
 /// Apply suppression specifications for this corpus diff to the set
 /// of added/removed functions/variables, as well as to types not
 /// reachable from global functions/variables.
+///
+/// The function and variable suppression specifications to evaluate
+/// against each function, variable or ELF symbol are looked up in
+/// the suppressions index of the diff context, rather than being
+/// all evaluated against each artifact.
 void
 corpus_diff::priv::apply_supprs_to_added_removed_fns_vars_unreachable_types()
 {
   diff_context_sptr ctxt = get_context();
+  const suppressions_index& index = ctxt->get_suppressions_index();
+  vector<function_suppression_sptr> fn_supprs;
+  vector<variable_suppression_sptr> var_supprs;
+
+  // Added functions
+  for (string_function_ptr_map::const_iterator e = added_fns_.begin();
+       e != added_fns_.end();
+       ++e)
+    {
+      fn_supprs.clear();
+      index.get_function_suppressions(*e->second, fn_supprs);
+      for (const function_suppression_sptr& s : fn_supprs)
+	if (s->suppresses_function(e->second,
+				   function_suppression::ADDED_FUNCTION_CHANGE_KIND,
+				   ctxt))
+	  {
+	    suppressed_added_fns_[e->first] = e->second;
+	    break;
+	  }
+    }
+
+  // Deleted functions.
+  for (string_function_ptr_map::const_iterator e = deleted_fns_.begin();
+       e != deleted_fns_.end();
+       ++e)
+    {
+      fn_supprs.clear();
+      index.get_function_suppressions(*e->second, fn_supprs);
+      for (const function_suppression_sptr& s : fn_supprs)
+	if (s->suppresses_function(e->second,
+				   function_suppression::DELETED_FUNCTION_CHANGE_KIND,
+				   ctxt))
+	  {
+	    suppressed_deleted_fns_[e->first] = e->second;
+	    break;
+	  }
+    }
+
+  // Added function symbols not referenced by any debug info
+  for (string_elf_symbol_map::const_iterator e =
+	 added_unrefed_fn_syms_.begin();
+       e != added_unrefed_fn_syms_.end();
+       ++e)
+    {
+      fn_supprs.clear();
+      index.get_function_symbol_suppressions(*e->second, fn_supprs);
+      for (const function_suppression_sptr& s : fn_supprs)
+	if (s->suppresses_function_symbol(e->second,
+					  function_suppression::ADDED_FUNCTION_CHANGE_KIND,
+					  ctxt))
+	  {
+	    suppressed_added_unrefed_fn_syms_[e->first] = e->second;
+	    break;
+	  }
+    }
+
+  // Removed function symbols not referenced by any debug info
+  for (string_elf_symbol_map::const_iterator e =
+	 deleted_unrefed_fn_syms_.begin();
+       e != deleted_unrefed_fn_syms_.end();
+       ++e)
+    {
+      fn_supprs.clear();
+      index.get_function_symbol_suppressions(*e->second, fn_supprs);
+      for (const function_suppression_sptr& s : fn_supprs)
+	if (s->suppresses_function_symbol(e->second,
+					  function_suppression::DELETED_FUNCTION_CHANGE_KIND,
+					  ctxt))
+	  {
+	    suppressed_deleted_unrefed_fn_syms_[e->first] = e->second;
+	    break;
+	  }
+    }
+
+  // Added variables
+  for (string_var_ptr_map::const_iterator e = added_vars_.begin();
+       e != added_vars_.end();
+       ++e)
+    {
+      var_supprs.clear();
+      index.get_variable_suppressions(*e->second, var_supprs);
+      for (const variable_suppression_sptr& s : var_supprs)
+	if (s->suppresses_variable(e->second,
+				   variable_suppression::ADDED_VARIABLE_CHANGE_KIND,
+				   ctxt))
+	  {
+	    suppressed_added_vars_[e->first] = e->second;
+	    break;
+	  }
+    }
+
+  //Deleted variables
+  for (string_var_ptr_map::const_iterator e = deleted_vars_.begin();
+       e != deleted_vars_.end();
+       ++e)
+    {
+      var_supprs.clear();
+      index.get_variable_suppressions(*e->second, var_supprs);
+      for (const variable_suppression_sptr& s : var_supprs)
+	if (s->suppresses_variable(e->second,
+				   variable_suppression::DELETED_VARIABLE_CHANGE_KIND,
+				   ctxt))
+	  {
+	    suppressed_deleted_vars_[e->first] = e->second;
+	    break;
+	  }
+    }
+
+  // Added variable symbols not referenced by any debug info
+  for (string_elf_symbol_map::const_iterator e =
+	 added_unrefed_var_syms_.begin();
+       e != added_unrefed_var_syms_.end();
+       ++e)
+    {
+      var_supprs.clear();
+      index.get_variable_symbol_suppressions(*e->second, var_supprs);
+      for (const variable_suppression_sptr& s : var_supprs)
+	if (s->suppresses_variable_symbol(e->second,
+					  variable_suppression::ADDED_VARIABLE_CHANGE_KIND,
+					  ctxt))
+	  {
+	    suppressed_added_unrefed_var_syms_[e->first] = e->second;
+	    break;
+	  }
+    }
+
+  // Removed variable symbols not referenced by any debug info
+  for (string_elf_symbol_map::const_iterator e =
+	 deleted_unrefed_var_syms_.begin();
+       e != deleted_unrefed_var_syms_.end();
+       ++e)
+    {
+      var_supprs.clear();
+      index.get_variable_symbol_suppressions(*e->second, var_supprs);
+      for (const variable_suppression_sptr& s : var_supprs)
+	if (s->suppresses_variable_symbol(e->second,
+					  variable_suppression::DELETED_VARIABLE_CHANGE_KIND,
+					  ctxt))
+	  {
+	    suppressed_deleted_unrefed_var_syms_[e->first] = e->second;
+	    break;
+	  }
+    }
 
   const suppressions_type& suppressions = ctxt->suppressions();
   for (suppressions_type::const_iterator i = suppressions.begin();
        i != suppressions.end();
        ++i)
     {
-      // Added/Deleted functions.
-      if (function_suppression_sptr fn_suppr = is_function_suppression(*i))
-	{
-	  // Added functions
-	  for (string_function_ptr_map::const_iterator e = added_fns_.begin();
-	       e != added_fns_.end();
-	       ++e)
-	    if (function_is_suppressed(e->second, fn_suppr,
-				       function_suppression::ADDED_FUNCTION_CHANGE_KIND,
-				       ctxt))
-	      suppressed_added_fns_[e->first] = e->second;
-
-	  // Deleted functions.
-	  for (string_function_ptr_map::const_iterator e = deleted_fns_.begin();
-	       e != deleted_fns_.end();
-	       ++e)
-	    if (function_is_suppressed(e->second, fn_suppr,
-				       function_suppression::DELETED_FUNCTION_CHANGE_KIND,
-				       ctxt))
-	      suppressed_deleted_fns_[e->first] = e->second;
-
-	  // Added function symbols not referenced by any debug info
-	  for (string_elf_symbol_map::const_iterator e =
-		 added_unrefed_fn_syms_.begin();
-	       e != added_unrefed_fn_syms_.end();
-	       ++e)
-	    if (fn_suppr->suppresses_function_symbol(e->second,
-						     function_suppression::ADDED_FUNCTION_CHANGE_KIND,
-						     ctxt))
-	      suppressed_added_unrefed_fn_syms_[e->first] = e->second;
-
-	  // Removed function symbols not referenced by any debug info
-	  for (string_elf_symbol_map::const_iterator e =
-		 deleted_unrefed_fn_syms_.begin();
-	       e != deleted_unrefed_fn_syms_.end();
-	       ++e)
-	    if (fn_suppr->suppresses_function_symbol(e->second,
-						     function_suppression::DELETED_FUNCTION_CHANGE_KIND,
-						     ctxt))
-	      suppressed_deleted_unrefed_fn_syms_[e->first] = e->second;
-	}
       // Added/Delete virtual member functions changes that might be
       // suppressed by a type_suppression that matches the enclosing
       // class of the virtual member function.
-      else if (type_suppression_sptr type_suppr = is_type_suppression(*i))
+      if (type_suppression_sptr type_suppr = is_type_suppression(*i))
 	{
 	  // Added virtual functions
 	  for (string_function_ptr_map::const_iterator e = added_fns_.begin();
@@ -9759,48 +9876,6 @@ corpus_diff::priv::apply_supprs_to_added_removed_fns_vars_unreachable_types()
 	    if (type_suppr->suppresses_type(e->second, ctxt))
 	      suppressed_added_unreachable_types_[e->first] = e->second;
 	}
-      // Added/Deleted variables
-      else if (variable_suppression_sptr var_suppr =
-	       is_variable_suppression(*i))
-	{
-	  // Added variables
-	  for (string_var_ptr_map::const_iterator e = added_vars_.begin();
-	       e != added_vars_.end();
-	       ++e)
-	    if (variable_is_suppressed(e->second, var_suppr,
-				       variable_suppression::ADDED_VARIABLE_CHANGE_KIND,
-				       ctxt))
-	      suppressed_added_vars_[e->first] = e->second;
-
-	  //Deleted variables
-	  for (string_var_ptr_map::const_iterator e = deleted_vars_.begin();
-	       e != deleted_vars_.end();
-	       ++e)
-	    if (variable_is_suppressed(e->second, var_suppr,
-				       variable_suppression::DELETED_VARIABLE_CHANGE_KIND,
-				       ctxt))
-	      suppressed_deleted_vars_[e->first] = e->second;
-
-	  // Added variable symbols not referenced by any debug info
-	  for (string_elf_symbol_map::const_iterator e =
-		 added_unrefed_var_syms_.begin();
-	       e != added_unrefed_var_syms_.end();
-	       ++e)
-	    if (var_suppr->suppresses_variable_symbol(e->second,
-						      variable_suppression::ADDED_VARIABLE_CHANGE_KIND,
-						      ctxt))
-	      suppressed_added_unrefed_var_syms_[e->first] = e->second;
-
-	  // Removed variable symbols not referenced by any debug info
-	  for (string_elf_symbol_map::const_iterator e =
-		 deleted_unrefed_var_syms_.begin();
-	       e != deleted_unrefed_var_syms_.end();
-	       ++e)
-	    if (var_suppr->suppresses_variable_symbol(e->second,
-						      variable_suppression::DELETED_VARIABLE_CHANGE_KIND,
-						      ctxt))
-	      suppressed_deleted_unrefed_var_syms_[e->first] = e->second;
-	}
     }
 }
 
@@ -11253,6 +11328,10 @@ corpus_diff::apply_filters_and_suppressions_before_reporting()
   if (priv_->diff_stats_)
     return *priv_->diff_stats_;
 
+  metrics::scoped_phase
+    phase(first_corpus()->get_environment().get_metrics(),
+	  "comparison.apply-filters-and-suppressions");
+
   tools_utils::timer t;
   if (do_log())
     {
@@ -11430,6 +11509,9 @@ corpus_diff::get_leaf_diffs() const
 void
 corpus_diff::report(ostream& out, const string& indent) const
 {
+  metrics::scoped_phase
+    phase(first_corpus()->get_environment().get_metrics(),
+	  "reporter.report");
   context()->get_reporter()->report(*this, out, indent);
 }
 
@@ -11547,6 +11629,9 @@ compute_diff(const corpus_sptr	f,
 
   ABG_ASSERT(f && s);
 
+  metrics::scoped_phase phase(f->get_environment().get_metrics(),
+			      "comparison.compute-corpus-diff");
+
   if (!ctxt)
     ctxt.reset(new diff_context);
 
@@ -11562,15 +11647,19 @@ compute_diff(const corpus_sptr	f,
   r->priv_->architectures_equal_ =
     f->get_architecture_name() == s->get_architecture_name();
 
-  // Compute the diff of publicly defined and exported functions
-  diff_utils::compute_diff<fns_it_type, eq_type>(f->get_functions().begin(),
-						 f->get_functions().end(),
-						 s->get_functions().begin(),
-						 s->get_functions().end(),
-						 r->priv_->fns_edit_script_);
+  // Compute the diff of publicly defined and exported functions.
+  //
+  // The functions are matched by ID first, so that only the
+  // functions that have no counterpart with the same ID are compared
+  // with the (quadratic in the worst case) sequence diffing
+  // algorithm.
+  diff_utils::compute_diff_by_key<fns_it_type, function_key, eq_type>
+    (f->get_functions().begin(), f->get_functions().end(),
+     s->get_functions().begin(), s->get_functions().end(),
+     r->priv_->fns_edit_script_);
 
   // Compute the diff of publicly defined and exported variables.
-  diff_utils::compute_diff<vars_it_type, eq_type>
+  diff_utils::compute_diff_by_key<vars_it_type, var_key, eq_type>
     (f->get_variables().begin(), f->get_variables().end(),
      s->get_variables().begin(), s->get_variables().end(),
      r->priv_->vars_edit_script_);
@@ -747,6 +747,10 @@ struct corpus::priv
   type_maps					type_per_loc_map_;
   mutable vector<type_base_wptr>		types_not_reachable_from_pub_ifaces_;
   unordered_set<interned_string, hash_interned_string> *pub_type_pretty_reprs_;
+  // The corpus some translation units of this corpus were taken
+  // from, if any.  It's kept alive as the types of these translation
+  // units can refer to types of its other translation units.
+  corpus_sptr					baseline_corpus;
   bool 						do_log;
 
 private:
@@ -813,6 +817,9 @@ public:
   unordered_set<interned_string, hash_interned_string>*
   get_public_types_pretty_representations();
 
+  void
+  drop_symbols_and_exported_decls();
+
   ~priv();
 }; // end struct corpus::priv
 
@@ -859,6 +866,9 @@ maybe_update_types_lookup_map(const decl_base_sptr& decl);
 void
 maybe_update_types_lookup_map(const type_base_sptr& type);
 
+void
+add_types_to_corpus_lookup_maps(translation_unit& tu);
+
 }// end namespace ir
 
 }// end namespace abigail
@@ -629,6 +629,31 @@ corpus::priv::get_public_types_pretty_representations()
   return pub_type_pretty_reprs_;
 }
 
+/// Drop the symbol table of the corpus, the tables of its exported
+/// declarations, and the symbol maps computed from them.
+///
+/// The declarations and types of the corpus are left alone.
+void
+corpus::priv::drop_symbols_and_exported_decls()
+{
+  exported_decls_builder.reset();
+  vector<function_decl*>().swap(fns);
+  vector<var_decl*>().swap(vars);
+  symtab_.reset();
+  sorted_var_symbols = abg_compat::optional<elf_symbols>();
+  var_symbol_map = abg_compat::optional<string_elf_symbols_map_type>();
+  sorted_undefined_var_symbols = abg_compat::optional<elf_symbols>();
+  undefined_var_symbol_map =
+    abg_compat::optional<string_elf_symbols_map_type>();
+  unrefed_var_symbols = abg_compat::optional<elf_symbols>();
+  sorted_fun_symbols = abg_compat::optional<elf_symbols>();
+  fun_symbol_map = abg_compat::optional<string_elf_symbols_map_type>();
+  sorted_undefined_fun_symbols = abg_compat::optional<elf_symbols>();
+  undefined_fun_symbol_map =
+    abg_compat::optional<string_elf_symbols_map_type>();
+  unrefed_fun_symbols = abg_compat::optional<elf_symbols>();
+}
+
 /// Destructor of the @ref corpus::priv type.
 corpus::priv::~priv()
 {
@@ -1591,6 +1616,109 @@ corpus::get_exported_decls_builder() const
   return priv_->exported_decls_builder;
 }
 
+/// Release the ELF symbols of the current corpus, as well as its
+/// tables of exported functions and variables.
+///
+/// This is meant for a corpus that is not going to be looked at
+/// anymore, e.g, a member of a corpus group that was already
+/// serialized.  The types and declarations of the corpus are kept,
+/// as the other members of its group might refer to them.  After
+/// this, the corpus has no symbol and exports no declaration.
+void
+corpus::drop_symbols_and_exported_decls()
+{priv_->drop_symbols_and_exported_decls();}
+
+/// A visitor that records the memory used by the IR nodes it
+/// visits.
+///
+/// A node reachable from several others, like a type used by several
+/// declarations, is only recorded (and its sub-tree walked) once.
+class memory_usage_recorder : public ir_node_visitor
+{
+  metrics::memory_stats&			stats_;
+  std::unordered_set<const type_or_decl_base*>	recorded_;
+
+  /// Record the memory used by a node, unless it was already
+  /// recorded.
+  ///
+  /// @param node the node to consider.
+  ///
+  /// @return true iff @p node was not recorded already, meaning its
+  /// sub-tree must be walked.
+  bool
+  record(const type_or_decl_base* node)
+  {
+    if (!recorded_.insert(node).second)
+      return false;
+    record_memory_usage(*node, stats_);
+    return true;
+  }
+
+public:
+  memory_usage_recorder(metrics::memory_stats& stats)
+    : stats_(stats)
+  {}
+
+  virtual bool
+  visit_begin(decl_base* d)
+  {return record(d);}
+
+  virtual bool
+  visit_begin(scope_decl* d)
+  {return record(d);}
+
+  virtual bool
+  visit_begin(type_base* t)
+  {return record(t);}
+}; // end class memory_usage_recorder
+
+/// Record the memory used by the IR nodes and the locations of the
+/// translation units of a corpus, or of the corpora of a corpus
+/// group.
+///
+/// @param corp the corpus to consider.
+///
+/// @param recorder the visitor recording the memory used by the IR
+/// nodes.
+///
+/// @param stats the memory statistics to record into.
+static void
+record_memory_usage(const corpus& corp,
+		    memory_usage_recorder& recorder,
+		    metrics::memory_stats& stats)
+{
+  for (const translation_unit_sptr& tu : corp.get_translation_units())
+    {
+      tu->traverse(recorder);
+      tu->get_loc_mgr().get_memory_stats(stats);
+    }
+
+  if (const corpus_group* group = dynamic_cast<const corpus_group*>(&corp))
+    for (const corpus_sptr& c : group->get_corpora())
+      record_memory_usage(*c, recorder, stats);
+}
+
+/// Record the memory used by the corpus and by its environment.
+///
+/// The IR nodes of the corpus are walked and recorded by kind, in
+/// the categories "ir.class-type", "ir.function-decl", etc.  See
+/// record_memory_usage.  The tables of locations of the translation
+/// units are recorded as well, and so are the interned strings and
+/// the map of canonical types of the environment.  See
+/// environment::get_memory_stats.
+///
+/// If the corpus is a @ref corpus_group, the IR nodes of its corpora
+/// are recorded.
+///
+/// @param stats the memory statistics to record into.
+void
+corpus::get_memory_stats(metrics::memory_stats& stats) const
+{
+  memory_usage_recorder recorder(stats);
+  record_memory_usage(*this, recorder, stats);
+  get_environment().get_memory_stats(stats);
+}
+
 /// Bitwise | operator for the corpus::origin type.
 ///
 /// @param l the left-hand side operand of the | operation.
@@ -647,6 +647,8 @@ public:
   corpus_sptr
   read_corpus(fe_iface::status &status)
   {
+    metrics::scoped_phase phase(env().get_metrics(), "ctf.read-corpus");
+    arena_allocation_scope arena_scope(env());
     corpus_sptr corp = corpus();
     status = fe_iface::STATUS_UNKNOWN;
 
@@ -0,0 +1,1110 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2023 Red Hat, Inc.
+
+/// @file
+///
+/// This contains the definitions of the reader of the .debug_names
+/// and .gdb_index name indexes.
+///
+/// The format of the .debug_names section is described in section
+/// 6.1.1 of the DWARF 5 specification.  The format of the .gdb_index
+/// section is described in the "Index Section Format" appendix of the
+/// GDB manual.
+
+#include <cctype>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "abg-elf-helpers.h"
+#include "abg-internal.h"
+
+// Though this is an internal header, we need to export the symbols to be able
+// to test this code.
+ABG_BEGIN_EXPORT_DECLARATIONS
+#include "abg-dwarf-name-index.h"
+ABG_END_EXPORT_DECLARATIONS
+
+namespace abigail
+{
+namespace dwarf_name_index
+{
+
+// The values of the DW_IDX_* and DW_FORM_* constants that can be
+// used by the .debug_names section.  They are defined here because
+// not all of them are provided by the oldest versions of elfutils
+// that are supported.
+enum
+{
+  IDX_compile_unit	= 0x01,
+  IDX_type_unit		= 0x02,
+  IDX_die_offset	= 0x03
+};
+
+enum
+{
+  FORM_data2		= 0x05,
+  FORM_data4		= 0x06,
+  FORM_data8		= 0x07,
+  FORM_data1		= 0x0b,
+  FORM_flag		= 0x0c,
+  FORM_sdata		= 0x0d,
+  FORM_udata		= 0x0f,
+  FORM_ref1		= 0x11,
+  FORM_ref2		= 0x12,
+  FORM_ref4		= 0x13,
+  FORM_ref8		= 0x14,
+  FORM_ref_udata	= 0x15,
+  FORM_sec_offset	= 0x17,
+  FORM_flag_present	= 0x19,
+  FORM_data16		= 0x1e,
+  FORM_ref_sig8		= 0x20,
+  FORM_implicit_const	= 0x21
+};
+
+/// A cursor that reads integers from the content of a section,
+/// without reading past the end of the content.
+///
+/// Once an attempt to read past the end has been made, the cursor is
+/// no longer "ok" and all subsequent reads yield zero.
+class section_cursor
+{
+  const unsigned char*	cur_;
+  const unsigned char*	end_;
+  bool			is_big_endian_;
+  bool			is_ok_;
+
+public:
+
+  section_cursor(const unsigned char* begin,
+		 const unsigned char* end,
+		 bool is_big_endian)
+    : cur_(begin), end_(end), is_big_endian_(is_big_endian),
+      is_ok_(begin <= end)
+  {}
+
+  /// @return true iff no attempt to read past the end was made.
+  bool
+  ok() const
+  {return is_ok_;}
+
+  /// @return the current position of the cursor.
+  const unsigned char*
+  cur() const
+  {return cur_;}
+
+  /// @return the number of bytes left to read.
+  size_t
+  remaining() const
+  {return is_ok_ ? end_ - cur_ : 0;}
+
+  /// Skip some bytes.
+  ///
+  /// @param n the number of bytes to skip.
+  ///
+  /// @return true iff the bytes could be skipped.
+  bool
+  skip(uint64_t n)
+  {
+    if (n > remaining())
+      is_ok_ = false;
+    else
+      cur_ += n;
+    return is_ok_;
+  }
+
+  /// Read an unsigned integer of a given size.
+  ///
+  /// @param size the size of the integer, in bytes.  Must be at most
+  /// 8.
+  ///
+  /// @return the integer read.
+  uint64_t
+  read(size_t size)
+  {
+    if (size > remaining())
+      {
+	is_ok_ = false;
+	return 0;
+      }
+
+    uint64_t result = 0;
+    for (size_t i = 0; i < size; ++i)
+      {
+	size_t shift = is_big_endian_ ? (size - 1 - i) * 8 : i * 8;
+	result |= static_cast<uint64_t>(cur_[i]) << shift;
+      }
+    cur_ += size;
+    return result;
+  }
+
+  /// Read an unsigned LEB128 integer.
+  ///
+  /// @return the integer read.
+  uint64_t
+  read_uleb128()
+  {
+    uint64_t result = 0;
+    for (unsigned shift = 0; remaining(); shift += 7)
+      {
+	unsigned char byte = *cur_++;
+	if (shift < 64)
+	  result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+	if (!(byte & 0x80))
+	  return result;
+      }
+    is_ok_ = false;
+    return 0;
+  }
+
+  /// Read a signed LEB128 integer.
+  ///
+  /// @return the integer read.
+  int64_t
+  read_sleb128()
+  {
+    uint64_t result = 0;
+    for (unsigned shift = 0; remaining();)
+      {
+	unsigned char byte = *cur_++;
+	if (shift < 64)
+	  result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+	shift += 7;
+	if (!(byte & 0x80))
+	  {
+	    if (shift < 64 && (byte & 0x40))
+	      result |= ~static_cast<uint64_t>(0) << shift;
+	    return static_cast<int64_t>(result);
+	  }
+      }
+    is_ok_ = false;
+    return 0;
+  }
+}; // end class section_cursor
+
+/// An attribute specification of an abbreviation of a .debug_names
+/// section.
+struct debug_names_attribute
+{
+  uint64_t	index;
+  uint64_t	form;
+  int64_t	implicit_const;
+}; // end struct debug_names_attribute
+
+/// Read the value of an attribute of an entry of a .debug_names
+/// section.
+///
+/// @param cursor the cursor to read the value from.
+///
+/// @param attr the specification of the attribute to read.
+///
+/// @param offset_size the size of the section offsets of the name
+/// index, in bytes.
+///
+/// @param value output parameter.  The value read.  Values that are
+/// not integers of at most 64 bits are skipped and read as zero.
+///
+/// @return true iff the form of the attribute is supported and its
+/// value could be read.
+static bool
+read_debug_names_attribute(section_cursor&		cursor,
+			   const debug_names_attribute&	attr,
+			   size_t			offset_size,
+			   uint64_t&			value)
+{
+  value = 0;
+  switch (attr.form)
+    {
+    case FORM_data1:
+    case FORM_ref1:
+    case FORM_flag:
+      value = cursor.read(1);
+      break;
+    case FORM_data2:
+    case FORM_ref2:
+      value = cursor.read(2);
+      break;
+    case FORM_data4:
+    case FORM_ref4:
+      value = cursor.read(4);
+      break;
+    case FORM_data8:
+    case FORM_ref8:
+    case FORM_ref_sig8:
+      value = cursor.read(8);
+      break;
+    case FORM_sec_offset:
+      value = cursor.read(offset_size);
+      break;
+    case FORM_udata:
+    case FORM_ref_udata:
+      value = cursor.read_uleb128();
+      break;
+    case FORM_sdata:
+      value = cursor.read_sleb128();
+      break;
+    case FORM_flag_present:
+      value = 1;
+      break;
+    case FORM_implicit_const:
+      value = attr.implicit_const;
+      break;
+    case FORM_data16:
+      cursor.skip(16);
+      break;
+    default:
+      return false;
+    }
+  return cursor.ok();
+}
+
+/// Get the content of a section.
+///
+/// @param section the section to consider.
+///
+/// @param data output parameter.  The content of the section.
+///
+/// @param size output parameter.  The size of the content of the
+/// section.
+///
+/// @return true iff the content of the section could be read.  This
+/// is not the case of compressed sections, which are normally
+/// decompressed by libdw when it opens the debug info.
+static bool
+get_section_data(Elf_Scn* section, const unsigned char*& data, size_t& size)
+{
+  GElf_Shdr header_mem;
+  GElf_Shdr* header = gelf_getshdr(section, &header_mem);
+  if (!header
+      || header->sh_type == SHT_NOBITS
+      || (header->sh_flags & SHF_COMPRESSED))
+    return false;
+
+  Elf_Data* d = elf_getdata(section, 0);
+  if (!d || !d->d_buf)
+    return false;
+
+  data = static_cast<const unsigned char*>(d->d_buf);
+  size = d->d_size;
+  return true;
+}
+
+/// Compute the hash of a name as the hash tables of .debug_names do.
+///
+/// This is the DJB hash of the name, after case folding.  As only
+/// the case folding of ASCII letters is done here, the hash of names
+/// with non-ASCII characters can't be computed.
+///
+/// @param name the name to hash.
+///
+/// @param hash output parameter.  The hash of @p name.
+///
+/// @return true iff the hash could be computed.
+static bool
+debug_names_hash(const std::string& name, uint32_t& hash)
+{
+  hash = 5381;
+  for (unsigned char c : name)
+    {
+      if (c >= 0x80)
+	return false;
+      hash = hash * 33 + tolower(c);
+    }
+  return true;
+}
+
+/// Compute the hash of a name as the hash table of .gdb_index does.
+///
+/// @param name the name to hash.
+///
+/// @param version the version of the .gdb_index section.  From
+/// version 5 on, the hash is case insensitive.
+///
+/// @return the hash of @p name.
+static uint32_t
+gdb_index_hash(const std::string& name, uint64_t version)
+{
+  uint32_t hash = 0;
+  for (unsigned char c : name)
+    {
+      if (version >= 5)
+	c = tolower(c);
+      hash = hash * 67 + c - 113;
+    }
+  return hash;
+}
+
+/// Test if a name equals the string at a given offset of a string
+/// table.
+///
+/// @param name the name to consider.
+///
+/// @param str_data the string table.
+///
+/// @param str_size the size of @p str_data.
+///
+/// @param offset the offset of the string in @p str_data.
+///
+/// @return true iff the string at @p offset is @p name.
+static bool
+string_at_offset_equals(const std::string&	name,
+			const unsigned char*	str_data,
+			size_t			str_size,
+			uint64_t		offset)
+{
+  if (offset >= str_size || str_size - offset <= name.size())
+    return false;
+  const char* s = reinterpret_cast<const char*>(str_data + offset);
+  return name.compare(0, name.size(), s, name.size()) == 0
+    && s[name.size()] == '\0';
+}
+
+/// Add an entry to a vector of entries, unless it's already there.
+///
+/// @param entries the vector of entries to add to.
+///
+/// @param unit_offset the offset of the compilation unit of the
+/// entry.
+///
+/// @param die_offset the offset of the DIE of the entry, or zero if
+/// it's unknown.
+static void
+add_entry(name_index::entries_type&	entries,
+	  uint64_t			unit_offset,
+	  uint64_t			die_offset)
+{
+  for (const entry& e : entries)
+    if (e.unit_offset == unit_offset && e.die_offset == die_offset)
+      return;
+  entries.push_back(entry(unit_offset, die_offset));
+}
+
+/// One of the name indexes of a .debug_names section.
+///
+/// A .debug_names section is made of a sequence of name indexes,
+/// typically one per compilation unit, unless the linker merged
+/// them.
+struct debug_names_unit
+{
+  size_t		offset_size;
+  uint64_t		comp_unit_count;
+  uint64_t		bucket_count;
+  uint64_t		name_count;
+  const unsigned char*	comp_units;
+  const unsigned char*	buckets;
+  const unsigned char*	hashes;
+  const unsigned char*	string_offsets;
+  const unsigned char*	entry_offsets;
+  const unsigned char*	entry_pool;
+  const unsigned char*	end;
+  std::unordered_map<uint64_t,
+		     std::vector<debug_names_attribute>> abbrev_table;
+  // If the name index has no hash table, this maps its names to
+  // their indexes in the name table.
+  std::unordered_map<std::string, uint64_t> names;
+}; // end struct debug_names_unit
+
+/// The private data of the @ref name_index type.
+struct name_index::priv
+{
+  kind					kind_;
+  size_t				number_of_names_;
+  std::unordered_set<uint64_t>		covered_units_;
+  bool					is_big_endian_;
+
+  // The name indexes of a .debug_names section, and the content of
+  // the .debug_str section.
+  std::vector<debug_names_unit>		debug_names_units_;
+  const unsigned char*			str_data_;
+  size_t				str_size_;
+
+  // The compilation units, the symbol table and the constant pool
+  // of a .gdb_index section.
+  uint64_t				gdb_index_version_;
+  std::vector<uint64_t>			gdb_index_units_;
+  const unsigned char*			symbol_table_;
+  uint64_t				symbol_table_slots_;
+  const unsigned char*			constant_pool_;
+  size_t				constant_pool_size_;
+
+  priv(kind k)
+    : kind_(k),
+      number_of_names_(),
+      is_big_endian_(),
+      str_data_(),
+      str_size_(),
+      gdb_index_version_(),
+      symbol_table_(),
+      symbol_table_slots_(),
+      constant_pool_(),
+      constant_pool_size_()
+  {}
+
+  /// Read the entries of a name of a name index of the .debug_names
+  /// section.
+  ///
+  /// @param u the name index to consider.
+  ///
+  /// @param i the index of the name in the name table of @p u.
+  ///
+  /// @param entries the vector to add the entries of the name to.
+  void
+  read_debug_names_entries(const debug_names_unit&	u,
+			   uint64_t			i,
+			   entries_type&		entries) const
+  {
+    section_cursor entry_offset(u.entry_offsets + i * u.offset_size,
+				u.entry_offsets + (i + 1) * u.offset_size,
+				is_big_endian_);
+    uint64_t pool_offset = entry_offset.read(u.offset_size);
+    if (pool_offset > static_cast<uint64_t>(u.end - u.entry_pool))
+      return;
+
+    section_cursor e(u.entry_pool + pool_offset, u.end, is_big_endian_);
+    for (uint64_t code = e.read_uleb128(); code; code = e.read_uleb128())
+      {
+	auto abbrev = u.abbrev_table.find(code);
+	if (abbrev == u.abbrev_table.end())
+	  return;
+
+	// If there is only one compilation unit, the entries don't
+	// need to tell which one they belong to.
+	uint64_t cu_index = 0, die_offset = 0, value = 0;
+	bool has_cu_index = u.comp_unit_count == 1;
+	bool has_die_offset = false, is_in_type_unit = false;
+	for (const debug_names_attribute& attr : abbrev->second)
+	  {
+	    if (!read_debug_names_attribute(e, attr, u.offset_size, value))
+	      return;
+	    switch (attr.index)
+	      {
+	      case IDX_compile_unit:
+		cu_index = value;
+		has_cu_index = true;
+		break;
+	      case IDX_type_unit:
+		is_in_type_unit = true;
+		break;
+	      case IDX_die_offset:
+		die_offset = value;
+		has_die_offset = true;
+		break;
+	      default:
+		break;
+	      }
+	  }
+
+	if (is_in_type_unit
+	    || !has_cu_index
+	    || !has_die_offset
+	    || cu_index >= u.comp_unit_count)
+	  continue;
+
+	// The offset of the DIE is relative to its unit.
+	section_cursor cu(u.comp_units + cu_index * u.offset_size,
+			  u.comp_units + (cu_index + 1) * u.offset_size,
+			  is_big_endian_);
+	uint64_t unit_offset = cu.read(u.offset_size);
+	add_entry(entries, unit_offset, unit_offset + die_offset);
+      }
+  }
+
+  /// Look up a name in a name index of the .debug_names section.
+  ///
+  /// @param u the name index to look the name up in.
+  ///
+  /// @param name the name to look up.
+  ///
+  /// @param entries the vector to add the entries of the name to.
+  void
+  lookup_in_debug_names_unit(const debug_names_unit&	u,
+			     const std::string&		name,
+			     entries_type&		entries) const
+  {
+    uint32_t hash = 0;
+    if (!u.bucket_count || !debug_names_hash(name, hash))
+      {
+	// Without a hash table, or a hash, use the map of the names.
+	// It's built when the index is read if there is no hash
+	// table.  Otherwise, names with non-ASCII characters are
+	// looked up linearly; they are rare.
+	if (!u.bucket_count)
+	  {
+	    auto i = u.names.find(name);
+	    if (i != u.names.end())
+	      read_debug_names_entries(u, i->second, entries);
+	    return;
+	  }
+	for (uint64_t i = 0; i < u.name_count; ++i)
+	  {
+	    section_cursor c(u.string_offsets + i * u.offset_size,
+			     u.string_offsets + (i + 1) * u.offset_size,
+			     is_big_endian_);
+	    if (string_at_offset_equals(name, str_data_, str_size_,
+					c.read(u.offset_size)))
+	      read_debug_names_entries(u, i, entries);
+	  }
+	return;
+      }
+
+    // The names of a bucket are consecutive in the name table, and
+    // the bucket holds the index (starting at 1) of the first one.
+    uint64_t bucket = hash % u.bucket_count;
+    section_cursor b(u.buckets + bucket * 4, u.buckets + (bucket + 1) * 4,
+		     is_big_endian_);
+    uint64_t first = b.read(4);
+    if (!first)
+      return;
+    for (uint64_t i = first - 1; i < u.name_count; ++i)
+      {
+	section_cursor h(u.hashes + i * 4, u.hashes + (i + 1) * 4,
+			 is_big_endian_);
+	uint32_t name_hash = h.read(4);
+	if (name_hash % u.bucket_count != bucket)
+	  break;
+	if (name_hash != hash)
+	  continue;
+	section_cursor c(u.string_offsets + i * u.offset_size,
+			 u.string_offsets + (i + 1) * u.offset_size,
+			 is_big_endian_);
+	if (string_at_offset_equals(name, str_data_, str_size_,
+				    c.read(u.offset_size)))
+	  read_debug_names_entries(u, i, entries);
+      }
+  }
+
+  /// Look up a name in the .gdb_index section.
+  ///
+  /// @param name the name to look up.
+  ///
+  /// @param entries the vector to add the entries of the name to.
+  void
+  lookup_in_gdb_index(const std::string& name, entries_type& entries) const
+  {
+    if (!symbol_table_slots_)
+      return;
+
+    // The symbol table is an open addressing hash table which size
+    // is a power of two.
+    uint32_t hash = gdb_index_hash(name, gdb_index_version_);
+    uint64_t mask = symbol_table_slots_ - 1;
+    uint64_t slot = hash & mask;
+    uint64_t step = ((hash * 17) & mask) | 1;
+    for (uint64_t n = 0; n < symbol_table_slots_; ++n)
+      {
+	section_cursor c(symbol_table_ + slot * 8,
+			 symbol_table_ + (slot + 1) * 8,
+			 /*is_big_endian=*/false);
+	uint64_t name_offset = c.read(4);
+	uint64_t cu_vector_offset = c.read(4);
+	if (!name_offset && !cu_vector_offset)
+	  // This is an empty slot, so the name is not in the table.
+	  return;
+
+	if (string_at_offset_equals(name, constant_pool_,
+				    constant_pool_size_, name_offset)
+	    && cu_vector_offset < constant_pool_size_)
+	  {
+	    section_cursor cu_vector(constant_pool_ + cu_vector_offset,
+				     constant_pool_ + constant_pool_size_,
+				     /*is_big_endian=*/false);
+	    uint64_t count = cu_vector.read(4);
+	    for (uint64_t i = 0; i < count && cu_vector.ok(); ++i)
+	      {
+		// The low 24 bits are the index of the unit in the list
+		// of compilation units followed by the list of type
+		// units.  The high bits are attributes of the symbol.
+		uint64_t cu_index = cu_vector.read(4) & 0xffffff;
+		if (cu_vector.ok() && cu_index < gdb_index_units_.size())
+		  add_entry(entries, gdb_index_units_[cu_index], 0);
+	      }
+	    return;
+	  }
+
+	slot = (slot + step) & mask;
+      }
+  }
+}; // end struct name_index::priv
+
+/// Constructor of the @ref name_index type.
+///
+/// @param k the kind of section the index is read from.
+name_index::name_index(kind k)
+  : priv_(new priv(k))
+{}
+
+/// Destructor of the @ref name_index type.
+name_index::~name_index() = default;
+
+/// Getter of the kind of section the index was read from.
+///
+/// @return the kind of section the index was read from.
+name_index::kind
+name_index::get_kind() const
+{return priv_->kind_;}
+
+/// Look up the entries of a given name.
+///
+/// Note that .debug_names indexes the DIEs by their DW_AT_name and
+/// DW_AT_linkage_name, whereas .gdb_index indexes them by their
+/// (demangled) qualified name.
+///
+/// @param name the name to look up.
+///
+/// @param entries output parameter.  The entries of the DIEs named
+/// @p name.
+///
+/// @return true iff there is at least one DIE named @p name.
+bool
+name_index::lookup(const std::string& name, entries_type& entries) const
+{
+  entries.clear();
+  if (priv_->kind_ == GDB_INDEX_KIND)
+    priv_->lookup_in_gdb_index(name, entries);
+  else
+    for (const debug_names_unit& u : priv_->debug_names_units_)
+      priv_->lookup_in_debug_names_unit(u, name, entries);
+  return !entries.empty();
+}
+
+/// Getter of the number of names in the index.
+///
+/// For a .debug_names section made of several name indexes, a name
+/// that is in several of them is counted several times.
+///
+/// @return the number of names in the index.
+size_t
+name_index::get_number_of_names() const
+{return priv_->number_of_names_;}
+
+/// Test if the index covers a given compilation unit.
+///
+/// The names of the DIEs of a unit that is not covered by the index
+/// are not in the index.
+///
+/// @param unit_offset the offset of the header of the unit, in the
+/// .debug_info section.
+///
+/// @return true iff the index covers the unit at @p unit_offset.
+bool
+name_index::covers_unit(uint64_t unit_offset) const
+{return priv_->covered_units_.count(unit_offset);}
+
+/// Getter of the number of compilation units covered by the index.
+///
+/// @return the number of compilation units covered by the index.
+size_t
+name_index::get_number_of_covered_units() const
+{return priv_->covered_units_.size();}
+
+/// Load the name index of an ELF file.
+///
+/// The .debug_names section is used if it's present.  Otherwise, the
+/// .gdb_index section is used.
+///
+/// @param elf_handle the ELF file containing the debug info.  The
+/// name index refers to its content, so it must not be used once
+/// @p elf_handle is closed.
+///
+/// @return the name index, or nil if the ELF file has no name index
+/// or if it couldn't be read.
+name_index_sptr
+name_index::load(Elf* elf_handle)
+{
+  name_index_sptr result;
+  if (!elf_handle)
+    return result;
+
+  const unsigned char* data = 0;
+  size_t size = 0;
+  if (Elf_Scn* section =
+      elf_helpers::find_section_by_name(elf_handle, ".debug_names"))
+    {
+      const unsigned char* str_data = 0;
+      size_t str_size = 0;
+      Elf_Scn* str_section =
+	elf_helpers::find_section_by_name(elf_handle, ".debug_str");
+      GElf_Ehdr ehdr_mem;
+      GElf_Ehdr* ehdr = gelf_getehdr(elf_handle, &ehdr_mem);
+      if (ehdr
+	  && str_section
+	  && get_section_data(section, data, size)
+	  && get_section_data(str_section, str_data, str_size))
+	result = read_debug_names(data, size, str_data, str_size,
+				  ehdr->e_ident[EI_DATA] == ELFDATA2MSB);
+    }
+
+  if (!result)
+    if (Elf_Scn* section =
+	elf_helpers::find_section_by_name(elf_handle, ".gdb_index"))
+      if (get_section_data(section, data, size))
+	result = read_gdb_index(data, size);
+
+  return result;
+}
+
+/// Read the name index of a .debug_names section.
+///
+/// Only the headers and the abbreviation tables of the section are
+/// read.  The names are looked up in the section by @ref
+/// name_index::lookup.
+///
+/// @param data the content of the .debug_names section.  It must
+/// outlive the returned index.
+///
+/// @param size the size of @p data.
+///
+/// @param str_data the content of the .debug_str section.  It must
+/// outlive the returned index.
+///
+/// @param str_size the size of @p str_data.
+///
+/// @param is_big_endian true iff the ELF file is big endian.
+///
+/// @return the name index or nil if the section is malformed or
+/// uses a version of the format that is not supported.
+name_index_sptr
+name_index::read_debug_names(const unsigned char*	data,
+			     size_t			size,
+			     const unsigned char*	str_data,
+			     size_t			str_size,
+			     bool			is_big_endian)
+{
+  name_index_sptr nil, result(new name_index(DEBUG_NAMES_KIND));
+  priv& p = *result->priv_;
+  p.is_big_endian_ = is_big_endian;
+  p.str_data_ = str_data;
+  p.str_size_ = str_size;
+
+  section_cursor section(data, data + size, is_big_endian);
+  while (section.remaining())
+    {
+      debug_names_unit u;
+      u.offset_size = 4;
+      uint64_t unit_length = section.read(4);
+      if (unit_length == 0xffffffff)
+	{
+	  u.offset_size = 8;
+	  unit_length = section.read(8);
+	}
+      if (!section.ok() || unit_length > section.remaining())
+	return nil;
+
+      u.end = section.cur() + unit_length;
+      section_cursor c(section.cur(), u.end, is_big_endian);
+      section.skip(unit_length);
+
+      uint64_t version = c.read(2);
+      c.skip(2); // padding
+      if (version != 5)
+	return nil;
+
+      u.comp_unit_count = c.read(4);
+      uint64_t local_type_unit_count = c.read(4);
+      uint64_t foreign_type_unit_count = c.read(4);
+      u.bucket_count = c.read(4);
+      u.name_count = c.read(4);
+      uint64_t abbrev_table_size = c.read(4);
+      uint64_t augmentation_string_size = c.read(4);
+      c.skip(augmentation_string_size);
+
+      u.comp_units = c.cur();
+      c.skip(u.comp_unit_count * u.offset_size);
+      c.skip(local_type_unit_count * u.offset_size);
+      c.skip(foreign_type_unit_count * 8);
+      // The hash lookup table is omitted if there are no buckets.
+      u.buckets = c.cur();
+      c.skip(u.bucket_count * 4);
+      u.hashes = c.cur();
+      if (u.bucket_count)
+	c.skip(u.name_count * 4);
+      u.string_offsets = c.cur();
+      c.skip(u.name_count * u.offset_size);
+      u.entry_offsets = c.cur();
+      c.skip(u.name_count * u.offset_size);
+      const unsigned char* abbrevs = c.cur();
+      c.skip(abbrev_table_size);
+      u.entry_pool = c.cur();
+      if (!c.ok())
+	return nil;
+
+      section_cursor cu(u.comp_units,
+			u.comp_units + u.comp_unit_count * u.offset_size,
+			is_big_endian);
+      for (uint64_t i = 0; i < u.comp_unit_count; ++i)
+	p.covered_units_.insert(cu.read(u.offset_size));
+
+      // Read the abbreviations of the entries.
+      section_cursor a(abbrevs, u.entry_pool, is_big_endian);
+      for (uint64_t code = a.read_uleb128(); code; code = a.read_uleb128())
+	{
+	  a.read_uleb128(); // the tag of the DIEs of the entries
+	  std::vector<debug_names_attribute>& attrs = u.abbrev_table[code];
+	  for (;;)
+	    {
+	      debug_names_attribute attr;
+	      attr.index = a.read_uleb128();
+	      attr.form = a.read_uleb128();
+	      attr.implicit_const = 0;
+	      if (!a.ok() || (!attr.index && !attr.form))
+		break;
+	      if (attr.form == FORM_implicit_const)
+		attr.implicit_const = a.read_sleb128();
+	      attrs.push_back(attr);
+	    }
+	  if (!a.ok())
+	    return nil;
+	}
+      if (!a.ok())
+	return nil;
+
+      // Without a hash table, names can only be looked up through a
+      // map of the names.
+      if (!u.bucket_count)
+	{
+	  section_cursor o(u.string_offsets, u.entry_offsets, is_big_endian);
+	  for (uint64_t i = 0; i < u.name_count; ++i)
+	    {
+	      uint64_t str_offset = o.read(u.offset_size);
+	      if (str_offset >= str_size)
+		return nil;
+	      const char* s =
+		reinterpret_cast<const char*>(str_data + str_offset);
+	      u.names.emplace(std::string(s, strnlen(s, str_size - str_offset)),
+			      i);
+	    }
+	}
+
+      p.number_of_names_ += u.name_count;
+      p.debug_names_units_.push_back(std::move(u));
+    }
+
+  return result;
+}
+
+/// Read the name index of a .gdb_index section.
+///
+/// Versions 4 to 9 of the format are supported.  Only the header and
+/// the list of compilation units of the section are read.  The names
+/// are looked up in the section by @ref name_index::lookup.
+///
+/// @param data the content of the .gdb_index section.  It must
+/// outlive the returned index.
+///
+/// @param size the size of @p data.
+///
+/// @return the name index or nil if the section is malformed or
+/// uses a version of the format that is not supported.
+name_index_sptr
+name_index::read_gdb_index(const unsigned char* data, size_t size)
+{
+  name_index_sptr nil, result(new name_index(GDB_INDEX_KIND));
+  priv& p = *result->priv_;
+
+  // The .gdb_index section is always little endian.
+  section_cursor header(data, data + size, /*is_big_endian=*/false);
+  uint64_t version = header.read(4);
+  if (version < 4 || version > 9)
+    return nil;
+
+  uint64_t cu_list_offset = header.read(4);
+  uint64_t types_cu_list_offset = header.read(4);
+  header.read(4); // the offset of the address area
+  uint64_t symbol_table_offset = header.read(4);
+  uint64_t symbol_table_end = header.read(4);
+  // Version 9 adds a shortcut table between the symbol table and
+  // the constant pool.
+  uint64_t constant_pool_offset =
+    version >= 9 ? header.read(4) : symbol_table_end;
+  uint64_t slots = (symbol_table_end - symbol_table_offset) / 8;
+  if (!header.ok()
+      || cu_list_offset > types_cu_list_offset
+      || symbol_table_offset > symbol_table_end
+      || symbol_table_end > constant_pool_offset
+      || types_cu_list_offset > size
+      || constant_pool_offset > size
+      // The symbol table is a hash table which size is a power of
+      // two.
+      || (slots & (slots - 1)))
+    return nil;
+
+  section_cursor cu_list(data + cu_list_offset, data + types_cu_list_offset,
+			 /*is_big_endian=*/false);
+  while (cu_list.remaining() >= 16)
+    {
+      p.gdb_index_units_.push_back(cu_list.read(8));
+      cu_list.read(8); // the length of the unit
+    }
+  p.covered_units_.insert(p.gdb_index_units_.begin(),
+			  p.gdb_index_units_.end());
+
+  p.gdb_index_version_ = version;
+  p.symbol_table_ = data + symbol_table_offset;
+  p.symbol_table_slots_ = slots;
+  p.constant_pool_ = data + constant_pool_offset;
+  p.constant_pool_size_ = size - constant_pool_offset;
+
+  // Count the names, i.e, the slots of the symbol table that are not
+  // empty.
+  section_cursor symbols(p.symbol_table_, p.symbol_table_ + slots * 8,
+			 /*is_big_endian=*/false);
+  for (uint64_t i = 0; i < slots; ++i)
+    {
+      uint64_t name_offset = symbols.read(4);
+      uint64_t cu_vector_offset = symbols.read(4);
+      if (name_offset || cu_vector_offset)
+	++p.number_of_names_;
+    }
+
+  return result;
+}
+
+/// Test if a character can be part of an identifier.
+///
+/// @param c the character to consider.
+///
+/// @return true iff @p c can be part of an identifier.
+static bool
+is_identifier_char(char c)
+{return isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$';}
+
+/// Test if the keyword "operator" starts at a given position of a
+/// name.
+///
+/// @param name the name to consider.
+///
+/// @param pos the position to consider in @p name.
+///
+/// @return true iff the keyword "operator" starts at @p pos.
+static bool
+operator_keyword_starts_at(const std::string& name, std::string::size_type pos)
+{
+  static const std::string keyword = "operator";
+  return (name.compare(pos, keyword.size(), keyword) == 0
+	  && (pos == 0 || !is_identifier_char(name[pos - 1]))
+	  && (pos + keyword.size() == name.size()
+	      || !is_identifier_char(name[pos + keyword.size()])));
+}
+
+/// Get the names under which a name index might index the DIE of a
+/// C++ function or variable, from the demangled name of its symbol.
+///
+/// The demangled name of a function symbol has the parameters of the
+/// function, and the return type of the function if it's a template
+/// instance.  Both kinds of names can have ABI tags.  For instance,
+/// "void ns::foo<int>(int)" or "ns::bar[abi:cxx11]()".  The DIE of
+/// the function is named without those: .gdb_index indexes it by its
+/// qualified name, e.g. "ns::foo<int>", and .debug_names by its
+/// unqualified name, e.g, "foo<int>", and by its linkage name.
+///
+/// As the return type can't always be told apart from the name
+/// without parsing the demangled name, all the names that might be
+/// the name of the DIE are returned.  Looking up a few more names
+/// than needed is harmless.
+///
+/// @param demangled_name the demangled name of the symbol.
+///
+/// @param names output parameter.  The names to look up.
+void
+get_lookup_names_of_demangled_name(const std::string& demangled_name,
+				   std::vector<std::string>& names)
+{
+  names.clear();
+  std::string name = demangled_name;
+
+  // Strip the ABI tags.
+  for (std::string::size_type pos = name.find("[abi:");
+       pos != std::string::npos;
+       pos = name.find("[abi:", pos))
+    {
+      std::string::size_type end = name.find(']', pos);
+      if (end == std::string::npos)
+	break;
+      name.erase(pos, end - pos + 1);
+    }
+
+  // Strip the parameters, and the qualifiers that follow them, from
+  // the name of a function.
+  std::string::size_type pos = name.rfind(')');
+  if (pos != std::string::npos)
+    {
+      int depth = 0;
+      for (;; --pos)
+	{
+	  if (name[pos] == ')')
+	    ++depth;
+	  else if (name[pos] == '(' && --depth == 0)
+	    break;
+	  if (pos == 0)
+	    break;
+	}
+      if (depth == 0 && pos > 0)
+	name.resize(pos);
+    }
+
+  // Find the spaces that might separate the return type from the
+  // name, i.e, those that are not nested in template arguments or
+  // parentheses and that are not part of the name of an operator.
+  std::vector<std::string::size_type> starts(1, 0);
+  int depth = 0;
+  for (pos = 0; pos < name.size(); ++pos)
+    {
+      if (operator_keyword_starts_at(name, pos))
+	{
+	  // Skip the operator name, e.g, "<<" in "operator<<" or
+	  // "new" in "operator new".  The name of a conversion
+	  // operator, e.g, "operator unsigned int", ends the name.
+	  pos += strlen("operator");
+	  while (pos < name.size() && name[pos] == ' ')
+	    ++pos;
+	  if (pos < name.size() && is_identifier_char(name[pos])
+	      && name.compare(pos, 3, "new") != 0
+	      && name.compare(pos, 6, "delete") != 0)
+	    break;
+	  while (pos < name.size()
+		 && !is_identifier_char(name[pos])
+		 && name[pos] != ' ')
+	    ++pos;
+	  while (pos < name.size() && is_identifier_char(name[pos]))
+	    ++pos;
+	  --pos;
+	  continue;
+	}
+
+      char c = name[pos];
+      if (c == '<' || c == '(')
+	++depth;
+      else if ((c == '>' || c == ')') && depth > 0)
+	--depth;
+      else if (c == ' ' && depth == 0 && pos + 1 < name.size())
+	starts.push_back(pos + 1);
+    }
+
+  for (std::string::size_type start : starts)
+    {
+      std::string qualified_name = name.substr(start);
+      names.push_back(qualified_name);
+
+      // The unqualified name is the part following the last "::" that
+      // is not nested in template arguments.
+      std::string::size_type last_scope = std::string::npos;
+      depth = 0;
+      for (pos = 0; pos + 1 < qualified_name.size(); ++pos)
+	{
+	  char c = qualified_name[pos];
+	  if (c == '<' || c == '(')
+	    ++depth;
+	  else if ((c == '>' || c == ')') && depth > 0)
+	    --depth;
+	  else if (depth == 0 && c == ':' && qualified_name[pos + 1] == ':')
+	    last_scope = pos;
+	}
+      if (last_scope != std::string::npos)
+	names.push_back(qualified_name.substr(last_scope + 2));
+    }
+}
+
+} // end namespace dwarf_name_index
+} // end namespace abigail
@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2023 Red Hat, Inc.
+
+/// @file
+///
+/// This contains the declarations of the reader of the name indexes
+/// that toolchains can emit along with DWARF debug info: the DWARF 5
+/// .debug_names section and the .gdb_index section.
+
+#ifndef __ABG_DWARF_NAME_INDEX_H__
+#define __ABG_DWARF_NAME_INDEX_H__
+
+#include <gelf.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace abigail
+{
+namespace dwarf_name_index
+{
+
+/// An entry of a @ref name_index.
+///
+/// It designates a DIE (or a compilation unit containing DIEs) of
+/// the .debug_info section that has a given name.
+struct entry
+{
+  /// The offset of the header of the compilation unit of the DIE, in
+  /// the .debug_info section.
+  uint64_t	unit_offset;
+
+  /// The offset of the DIE in the .debug_info section, or zero if
+  /// the index only tells the compilation unit of the DIE.  This is
+  /// the case of .gdb_index.
+  uint64_t	die_offset;
+
+  entry(uint64_t u, uint64_t d)
+    : unit_offset(u), die_offset(d)
+  {}
+}; // end struct entry
+
+class name_index;
+
+/// Convenience typedef for a shared pointer to @ref name_index.
+typedef std::shared_ptr<name_index> name_index_sptr;
+
+/// The name -> DIE index read from the .debug_names or .gdb_index
+/// section of a binary.
+///
+/// The index is not loaded into memory: names are looked up in the
+/// hash tables of the section.  So the index refers to the content
+/// of the section (and of the .debug_str section), which must
+/// outlive it.
+///
+/// Only the DIEs of compilation units are indexed.  The DIEs of type
+/// units are left out.
+///
+/// A name index doesn't necessarily cover all the compilation units
+/// of the debug info.  For instance, if some object files were
+/// compiled without the option to emit a name index, the linker
+/// merges the name indexes of the other object files only.  So the
+/// DIEs of a unit that is not covered by the index can't be looked
+/// up in it.
+///
+/// An example use of the name index is
+///
+/// if (name_index_sptr index = name_index::load(elf_handle))
+///   {
+///     name_index::entries_type entries;
+///     if (index->lookup("foo", entries))
+///       for (const entry& e : entries)
+///         std::cout << std::hex << e.unit_offset << "\n";
+///   }
+class name_index
+{
+public:
+  /// The kinds of sections a name index can be read from.
+  enum kind
+  {
+    DEBUG_NAMES_KIND,
+    GDB_INDEX_KIND
+  };
+
+  typedef std::vector<entry> entries_type;
+
+  ~name_index();
+
+  kind
+  get_kind() const;
+
+  bool
+  lookup(const std::string& name, entries_type& entries) const;
+
+  size_t
+  get_number_of_names() const;
+
+  bool
+  covers_unit(uint64_t unit_offset) const;
+
+  size_t
+  get_number_of_covered_units() const;
+
+  static name_index_sptr
+  load(Elf* elf_handle);
+
+  static name_index_sptr
+  read_debug_names(const unsigned char* data, size_t size,
+		   const unsigned char* str_data, size_t str_size,
+		   bool is_big_endian);
+
+  static name_index_sptr
+  read_gdb_index(const unsigned char* data, size_t size);
+
+private:
+  struct priv;
+  std::unique_ptr<priv> priv_;
+
+  name_index(kind k);
+}; // end class name_index
+
+void
+get_lookup_names_of_demangled_name(const std::string& demangled_name,
+				   std::vector<std::string>& names);
+
+} // end namespace dwarf_name_index
+} // end namespace abigail
+
+#endif // __ABG_DWARF_NAME_INDEX_H__
@@ -25,6 +25,7 @@
 #include <cmath>
 #include <cstring>
 #include <deque>
+#include <iomanip>
 #include <list>
 #include <memory>
 #include <ostream>
@@ -38,15 +39,19 @@
 #include "abg-suppression-priv.h"
 #include "abg-corpus-priv.h"
 #include "abg-symtab-reader.h"
+#include "abg-dwarf-name-index.h"
 
 // <headers defining libabigail's API go under here>
 ABG_BEGIN_EXPORT_DECLARATIONS
 
+#include "abg-config.h"
 #include "abg-dwarf-reader.h"
 #include "abg-elf-based-reader.h"
 #include "abg-sptr-utils.h"
 #include "abg-tools-utils.h"
 #include "abg-elf-helpers.h"
+#include "abg-hash.h"
+#include "abg-reader.h"
 
 ABG_END_EXPORT_DECLARATIONS
 // </headers defining libabigail's API>
@@ -126,12 +131,59 @@ typedef unordered_map<Dwarf_Off, translation_unit_sptr> die_tu_map_type;
 /// the value is the corresponding qualified name of the DIE.
 typedef unordered_map<Dwarf_Off, interned_string> die_istring_map_type;
 
-/// Convenience typedef for a map which is an interned_string and
-/// which value is a vector of offsets.
+/// The structural hash of a DIE.
+///
+/// This is computed by reader::get_die_structural_hash.  If two DIEs
+/// compare equal and the structural hash of one of them is reliable,
+/// then their structural hashes are equal.
+struct die_structural_hash
+{
+  size_t	value = 0;
+  // This is false while the hash is being computed.
+  bool		computed = false;
+  // True iff the DIEs the hash depends on form a cycle.
+  bool		cyclic = false;
+  // True iff the DIEs the hash depends on come from languages for
+  // which the One Definition Rule is not relevant.
+  bool		odr_free = true;
+
+  /// Test if the hash can be used to rule out the equality of a DIE
+  /// with the DIEs that have a different hash.
+  ///
+  /// @return true iff the hash is reliable.
+  bool
+  is_reliable() const
+  {return !cyclic && odr_free;}
+}; // end struct die_structural_hash
+
+/// Convenience typedef for a map which key is the offset of a DIE and
+/// which value is the structural hash of the DIE.
+typedef unordered_map<Dwarf_Off, die_structural_hash>
+die_structural_hash_map_type;
+
+/// The DIEs that have the same string representation, as considered
+/// during DIE canonicalization.
+///
+/// The DIEs are also partitioned by structural hash so that a DIE is
+/// only compared to the DIEs of the bucket that have the same hash
+/// as its own, whenever that hash is reliable.
+struct die_repr_bucket
+{
+  // The offsets of the DIEs of the bucket, in the order in which
+  // they were added.
+  dwarf_offsets_type				offsets;
+  // The offsets of the DIEs of the bucket, per structural hash.
+  unordered_map<size_t, dwarf_offsets_type>	offsets_per_hash;
+  // True iff a DIE of the bucket has no reliable structural hash.
+  bool						has_unreliable_hash = false;
+}; // end struct die_repr_bucket
+
+/// Convenience typedef for a map which key is an interned_string and
+/// which value is a @ref die_repr_bucket.
 typedef unordered_map<interned_string,
-		      dwarf_offsets_type,
+		      die_repr_bucket,
 		      hash_interned_string>
-istring_dwarf_offsets_map_type;
+istring_die_repr_bucket_map_type;
 
 /// A hasher for a pair of Dwarf_Off.  This is used as a hasher for
 /// the type @ref dwarf_offset_pair_set_type.
@@ -509,6 +561,14 @@ die_address_attribute(Dwarf_Die* die, unsigned attr_name, Dwarf_Addr& result);
 static string
 die_name(const Dwarf_Die* die);
 
+static string
+die_linkage_name(const Dwarf_Die* die);
+
+static void
+die_translation_unit_path(const Dwarf_Die* die,
+			  string& path,
+			  string& compilation_dir);
+
 static location
 die_location(const reader& rdr, const Dwarf_Die* die);
 
@@ -647,6 +707,12 @@ compare_dies_during_canonicalization(reader& rdr,
 static bool
 get_member_child_die(const Dwarf_Die *die, Dwarf_Die *child);
 
+static bool
+get_next_member_sibling_die(const Dwarf_Die *die, Dwarf_Die *member);
+
+static bool
+die_size_in_bits(const Dwarf_Die* die, uint64_t& size);
+
 /// Compare a symbol name against another name, possibly demangling
 /// the symbol_name before performing the comparison.
 ///
@@ -1695,6 +1761,116 @@ struct dwarf_expr_eval_context
 // </location expression evaluation types>
 // ---------------------------------------
 
+/// The state of the hashing of the attributes of a DIE, as computed
+/// by reader::hash_die_tree.
+struct die_content_hash_context
+{
+  /// The offset of the DIE of the compilation unit of the DIE.
+  Dwarf_Off	unit_offset;
+  /// The textual representation of the attributes hashed so far.
+  string	repr;
+  /// True iff no attribute hashed so far refers to a DIE of another
+  /// unit.
+  bool		is_self_contained;
+
+  die_content_hash_context(Dwarf_Off o)
+    : unit_offset(o), is_self_contained(true)
+  {}
+}; // end struct die_content_hash_context
+
+/// Append the textual representation of an attribute of a DIE to a
+/// @ref die_content_hash_context.
+///
+/// The values that depend on where the code and data of the unit
+/// are, like addresses and section offsets, are left out, as they
+/// change whenever another unit of the binary changes.
+///
+/// This is a callback for dwarf_getattrs.
+///
+/// @param attr the attribute to consider.
+///
+/// @param data a pointer to the @ref die_content_hash_context to
+/// update.
+///
+/// @return DWARF_CB_OK to keep looking at the attributes of the DIE.
+static int
+hash_die_attribute(Dwarf_Attribute* attr, void* data)
+{
+  die_content_hash_context& ctxt =
+    *static_cast<die_content_hash_context*>(data);
+  unsigned name = dwarf_whatattr(attr), form = dwarf_whatform(attr);
+
+  string& r = ctxt.repr;
+  r += std::to_string(name);
+  r += ':';
+  r += std::to_string(form);
+  r += '=';
+
+  Dwarf_Addr address = 0;
+  Dwarf_Die target;
+  Dwarf_Word value = 0;
+  Dwarf_Block block;
+  bool flag = false;
+  if (name == DW_AT_location
+      || name == DW_AT_frame_base
+      || form == DW_FORM_sec_offset)
+    ;
+  else if (form == DW_FORM_ref_addr
+	   || form == DW_FORM_GNU_ref_alt
+	   || form == DW_FORM_ref_sig8)
+    ctxt.is_self_contained = false;
+  else if (dwarf_formaddr(attr, &address) == 0)
+    ;
+  else if (const char* s = dwarf_formstring(attr))
+    r += s;
+  else if (dwarf_formref_die(attr, &target))
+    r += std::to_string(dwarf_dieoffset(&target) - ctxt.unit_offset);
+  else if (dwarf_formudata(attr, &value) == 0)
+    r += std::to_string(value);
+  else if (dwarf_formflag(attr, &flag) == 0)
+    r += flag ? '1' : '0';
+  else if (dwarf_formblock(attr, &block) == 0)
+    r.append(reinterpret_cast<const char*>(block.data), block.length);
+  r += ';';
+
+  return DWARF_CB_OK;
+}
+
+/// An IR visitor that collects the functions and variables of a
+/// given translation unit.
+///
+/// This is used to find the declarations that a translation unit
+/// taken from another corpus contributes to the exported
+/// declarations of a corpus.
+struct translation_unit_decls_collector : public ir_node_visitor
+{
+  const translation_unit&	tu;
+  vector<function_decl*>	functions;
+  vector<var_decl*>		variables;
+
+  translation_unit_decls_collector(const translation_unit& t)
+    : tu(t)
+  {}
+
+  virtual bool
+  visit_begin(function_decl* fn)
+  {
+    if (fn->get_translation_unit() == &tu)
+      functions.push_back(fn);
+    // Don't look into the type of the function.
+    return false;
+  }
+
+  virtual bool
+  visit_begin(var_decl* var)
+  {
+    if (var->get_translation_unit() == &tu)
+      variables.push_back(var);
+    // Don't look into the type of the variable.
+    return false;
+  }
+}; // end struct translation_unit_decls_collector
+
 class reader;
 
 typedef shared_ptr<reader> reader_sptr;
@@ -1813,13 +1989,17 @@ public:
   // A set of maps (one per kind of die source) that associates a decl
   // string representation with the DIEs (offsets) representing that
   // decl.
-  mutable die_source_dependant_container_set<istring_dwarf_offsets_map_type>
+  mutable die_source_dependant_container_set<istring_die_repr_bucket_map_type>
   decl_die_repr_die_offsets_maps_;
   // A set of maps (one per kind of die source) that associates a type
   // string representation with the DIEs (offsets) representing that
   // type.
-  mutable die_source_dependant_container_set<istring_dwarf_offsets_map_type>
+  mutable die_source_dependant_container_set<istring_die_repr_bucket_map_type>
   type_die_repr_die_offsets_maps_;
+  // A set of maps (one per kind of die source) that associates the
+  // offset of a DIE with its structural hash.
+  mutable die_source_dependant_container_set<die_structural_hash_map_type>
+  die_structural_hash_maps_;
   mutable die_source_dependant_container_set<die_istring_map_type>
   die_qualified_name_maps_;
   mutable die_source_dependant_container_set<die_istring_map_type>
@@ -1878,6 +2058,19 @@ public:
   // file.
   offset_offset_map_type	alternate_die_parent_map_;
   offset_offset_map_type	type_section_die_parent_map_;
+  // When the exported interfaces are read lazily, this associates
+  // the offset of each compilation unit DIE of the main debug info
+  // to the offsets of its children DIEs that are declarations with
+  // exported symbols.
+  unordered_map<Dwarf_Off, dwarf_offsets_type> cu_exported_decl_dies_;
+  // The offsets of the unit DIEs of the main debug info whose DIE ->
+  // parent relations are in primary_die_parent_map_, when that map
+  // is built lazily.
+  unordered_set<Dwarf_Off>	die_parent_map_units_;
+  // True iff the DIE -> parent relations of a unit of the main debug
+  // info are to be added to primary_die_parent_map_ the first time
+  // the parent of one of its DIEs is needed.
+  bool				lazy_primary_die_parent_map_;
   list<var_decl_sptr>		var_decls_to_add_;
 #ifdef WITH_DEBUG_TYPE_CANONICALIZATION
   bool				debug_die_canonicalization_is_on_;
@@ -1886,7 +2079,20 @@ public:
   mutable size_t		compare_count_;
   mutable size_t		canonical_propagated_count_;
   mutable size_t		cancelled_propagation_count_;
+  mutable size_t		canonical_die_lookup_count_;
+  mutable size_t		canonical_die_repr_candidates_count_;
+  mutable size_t		canonical_die_hash_candidates_count_;
   mutable optional<bool>	leverage_dwarf_factorization_;
+  // When the content of the translation units is hashed, this
+  // associates the absolute path of each translation unit with the
+  // hash of its content.
+  unordered_map<string, string>	translation_unit_hashes_;
+  // The translation units of the baseline ABIXML file that are
+  // re-used instead of being built from the debug info, by
+  // absolute path.
+  unordered_map<string, translation_unit_sptr> baseline_translation_units_;
+  // The corpus read from the baseline ABIXML file, if any.
+  corpus_sptr			baseline_corpus_;
 
 protected:
 
@@ -1954,6 +2160,7 @@ public:
     cur_tu_die_ =  0;
     decl_die_repr_die_offsets_maps_.clear();
     type_die_repr_die_offsets_maps_.clear();
+    die_structural_hash_maps_.clear();
     die_qualified_name_maps_.clear();
     die_pretty_repr_maps_.clear();
     die_pretty_type_repr_maps_.clear();
@@ -1980,7 +2187,13 @@ public:
     type_units_tu_die_imported_unit_points_map_.clear();
     alternate_die_parent_map_.clear();
     type_section_die_parent_map_.clear();
+    cu_exported_decl_dies_.clear();
+    die_parent_map_units_.clear();
+    lazy_primary_die_parent_map_ = false;
     var_decls_to_add_.clear();
+    translation_unit_hashes_.clear();
+    baseline_translation_units_.clear();
+    baseline_corpus_.reset();
     clear_per_translation_unit_data();
     options().load_in_linux_kernel_mode = linux_kernel_mode;
     options().load_all_types = load_all_types;
@@ -1992,6 +2205,9 @@ public:
     compare_count_ = 0;
     canonical_propagated_count_ = 0;
     cancelled_propagation_count_ = 0;
+    canonical_die_lookup_count_ = 0;
+    canonical_die_repr_candidates_count_ = 0;
+    canonical_die_hash_candidates_count_ = 0;
     load_in_linux_kernel_mode(linux_kernel_mode);
   }
 
@@ -2069,6 +2285,15 @@ public:
   {
     status = STATUS_UNKNOWN;
 
+    metrics::scoped_phase phase(env().get_metrics(), "dwarf.read-corpus");
+    arena_allocation_scope arena_scope(env());
+
+    // If the corpus of this binary was already built and stored in
+    // the on-disk cache of corpora, then just use it.
+    if (corpus_sptr corp = read_corpus_from_cache(corpus::DWARF_ORIGIN,
+						  status))
+      return corp;
+
     // Load the generic ELF parts of the corpus.
     elf::reader::read_corpus(status);
 
@@ -2103,9 +2328,435 @@ public:
 
     status |= STATUS_OK;
 
+    save_corpus_to_cache(corpus::DWARF_ORIGIN, corp, status);
+
     return corp;
   }
 
+  /// Record the memory used by the maps of a set of DIE maps, one map
+  /// per kind of @ref die_source.
+  ///
+  /// @param maps the set of maps to consider.
+  ///
+  /// @param category the category to record the maps into.
+  ///
+  /// @param stats the memory statistics to record into.
+  template<typename map_type>
+  static void
+  record_die_maps_memory_usage
+  (const die_source_dependant_container_set<map_type>& maps,
+   const string& category,
+   metrics::memory_stats& stats)
+  {
+    const die_source sources[] =
+      {
+	PRIMARY_DEBUG_INFO_DIE_SOURCE,
+	ALT_DEBUG_INFO_DIE_SOURCE,
+	TYPE_UNIT_DIE_SOURCE
+      };
+    for (die_source source : sources)
+      {
+	const map_type& m = maps.get_container(source);
+	stats.record(category, m.size(),
+		     metrics::estimate_hash_table_memory_usage(m));
+      }
+  }
+
+  /// Record the memory used by the maps that associate the DIEs of
+  /// the debug info to their string representation, their canonical
+  /// DIE, the IR nodes built from them, etc.
+  ///
+  /// These maps are kept until the reader reads another corpus.
+  ///
+  /// @param stats the memory statistics to record into.
+  void
+  get_memory_stats(metrics::memory_stats& stats) const
+  {
+    record_die_maps_memory_usage(decl_die_repr_die_offsets_maps_,
+				 "dwarf.die-repr-maps", stats);
+    record_die_maps_memory_usage(type_die_repr_die_offsets_maps_,
+				 "dwarf.die-repr-maps", stats);
+    // The DIE offsets of the buckets of the maps above.
+    const die_source sources[] =
+      {
+	PRIMARY_DEBUG_INFO_DIE_SOURCE,
+	ALT_DEBUG_INFO_DIE_SOURCE,
+	TYPE_UNIT_DIE_SOURCE
+      };
+    uint64_t nb_bucket_bytes = 0;
+    for (die_source source : sources)
+      for (auto maps : {&decl_die_repr_die_offsets_maps_,
+			&type_die_repr_die_offsets_maps_})
+	for (const auto& e : maps->get_container(source))
+	  {
+	    nb_bucket_bytes +=
+	      metrics::estimate_memory_usage(e.second.offsets)
+	      + metrics::estimate_hash_table_memory_usage
+	      (e.second.offsets_per_hash);
+	    for (const auto& h : e.second.offsets_per_hash)
+	      nb_bucket_bytes += metrics::estimate_memory_usage(h.second);
+	  }
+    stats.record("dwarf.die-repr-maps", 0, nb_bucket_bytes);
+
+    record_die_maps_memory_usage(die_structural_hash_maps_,
+				 "dwarf.die-structural-hashes", stats);
+    record_die_maps_memory_usage(die_qualified_name_maps_,
+				 "dwarf.die-name-maps", stats);
+    record_die_maps_memory_usage(die_pretty_repr_maps_,
+				 "dwarf.die-name-maps", stats);
+    record_die_maps_memory_usage(die_pretty_type_repr_maps_,
+				 "dwarf.die-name-maps", stats);
+    record_die_maps_memory_usage(decl_die_artefact_maps_,
+				 "dwarf.die-artefact-maps", stats);
+    record_die_maps_memory_usage(type_die_artefact_maps_,
+				 "dwarf.die-artefact-maps", stats);
+    record_die_maps_memory_usage(canonical_type_die_offsets_,
+				 "dwarf.canonical-die-maps", stats);
+    record_die_maps_memory_usage(canonical_decl_die_offsets_,
+				 "dwarf.canonical-die-maps", stats);
+
+    stats.record("dwarf.die-comparison-results",
+		 die_comparison_results_.size(),
+		 metrics::estimate_hash_table_memory_usage
+		 (die_comparison_results_));
+    stats.record("dwarf.propagated-types",
+		 propagated_types_.size(),
+		 metrics::estimate_hash_table_memory_usage(propagated_types_));
+    stats.record("dwarf.function-type-maps",
+		 per_tu_repr_to_fn_type_maps_.size(),
+		 metrics::estimate_hash_table_memory_usage
+		 (per_tu_repr_to_fn_type_maps_));
+
+    for (auto m : {&die_wip_classes_map_,
+		   &alternate_die_wip_classes_map_,
+		   &type_unit_die_wip_classes_map_})
+      stats.record("dwarf.wip-maps", m->size(),
+		   metrics::estimate_hash_table_memory_usage(*m));
+    for (auto m : {&die_wip_function_types_map_,
+		   &alternate_die_wip_function_types_map_,
+		   &type_unit_die_wip_function_types_map_})
+      stats.record("dwarf.wip-maps", m->size(),
+		   metrics::estimate_hash_table_memory_usage(*m));
+
+    for (auto m : {&primary_die_parent_map_,
+		   &alternate_die_parent_map_,
+		   &type_section_die_parent_map_})
+      stats.record("dwarf.die-parent-maps", m->size(),
+		   metrics::estimate_hash_table_memory_usage(*m));
+    stats.record("dwarf.die-parent-maps", 0,
+		 metrics::estimate_hash_table_memory_usage
+		 (die_parent_map_units_));
+
+    for (auto m : {&tu_die_imported_unit_points_map_,
+		   &alt_tu_die_imported_unit_points_map_,
+		   &type_units_tu_die_imported_unit_points_map_})
+      {
+	uint64_t nb_bytes = metrics::estimate_hash_table_memory_usage(*m);
+	for (const auto& e : *m)
+	  nb_bytes += metrics::estimate_memory_usage(e.second);
+	stats.record("dwarf.imported-unit-points", m->size(), nb_bytes);
+      }
+
+    uint64_t nb_bytes =
+      metrics::estimate_hash_table_memory_usage(cu_exported_decl_dies_);
+    for (const auto& e : cu_exported_decl_dies_)
+      nb_bytes += metrics::estimate_memory_usage(e.second);
+    stats.record("dwarf.exported-decl-dies",
+		 cu_exported_decl_dies_.size(), nb_bytes);
+
+    stats.record("dwarf.types-to-canonicalize",
+		 types_to_canonicalize_.size(),
+		 metrics::estimate_memory_usage(types_to_canonicalize_));
+  }
+
+  /// Getter of the hashes of the content of the translation units
+  /// of the main debug info.
+  ///
+  /// This is empty unless the content of the translation units is
+  /// hashed.  See fe_iface::options_type::hash_translation_units.
+  ///
+  /// @return the map that associates the absolute path of each
+  /// translation unit with the hash of its content.
+  const unordered_map<string, string>&
+  translation_unit_hashes() const
+  {return translation_unit_hashes_;}
+
+  /// Compute the hashes of the content of the translation units of
+  /// the main debug info.
+  ///
+  /// The hash of a compilation unit covers its DIEs, the names of the
+  /// files of its line table and the IDs of the ELF symbols of its
+  /// functions and variables.  It doesn't cover the addresses and
+  /// section offsets that change whenever another unit changes.
+  /// Several compilation units can have the same path, so the hash
+  /// of a translation unit combines the hashes of its compilation
+  /// units.
+  ///
+  /// The hashes are recorded in translation_unit_hashes_.
+  ///
+  /// @param type_names output parameter.  This associates the
+  /// absolute path of each translation unit with the names of the
+  /// classes, unions and enums it defines.
+  ///
+  /// @return true iff the compilation units don't refer to DIEs of
+  /// other units, i.e, iff a translation unit can be re-used
+  /// independently of the others.
+  bool
+  hash_translation_units(unordered_map<string, unordered_set<string>>& type_names)
+  {
+    translation_unit_hashes_.clear();
+
+    // Things that change the result of the reading of a unit must be
+    // hashed along with its content.
+    uint64_t seed = 0;
+    {
+      string major, minor, revision, suffix;
+      abigail_get_library_version(major, minor, revision, suffix);
+      std::ostringstream o;
+      o << major << "." << minor << "." << revision << suffix
+	<< " " << options().load_all_types
+	<< options().drop_undefined_syms
+	<< options().leverage_dwarf_factorization
+	<< options().assume_odr_for_cplusplus
+	<< options().read_exported_interfaces_lazily
+	<< env().analyze_exported_interfaces_only()
+	<< load_in_linux_kernel_mode();
+      seed = hashing::fnv_hash64(o.str());
+    }
+
+    unordered_map<string, uint64_t> hashes;
+    bool units_are_self_contained = true;
+    Dwarf* dwarf = const_cast<Dwarf*>(dwarf_debug_info());
+    size_t header_size = 0;
+    for (Dwarf_Off offset = 0, next_offset = 0;
+	 (dwarf_next_unit(dwarf, offset, &next_offset, &header_size,
+			  NULL, NULL, NULL, NULL, NULL, NULL) == 0);
+	 offset = next_offset)
+      {
+	Dwarf_Die unit;
+	if (!dwarf_offdie(dwarf, offset + header_size, &unit)
+	    || dwarf_tag(&unit) != DW_TAG_compile_unit)
+	  continue;
+
+	string path, compilation_dir;
+	die_translation_unit_path(&unit, path, compilation_dir);
+	const string abs_path =
+	  compilation_dir.empty() ? path : compilation_dir + "/" + path;
+
+	auto h = hashes.find(abs_path);
+	uint64_t hash = h == hashes.end() ? seed : h->second;
+
+	Dwarf_Files* files = NULL;
+	size_t nb_files = 0;
+	if (dwarf_getsrcfiles(&unit, &files, &nb_files) == 0)
+	  for (size_t i = 0; i < nb_files; ++i)
+	    if (const char* f = dwarf_filesrc(files, i, NULL, NULL))
+	      hash = hashing::fnv_hash64(string(f) + "\n", hash);
+
+	if (!hash_die_tree(&unit, dwarf_dieoffset(&unit), hash,
+			   type_names[abs_path]))
+	  units_are_self_contained = false;
+	hashes[abs_path] = hash;
+      }
+
+    for (const auto& h : hashes)
+      {
+	std::ostringstream o;
+	o << std::hex << std::setw(16) << std::setfill('0') << h.second;
+	translation_unit_hashes_[h.first] = o.str();
+      }
+
+    return units_are_self_contained;
+  }
+
+  /// Hash a DIE and its children DIEs, as part of the hashing of the
+  /// content of their compilation unit.
+  ///
+  /// @param die the DIE to hash.
+  ///
+  /// @param unit_offset the offset of the DIE of the compilation unit
+  /// of @p die.
+  ///
+  /// @param hash in/out parameter.  The hash to update.
+  ///
+  /// @param type_names output parameter.  The names of the classes,
+  /// unions and enums defined by @p die and its children DIEs are
+  /// added to this.
+  ///
+  /// @return true iff @p die and its children DIEs don't refer to
+  /// DIEs of other units.
+  bool
+  hash_die_tree(Dwarf_Die*		die,
+		Dwarf_Off		unit_offset,
+		uint64_t&		hash,
+		unordered_set<string>&	type_names) const
+  {
+    die_content_hash_context ctxt(unit_offset);
+    int tag = dwarf_tag(die);
+    ctxt.repr = std::to_string(tag) + "{";
+    dwarf_getattrs(die, hash_die_attribute, &ctxt, 0);
+
+    // The symbols the functions and variables are associated with
+    // are part of the content of the unit, as their IDs are
+    // serialized.
+    elf_symbol_sptr symbol;
+    Dwarf_Addr address = 0;
+    if (tag == DW_TAG_subprogram)
+      {
+	if (get_function_address(die, address))
+	  symbol = function_symbol_is_exported(address);
+	else
+	  {
+	    // See fixup_functions_with_no_symbols.
+	    string linkage_name = die_linkage_name(die);
+	    if (!linkage_name.empty())
+	      symbol = function_symbol_is_exported(linkage_name);
+	  }
+      }
+    else if (tag == DW_TAG_variable && get_variable_address(die, address))
+      symbol = variable_symbol_is_exported(address);
+    if (symbol)
+      ctxt.repr += symbol->get_id_string();
+
+    if ((tag == DW_TAG_structure_type
+	 || tag == DW_TAG_class_type
+	 || tag == DW_TAG_union_type
+	 || tag == DW_TAG_enumeration_type)
+	&& !die_is_declaration_only(die))
+      {
+	string name = die_name(die);
+	if (!name.empty())
+	  type_names.insert(name);
+      }
+
+    hash = hashing::fnv_hash64(ctxt.repr, hash);
+    bool is_self_contained = ctxt.is_self_contained;
+
+    Dwarf_Die child;
+    if (dwarf_child(die, &child) == 0)
+      do
+	if (!hash_die_tree(&child, unit_offset, hash, type_names))
+	  is_self_contained = false;
+      while (dwarf_siblingof(&child, &child) == 0);
+    hash = hashing::fnv_hash64("}", hash);
+
+    return is_self_contained;
+  }
+
+  /// Find the translation units of the baseline ABIXML file that can
+  /// be re-used instead of being built from the debug info.
+  ///
+  /// This must be called after hash_translation_units.  The re-usable
+  /// translation units are recorded in baseline_translation_units_.
+  ///
+  /// See fe_iface::options_type::baseline_abixml_path.
+  ///
+  /// @param type_names the names of the classes, unions and enums
+  /// defined by each translation unit of the debug info, as computed
+  /// by hash_translation_units.
+  void
+  find_baseline_translation_units
+  (const unordered_map<string, unordered_set<string>>& type_names)
+  {
+    baseline_translation_units_.clear();
+    baseline_corpus_.reset();
+
+    const string& path = options().baseline_abixml_path;
+    unordered_set<string> reusable_paths;
+    if (!abixml::find_reusable_translation_units(path,
+						 translation_unit_hashes_,
+						 type_names,
+						 reusable_paths)
+	|| reusable_paths.empty())
+      return;
+
+    // Only read the translation units that are re-used, so that the
+    // types of the others don't become the canonical types of the
+    // types of the corpus.  They would then never be emitted.
+    baseline_corpus_ = abixml::read_corpus_from_abixml_file(path, env(),
+							    reusable_paths);
+    if (!baseline_corpus_)
+      return;
+
+    for (const translation_unit_sptr& tu :
+	   baseline_corpus_->get_translation_units())
+      if (reusable_paths.count(tu->get_absolute_path()))
+	baseline_translation_units_[tu->get_absolute_path()] = tu;
+
+    if (do_log())
+      cerr << "re-using " << baseline_translation_units_.size()
+	   << " of " << translation_unit_hashes_.size()
+	   << " translation units from " << path << "\n";
+  }
+
+  /// Add the translation unit of a given path that was taken from the
+  /// baseline ABIXML file, if any, to the current corpus.
+  ///
+  /// The functions and variables of the translation unit are bound to
+  /// the symbols of the current binary that have the same IDs, and
+  /// are added to the set of exported declarations of the corpus.
+  ///
+  /// @param abs_path the absolute path of the translation unit.
+  ///
+  /// @return true iff the translation unit of path @p abs_path is
+  /// taken from the baseline ABIXML file, in which case its
+  /// compilation units must not be read.
+  bool
+  maybe_reuse_baseline_translation_unit(const string& abs_path)
+  {
+    auto i = baseline_translation_units_.find(abs_path);
+    if (i == baseline_translation_units_.end())
+      return false;
+
+    translation_unit_sptr tu = i->second;
+    if (tu->get_corpus() == corpus().get())
+      // The translation unit was added for a previous compilation
+      // unit of the same path.
+      return true;
+
+    corpus()->add(tu);
+    add_types_to_corpus_lookup_maps(*tu);
+    // The types of the translation unit can refer to types of the
+    // other translation units of the baseline corpus.
+    corpus()->priv_->baseline_corpus = baseline_corpus_;
+
+    translation_unit_decls_collector collector(*tu);
+    tu->traverse(collector);
+    for (function_decl* fn : collector.functions)
+      if (elf_symbol_sptr symbol = fn->get_symbol())
+	{
+	  fn->set_symbol(lookup_symbol_from_id(symbol->get_id_string()));
+	  maybe_add_fn_to_exported_decls(fn);
+	}
+    for (var_decl* var : collector.variables)
+      if (elf_symbol_sptr symbol = var->get_symbol())
+	{
+	  var->set_symbol(lookup_symbol_from_id(symbol->get_id_string()));
+	  maybe_add_var_to_exported_decls(var);
+	}
+
+    env().get_metrics().increment_counter("dwarf.reused-translation-units");
+    return true;
+  }
+
+  /// Look up the symbol of a given ID in the symbol table of the
+  /// current binary.
+  ///
+  /// @param id the ID of the symbol, as returned by
+  /// elf_symbol::get_id_string.
+  ///
+  /// @return the symbol found, or nil if none was found.
+  elf_symbol_sptr
+  lookup_symbol_from_id(const string& id) const
+  {
+    string name, version;
+    elf_symbol::get_name_and_version_from_id(id, name, version);
+    for (const elf_symbol_sptr& s : symtab()->lookup_symbol(name))
+      if (s->get_id_string() == id)
+	return s;
+    return elf_symbol_sptr();
+  }
+
   /// Read an analyze the DWARF information.
   ///
   /// Construct an ABI corpus from it.
@@ -2154,9 +2805,36 @@ public:
       env().set_self_comparison_debug_input(corpus());
 #endif
 
+    // If we are asked to read the exported interfaces lazily, find
+    // the DIEs of the exported declarations first, so that the
+    // compilation units that have none can be left alone.
+    if (read_exported_interfaces_lazily())
+      {
+	metrics::scoped_phase phase(env().get_metrics(),
+				    "dwarf.collect-exported-decl-dies");
+	tools_utils::timer t;
+	if (do_log())
+	  {
+	    cerr << "collecting DIEs of exported declarations ...";
+	    t.start();
+	  }
+
+	collect_exported_decl_dies();
+
+	if (do_log())
+	  {
+	    t.stop();
+	    cerr << " DONE@" << corpus()->get_path()
+		 << ":"
+		 << t
+		 << "\n";
+	  }
+      }
+
     // Walk all the DIEs of the debug info to build a DIE -> parent map
     // useful for get_die_parent() to work.
     {
+      metrics::scoped_phase phase(env().get_metrics(), "dwarf.build-die-parent-maps");
       tools_utils::timer t;
       if (do_log())
 	{
@@ -2176,9 +2854,64 @@ public:
 	}
     }
 
+    // If we are asked to, compute the canonical DIEs of all the type
+    // DIEs before building the IR.  This is pointless if only the
+    // exported interfaces are analyzed, as most type DIEs are then
+    // not looked at.
+    if (options().precompute_canonical_dies
+	&& !env().analyze_exported_interfaces_only())
+      {
+	metrics::scoped_phase phase(env().get_metrics(),
+				    "dwarf.precompute-canonical-dies");
+	tools_utils::timer t;
+	if (do_log())
+	  {
+	    cerr << "computing canonical DIEs ...";
+	    t.start();
+	  }
+
+	precompute_canonical_dies();
+
+	if (do_log())
+	  {
+	    t.stop();
+	    cerr << " DONE@" << corpus()->get_path()
+		 << ":"
+		 << t
+		 << "\n";
+	  }
+      }
+
+    // If we are asked to, hash the content of the translation units
+    // and find the translation units of the baseline ABIXML file that
+    // didn't change, so that they are not built again.  Suppression
+    // specifications change the content of translation units, so
+    // they are not hashed in that case.
+    if (options().hash_translation_units && suppressions().empty())
+      {
+	bool units_are_self_contained = false;
+	unordered_map<string, unordered_set<string>> type_names;
+	{
+	  metrics::scoped_phase phase(env().get_metrics(),
+				      "dwarf.hash-translation-units");
+	  units_are_self_contained = hash_translation_units(type_names);
+	}
+
+	if (!options().baseline_abixml_path.empty()
+	    && units_are_self_contained
+	    && !(origin & corpus::LINUX_KERNEL_BINARY_ORIGIN)
+	    && !corpus_group())
+	  {
+	    metrics::scoped_phase phase(env().get_metrics(),
+					"dwarf.read-baseline");
+	    find_baseline_translation_units(type_names);
+	  }
+      }
+
     env().canonicalization_is_done(false);
 
     {
+      metrics::scoped_phase phase(env().get_metrics(), "dwarf.build-ir");
       tools_utils::timer t;
       if (do_log())
 	{
@@ -2205,6 +2938,17 @@ public:
 
 	  address_size *= 8;
 
+	  if (!baseline_translation_units_.empty())
+	    {
+	      string path, compilation_dir;
+	      die_translation_unit_path(&unit, path, compilation_dir);
+	      if (maybe_reuse_baseline_translation_unit
+		  (compilation_dir.empty()
+		   ? path
+		   : compilation_dir + "/" + path))
+		continue;
+	    }
+
 	  // Build a translation_unit IR node from cu; note that cu must
 	  // be a DW_TAG_compile_unit die.
 	  translation_unit_sptr ir_node =
@@ -2226,9 +2970,26 @@ public:
 	       << "Number of cancelled propagated canonical types:"
 	       << cancelled_propagation_count_ << "\n";
 	}
+
+      metrics::registry& m = env().get_metrics();
+      m.increment_counter("dwarf.aggregate-types-compared", compare_count_);
+      m.increment_counter("dwarf.canonical-types-propagated",
+			  canonical_propagated_count_);
+      m.increment_counter("dwarf.cancelled-canonical-type-propagations",
+			  cancelled_propagation_count_);
+      m.increment_counter("dwarf.canonical-die-lookups",
+			  canonical_die_lookup_count_);
+      m.increment_counter("dwarf.canonical-die-candidates-by-repr",
+			  canonical_die_repr_candidates_count_);
+      m.increment_counter("dwarf.canonical-die-candidates-by-hash",
+			  canonical_die_hash_candidates_count_);
+      if (lazy_primary_die_parent_map_)
+	m.increment_counter("dwarf.die-parent-map-units",
+			    die_parent_map_units_.size());
     }
 
     {
+      metrics::scoped_phase phase(env().get_metrics(), "dwarf.resolve-decl-only-classes");
       tools_utils::timer t;
       if (do_log())
 	{
@@ -2247,6 +3008,7 @@ public:
     }
 
     {
+      metrics::scoped_phase phase(env().get_metrics(), "dwarf.resolve-decl-only-enums");
       tools_utils::timer t;
       if (do_log())
 	{
@@ -2265,6 +3027,7 @@ public:
     }
 
     {
+      metrics::scoped_phase phase(env().get_metrics(), "dwarf.fixup-functions-with-no-symbols");
       tools_utils::timer t;
       if (do_log())
 	{
@@ -2295,6 +3058,7 @@ public:
     /// are in the alternate debug info section and for types that in
     /// the main debug info section.
     {
+      metrics::scoped_phase phase(env().get_metrics(), "dwarf.late-type-canonicalization");
       tools_utils::timer t;
       if (do_log())
 	{
@@ -2317,6 +3081,7 @@ public:
     env().canonicalization_is_done(true);
 
     {
+      metrics::scoped_phase phase(env().get_metrics(), "dwarf.sort-functions-and-variables");
       tools_utils::timer t;
       if (do_log())
 	{
@@ -2475,7 +3240,7 @@ public:
   ///
   /// @return the maps set that associates a representation of a decl
   /// DIE to a vector of offsets of DIEs having that representation.
-  const die_source_dependant_container_set<istring_dwarf_offsets_map_type>&
+  const die_source_dependant_container_set<istring_die_repr_bucket_map_type>&
   decl_die_repr_die_offsets_maps() const
   {return decl_die_repr_die_offsets_maps_;}
 
@@ -2484,7 +3249,7 @@ public:
   ///
   /// @return the maps set that associates a representation of a decl
   /// DIE to a vector of offsets of DIEs having that representation.
-  die_source_dependant_container_set<istring_dwarf_offsets_map_type>&
+  die_source_dependant_container_set<istring_die_repr_bucket_map_type>&
   decl_die_repr_die_offsets_maps()
   {return decl_die_repr_die_offsets_maps_;}
 
@@ -2493,7 +3258,7 @@ public:
   ///
   /// @return the maps set that associate a representation of a type
   /// DIE to a vector of offsets of DIEs having that representation.
-  const die_source_dependant_container_set<istring_dwarf_offsets_map_type>&
+  const die_source_dependant_container_set<istring_die_repr_bucket_map_type>&
   type_die_repr_die_offsets_maps() const
   {return type_die_repr_die_offsets_maps_;}
 
@@ -2502,10 +3267,232 @@ public:
   ///
   /// @return the maps set that associate a representation of a type
   /// DIE to a vector of offsets of DIEs having that representation.
-  die_source_dependant_container_set<istring_dwarf_offsets_map_type>&
+  die_source_dependant_container_set<istring_die_repr_bucket_map_type>&
   type_die_repr_die_offsets_maps()
   {return type_die_repr_die_offsets_maps_;}
 
+  /// Get the structural hash of a DIE.
+  ///
+  /// The hash is made of the properties of the DIE that compare_dies
+  /// always looks at: its tag, the size of the type, the offsets of
+  /// the data members of a class, the values of the enumerators of
+  /// an enum, and the hash of the type underlying a typedef, pointer,
+  /// reference, qualified or array type.  The names are left out as
+  /// DIEs are already bucketed by their string representation.
+  ///
+  /// When the One Definition Rule is relevant to the DIEs being
+  /// compared, compare_dies is more lenient: a declaration-only class
+  /// equals its definition, for instance.  That is why the hash is
+  /// only reliable for DIEs from languages where the ODR is not
+  /// relevant, like C.
+  ///
+  /// The hash is cached.  If computing it leads back to the DIE
+  /// itself, the hash is flagged as cyclic.
+  ///
+  /// @param die the DIE to consider.
+  ///
+  /// @return the structural hash of @p die.
+  const die_structural_hash&
+  get_die_structural_hash(const Dwarf_Die* die) const
+  {
+    die_structural_hash_map_type& hashes =
+      die_structural_hash_maps_.get_container(*this, die);
+    Dwarf_Off offset = dwarf_dieoffset(const_cast<Dwarf_Die*>(die));
+
+    die_structural_hash_map_type::iterator i = hashes.find(offset);
+    if (i != hashes.end())
+      {
+	if (!i->second.computed)
+	  // We are looking at a DIE whose hash is being computed.
+	  i->second.cyclic = true;
+	return i->second;
+      }
+
+    // Note that references to the elements of an unordered_map remain
+    // valid when the map is re-hashed.
+    die_structural_hash& result = hashes[offset];
+
+    int tag = dwarf_tag(const_cast<Dwarf_Die*>(die));
+    size_t h = hashing::combine_hashes(0, tag);
+    bool cyclic = false, odr_free = true, is_sized = false;
+    uint64_t size = 0;
+
+    switch (tag)
+      {
+      case DW_TAG_base_type:
+      case DW_TAG_string_type:
+      case DW_TAG_unspecified_type:
+      case DW_TAG_typedef:
+      case DW_TAG_pointer_type:
+      case DW_TAG_reference_type:
+      case DW_TAG_rvalue_reference_type:
+      case DW_TAG_const_type:
+      case DW_TAG_volatile_type:
+      case DW_TAG_restrict_type:
+      case DW_TAG_array_type:
+	{
+	  is_sized = tag != DW_TAG_array_type;
+	  Dwarf_Die underlying_type_die;
+	  if (die_die_attribute(die, DW_AT_type, underlying_type_die))
+	    {
+	      const die_structural_hash& u =
+		get_die_structural_hash(&underlying_type_die);
+	      h = hashing::combine_hashes(h, u.value);
+	      cyclic = u.cyclic;
+	      odr_free = u.odr_free;
+	    }
+	}
+	break;
+
+      case DW_TAG_enumeration_type:
+	{
+	  is_sized = true;
+	  Dwarf_Die child;
+	  for (bool found = dwarf_child(const_cast<Dwarf_Die*>(die),
+					&child) == 0;
+	       found;
+	       found = dwarf_siblingof(&child, &child) == 0)
+	    {
+	      int child_tag = dwarf_tag(&child);
+	      h = hashing::combine_hashes(h, child_tag);
+	      if (child_tag == DW_TAG_enumerator)
+		{
+		  uint64_t value = 0;
+		  die_unsigned_constant_attribute(&child,
+						  DW_AT_const_value,
+						  value);
+		  h = hashing::combine_hashes(h, value);
+		}
+	    }
+	}
+	break;
+
+      case DW_TAG_structure_type:
+      case DW_TAG_union_type:
+      case DW_TAG_class_type:
+	{
+	  is_sized = true;
+	  Dwarf_Die member;
+	  for (bool found = get_member_child_die(die, &member);
+	       found;
+	       found = get_next_member_sibling_die(&member, &member))
+	    {
+	      int member_tag = dwarf_tag(&member);
+	      h = hashing::combine_hashes(h, member_tag);
+	      if (member_tag == DW_TAG_member
+		  || member_tag == DW_TAG_inheritance)
+		{
+		  int64_t offset_in_bits = 0;
+		  die_member_offset(*this, &member, offset_in_bits);
+		  h = hashing::combine_hashes(h, offset_in_bits);
+		}
+	    }
+	}
+	break;
+
+      default:
+	break;
+      }
+
+    if (is_sized)
+      {
+	die_size_in_bits(die, size);
+	h = hashing::combine_hashes(h, size);
+
+	translation_unit::language lang;
+	if (!get_die_language(die, lang) || odr_is_relevant(lang))
+	  odr_free = false;
+      }
+
+    result.value = h;
+    result.cyclic = result.cyclic || cyclic;
+    result.odr_free = odr_free;
+    result.computed = true;
+    return result;
+  }
+
+  /// Test if the structural hash of a DIE can be reliable at all.
+  ///
+  /// The hash of a DIE coming from a language for which the One
+  /// Definition Rule is relevant is never reliable, so there is no
+  /// need to compute it.
+  ///
+  /// @param die the DIE to consider.
+  ///
+  /// @return true iff the structural hash of @p die is worth
+  /// computing.
+  bool
+  die_structural_hash_can_be_reliable(const Dwarf_Die* die) const
+  {
+    translation_unit::language lang;
+    return get_die_language(die, lang) && !odr_is_relevant(lang);
+  }
+
+  /// Add a DIE to a bucket of DIEs having the same string
+  /// representation.
+  ///
+  /// @param bucket the bucket to consider.
+  ///
+  /// @param die the DIE to add to @p bucket.
+  void
+  add_die_to_repr_bucket(die_repr_bucket& bucket, const Dwarf_Die* die) const
+  {
+    Dwarf_Off offset = dwarf_dieoffset(const_cast<Dwarf_Die*>(die));
+    bucket.offsets.push_back(offset);
+
+    if (!die_structural_hash_can_be_reliable(die))
+      {
+	bucket.has_unreliable_hash = true;
+	return;
+      }
+
+    const die_structural_hash& h = get_die_structural_hash(die);
+    if (h.cyclic)
+      bucket.has_unreliable_hash = true;
+    else
+      bucket.offsets_per_hash[h.value].push_back(offset);
+  }
+
+  /// Get the DIEs of a bucket of DIEs having the same string
+  /// representation that a given DIE has to be compared to, to find
+  /// its canonical DIE.
+  ///
+  /// If the structural hash of the DIE is reliable, these are the
+  /// DIEs of the bucket that have the same structural hash.
+  /// Otherwise, these are all the DIEs of the bucket.  In both cases,
+  /// they are in the order in which they were added to the bucket.
+  ///
+  /// @param die the DIE to consider.
+  ///
+  /// @param bucket the bucket to consider.
+  ///
+  /// @return the offsets of the DIEs @p die has to be compared to.
+  const dwarf_offsets_type&
+  get_canonical_die_candidates(const Dwarf_Die* die,
+			       const die_repr_bucket& bucket) const
+  {
+    ++canonical_die_lookup_count_;
+    canonical_die_repr_candidates_count_ += bucket.offsets.size();
+
+    if (bucket.has_unreliable_hash
+	|| !die_structural_hash_can_be_reliable(die)
+	|| !get_die_structural_hash(die).is_reliable())
+      {
+	canonical_die_hash_candidates_count_ += bucket.offsets.size();
+	return bucket.offsets;
+      }
+
+    static const dwarf_offsets_type no_candidate;
+    const die_structural_hash& h = get_die_structural_hash(die);
+    unordered_map<size_t, dwarf_offsets_type>::const_iterator i =
+      bucket.offsets_per_hash.find(h.value);
+    if (i == bucket.offsets_per_hash.end())
+      return no_candidate;
+
+    canonical_die_hash_candidates_count_ += i->second.size();
+    return i->second;
+  }
+
 
   /// Compute the offset of the canonical DIE of a given DIE.
   ///
@@ -2587,8 +3574,8 @@ public:
 			bool die_as_type) const
   {
     // The map that associates the string representation of 'die'
-    // with a vector of offsets of potentially equivalent DIEs.
-    istring_dwarf_offsets_map_type& map =
+    // with a bucket of offsets of potentially equivalent DIEs.
+    istring_die_repr_bucket_map_type& map =
       die_as_type
       ? (const_cast<reader*>(this)->
 	 type_die_repr_die_offsets_maps().get_container(source))
@@ -2611,21 +3598,22 @@ public:
       : get_die_pretty_representation(&die, /*where=*/0);
 
     Dwarf_Off canonical_die_offset = 0;
-    istring_dwarf_offsets_map_type::iterator i = map.find(name);
+    istring_die_repr_bucket_map_type::iterator i = map.find(name);
     if (i == map.end())
       {
-	dwarf_offsets_type offsets;
-	offsets.push_back(die_offset);
-	map[name] = offsets;
+	add_die_to_repr_bucket(map[name], &die);
 	set_canonical_die_offset(canonical_dies, die_offset, die_offset);
 	get_die_from_offset(source, die_offset, &canonical_die);
 	return;
       }
 
+    die_repr_bucket& bucket = i->second;
+    const dwarf_offsets_type& candidates =
+      get_canonical_die_candidates(&die, bucket);
     Dwarf_Off cur_die_offset;
     Dwarf_Die potential_canonical_die;
-    for (dwarf_offsets_type::const_iterator o = i->second.begin();
-	 o != i->second.end();
+    for (dwarf_offsets_type::const_iterator o = candidates.begin();
+	 o != candidates.end();
 	 ++o)
       {
 	cur_die_offset = *o;
@@ -2642,7 +3630,7 @@ public:
       }
 
     canonical_die_offset = die_offset;
-    i->second.push_back(die_offset);
+    add_die_to_repr_bucket(bucket, &die);
     set_canonical_die_offset(canonical_dies, die_offset, die_offset);
     get_die_from_offset(source, canonical_die_offset, &canonical_die);
   }
@@ -2686,8 +3674,8 @@ public:
       }
 
     // The map that associates the string representation of 'die'
-    // with a vector of offsets of potentially equivalent DIEs.
-    istring_dwarf_offsets_map_type& map =
+    // with a bucket of offsets of potentially equivalent DIEs.
+    istring_die_repr_bucket_map_type& map =
       die_as_type
       ? (const_cast<reader*>(this)->
 	 type_die_repr_die_offsets_maps().get_container(*this, die))
@@ -2705,13 +3693,15 @@ public:
       ? get_die_pretty_type_representation(die, where)
       : get_die_pretty_representation(die, where);
 
-    istring_dwarf_offsets_map_type::iterator i = map.find(name);
+    istring_die_repr_bucket_map_type::iterator i = map.find(name);
     if (i == map.end())
       return false;
 
+    const dwarf_offsets_type& candidates =
+      get_canonical_die_candidates(die, i->second);
     Dwarf_Off cur_die_offset;
-    for (dwarf_offsets_type::const_iterator o = i->second.begin();
-	 o != i->second.end();
+    for (dwarf_offsets_type::const_iterator o = candidates.begin();
+	 o != candidates.end();
 	 ++o)
       {
 	cur_die_offset = *o;
@@ -2783,8 +3773,8 @@ public:
       return false;
 
     // The map that associates the string representation of 'die'
-    // with a vector of offsets of potentially equivalent DIEs.
-    istring_dwarf_offsets_map_type& map =
+    // with a bucket of offsets of potentially equivalent DIEs.
+    istring_die_repr_bucket_map_type& map =
       die_as_type
       ? (const_cast<reader*>(this)->
 	 type_die_repr_die_offsets_maps().get_container(*this, die))
@@ -2802,12 +3792,10 @@ public:
       ? get_die_pretty_type_representation(die, where)
       : get_die_pretty_representation(die, where);
 
-    istring_dwarf_offsets_map_type::iterator i = map.find(name);
+    istring_die_repr_bucket_map_type::iterator i = map.find(name);
     if (i == map.end())
       {
-	dwarf_offsets_type offsets;
-	offsets.push_back(initial_die_offset);
-	map[name] = offsets;
+	add_die_to_repr_bucket(map[name], die);
 	get_die_from_offset(source, initial_die_offset, &canonical_die);
 	set_canonical_die_offset(canonical_dies,
 				 initial_die_offset,
@@ -2815,13 +3803,16 @@ public:
 	return false;
       }
 
-    // walk i->second without any iterator (using a while loop rather
-    // than a for loop) because compare_dies might add new content to
-    // the end of the i->second vector during the walking.
-    dwarf_offsets_type::size_type n = 0, s = i->second.size();
+    // Walk the candidates without any iterator (using a while loop
+    // rather than a for loop) because compare_dies might add new
+    // content to the end of the bucket during the walking.
+    die_repr_bucket& bucket = i->second;
+    const dwarf_offsets_type& candidates =
+      get_canonical_die_candidates(die, bucket);
+    dwarf_offsets_type::size_type n = 0, s = candidates.size();
     while (n < s)
       {
-	Dwarf_Off die_offset = i->second[n];
+	Dwarf_Off die_offset = candidates[n];
 	get_die_from_offset(source, die_offset, &canonical_die);
 	// compare die and canonical_die.
 	if (compare_dies_during_canonicalization(const_cast<reader&>(*this),
@@ -2839,7 +3830,7 @@ public:
     // We didn't find a canonical DIE for 'die'.  So let's consider
     // that it is its own canonical DIE.
     get_die_from_offset(source, initial_die_offset, &canonical_die);
-    i->second.push_back(initial_die_offset);
+    add_die_to_repr_bucket(bucket, die);
     set_canonical_die_offset(canonical_dies,
 			     initial_die_offset,
 			     initial_die_offset);
@@ -5295,6 +6286,285 @@ public:
     return true;
   }
 
+  /// Test if the exported interfaces are read lazily.
+  ///
+  /// That is the case if only the exported interfaces and the types
+  /// reachable from them are analyzed, and if the
+  /// read_exported_interfaces_lazily option is set.  The IR is then
+  /// only built from the compilation units that have DIEs of exported
+  /// declarations, and the DIE -> parent relations of the other units
+  /// are only computed if they are needed.
+  ///
+  /// @return true iff the exported interfaces are read lazily.
+  bool
+  read_exported_interfaces_lazily() const
+  {
+    return (options().read_exported_interfaces_lazily
+	    && env().analyze_exported_interfaces_only());
+  }
+
+  /// Walk the children DIEs of the compilation units of the main
+  /// debug info and record those that are declarations with exported
+  /// symbols.
+  ///
+  /// These are the DIEs from which the IR is built when only the
+  /// exported interfaces are analyzed.  Note that the walk doesn't
+  /// descend into the children DIEs, so it's a lot cheaper than the
+  /// walks that build the DIE -> parent maps or the IR.
+  void
+  collect_exported_decl_dies()
+  {
+    cu_exported_decl_dies_.clear();
+
+    // If the debug info has a name index, only look at the units it
+    // says might describe exported symbols, and at the units it
+    // doesn't cover.
+    unordered_set<Dwarf_Off> candidate_units;
+    dwarf_name_index::name_index_sptr index =
+      get_units_of_exported_symbols_from_name_index(candidate_units);
+
+    size_t header_size = 0, nb_skipped_units = 0;
+    for (Dwarf_Off offset = 0, next_offset = 0;
+	 (dwarf_next_unit(const_cast<Dwarf*>(dwarf_debug_info()),
+			  offset, &next_offset, &header_size,
+			  NULL, NULL, NULL, NULL, NULL, NULL) == 0);
+	 offset = next_offset)
+      {
+	if (index
+	    && index->covers_unit(offset)
+	    && !candidate_units.count(offset))
+	  {
+	    ++nb_skipped_units;
+	    continue;
+	  }
+
+	Dwarf_Off die_offset = offset + header_size;
+	Dwarf_Die cu;
+	if (!dwarf_offdie(const_cast<Dwarf*>(dwarf_debug_info()),
+			  die_offset, &cu)
+	    || dwarf_tag(&cu) != DW_TAG_compile_unit)
+	  continue;
+
+	Dwarf_Die child;
+	if (dwarf_child(&cu, &child) != 0)
+	  continue;
+
+	dwarf_offsets_type exported_decl_dies;
+	do
+	  if (is_decl_die_with_exported_symbol(&child))
+	    exported_decl_dies.push_back(dwarf_dieoffset(&child));
+	while (dwarf_siblingof(&child, &child) == 0);
+
+	if (!exported_decl_dies.empty())
+	  cu_exported_decl_dies_[die_offset].swap(exported_decl_dies);
+      }
+
+    metrics::registry& m = env().get_metrics();
+    m.increment_counter("dwarf.units-with-exported-decls",
+			cu_exported_decl_dies_.size());
+    m.increment_counter("dwarf.units-skipped-by-name-index",
+			nb_skipped_units);
+  }
+
+  /// Use the name index of the debug info, if any, to find the
+  /// compilation units that might have DIEs of declarations with
+  /// exported symbols.
+  ///
+  /// The name index is read from the .debug_names section or, if
+  /// there is none, from the .gdb_index section.  The units of the
+  /// DIEs named after an exported symbol, or after a symbol aliasing
+  /// it, are the candidate units.  The DIEs are looked up by the
+  /// linkage name of the symbol, which .debug_names indexes, and by
+  /// the names derived from the demangled name of the symbol, which
+  /// .gdb_index indexes.  An exported symbol that the index doesn't
+  /// name is assumed to not be described by the units that the index
+  /// covers, like the symbols of functions written in assembly.  The
+  /// units that the index doesn't cover are not candidates, as
+  /// nothing is known about them; they have to be looked at anyway.
+  ///
+  /// @param units output parameter.  The offsets of the headers of
+  /// the candidate units.
+  ///
+  /// @return the name index that was used to find the candidate
+  /// units, or nil if none was.  In the later case, all the units are
+  /// to be looked at.
+  dwarf_name_index::name_index_sptr
+  get_units_of_exported_symbols_from_name_index(unordered_set<Dwarf_Off>& units)
+  {
+    dwarf_name_index::name_index_sptr nil;
+
+    // Suppressed symbols are not walked below, yet the DIEs of
+    // declarations that have such symbols are considered to be
+    // exported.  So don't use the index if symbols might be
+    // suppressed.
+    if (!suppressions().empty())
+      return nil;
+
+    dwarf_name_index::name_index_sptr index;
+    {
+      metrics::scoped_phase phase(env().get_metrics(),
+				  "dwarf.load-name-index");
+      index = dwarf_name_index::name_index::load(dwarf_elf_handle());
+    }
+    if (!index)
+      return nil;
+
+    if (do_log())
+      cerr << "using the "
+	   << (index->get_kind() == dwarf_name_index::name_index::GDB_INDEX_KIND
+	       ? ".gdb_index"
+	       : ".debug_names")
+	   << " name index with " << index->get_number_of_names()
+	   << " names covering " << index->get_number_of_covered_units()
+	   << " units\n";
+
+    // This must select the symbols that
+    // elf::reader::{function,variable}_symbol_is_exported select.
+    symtab_reader::symtab_filter filter;
+    filter.set_public_symbols();
+    if (load_in_linux_kernel_mode() && elf_helpers::is_linux_kernel(elf_handle()))
+      filter.set_kernel_symbols();
+    symtab_reader::symtab_filter fn_filter = filter, var_filter = filter;
+    fn_filter.set_functions();
+    var_filter.set_variables();
+
+    vector<string> names;
+    dwarf_name_index::name_index::entries_type entries;
+    for (const symtab_reader::symtab_filter* f : {&fn_filter, &var_filter})
+      for (const auto& symbol : symtab_reader::filtered_symtab(*symtab(), *f))
+	{
+	  elf_symbol_sptr main = symbol->get_main_symbol();
+	  add_units_of_name(*index, main->get_name(), names, entries, units);
+	  for (elf_symbol_sptr a = main->get_next_alias();
+	       a && !a->is_main_symbol();
+	       a = a->get_next_alias())
+	    add_units_of_name(*index, a->get_name(), names, entries, units);
+	}
+
+    return index;
+  }
+
+  /// Add the units of the DIEs of a given symbol name to a set of
+  /// units, using a name index.
+  ///
+  /// If the name is a mangled C++ name, the units of the DIEs named
+  /// after the names derived from its demangled name are added as
+  /// well.  See dwarf_name_index::get_lookup_names_of_demangled_name.
+  ///
+  /// @param index the name index to use.
+  ///
+  /// @param name the symbol name to consider.
+  ///
+  /// @param names a scratch vector of names, passed in to avoid
+  /// allocating a new one for each symbol.
+  ///
+  /// @param entries a scratch vector of entries, passed in for the
+  /// same reason.
+  ///
+  /// @param units the set of offsets of unit headers to add to.
+  static void
+  add_units_of_name(const dwarf_name_index::name_index&		index,
+		    const string&				name,
+		    vector<string>&				names,
+		    dwarf_name_index::name_index::entries_type&	entries,
+		    unordered_set<Dwarf_Off>&			units)
+  {
+    if (index.lookup(name, entries))
+      for (const dwarf_name_index::entry& e : entries)
+	units.insert(e.unit_offset);
+
+    string demangled = demangle_cplus_mangled_name(name);
+    if (demangled.empty() || demangled == name)
+      return;
+
+    dwarf_name_index::get_lookup_names_of_demangled_name(demangled, names);
+    for (const string& n : names)
+      if (index.lookup(n, entries))
+	for (const dwarf_name_index::entry& e : entries)
+	  units.insert(e.unit_offset);
+  }
+
+  /// Getter of the DIEs of the declarations with exported symbols
+  /// of a given compilation unit.
+  ///
+  /// This is only meaningful if the exported interfaces are read
+  /// lazily.
+  ///
+  /// @param cu_die_offset the offset of the DIE of the compilation
+  /// unit to consider.
+  ///
+  /// @return the offsets of the DIEs of the declarations with
+  /// exported symbols of the compilation unit, in the order in which
+  /// they appear in the debug info.
+  const dwarf_offsets_type&
+  exported_decl_dies_of_cu(Dwarf_Off cu_die_offset) const
+  {
+    static const dwarf_offsets_type empty;
+    auto i = cu_exported_decl_dies_.find(cu_die_offset);
+    if (i == cu_exported_decl_dies_.end())
+      return empty;
+    return i->second;
+  }
+
+  /// If the DIE -> parent map of the main debug info is built
+  /// lazily, make sure it contains the DIE -> parent relations of the
+  /// unit of a given DIE.
+  ///
+  /// This is needed when the IR built from the DIEs of a unit refers
+  /// to a DIE of another unit that wasn't walked by
+  /// build_die_parent_maps.
+  ///
+  /// @param die the DIE to consider.
+  void
+  maybe_build_die_parent_map_of_unit_of(const Dwarf_Die* die) const
+  {
+    if (!lazy_primary_die_parent_map_
+	|| get_die_source(die) != PRIMARY_DEBUG_INFO_DIE_SOURCE)
+      return;
+
+    Dwarf_Die unit;
+    if (dwarf_diecu(const_cast<Dwarf_Die*>(die), &unit, NULL, NULL))
+      maybe_build_die_parent_map_of_unit(PRIMARY_DEBUG_INFO_DIE_SOURCE,
+					 dwarf_dieoffset(&unit));
+  }
+
+  /// If the DIE -> parent map of the main debug info is built
+  /// lazily, make sure it contains the DIE -> parent relations of a
+  /// given unit, as well as its import points.
+  ///
+  /// @param source the source of the unit to consider.  Nothing is
+  /// done for units that don't come from the main debug info.
+  ///
+  /// @param unit_offset the offset of the DIE of the unit to
+  /// consider.
+  void
+  maybe_build_die_parent_map_of_unit(die_source source,
+				     Dwarf_Off unit_offset) const
+  {
+    if (!lazy_primary_die_parent_map_
+	|| source != PRIMARY_DEBUG_INFO_DIE_SOURCE)
+      return;
+
+    reader* r = const_cast<reader*>(this);
+    if (!r->die_parent_map_units_.insert(unit_offset).second)
+      return;
+
+    Dwarf_Die unit;
+    if (!dwarf_offdie(const_cast<Dwarf*>(dwarf_debug_info()),
+		      unit_offset, &unit))
+      return;
+
+    // The unit being walked must be the current one while its import
+    // points are recorded, so save the current one.
+    Dwarf_Die* saved_tu_die = const_cast<Dwarf_Die*>(cur_tu_die());
+    r->cur_tu_die(&unit);
+    imported_unit_points_type& imported_units =
+      r->tu_die_imported_unit_points_map(source)[unit_offset] =
+      imported_unit_points_type();
+    r->build_die_parent_relations_under(&unit, source, imported_units);
+    r->cur_tu_die(saved_tu_die);
+  }
+
   /// Walk all the DIEs accessible in the debug info (and in the
   /// alternate debug info as well) and build maps representing the
   /// relationship DIE -> parent.  That is, make it so that we can get
@@ -5318,6 +6588,7 @@ public:
     bool we_do_have_to_build_die_parent_map = false;
     uint8_t address_size = 0;
     size_t header_size = 0;
+    vector<Dwarf_Off> cu_die_offsets;
     // Get the DIE of the current translation unit, look at it to get
     // its language. If that language is in C, then all types are in
     // the global namespace so we don't need to build the DIE ->
@@ -5333,6 +6604,7 @@ public:
 	if (!dwarf_offdie(const_cast<Dwarf*>(dwarf_debug_info()),
 			  die_offset, &cu))
 	  continue;
+	cu_die_offsets.push_back(die_offset);
 
 	uint64_t l = 0;
 	die_unsigned_constant_attribute(&cu, DW_AT_language, l);
@@ -5344,6 +6616,22 @@ public:
     if (!we_do_have_to_build_die_parent_map)
       return;
 
+    if (read_exported_interfaces_lazily())
+      {
+	// Only walk the units of the main debug info that have DIEs of
+	// exported declarations now.  The other units are walked the
+	// first time the parent of one of their DIEs is needed, if
+	// ever.  See maybe_build_die_parent_map_of_unit_of.
+	lazy_primary_die_parent_map_ = true;
+	dwarf_offsets_type offsets;
+	for (Dwarf_Off o : cu_die_offsets)
+	  if (cu_exported_decl_dies_.count(o))
+	    offsets.push_back(o);
+	cu_die_offsets.swap(offsets);
+	die_parent_map_units_.insert(cu_die_offsets.begin(),
+				     cu_die_offsets.end());
+      }
+
     // Build the DIE -> parent relation for DIEs coming from the
     // .debug_info section in the alternate debug info file.
     die_source source = ALT_DEBUG_INFO_DIE_SOURCE;
@@ -5369,15 +6657,8 @@ public:
     // Build the DIE -> parent relation for DIEs coming from the
     // .debug_info section of the main debug info file.
     source = PRIMARY_DEBUG_INFO_DIE_SOURCE;
-    address_size = 0;
-    header_size = 0;
-    for (Dwarf_Off offset = 0, next_offset = 0;
-	 (dwarf_next_unit(const_cast<Dwarf*>(dwarf_debug_info()),
-			  offset, &next_offset, &header_size,
-			  NULL, NULL, &address_size, NULL, NULL, NULL) == 0);
-	 offset = next_offset)
+    for (Dwarf_Off die_offset : cu_die_offsets)
       {
-	Dwarf_Off die_offset = offset + header_size;
 	Dwarf_Die cu;
 	if (!dwarf_offdie(const_cast<Dwarf*>(dwarf_debug_info()),
 			  die_offset, &cu))
@@ -5416,6 +6697,107 @@ public:
 	build_die_parent_relations_under(&cu, source, imported_units);
       }
   }
+
+  /// Compute the canonical DIEs of the type DIEs under a given DIE.
+  ///
+  /// This is done recursively as for each child DIE, this function
+  /// walks its children as well.
+  ///
+  /// @param die the DIE whose children to walk recursively.
+  ///
+  /// @param where_offset where in the DIE stream we logically are.
+  void
+  precompute_canonical_dies_under(Dwarf_Die* die, size_t where_offset)
+  {
+    Dwarf_Die child;
+    if (dwarf_child(die, &child) != 0)
+      return;
+
+    do
+      {
+	if (is_type_die_to_be_canonicalized(&child))
+	  {
+	    Dwarf_Die canonical_die;
+	    get_or_compute_canonical_die(&child, canonical_die,
+					 where_offset,
+					 /*die_as_type=*/true);
+	  }
+	precompute_canonical_dies_under(&child, where_offset);
+      }
+    while (dwarf_siblingof(&child, &child) == 0);
+  }
+
+  /// Compute the canonical DIEs of the type DIEs of the compilation
+  /// units of the main debug info file, before building the IR.
+  ///
+  /// Building the IR then only looks up the canonical DIEs of these
+  /// type DIEs.  Note that the canonical DIEs of the type DIEs that
+  /// are in the partial units imported by the compilation units are
+  /// still computed while building the IR, as their string
+  /// representation depends on where they are imported.
+  void
+  precompute_canonical_dies()
+  {
+    uint8_t address_size = 0;
+    size_t header_size = 0;
+    Dwarf_Half dwarf_vers = 0;
+    for (Dwarf_Off offset = 0, next_offset = 0;
+	 (dwarf_next_unit(const_cast<Dwarf*>(dwarf_debug_info()),
+			  offset, &next_offset, &header_size,
+			  &dwarf_vers, NULL, &address_size, NULL,
+			  NULL, NULL) == 0);
+	 offset = next_offset)
+      {
+	Dwarf_Off die_offset = offset + header_size;
+	Dwarf_Die unit;
+	if (!dwarf_offdie(const_cast<Dwarf*>(dwarf_debug_info()),
+			  die_offset, &unit)
+	    || dwarf_tag(&unit) != DW_TAG_compile_unit)
+	  continue;
+
+	dwarf_version(dwarf_vers);
+
+	// The string representation of a DIE depends on the language
+	// of the current translation unit.  So let's use a translation
+	// unit that has the language of the unit.  It's not added to
+	// the corpus.
+	translation_unit_sptr tu(new translation_unit(env(),
+						      die_name(&unit),
+						      address_size * 8));
+	uint64_t l = 0;
+	die_unsigned_constant_attribute(&unit, DW_AT_language, l);
+	tu->set_language(dwarf_language_to_tu_language(l));
+	// The string representation of an Ada subrange type DIE
+	// builds the IR of its underlying type, which would then
+	// belong to the translation unit above.  So the type DIEs of
+	// Ada units are canonicalized while the IR is built.
+	if (is_ada_language(tu->get_language()))
+	  continue;
+	cur_tu_die(&unit);
+	cur_transl_unit(tu);
+
+	Dwarf_Die child;
+	if (dwarf_child(&unit, &child) != 0)
+	  continue;
+
+	do
+	  {
+	    size_t where_offset = dwarf_dieoffset(&child);
+	    if (is_type_die_to_be_canonicalized(&child))
+	      {
+		Dwarf_Die canonical_die;
+		get_or_compute_canonical_die(&child, canonical_die,
+					     where_offset,
+					     /*die_as_type=*/true);
+	      }
+	    precompute_canonical_dies_under(&child, where_offset);
+	  }
+	while (dwarf_siblingof(&child, &child) == 0);
+      }
+
+    cur_tu_die(0);
+    cur_tu_.reset();
+  }
 };// end class reader.
 
 /// The type of the aggregates being compared during a DIE comparison.
@@ -11529,6 +12911,8 @@ find_import_unit_point_between_dies(const reader& rdr,
 				    size_t		last_die_offset,
 				    size_t&		imported_point_offset)
 {
+  rdr.maybe_build_die_parent_map_of_unit(source, first_die_cu_offset);
+
   const tu_die_imported_unit_points_map_type& tu_die_imported_unit_points_map =
     rdr.tu_die_imported_unit_points_map(source);
 
@@ -11692,6 +13076,8 @@ get_parent_die(const reader&	rdr,
 
   const die_source source = rdr.get_die_source(die);
 
+  rdr.maybe_build_die_parent_map_of_unit_of(die);
+
   const offset_offset_map_type& m = rdr.die_parent_map(source);
   offset_offset_map_type::const_iterator i =
     m.find(dwarf_dieoffset(const_cast<Dwarf_Die*>(die)));
@@ -11832,6 +13218,7 @@ get_scope_for_die(reader& rdr,
 
   translation_unit::language die_lang = translation_unit::LANG_UNKNOWN;
   rdr.get_die_language(die, die_lang);
+  rdr.maybe_build_die_parent_map_of_unit_of(die);
   if (is_c_language(die_lang)
       || rdr.die_parent_map(source_of_die).empty())
     {
@@ -12130,6 +13517,35 @@ find_lower_bound_in_imported_unit_points(const imported_unit_points_type& p,
   return is_ok;
 }
 
+/// Get the path of the translation unit of a DW_TAG_compile_unit DIE.
+///
+/// @param die the DW_TAG_compile_unit DIE to consider.
+///
+/// @param path output parameter.  The path of the translation unit,
+/// made unique if the unit was generated by the compiler.
+///
+/// @param compilation_dir output parameter.  The compilation
+/// directory of the translation unit.
+static void
+die_translation_unit_path(const Dwarf_Die* die,
+			  string& path,
+			  string& compilation_dir)
+{
+  path = die_string_attribute(die, DW_AT_name);
+  if (path == "<artificial>")
+    {
+      // This is a file artificially generated by the compiler, so its
+      // name is '<artificial>'.  As we want all different translation
+      // units to have unique path names, let's suffix this path name
+      // with its die offset.
+      std::ostringstream o;
+      o << path << "-" << std::hex
+	<< dwarf_dieoffset(const_cast<Dwarf_Die*>(die));
+      path = o.str();
+    }
+  compilation_dir = die_string_attribute(die, DW_AT_comp_dir);
+}
+
 /// Given a DW_TAG_compile_unit, build and return the corresponding
 /// abigail::translation_unit ir node.  Note that this function
 /// recursively reads the children dies of the current DIE and
@@ -12160,18 +13576,8 @@ build_translation_unit_and_add_to_ir(reader&	rdr,
 
   rdr.cur_tu_die(die);
 
-  string path = die_string_attribute(die, DW_AT_name);
-  if (path == "<artificial>")
-    {
-      // This is a file artificially generated by the compiler, so its
-      // name is '<artificial>'.  As we want all different translation
-      // units to have unique path names, let's suffix this path name
-      // with its die offset.
-      std::ostringstream o;
-      o << path << "-" << std::hex << dwarf_dieoffset(die);
-      path = o.str();
-    }
-  string compilation_dir = die_string_attribute(die, DW_AT_comp_dir);
+  string path, compilation_dir;
+  die_translation_unit_path(die, path, compilation_dir);
 
   // See if the same translation unit exits already in the current
   // corpus.  Sometimes, the same translation unit can be present
@@ -12180,11 +13586,9 @@ build_translation_unit_and_add_to_ir(reader&	rdr,
   // represent that, we are going to re-use the same translation
   // unit.  That is, it's going to be the union of all the translation
   // units of the same path.
-  {
-    const string& abs_path =
-      compilation_dir.empty() ? path : compilation_dir + "/" + path;
-    result = rdr.corpus()->find_translation_unit(abs_path);
-  }
+  const string abs_path =
+    compilation_dir.empty() ? path : compilation_dir + "/" + path;
+  result = rdr.corpus()->find_translation_unit(abs_path);
 
   if (!result)
     {
@@ -12192,6 +13596,9 @@ build_translation_unit_and_add_to_ir(reader&	rdr,
 					path,
 					address_size));
       result->set_compilation_dir_path(compilation_dir);
+      auto h = rdr.translation_unit_hashes().find(abs_path);
+      if (h != rdr.translation_unit_hashes().end())
+	result->set_content_hash(h->second);
       rdr.corpus()->add(result);
       uint64_t l = 0;
       die_unsigned_constant_attribute(die, DW_AT_language, l);
@@ -12207,15 +13614,28 @@ build_translation_unit_and_add_to_ir(reader&	rdr,
 
   result->set_is_constructed(false);
 
-  do
-    // Analyze all the DIEs we encounter unless we are asked to only
-    // analyze exported interfaces and the types reachables from them.
-    if (!rdr.env().analyze_exported_interfaces_only()
-	|| rdr.is_decl_die_with_exported_symbol(&child))
-      build_ir_node_from_die(rdr, &child,
-			     die_is_public_decl(&child),
-			     dwarf_dieoffset(&child));
-  while (dwarf_siblingof(&child, &child) == 0);
+  if (rdr.read_exported_interfaces_lazily())
+    // The DIEs of the exported declarations of this unit were
+    // already found by reader::collect_exported_decl_dies so only
+    // look at those.
+    for (Dwarf_Off o : rdr.exported_decl_dies_of_cu(dwarf_dieoffset(die)))
+      {
+	ABG_ASSERT(dwarf_offdie(const_cast<Dwarf*>(rdr.dwarf_debug_info()),
+				o, &child));
+	build_ir_node_from_die(rdr, &child,
+			       die_is_public_decl(&child),
+			       dwarf_dieoffset(&child));
+      }
+  else
+    do
+      // Analyze all the DIEs we encounter unless we are asked to only
+      // analyze exported interfaces and the types reachables from them.
+      if (!rdr.env().analyze_exported_interfaces_only()
+	  || rdr.is_decl_die_with_exported_symbol(&child))
+	build_ir_node_from_die(rdr, &child,
+			       die_is_public_decl(&child),
+			       dwarf_dieoffset(&child));
+    while (dwarf_siblingof(&child, &child) == 0);
 
   if (!rdr.var_decls_to_re_add_to_tree().empty())
     for (list<var_decl_sptr>::const_iterator v =
@@ -14234,28 +15654,32 @@ build_subrange_type(reader&		rdr,
 
   string name = die_name(die);
 
+  translation_unit::language language = rdr.cur_transl_unit()->get_language();
+
   // load the underlying type.
   Dwarf_Die underlying_type_die;
   type_base_sptr underlying_type;
   /* Unless there is an underlying type which says differently.  */
   bool is_signed = false;
   if (die_die_attribute(die, DW_AT_type, underlying_type_die))
-    underlying_type =
-      is_type(build_ir_node_from_die(rdr,
-				     &underlying_type_die,
-				     /*called_from_public_decl=*/true,
-				     where_offset));
-
-  if (underlying_type)
     {
+      // Building the underlying type adds it to the current type
+      // tree.  So if the subrange is not to be added to it, only
+      // build the underlying type if it's needed by the string
+      // representation of the subrange, that is, for Ada.
+      if (associate_type_to_die || is_ada_language(language))
+	underlying_type =
+	  is_type(build_ir_node_from_die(rdr,
+					 &underlying_type_die,
+					 /*called_from_public_decl=*/true,
+					 where_offset));
+
       uint64_t ate;
       if (die_unsigned_constant_attribute (&underlying_type_die,
 					   DW_AT_encoding,
 					   ate))
 	  is_signed = (ate == DW_ATE_signed || ate == DW_ATE_signed_char);
     }
-
-  translation_unit::language language = rdr.cur_transl_unit()->get_language();
   array_type_def::subrange_type::bound_value lower_bound =
     get_default_array_lower_bound(language);
   array_type_def::subrange_type::bound_value upper_bound;
@@ -14,17 +14,41 @@
 /// abigail::dwarf_reader::reader and abigail::ctf_raeder::reader.
 
 #include "abg-internal.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <vector>
 
 // <headers defining libabigail's API go under here>
 ABG_BEGIN_EXPORT_DECLARATIONS
 
 #include "abg-elf-based-reader.h"
+#include "abg-config.h"
+#include "abg-hash.h"
+#include "abg-reader.h"
+#include "abg-tools-utils.h"
+#include "abg-writer.h"
 
 ABG_END_EXPORT_DECLARATIONS
 // </headers defining libabigail's API>
+
+#include "abg-elf-helpers.h"
+
 namespace abigail
 {
 
+using std::ostringstream;
+using std::vector;
+
 /// The private data of the @ref elf_based_reader type.
 struct elf_based_reader::priv
 {
@@ -78,6 +102,370 @@ elf_based_reader::reset(const std::string& elf_path,
   priv_->initialize();
 }
 
+/// Compute a digest of a set of suppression specifications that
+/// apply at the time an ABI corpus is built.
+///
+/// A suppression specification read from a file is digested as the
+/// hash of the content of the file.  The suppression specifications
+/// generated from a set of public headers to drop private types, as
+/// done by the "--headers-dir" option of the tools, are digested as
+/// the sorted list of the headers files that are kept.
+///
+/// @param supprs the suppression specifications to consider.
+///
+/// @param digest output parameter.  This is set to the digest of @p
+/// supprs iff the function returns true.
+///
+/// @return true iff @p supprs could be digested.
+static bool
+digest_suppressions(const suppr::suppressions_type& supprs, string& digest)
+{
+  ostringstream o;
+  o << std::hex;
+  std::set<uint64_t> source_hashes;
+  for (const auto& s : supprs)
+    {
+      if (uint64_t h = s->get_source_hash())
+	{
+	  // Several suppression specifications come from the same
+	  // file.
+	  if (source_hashes.insert(h).second)
+	    o << "suppression-source: " << h << "\n";
+	  continue;
+	}
+
+      suppr::type_suppression_sptr ts = suppr::is_type_suppression(s);
+      if (!ts || ts->get_label() != suppr::get_private_types_suppr_spec_label())
+	// We can't tell what this suppression specification does to
+	// the corpus without looking at it in detail.
+	return false;
+
+      vector<string> locations(ts->get_source_locations_to_keep().begin(),
+			       ts->get_source_locations_to_keep().end());
+      std::sort(locations.begin(), locations.end());
+      o << "suppression: " << ts->get_label()
+	<< " " << ts->get_drops_artifact_from_ir()
+	<< " " << ts->get_source_location_to_keep_regex_str() << "\n";
+      for (const auto& l : locations)
+	o << "  " << l << "\n";
+    }
+  digest = o.str();
+  return true;
+}
+
+/// Compute the key of the ABI corpus built by a given reader, in the
+/// on-disk cache of ABI corpora.
+///
+/// The key identifies the binary through its build-id, and
+/// identifies everything else that has an influence on the resulting
+/// corpus: the version of libabigail, the front-end used, the
+/// options of the front-end, the content of the baseline abixml file,
+/// if any, the debug info found and the suppression specifications
+/// that apply.
+///
+/// @param rdr the reader to consider.
+///
+/// @param fe_origin the kind of the front-end of @p rdr.
+///
+/// @param key output parameter.  This is set to the key iff the
+/// function returns true.
+///
+/// @return true iff the corpus built by @p rdr can be cached.
+static bool
+compute_corpus_cache_key(const elf_based_reader& rdr,
+			 corpus::origin fe_origin,
+			 string& key)
+{
+  const fe_iface::options_type& opts = rdr.options();
+  if (opts.corpus_cache_dir.empty()
+      // Corpora of a Linux kernel are built in the context of their
+      // corpus group so they are not cached.
+      || !rdr.elf_handle()
+      || (rdr.load_in_linux_kernel_mode()
+	  && elf_helpers::is_linux_kernel(rdr.elf_handle()))
+      || rdr.has_corpus_group())
+    return false;
+
+  string build_id;
+  if (!elf_helpers::get_build_id(rdr.elf_handle(), build_id))
+    return false;
+
+  string suppressions;
+  if (!digest_suppressions(rdr.suppressions(), suppressions))
+    return false;
+
+  // The translation units re-used from a baseline abixml file
+  // depend on its content, not only on its path.
+  uint64_t baseline_hash = 0;
+  if (!opts.baseline_abixml_path.empty())
+    {
+      std::ifstream input(opts.baseline_abixml_path.c_str());
+      if (!input)
+	return false;
+      std::stringstream text;
+      text << input.rdbuf();
+      baseline_hash = hashing::fnv_hash64(text.str());
+    }
+
+  string maj, min, rev, suf, xml_maj, xml_min;
+  abigail_get_library_version(maj, min, rev, suf);
+  abigail_get_abixml_version(xml_maj, xml_min);
+
+  ostringstream o;
+  o << "build-id: " << build_id << "\n"
+    << "libabigail: " << maj << "." << min << "." << rev << suf << "\n"
+    << "abixml: " << xml_maj << "." << xml_min << "\n"
+    << "front-end: " << fe_origin << "\n"
+    << "options: "
+    << opts.load_in_linux_kernel_mode
+    << opts.load_all_types
+    << opts.drop_undefined_syms
+    << opts.leverage_dwarf_factorization
+    << opts.assume_odr_for_cplusplus
+    << opts.precompute_canonical_dies
+    << opts.read_exported_interfaces_lazily
+    << opts.hash_translation_units
+    << opts.env.analyze_exported_interfaces_only() << "\n"
+    << "baseline: " << opts.baseline_abixml_path
+    << " " << std::hex << baseline_hash << std::dec << "\n"
+    << "debug-info: "
+    << rdr.has_dwarf_debug_info()
+    << !rdr.alternate_dwarf_debug_info_path().empty()
+    << (rdr.alternate_dwarf_debug_info() != nullptr) << "\n"
+    << suppressions;
+  key = o.str();
+  return true;
+}
+
+/// Get the paths of the files of an entry of the on-disk cache of
+/// ABI corpora.
+///
+/// @param dir the directory of the cache.
+///
+/// @param key the key of the entry.
+///
+/// @param corpus_path output parameter.  This is set to the path of
+/// the file containing the serialized corpus.
+///
+/// @param key_path output parameter.  This is set to the path of the
+/// file containing the key of the entry and the properties of the
+/// corpus that are not serialized.
+static void
+get_corpus_cache_entry_paths(const string& dir,
+			     const string& key,
+			     string& corpus_path,
+			     string& key_path)
+{
+  ostringstream o;
+  o << dir << "/" << std::hex;
+  o.width(16);
+  o.fill('0');
+  o << hashing::fnv_hash64(key);
+  corpus_path = o.str() + ".abi";
+  key_path = o.str() + ".key";
+}
+
+/// Write a file of the on-disk cache of ABI corpora.
+///
+/// The content is first written into a temporary file that is then
+/// renamed, so that concurrent readers of the cache never see a
+/// partially written file.
+///
+/// @param path the path of the file to write.
+///
+/// @param content the content to write.
+///
+/// @return true iff the file was written.
+static bool
+write_corpus_cache_file(const string& path, const string& content)
+{
+  static std::atomic<unsigned> counter(0);
+  ostringstream o;
+  o << path << ".tmp." << getpid() << "." << counter++;
+  string tmp_path = o.str();
+
+  {
+    std::ofstream out(tmp_path.c_str(), std::ios::binary);
+    out << content;
+    out.close();
+    if (!out)
+      {
+	unlink(tmp_path.c_str());
+	return false;
+      }
+  }
+
+  if (rename(tmp_path.c_str(), path.c_str()))
+    {
+      unlink(tmp_path.c_str());
+      return false;
+    }
+  return true;
+}
+
+/// Remove the least recently used entries of the on-disk cache of
+/// ABI corpora until the cache fits in a given size.
+///
+/// @param dir the directory of the cache.
+///
+/// @param max_size the maximum size of the cache, in bytes.  If it's
+/// zero, the size of the cache is not limited.
+static void
+evict_corpus_cache_entries(const string& dir, uint64_t max_size)
+{
+  if (!max_size)
+    return;
+
+  DIR* d = opendir(dir.c_str());
+  if (!d)
+    return;
+
+  struct entry
+  {
+    string	corpus_path;
+    string	key_path;
+    time_t	mtime;
+    uint64_t	size;
+  };
+
+  vector<entry> entries;
+  uint64_t total_size = 0;
+  while (struct dirent* e = readdir(d))
+    {
+      string name = e->d_name;
+      if (!tools_utils::string_ends_with(name, ".abi"))
+	continue;
+
+      entry n;
+      n.corpus_path = dir + "/" + name;
+      n.key_path = n.corpus_path.substr(0, n.corpus_path.size() - 4) + ".key";
+      struct stat st;
+      if (stat(n.corpus_path.c_str(), &st))
+	continue;
+      n.mtime = st.st_mtime;
+      n.size = st.st_size;
+      if (!stat(n.key_path.c_str(), &st))
+	n.size += st.st_size;
+      total_size += n.size;
+      entries.push_back(n);
+    }
+  closedir(d);
+
+  if (total_size <= max_size)
+    return;
+
+  std::sort(entries.begin(), entries.end(),
+	    [](const entry& l, const entry& r)
+	    {return l.mtime < r.mtime;});
+
+  for (const auto& e : entries)
+    {
+      if (total_size <= max_size)
+	break;
+      unlink(e.key_path.c_str());
+      unlink(e.corpus_path.c_str());
+      total_size -= e.size;
+    }
+}
+
+/// Look up the ABI corpus of the current binary in the on-disk cache
+/// of ABI corpora.
+///
+/// The cache is used only if the @ref
+/// fe_iface::options_type::corpus_cache_dir option is set and if the
+/// current binary has a build-id.
+///
+/// @param fe_origin the kind of the front-end that builds the corpus.
+///
+/// @param status output parameter.  This is set to the status the
+/// corpus was built with, iff a non-nil corpus is returned.
+///
+/// @return the ABI corpus found in the cache, or nil if there was
+/// none.
+ir::corpus_sptr
+elf_based_reader::read_corpus_from_cache(ir::corpus::origin fe_origin,
+					 fe_iface::status& status)
+{
+  string key;
+  if (!compute_corpus_cache_key(*this, fe_origin, key))
+    return ir::corpus_sptr();
+
+  string corpus_file, key_file;
+  get_corpus_cache_entry_paths(options().corpus_cache_dir, key,
+			       corpus_file, key_file);
+
+  std::ifstream in(key_file.c_str(), std::ios::binary);
+  unsigned cached_status = 0, cached_origin = 0;
+  if (!(in >> cached_status >> cached_origin) || in.get() != '\n')
+    return ir::corpus_sptr();
+  string cached_key((std::istreambuf_iterator<char>(in)),
+		    std::istreambuf_iterator<char>());
+  if (cached_key != key)
+    return ir::corpus_sptr();
+
+  ir::corpus_sptr corp =
+    abixml::read_corpus_from_abixml_file(corpus_file, options().env);
+  if (!corp)
+    return corp;
+
+  corp->set_path(corpus_path());
+  corp->set_origin(static_cast<ir::corpus::origin>(cached_origin));
+  status = static_cast<fe_iface::status>(cached_status);
+
+  // Mark the entry as recently used, for the sake of eviction.
+  utime(corpus_file.c_str(), nullptr);
+
+  return corp;
+}
+
+/// Store the ABI corpus of the current binary into the on-disk cache
+/// of ABI corpora.
+///
+/// The corpus is stored in the abixml format.  If the cache then
+/// gets bigger than @ref
+/// fe_iface::options_type::corpus_cache_max_size, the least recently
+/// used entries are evicted.
+///
+/// @param fe_origin the kind of the front-end that built the corpus.
+///
+/// @param corp the corpus to store.
+///
+/// @param status the status the corpus was built with.
+///
+/// @return true iff the corpus was stored.
+bool
+elf_based_reader::save_corpus_to_cache(ir::corpus::origin fe_origin,
+				       const ir::corpus_sptr& corp,
+				       fe_iface::status status)
+{
+  string key;
+  if (!corp || !compute_corpus_cache_key(*this, fe_origin, key))
+    return false;
+
+  const string& dir = options().corpus_cache_dir;
+  if (!tools_utils::ensure_dir_path_created(dir))
+    return false;
+
+  ostringstream xml;
+  xml_writer::write_context_sptr ctxt =
+    xml_writer::create_write_context(options().env, xml);
+  if (!xml_writer::write_corpus(*ctxt, corp, /*indent=*/0))
+    return false;
+
+  string corpus_file, key_file;
+  get_corpus_cache_entry_paths(dir, key, corpus_file, key_file);
+
+  ostringstream k;
+  k << static_cast<unsigned>(status) << " " << corp->get_origin() << "\n"
+    << key;
+  if (!write_corpus_cache_file(corpus_file, xml.str())
+      || !write_corpus_cache_file(key_file, k.str()))
+    return false;
+
+  evict_corpus_cache_entries(dir, options().corpus_cache_max_size);
+  return true;
+}
+
 /// Read an ABI corpus and add it to a given corpus group.
 ///
 /// @param group the corpus group to consider.  The new corpus is
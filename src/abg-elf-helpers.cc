@@ -12,6 +12,7 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <limits.h>
+#include <cstring>
 #include <elfutils/libdwfl.h>
 #include <sstream>
 #include "abg-elf-helpers.h"
@@ -1259,6 +1260,63 @@ get_binary_load_address(Elf* elf_handle, GElf_Addr& load_address)
   return false;
 }
 
+/// Get the build-id of a given binary.
+///
+/// The build-id is the content of the NT_GNU_BUILD_ID note that the
+/// static linker puts into the binary.  It uniquely identifies the
+/// binary it's embedded into.
+///
+/// @param elf_handle the elf handle for the binary to consider.
+///
+/// @param build_id the build-id, as a string of hexadecimal digits.
+/// This is set by the function iff it returns true.
+///
+/// @return true iff the binary has a build-id and @p build_id was
+/// set to it.
+bool
+get_build_id(Elf* elf_handle, string& build_id)
+{
+  Elf_Scn* section = 0;
+  while ((section = elf_nextscn(elf_handle, section)) != 0)
+    {
+      GElf_Shdr header_mem, *header = gelf_getshdr(section, &header_mem);
+      if (!header || header->sh_type != SHT_NOTE)
+	continue;
+
+      Elf_Data* data = elf_getdata(section, 0);
+      if (!data)
+	continue;
+
+      GElf_Nhdr note;
+      size_t name_offset = 0, desc_offset = 0, offset = 0, next_offset;
+      while ((next_offset = gelf_getnote(data, offset, &note,
+					 &name_offset, &desc_offset)) > 0)
+	{
+	  offset = next_offset;
+	  if (note.n_type != NT_GNU_BUILD_ID
+	      || note.n_namesz != sizeof(ELF_NOTE_GNU)
+	      || memcmp(static_cast<const char*>(data->d_buf) + name_offset,
+			ELF_NOTE_GNU, sizeof(ELF_NOTE_GNU)))
+	    continue;
+
+	  if (note.n_descsz == 0)
+	    return false;
+
+	  static const char digits[] = "0123456789abcdef";
+	  const unsigned char* desc =
+	    static_cast<const unsigned char*>(data->d_buf) + desc_offset;
+	  build_id.clear();
+	  for (size_t i = 0; i < note.n_descsz; ++i)
+	    {
+	      build_id += digits[desc[i] >> 4];
+	      build_id += digits[desc[i] & 0xf];
+	    }
+	  return true;
+	}
+    }
+  return false;
+}
+
 /// Return the size of a word for the current architecture.
 ///
 /// @param elf_handle the ELF handle to consider.
@@ -214,6 +214,9 @@ create_new_dwfl_handle(Dwfl_Callbacks&);
 bool
 get_binary_load_address(Elf* elf_handle, GElf_Addr& load_address);
 
+bool
+get_build_id(Elf* elf_handle, string& build_id);
+
 unsigned char
 get_architecture_word_size(Elf* elf_handle);
 
@@ -949,6 +949,8 @@ reader::load_elf_properties()
 ir::corpus_sptr
 reader::read_corpus(status& status)
 {
+  metrics::scoped_phase phase(options().env.get_metrics(),
+			      "elf.read-corpus");
   status = STATUS_UNKNOWN;
 
   corpus::origin origin = corpus()->get_origin();
@@ -326,6 +326,21 @@ fe_iface::maybe_add_var_to_exported_decls(const var_decl* var)
       b->maybe_add_var_to_exported_vars(var);
 }
 
+/// Record the memory used by the internal data structures of the
+/// front-end, e.g, the maps that associate debug info entries to the
+/// IR nodes built from them.
+///
+/// These data structures are kept until the front-end reads another
+/// corpus or is destroyed.  The memory used by the corpus itself is
+/// recorded by corpus::get_memory_stats.
+///
+/// This default implementation records nothing.
+///
+/// @param stats the memory statistics to record into.
+void
+fe_iface::get_memory_stats(metrics::memory_stats&) const
+{}
+
 /// The bitwise OR operator for the @ref fe_iface::status type.
 ///
 /// @param l the left-hand side operand.
@@ -75,6 +75,49 @@ fnv_hash(const std::string& str)
   return hash;
 }
 
+/// The offset basis of the 64-bit FNV-1a algorithm.
+static const uint64_t fnv64_offset_basis = 0xcbf29ce484222325ULL;
+
+/// Compute a stable 64-bit string hash.
+///
+/// This is the 64-bit variant of the FNV-1a algorithm used by
+/// fnv_hash().  It has much fewer collisions than its 32-bit
+/// counterpart on big sets of strings, so it's suitable for keying
+/// maps by the hash of a string rather than by the string itself.
+///
+/// @param str the string to hash.
+///
+/// @return an unsigned 64 bit hash value.
+uint64_t
+fnv_hash64(const std::string& str)
+{return fnv_hash64(str, fnv64_offset_basis);}
+
+/// Continue the computation of a stable 64-bit string hash.
+///
+/// Hashing the string S1 with fnv_hash64(const std::string&), and
+/// then hashing the string S2 with this function, passing it the
+/// result of the first hashing, gives the same result as hashing the
+/// concatenation of S1 and S2.  This is useful to compute the hash
+/// of a string without having to build it.
+///
+/// @param str the string to hash.
+///
+/// @param hash the hash value of the characters that precede @p str.
+///
+/// @return an unsigned 64 bit hash value.
+uint64_t
+fnv_hash64(const std::string& str, uint64_t hash)
+{
+  const uint64_t prime = 0x100000001b3ULL;
+  for (std::string::const_iterator i = str.begin(); i != str.end(); ++i)
+    {
+      uint8_t byte = *i;
+      hash = hash ^ byte;
+      hash = hash * prime;
+    }
+  return hash;
+}
+
 }//end namespace hashing
 
 using std::list;
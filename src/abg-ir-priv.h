@@ -14,6 +14,10 @@
 #define __ABG_IR_PRIV_H__
 
 #include <string>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <iostream>
 
 #include "abg-ir.h"
@@ -138,6 +142,46 @@ bool
 parse_integral_type(const string& type_name,
 		    integral_type& type);
 
+// <node_arena declarations>
+
+class node_arena;
+
+/// Base type of the private data of the IR nodes.
+///
+/// Like the IR nodes themselves (see type_or_decl_base::operator
+/// new), the instances of the types deriving from this one are
+/// allocated from the arena of the current @ref
+/// arena_allocation_scope, if there is one.
+struct arena_allocated
+{
+  static void*
+  operator new(size_t);
+
+  static void
+  operator delete(void*, size_t);
+}; // end struct arena_allocated
+
+/// While an instance of this type is alive, the IR nodes (and their
+/// private data) created by the current thread are allocated from
+/// the arena of a given environment, if that environment uses arena
+/// allocation.
+///
+/// See environment::use_arena_allocation.
+///
+/// The readers create an instance of this type for the time it takes
+/// them to build a corpus.
+class arena_allocation_scope
+{
+  node_arena* previous_;
+
+public:
+  arena_allocation_scope(const environment&);
+
+  ~arena_allocation_scope();
+}; // end class arena_allocation_scope
+
+// </node_arena declarations>
+
 /// Private type to hold private members of @ref translation_unit
 struct translation_unit::priv
 {
@@ -149,6 +193,7 @@ struct translation_unit::priv
   std::string					path_;
   std::string					comp_dir_path_;
   std::string					abs_path_;
+  std::string					content_hash_;
   location_manager				loc_mgr_;
   mutable global_scope_sptr			global_scope_;
   mutable vector<type_base_sptr>		synthesized_types_;
@@ -161,7 +206,8 @@ struct translation_unit::priv
       corp(),
       is_constructed_(),
       address_size_(),
-      language_(LANG_UNKNOWN)
+      language_(LANG_UNKNOWN),
+      loc_mgr_(env)
   {}
 
   ~priv()
@@ -175,7 +221,7 @@ struct translation_unit::priv
 // <type_base definitions>
 
 /// Definition of the private data of @ref type_base.
-struct type_base::priv
+struct type_base::priv : public arena_allocated
 {
   size_t		size_in_bits;
   size_t		alignment_in_bits;
@@ -384,14 +430,18 @@ typedef unordered_set<const function_type*> fn_set_type;
 typedef unordered_map<uint64_t_pair_type, bool,
 		      uint64_t_pair_hash> type_comparison_result_type;
 
-/// The private data of the @ref environment type.
-struct environment::priv
+/// The state of the type comparison engine.
+///
+/// This gathers the data that is used and updated by the @ref equals
+/// overloads while they recursively compare two types.  That state
+/// is specific to a given thread of execution: two threads comparing
+/// types of the same environment each get their own instance of it
+/// by way of environment::priv::comparison_state().
+///
+/// Note that only the state of type comparison is per-thread.  Type
+/// canonicalization is still serial; see canonicalize_types.
+struct type_comparison_state
 {
-  config				config_;
-  canonical_types_map_type		canonical_types_;
-  mutable vector<type_base_sptr>	sorted_canonical_types_;
-  type_base_sptr			void_type_;
-  type_base_sptr			variadic_marker_type_;
   // The set of pairs of class types being currently compared.  It's
   // used to avoid endless loops while recursively comparing types.
   // This should be empty when none of the 'equal' overloads are
@@ -408,8 +458,6 @@ struct environment::priv
   // either class or function types) that are designated by their
   // memory address in the IR.
   type_comparison_result_type		type_comparison_results_cache_;
-  vector<type_base_sptr>		extra_live_types_;
-  interned_string_pool			string_pool_;
   // The two vectors below represent the stack of left and right
   // operands of the current type comparison operation that is
   // happening during type canonicalization.
@@ -460,6 +508,68 @@ struct environment::priv
   // must be cleared.
   pointer_set		types_with_non_confirmed_propagated_ct_;
   pointer_set		recursive_types_;
+  // The flags below override, for the current thread, the flags of
+  // the same names of the environment.  They are set when a thread
+  // other than the one that created the environment toggles these
+  // flags, e.g. while it reads a binary into an environment that is
+  // shared with other threads.  See the environment member functions
+  // of the same names.
+  optional<bool>	canonicalization_is_done_;
+  optional<bool>	do_on_the_fly_canonicalization_;
+  optional<bool>	decl_only_class_equals_definition_;
+  bool			allow_type_comparison_results_caching_;
+
+  type_comparison_state()
+    : allow_type_comparison_results_caching_(false)
+  {}
+};
+
+/// The private data of the @ref environment type.
+struct environment::priv
+{
+  config				config_;
+  canonical_types_map_type		canonical_types_;
+  mutable vector<type_base_sptr>	sorted_canonical_types_;
+  type_base_sptr			void_type_;
+  type_base_sptr			variadic_marker_type_;
+  // The two types above are created the first time they are needed,
+  // possibly by several threads at once.
+  std::once_flag			void_type_once_;
+  std::once_flag			variadic_marker_type_once_;
+  vector<type_base_sptr>		extra_live_types_;
+  interned_string_pool			string_pool_;
+  // The state of the type comparisons performed by the thread that
+  // created the environment.
+  type_comparison_state			main_comparison_state_;
+  std::thread::id			main_thread_id_;
+  // The states of the type comparisons performed by the other
+  // threads, created on demand and erased when these threads exit.
+  mutable std::mutex			comparison_states_lock_;
+  mutable unordered_map<std::thread::id,
+			std::unique_ptr<type_comparison_state>>
+					comparison_states_;
+  // A number that identifies the environment among all the
+  // environments created by the process.  See comparison_state.
+  const uint64_t			serial_;
+  // Held while types are canonicalized, so that several threads can
+  // read binaries into the environment.  See
+  // environment::get_canonicalization_lock.
+  mutable std::recursive_mutex		canonicalization_lock_;
+  // Held while extra_live_types_ is updated.
+  std::mutex				extra_live_types_lock_;
+  // The performance metrics recorded by the readers, the type
+  // canonicalizer, the comparison engine and the reporters working
+  // in this environment.
+  mutable metrics::registry		metrics_;
+  // The handles of the counters of metrics_ that are incremented on
+  // hot paths.
+  metrics::counter&			type_comparison_cache_hits_;
+  metrics::counter&			types_canonicalized_;
+  metrics::counter&			canonical_types_created_;
+  // The arena the IR nodes are allocated from, if
+  // use_arena_allocation_ is true.  See arena_allocation_scope.
+  node_arena*				node_arena_;
+  bool					use_arena_allocation_;
 #ifdef WITH_DEBUG_CT_PROPAGATION
   // Set of types which propagated canonical type has been cleared
   // during the "canonical type propagation optimization" phase. Those
@@ -492,7 +602,6 @@ struct environment::priv
   bool					do_on_the_fly_canonicalization_;
   bool					decl_only_class_equals_definition_;
   bool					use_enum_binary_only_equality_;
-  bool					allow_type_comparison_results_caching_;
   optional<bool>			analyze_exported_interfaces_only_;
 #ifdef WITH_DEBUG_SELF_COMPARISON
   bool					self_comparison_debug_on_;
@@ -515,11 +624,20 @@ struct environment::priv
 #endif
 
   priv()
-    : canonicalization_is_done_(),
+    : main_thread_id_(std::this_thread::get_id()),
+      serial_(get_next_serial()),
+      type_comparison_cache_hits_
+      (metrics_.get_counter_handle("ir.type-comparison-cache-hits")),
+      types_canonicalized_
+      (metrics_.get_counter_handle("ir.types-canonicalized")),
+      canonical_types_created_
+      (metrics_.get_counter_handle("ir.canonical-types-created")),
+      node_arena_(),
+      use_arena_allocation_(false),
+      canonicalization_is_done_(),
       do_on_the_fly_canonicalization_(true),
       decl_only_class_equals_definition_(false),
-      use_enum_binary_only_equality_(true),
-      allow_type_comparison_results_caching_(false)
+      use_enum_binary_only_equality_(true)
 #ifdef WITH_DEBUG_SELF_COMPARISON
     ,
       self_comparison_debug_on_(false)
@@ -532,6 +650,53 @@ struct environment::priv
 #endif
   {}
 
+  /// Get a number that was not returned by a previous invocation of
+  /// this function.
+  ///
+  /// @return the new number.
+  static uint64_t
+  get_next_serial()
+  {
+    static std::atomic<uint64_t> serial(0);
+    return ++serial;
+  }
+
+  /// Getter of the state of the type comparisons performed by the
+  /// current thread.
+  ///
+  /// Each thread remembers the state it got last, along with the
+  /// serial of its environment, so it only looks the state up when it
+  /// switches from one environment to another.  See
+  /// get_comparison_state_of_current_thread.
+  ///
+  /// @return the type comparison state of the current thread.
+  type_comparison_state&
+  comparison_state() const
+  {
+    thread_local uint64_t last_serial = 0;
+    thread_local type_comparison_state* last_state = nullptr;
+    if (last_serial != serial_)
+      {
+	last_state = &get_comparison_state_of_current_thread();
+	last_serial = serial_;
+      }
+    return *last_state;
+  }
+
+  type_comparison_state&
+  get_comparison_state_of_current_thread() const;
+
+  /// Test if the current thread is the one that created the
+  /// environment.
+  ///
+  /// @return true iff the current thread created the environment.
+  bool
+  current_thread_created_environment() const
+  {return &comparison_state() == &main_comparison_state_;}
+
+  void
+  forget_comparison_state_of_thread(std::thread::id id) const;
+
   /// Allow caching of the sub-types comparison results during the
   /// invocation of the @ref equal overloads for class and function
   /// types.
@@ -539,7 +704,7 @@ struct environment::priv
   /// @param f if true, allow type comparison result caching.
   void
   allow_type_comparison_results_caching(bool f)
-  {allow_type_comparison_results_caching_ = f;}
+  {comparison_state().allow_type_comparison_results_caching_ = f;}
 
   /// Check whether if caching of the sub-types comparison results during the
   /// invocation of the @ref equal overloads for class and function
@@ -550,7 +715,7 @@ struct environment::priv
   /// function types is in effect.
   bool
   allow_type_comparison_results_caching() const
-  {return allow_type_comparison_results_caching_;}
+  {return comparison_state().allow_type_comparison_results_caching_;}
 
   /// Cache the result of comparing two sub-types.
   ///
@@ -575,7 +740,7 @@ struct environment::priv
 	     && !is_type(&first)->priv_->depends_on_recursive_type()
 	     && !is_type(&second)->priv_->depends_on_recursive_type())))
       {
-	type_comparison_results_cache_.emplace
+	comparison_state().type_comparison_results_cache_.emplace
 	  (std::make_pair(reinterpret_cast<uint64_t>(&first),
 			  reinterpret_cast<uint64_t>(&second)),
 	   r);
@@ -609,12 +774,13 @@ struct environment::priv
       return false;
 
     type_comparison_result_type::const_iterator it =
-      type_comparison_results_cache_.find
+      comparison_state().type_comparison_results_cache_.find
 	 (std::make_pair(reinterpret_cast<uint64_t>(&first),
 			 reinterpret_cast<uint64_t>(&second)));
-    if (it == type_comparison_results_cache_.end())
+    if (it == comparison_state().type_comparison_results_cache_.end())
       return false;
 
+    type_comparison_cache_hits_.increment();
     r = it->second;
     return true;
   }
@@ -622,7 +788,7 @@ struct environment::priv
   /// Clear the cache type comparison results.
   void
   clear_type_comparison_results_cache()
-  {type_comparison_results_cache_.clear();}
+  {comparison_state().type_comparison_results_cache_.clear();}
 
   /// Push a pair of operands on the stack of operands of the current
   /// type comparison, during type canonicalization.
@@ -639,8 +805,8 @@ struct environment::priv
   {
     ABG_ASSERT(left && right);
 
-    left_type_comp_operands_.push_back(left);
-    right_type_comp_operands_.push_back(right);
+    comparison_state().left_type_comp_operands_.push_back(left);
+    comparison_state().right_type_comp_operands_.push_back(right);
   }
 
   /// Pop a pair of operands from the stack of operands to the current
@@ -660,13 +826,13 @@ struct environment::priv
   pop_composite_type_comparison_operands(const type_base* left,
 					 const type_base* right)
   {
-    const type_base *t = left_type_comp_operands_.back();
+    const type_base *t = comparison_state().left_type_comp_operands_.back();
     ABG_ASSERT(t == left);
-    t = right_type_comp_operands_.back();
+    t = comparison_state().right_type_comp_operands_.back();
     ABG_ASSERT(t == right);
 
-    left_type_comp_operands_.pop_back();
-    right_type_comp_operands_.pop_back();
+    comparison_state().left_type_comp_operands_.pop_back();
+    comparison_state().right_type_comp_operands_.pop_back();
   }
 
   /// Mark all the types that comes after a certain one as NOT being
@@ -760,11 +926,12 @@ struct environment::priv
   mark_dependant_types_compared_until(const type_base* right)
   {
     bool result = false;
+    type_comparison_state& s = comparison_state();
 
     result |=
       mark_dependant_types(right,
-			   right_type_comp_operands_);
-    recursive_types_.insert(reinterpret_cast<uintptr_t>(right));
+			   s.right_type_comp_operands_);
+    s.recursive_types_.insert(reinterpret_cast<uintptr_t>(right));
     return result;
   }
 
@@ -776,8 +943,9 @@ struct environment::priv
   bool
   is_recursive_type(const type_base* t)
   {
-    return (recursive_types_.find(reinterpret_cast<uintptr_t>(t))
-	    != recursive_types_.end());
+    type_comparison_state& s = comparison_state();
+    return (s.recursive_types_.find(reinterpret_cast<uintptr_t>(t))
+	    != s.recursive_types_.end());
   }
 
 
@@ -786,7 +954,7 @@ struct environment::priv
   /// @param t the type to unflag
   void
   set_is_not_recursive(const type_base* t)
-  {recursive_types_.erase(reinterpret_cast<uintptr_t>(t));}
+  {comparison_state().recursive_types_.erase(reinterpret_cast<uintptr_t>(t));}
 
   /// Propagate the canonical type of a type to another one.
   ///
@@ -824,7 +992,7 @@ struct environment::priv
   confirm_ct_propagation_for_types_dependant_on(const type_base* dependant_type)
   {
     pointer_set to_remove;
-    for (auto i : types_with_non_confirmed_propagated_ct_)
+    for (auto i : comparison_state().types_with_non_confirmed_propagated_ct_)
       {
 	type_base *t = reinterpret_cast<type_base*>(i);
 	t->priv_->set_does_not_depend_on_recursive_type(dependant_type);
@@ -839,7 +1007,7 @@ struct environment::priv
       }
 
     for (auto i : to_remove)
-      types_with_non_confirmed_propagated_ct_.erase(i);
+      comparison_state().types_with_non_confirmed_propagated_ct_.erase(i);
   }
 
   /// Mark a type that has been the target of canonical type
@@ -882,7 +1050,7 @@ struct environment::priv
   void
   confirm_ct_propagation()
   {
-    for (auto i : types_with_non_confirmed_propagated_ct_)
+    for (auto i : comparison_state().types_with_non_confirmed_propagated_ct_)
       {
 	type_base *t = reinterpret_cast<type_base*>(i);
 	t->priv_->set_does_not_depend_on_recursive_type();
@@ -891,7 +1059,7 @@ struct environment::priv
 	    check_abixml_canonical_type_propagation_during_self_comp(t);
 #endif
       }
-    types_with_non_confirmed_propagated_ct_.clear();
+    comparison_state().types_with_non_confirmed_propagated_ct_.clear();
   }
 
 #ifdef WITH_DEBUG_CT_PROPAGATION
@@ -1000,7 +1168,7 @@ struct environment::priv
   {
     pointer_set to_remove;
     collect_types_that_depends_on(target,
-				  types_with_non_confirmed_propagated_ct_,
+				  comparison_state().types_with_non_confirmed_propagated_ct_,
 				  to_remove);
 
     for (auto i : to_remove)
@@ -1017,7 +1185,7 @@ struct environment::priv
       }
 
     for (auto i : to_remove)
-      types_with_non_confirmed_propagated_ct_.erase(i);
+      comparison_state().types_with_non_confirmed_propagated_ct_.erase(i);
   }
 
   /// Reset the canonical type (set it nullptr) of a type that has
@@ -1087,7 +1255,7 @@ struct environment::priv
   add_to_types_with_non_confirmed_propagated_ct(const type_base *t)
   {
     uintptr_t v = reinterpret_cast<uintptr_t>(t);
-    types_with_non_confirmed_propagated_ct_.insert(v);
+    comparison_state().types_with_non_confirmed_propagated_ct_.insert(v);
   }
 
   /// Remove a given type from the set of types that have been
@@ -1099,7 +1267,7 @@ struct environment::priv
   remove_from_types_with_non_confirmed_propagated_ct(const type_base* dependant)
   {
     uintptr_t i = reinterpret_cast<uintptr_t>(dependant);
-    types_with_non_confirmed_propagated_ct_.erase(i);
+    comparison_state().types_with_non_confirmed_propagated_ct_.erase(i);
   }
 
   /// Cancel the propagated canonical types of all the types which
@@ -1108,7 +1276,7 @@ struct environment::priv
   cancel_all_non_confirmed_propagated_canonical_types()
   {
     vector<uintptr_t> to_erase;
-    for (auto i : types_with_non_confirmed_propagated_ct_)
+    for (auto i : comparison_state().types_with_non_confirmed_propagated_ct_)
       to_erase.push_back(i);
 
     for (auto i : to_erase)
@@ -1293,6 +1461,11 @@ struct environment::priv
 /// types must be canonicalized, and this function detects violations
 /// of that assertion.
 ///
+/// The types are canonicalized one after the other, on the calling
+/// thread.  Canonicalizing a type updates the canonical types map of
+/// the environment, which is not thread-safe, so this function must
+/// not be called concurrently on types of the same environment.
+///
 /// @tparam input_iterator the type of the input iterator of the @p
 /// beging and @p end.
 ///
@@ -1318,6 +1491,15 @@ canonicalize_types(const input_iterator& begin,
   if (begin == end)
     return;
 
+  metrics::scoped_phase
+    phase(deref(begin)->get_environment().get_metrics(),
+	  "ir.canonicalize-types");
+
+  // Take the lock that canonicalize takes for each type once and for
+  // all.
+  std::lock_guard<std::recursive_mutex>
+    guard(deref(begin)->get_environment().priv_->canonicalization_lock_);
+
   // First, let's compute the canonical type of this type.
   for (auto t = begin; t != end; ++t)
     canonicalize(deref(t));
@@ -1336,7 +1518,7 @@ canonicalize_types(const input_iterator& begin,
 }
 
 // <class_or_union::priv definitions>
-struct class_or_union::priv
+struct class_or_union::priv : public arena_allocated
 {
   typedef_decl_wptr		naming_typedef_;
   data_members			data_members_;
@@ -1385,8 +1567,9 @@ struct class_or_union::priv
   {
     const environment& env = first.get_environment();
 
-    env.priv_->left_classes_being_compared_.insert(&first);
-    env.priv_->right_classes_being_compared_.insert(&second);
+    type_comparison_state& s = env.priv_->comparison_state();
+    s.left_classes_being_compared_.insert(&first);
+    s.right_classes_being_compared_.insert(&second);
   }
 
   /// Mark a pair of classes or unions as being currently compared
@@ -1447,8 +1630,9 @@ struct class_or_union::priv
   {
     const environment& env = first.get_environment();
 
-    env.priv_->left_classes_being_compared_.erase(&first);
-    env.priv_->right_classes_being_compared_.erase(&second);
+    type_comparison_state& s = env.priv_->comparison_state();
+    s.left_classes_being_compared_.erase(&first);
+    s.right_classes_being_compared_.erase(&second);
   }
 
   /// If a pair of class_or_union has been previously marked as
@@ -1488,10 +1672,11 @@ struct class_or_union::priv
   {
     const environment& env = first.get_environment();
 
-    return (env.priv_->left_classes_being_compared_.count(&first)
-	    || env.priv_->right_classes_being_compared_.count(&second)
-	    || env.priv_->right_classes_being_compared_.count(&first)
-	    || env.priv_->left_classes_being_compared_.count(&second));
+    type_comparison_state& s = env.priv_->comparison_state();
+    return (s.left_classes_being_compared_.count(&first)
+	    || s.right_classes_being_compared_.count(&second)
+	    || s.right_classes_being_compared_.count(&first)
+	    || s.left_classes_being_compared_.count(&second));
   }
 
   /// Test if a pair of class_or_union is being currently compared.
@@ -1515,7 +1700,7 @@ struct class_or_union::priv
 // <function_type::priv definitions>
 
 /// The type of the private data of the @ref function_type type.
-struct function_type::priv
+struct function_type::priv : public arena_allocated
 {
   parameters parms_;
   type_base_wptr return_type_;
@@ -1549,8 +1734,9 @@ struct function_type::priv
   {
     const environment& env = first.get_environment();
 
-    env.priv_->left_fn_types_being_compared_.insert(&first);
-    env.priv_->right_fn_types_being_compared_.insert(&second);
+    type_comparison_state& s = env.priv_->comparison_state();
+    s.left_fn_types_being_compared_.insert(&first);
+    s.right_fn_types_being_compared_.insert(&second);
   }
 
   /// Mark a given pair of @ref function_type as being compared.
@@ -1566,8 +1752,9 @@ struct function_type::priv
   {
     const environment& env = first.get_environment();
 
-    env.priv_->left_fn_types_being_compared_.erase(&first);
-    env.priv_->right_fn_types_being_compared_.erase(&second);
+    type_comparison_state& s = env.priv_->comparison_state();
+    s.left_fn_types_being_compared_.erase(&first);
+    s.right_fn_types_being_compared_.erase(&second);
   }
 
   /// Tests if a @ref function_type is currently being compared.
@@ -1581,9 +1768,10 @@ struct function_type::priv
   {
     const environment& env = first.get_environment();
 
-    return (env.priv_->left_fn_types_being_compared_.count(&first)
+    type_comparison_state& s = env.priv_->comparison_state();
+    return (s.left_fn_types_being_compared_.count(&first)
 	    ||
-	    env.priv_->right_fn_types_being_compared_.count(&second));
+	    s.right_fn_types_being_compared_.count(&second));
   }
 };// end struc function_type::priv
 
@@ -11,10 +11,15 @@
 
 #include <cxxabi.h>
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <functional>
 #include <iterator>
 #include <memory>
+#include <mutex>
+#include <new>
 #include <sstream>
 #include <typeinfo>
 #include <unordered_map>
@@ -29,6 +34,7 @@ ABG_BEGIN_EXPORT_DECLARATIONS
 #include "abg-ir.h"
 #include "abg-corpus.h"
 #include "abg-regex.h"
+#include "abg-hash.h"
 
 ABG_END_EXPORT_DECLARATIONS
 // </headers defining libabigail's API>
@@ -70,22 +76,122 @@ using std::unordered_map;
 using std::dynamic_pointer_cast;
 using std::static_pointer_cast;
 
-/// Convenience typedef for a map of string -> string*.
-typedef unordered_map<string, string*> pool_map_type;
+/// The number of shards of an @ref interned_string_pool.
+///
+/// Each shard has its own lock, so threads interning strings that
+/// fall in different shards don't wait for each other.
+static const size_t nb_string_pool_shards = 16;
+
+/// The number of strings of each block of the arena of a shard of an
+/// @ref interned_string_pool.
+static const size_t string_pool_block_size = 1024;
+
+/// The key of a string in an @ref interned_string_pool.
+///
+/// It refers to the characters of the string, and carries their
+/// hash so that it's computed only once.
+struct pool_key
+{
+  const char*	data;
+  size_t	size;
+  size_t	hash;
+
+  pool_key(const char* d, size_t s)
+    : data(d), size(s), hash(std::hash<string>()(string(d, s)))
+  {}
+
+  pool_key(const string& s)
+    : data(s.data()), size(s.size()), hash(std::hash<string>()(s))
+  {}
+}; // end struct pool_key
+
+/// The hashing functor of @ref pool_key.
+struct pool_key_hash
+{
+  size_t
+  operator()(const pool_key& k) const
+  {return k.hash;}
+}; // end struct pool_key_hash
+
+/// The equality functor of @ref pool_key.
+struct pool_key_equal
+{
+  bool
+  operator()(const pool_key& l, const pool_key& r) const
+  {
+    return (l.hash == r.hash
+	    && l.size == r.size
+	    && !memcmp(l.data, r.data, l.size));
+  }
+}; // end struct pool_key_equal
+
+/// Convenience typedef for a map of @ref pool_key -> string*.
+typedef unordered_map<pool_key, string*,
+		      pool_key_hash, pool_key_equal> pool_map_type;
 
 /// The type of the private data structure of type @ref
 /// intered_string_pool.
+///
+/// The strings are spread over shards, by hash.  The strings of a
+/// shard are allocated in blocks, and never move, so the keys of the
+/// map of the shard refer to their characters rather than to a copy
+/// of them.
 struct interned_string_pool::priv
 {
-  pool_map_type map;
+  struct shard
+  {
+    mutable std::mutex		lock;
+    pool_map_type		map;
+    vector<std::unique_ptr<string[]>> blocks;
+    size_t			nb_strings_in_last_block = 0;
+    size_t			nb_bytes = 0;
+    uint64_t			nb_lookups = 0;
+    uint64_t			nb_hits = 0;
+  }; // end struct shard
+
+  shard shards[nb_string_pool_shards];
+
+  /// Get the shard of a string.
+  ///
+  /// @param k the key of the string.
+  ///
+  /// @return the shard of the string of key @p k.
+  shard&
+  get_shard(const pool_key& k)
+  {return shards[(k.hash >> 8) % nb_string_pool_shards];}
+
+  /// Look up a string in the pool.
+  ///
+  /// @param k the key of the string to look for.
+  ///
+  /// @param found output parameter.  This is set to true iff the
+  /// string was found.
+  ///
+  /// @return the string found, or nil if it wasn't found or if it's
+  /// the empty string.
+  const string*
+  lookup(const pool_key& k, bool& found)
+  {
+    found = true;
+    if (k.size == 0)
+      return 0;
+
+    shard& s = get_shard(k);
+    std::lock_guard<std::mutex> guard(s.lock);
+    pool_map_type::const_iterator i = s.map.find(k);
+    if (i == s.map.end())
+      {
+	found = false;
+	return 0;
+      }
+    return i->second;
+  }
 }; //end struc struct interned_string_pool::priv
 
 /// Default constructor.
 interned_string_pool::interned_string_pool()
   : priv_(new priv)
-{
-  priv_->map[""] = 0;
-}
+{}
 
 /// Test if the interned string pool already contains a string with a
 /// given value.
@@ -95,7 +201,11 @@ interned_string_pool::interned_string_pool()
 /// @return true if the pool contains a string with the value @p s.
 bool
 interned_string_pool::has_string(const char* s) const
-{return priv_->map.find(s) != priv_->map.end();}
+{
+  bool found = false;
+  priv_->lookup(pool_key(s, strlen(s)), found);
+  return found;
+}
 
 /// Get a pointer to the interned string which has a given value.
 ///
@@ -106,39 +216,89 @@ interned_string_pool::has_string(const char* s) const
 const char*
 interned_string_pool::get_string(const char* s) const
 {
-  unordered_map<string, string*>::const_iterator i =
-    priv_->map.find(s);
-  if (i == priv_->map.end())
+  bool found = false;
+  const string* result = priv_->lookup(pool_key(s, strlen(s)), found);
+  if (!found)
     return 0;
-  if (i->second)
-    return i->second->c_str();
+  if (result)
+    return result->c_str();
   return "";
 }
 
 /// Create an interned string with a given value.
 ///
+/// This can be called concurrently from several threads.
+///
 /// @param str_value the value of the interned string to create.
 ///
 /// @return the new created instance of @ref interned_string created.
 interned_string
 interned_string_pool::create_string(const std::string& str_value)
 {
-  string*& result = priv_->map[str_value];
-  if (!result && !str_value.empty())
-    result = new string(str_value);
+  if (str_value.empty())
+    return interned_string();
+
+  pool_key k(str_value);
+  priv::shard& s = priv_->get_shard(k);
+  std::lock_guard<std::mutex> guard(s.lock);
+
+  ++s.nb_lookups;
+  pool_map_type::const_iterator i = s.map.find(k);
+  if (i != s.map.end())
+    {
+      ++s.nb_hits;
+      return interned_string(i->second);
+    }
+
+  if (s.blocks.empty()
+      || s.nb_strings_in_last_block == string_pool_block_size)
+    {
+      s.blocks.push_back(std::unique_ptr<string[]>
+			 (new string[string_pool_block_size]));
+      s.nb_strings_in_last_block = 0;
+    }
+  string* result = &s.blocks.back()[s.nb_strings_in_last_block++];
+  *result = str_value;
+  s.nb_bytes += str_value.size() + 1;
+
+  // The key refers to the characters of the pooled string, which
+  // never move.
+  k.data = result->data();
+  s.map[k] = result;
   return interned_string(result);
 }
 
-/// Destructor.
-interned_string_pool::~interned_string_pool()
+/// Get the statistics about the content and the use of the pool.
+///
+/// @return the statistics of the pool.
+interned_string_pool::stats
+interned_string_pool::get_stats() const
 {
-  for (pool_map_type::iterator i = priv_->map.begin();
-       i != priv_->map.end();
-       ++i)
-    if (i->second)
-      delete i->second;
+  stats result;
+  for (const priv::shard& s : priv_->shards)
+    {
+      std::lock_guard<std::mutex> guard(s.lock);
+      result.nb_strings += s.map.size();
+      result.nb_bytes += s.nb_bytes;
+      result.nb_lookups += s.nb_lookups;
+      result.nb_hits += s.nb_hits;
+    }
+  return result;
 }
 
+/// Get the ratio of the calls to interned_string_pool::create_string
+/// that found the string already in the pool.
+///
+/// @return the hit rate, between 0 and 1, or 0 if there was no call
+/// to interned_string_pool::create_string.
+double
+interned_string_pool::stats::hit_rate() const
+{return nb_lookups ? static_cast<double>(nb_hits) / nb_lookups : 0;}
+
+/// Destructor.
+interned_string_pool::~interned_string_pool()
+{}
+
 /// Equality operator.
 ///
 /// @param l the instance of std::string on the left-hand-side of the
@@ -236,7 +396,7 @@ mark_dependant_types_compared_until(const type_base &r);
 /// type comparison, during type canonicalization.
 ///
 /// For more information on this, please look at the description of
-/// the environment::priv::right_type_comp_operands_ data member.
+/// the type_comparison_state::right_type_comp_operands_ data member.
 ///
 /// @param left the left-hand-side comparison operand to push.
 ///
@@ -253,7 +413,7 @@ push_composite_type_comparison_operands(const type_base& left,
 /// type comparison.
 ///
 /// For more information on this, please look at the description of
-/// the environment::privright_type_comp_operands_ data member.
+/// the type_comparison_state::right_type_comp_operands_ data member.
 ///
 /// @param left the left-hand-side comparison operand we expect to
 /// pop from the top of the stack.  If this doesn't match the
@@ -335,50 +495,6 @@ mark_dependant_types_compared_until(const type_base &r)
   return false;
 }
 
-/// @brief the location of a token represented in its simplest form.
-/// Instances of this type are to be stored in a sorted vector, so the
-/// type must have proper relational operators.
-class expanded_location
-{
-  string	path_;
-  unsigned	line_;
-  unsigned	column_;
-
-  expanded_location();
-
-public:
-
-  friend class location_manager;
-
-  expanded_location(const string& path, unsigned line, unsigned column)
-  : path_(path), line_(line), column_(column)
-  {}
-
-  bool
-  operator==(const expanded_location& l) const
-  {
-    return (path_ == l.path_
-	    && line_ == l.line_
-	    && column_ && l.column_);
-  }
-
-  bool
-  operator<(const expanded_location& l) const
-  {
-    if (path_ < l.path_)
-      return true;
-    else if (path_ > l.path_)
-      return false;
-
-    if (line_ < l.line_)
-      return true;
-    else if (line_ > l.line_)
-      return false;
-
-    return column_ < l.column_;
-  }
-};
-
 /// Expand the location into a tripplet path, line and column number.
 ///
 /// @param path the output parameter where this function sets the
@@ -421,17 +537,73 @@ location::expand(void) const
   return o.str();
 }
 
+/// The location of a token, as recorded by a @ref location_manager.
+///
+/// The path of the file of the token is designated by its index in
+/// the file table of the location manager, so that it's not stored
+/// once per token.
+struct packed_location
+{
+  uint32_t	file;
+  uint32_t	line;
+  uint32_t	column;
+
+  packed_location(uint32_t f, uint32_t l, uint32_t c)
+    : file(f), line(l), column(c)
+  {}
+}; // end struct packed_location
+
 struct location_manager::priv
 {
-  /// This sorted vector contains the expanded locations of the tokens
-  /// coming from a given ABI Corpus.  The index of a given expanded
-  /// location in the table gives us an integer that is used to build
-  /// instance of location types.
-  std::vector<expanded_location> locs;
+  const environment&	env;
+  /// The paths of the files of the tokens, interned in the
+  /// environment.  The index of a path in this table is its file ID.
+  vector<interned_string> files;
+  /// The file ID of each path of the file table.
+  unordered_map<interned_string, uint32_t, hash_interned_string> file_ids;
+  /// The file ID of the last location created.  Consecutive tokens
+  /// tend to come from the same file, so this often saves a lookup.
+  uint32_t		last_file;
+  /// This vector contains the locations of the tokens coming from a
+  /// given translation unit.  The index of a given location in the
+  /// table gives us an integer that is used to build instance of
+  /// location types.
+  std::vector<packed_location> locs;
+
+  priv(const environment& e)
+    : env(e), last_file()
+  {}
+
+  /// Get the ID of a file path in the file table, adding it to the
+  /// table if needed.
+  ///
+  /// @param path the path to consider.
+  ///
+  /// @return the file ID of @p path.
+  uint32_t
+  get_file_id(const string& path)
+  {
+    if (last_file < files.size() && files[last_file] == path)
+      return last_file;
+
+    interned_string p = env.intern(path);
+    auto i = file_ids.find(p);
+    if (i == file_ids.end())
+      {
+	i = file_ids.insert(std::make_pair(p, files.size())).first;
+	files.push_back(p);
+      }
+    last_file = i->second;
+    return last_file;
+  }
 };
 
-location_manager::location_manager()
-  : priv_(new location_manager::priv)
+/// Constructor of @ref location_manager.
+///
+/// @param env the environment the file paths of the locations are
+/// interned in.
+location_manager::location_manager(const environment& env)
+  : priv_(new location_manager::priv(env))
 {}
 
 location_manager::~location_manager() = default;
@@ -441,6 +613,9 @@ location_manager::~location_manager() = default;
 /// built from an integral type that represents the index of the
 /// source locus triplet into our source locus table.
 ///
+/// The file path is stored only once per translation unit, in a file
+/// table, and interned in the environment.
+///
 /// @param file_path the file path of the source locus
 /// @param line the line number of the source location
 /// @param col the column number of the source location
@@ -449,11 +624,10 @@ location_manager::create_new_location(const std::string&	file_path,
 				      size_t			line,
 				      size_t			col)
 {
-  expanded_location l(file_path, line, col);
-
-  // Just append the new expanded location to the end of the vector
-  // and return its index.  Note that indexes start at 1.
-  priv_->locs.push_back(l);
+  // Just append the new location to the end of the vector and return
+  // its index.  Note that indexes start at 1.
+  priv_->locs.push_back(packed_location(priv_->get_file_id(file_path),
+					line, col));
   return location(priv_->locs.size(), this);
 }
 
@@ -475,10 +649,24 @@ location_manager::expand_location(const location&	location,
 {
   if (location.value_ == 0)
     return;
-  expanded_location &l = priv_->locs[location.value_ - 1];
-  path = l.path_;
-  line = l.line_;
-  column = l.column_;
+  const packed_location &l = priv_->locs[location.value_ - 1];
+  path = priv_->files[l.file];
+  line = l.line;
+  column = l.column;
+}
+
+/// Record the memory used by the table of locations and the table of
+/// files of the location manager.
+///
+/// @param stats the memory statistics to record into.
+void
+location_manager::get_memory_stats(metrics::memory_stats& stats) const
+{
+  stats.record("ir.locations", priv_->locs.size(),
+	       metrics::estimate_memory_usage(priv_->locs));
+  stats.record("ir.location-files", priv_->files.size(),
+	       metrics::estimate_memory_usage(priv_->files)
+	       + metrics::estimate_hash_table_memory_usage(priv_->file_ids));
 }
 
 typedef unordered_map<function_type_sptr,
@@ -1022,6 +1210,7 @@ return_comparison_result(T& l, T& r, bool value,
   unmark_types_as_being_compared(l, r);
 
   const environment& env = l.get_environment();
+  type_comparison_state& comp_state = env.priv_->comparison_state();
   if (env.do_on_the_fly_canonicalization())
     // We are instructed to perform the "canonical type propagation"
     // optimization, making 'r' to possibly get the canonical type of
@@ -1034,14 +1223,14 @@ return_comparison_result(T& l, T& r, bool value,
 	      || env.priv_->is_recursive_type(&r))
 	  && is_type(&r)->priv_->canonical_type_propagated()
 	  && !is_type(&r)->priv_->propagated_canonical_type_confirmed()
-	  && !env.priv_->right_type_comp_operands_.empty())
+	  && !comp_state.right_type_comp_operands_.empty())
 	{
 	  // Track the object 'r' for which the propagated canonical
 	  // type might be re-initialized if the current comparison
 	  // eventually fails.
 	  env.priv_->add_to_types_with_non_confirmed_propagated_ct(is_type(&r));
 	}
-      else if (value == true && env.priv_->right_type_comp_operands_.empty())
+      else if (value == true && comp_state.right_type_comp_operands_.empty())
 	{
 	  // The type provided in the 'r' argument is the type that is
 	  // being canonicalized; 'r' is not a mere subtype being
@@ -1075,8 +1264,8 @@ return_comparison_result(T& l, T& r, bool value,
   // propagation can now see their tentative canonical type be
   // confirmed for real.
   if (value == true
-      && env.priv_->right_type_comp_operands_.empty()
-      && !env.priv_->types_with_non_confirmed_propagated_ct_.empty())
+      && comp_state.right_type_comp_operands_.empty()
+      && !comp_state.types_with_non_confirmed_propagated_ct_.empty())
     // So the comparison is completely done and there are some
     // types for which their propagated canonical type is sitll
     // considered not confirmed.  As the comparison did yield true, we
@@ -1084,9 +1273,9 @@ return_comparison_result(T& l, T& r, bool value,
     env.priv_->confirm_ct_propagation();
 
 #ifdef WITH_DEBUG_SELF_COMPARISON
-  if (value == false && env.priv_->right_type_comp_operands_.empty())
+  if (value == false && comp_state.right_type_comp_operands_.empty())
     {
-      for (const auto i : env.priv_->types_with_non_confirmed_propagated_ct_)
+      for (const auto i : comp_state.types_with_non_confirmed_propagated_ct_)
 	{
 	  type_base *t = reinterpret_cast<type_base*>(i);
 	  env.priv_->check_abixml_canonical_type_propagation_during_self_comp(t);
@@ -1325,6 +1514,27 @@ translation_unit::get_absolute_path() const
   return priv_->abs_path_;
 }
 
+/// Get the hash of the content of the translation unit, as found in
+/// the binary it was read from.
+///
+/// Front-ends set this hash when asked to, so that a later reading
+/// of a new version of the binary can tell if the translation unit
+/// changed.  See fe_iface::options_type::hash_translation_units.
+///
+/// @return the hash of the content of the translation unit, or an
+/// empty string if it's unknown.
+const std::string&
+translation_unit::get_content_hash() const
+{return priv_->content_hash_;}
+
+/// Set the hash of the content of the translation unit, as found in
+/// the binary it was read from.
+///
+/// @param h the new hash.
+void
+translation_unit::set_content_hash(const std::string& h)
+{priv_->content_hash_ = h;}
+
 /// Set the corpus this translation unit is a member of.
 ///
 /// Note that adding a translation unit to a @ref corpus automatically
@@ -3172,6 +3382,335 @@ dm_context_rel::~dm_context_rel()
 {}
 // </class dm_context_rel stuff>
 
+// <node_arena stuff>
+
+/// An arena from which the IR nodes of an @ref environment, and their
+/// private data, are allocated when the environment uses arena
+/// allocation.
+///
+/// The memory of the arena is reserved from the system by chunks of
+/// chunk_size bytes, out of which blocks are carved by bumping a
+/// pointer.  A released block is put on the free list of its size
+/// class, to be re-used by the next allocation of that size class.
+/// The chunks are only given back to the system, all at once, when
+/// the arena is destroyed.
+///
+/// The arena is destroyed with the environment that owns it if none
+/// of its blocks is in use anymore.  Otherwise, it's orphaned, and
+/// destroyed when its last block in use is released.
+///
+/// The arena a block belongs to is found from the address of its
+/// chunk, in a two-level map of the chunks of all the arenas, like
+/// the page map of a memory allocator.  The map is read without
+/// locking, so releasing a block only takes the lock of its arena.
+///
+/// Blocks larger than max_block_size bytes are not allocated from
+/// the arena but from the heap.
+class node_arena
+{
+public:
+  static const unsigned chunk_bits = 20;
+  static const size_t chunk_size = size_t(1) << chunk_bits;
+  static const size_t granularity = 16;
+  static const size_t max_block_size = 512;
+  static const size_t nb_size_classes = max_block_size / granularity;
+
+private:
+  std::mutex	lock_;
+  vector<char*>	chunks_;
+  char*		cur_;
+  char*		end_;
+  void*		free_lists_[nb_size_classes];
+  size_t	nb_live_blocks_;
+  bool		orphaned_;
+
+  // The number of arenas in existence.  While it's zero, there is no
+  // need to look the released blocks up in the map of chunks.
+  static std::atomic<size_t> nb_arenas_;
+
+  // The number of bits of the addresses of the chunks that can be
+  // put in the map of chunks.  Chunks at higher addresses are not
+  // used.
+  static const unsigned address_bits = 48;
+  // The number of bits of a chunk index that select an entry in a
+  // leaf of the map of chunks.
+  static const unsigned leaf_bits = 14;
+  static const size_t nb_leaves =
+    size_t(1) << (address_bits - chunk_bits - leaf_bits);
+
+  // A leaf of the map of chunks.  Its entries are the arenas of the
+  // chunks of 1 << (chunk_bits + leaf_bits) bytes of the address
+  // space.
+  struct chunk_map_leaf
+  {
+    std::atomic<node_arena*> entries[size_t(1) << leaf_bits];
+  };
+
+  // The root of the map of chunks.  Its leaves are allocated the
+  // first time a chunk they cover is added, and never freed.
+  static std::atomic<chunk_map_leaf*> chunk_map_[nb_leaves];
+
+  /// Getter of the mutex that serializes the allocation of the leaves
+  /// of the map of chunks.
+  ///
+  /// @return the mutex of the map of chunks.
+  static std::mutex&
+  chunk_map_lock()
+  {
+    static std::mutex lock;
+    return lock;
+  }
+
+  /// Get the entry of the map of chunks for a given address.
+  ///
+  /// @param p the address to consider.
+  ///
+  /// @param create if true, the leaf of the entry is created if it
+  /// doesn't exist yet.
+  ///
+  /// @return the entry of the chunk of @p p, or nil if @p p is not
+  /// covered by the map or if its leaf doesn't exist.
+  static std::atomic<node_arena*>*
+  chunk_map_entry(const void* p, bool create)
+  {
+    uintptr_t a = reinterpret_cast<uintptr_t>(p);
+    if (a >> address_bits)
+      return nullptr;
+    uintptr_t chunk = a >> chunk_bits;
+    std::atomic<chunk_map_leaf*>& root = chunk_map_[chunk >> leaf_bits];
+    chunk_map_leaf* leaf = root.load(std::memory_order_acquire);
+    if (!leaf && create)
+      {
+	std::lock_guard<std::mutex> l(chunk_map_lock());
+	leaf = root.load(std::memory_order_relaxed);
+	if (!leaf)
+	  {
+	    leaf = new chunk_map_leaf();
+	    root.store(leaf, std::memory_order_release);
+	  }
+      }
+    if (!leaf)
+      return nullptr;
+    return &leaf->entries[chunk & ((size_t(1) << leaf_bits) - 1)];
+  }
+
+  /// Look up the arena a block belongs to.
+  ///
+  /// As the chunks are aligned on chunk_size, the chunk of a block is
+  /// found by masking its address.
+  ///
+  /// @param p the block to consider.
+  ///
+  /// @return the arena @p p was allocated from, or nil if @p p was
+  /// allocated from the heap.
+  static node_arena*
+  lookup(void* p)
+  {
+    std::atomic<node_arena*>* e = chunk_map_entry(p, /*create=*/false);
+    return e ? e->load(std::memory_order_acquire) : nullptr;
+  }
+
+  /// Reserve a new chunk and make it the current one.
+  ///
+  /// @return true iff a chunk could be added to the arena.
+  bool
+  add_chunk()
+  {
+    void* c = nullptr;
+    if (posix_memalign(&c, chunk_size, chunk_size))
+      throw std::bad_alloc();
+    std::atomic<node_arena*>* e = chunk_map_entry(c, /*create=*/true);
+    if (!e)
+      {
+	free(c);
+	return false;
+      }
+    e->store(this, std::memory_order_release);
+    chunks_.push_back(static_cast<char*>(c));
+    cur_ = static_cast<char*>(c);
+    end_ = cur_ + chunk_size;
+    return true;
+  }
+
+  ~node_arena()
+  {
+    for (char* c : chunks_)
+      {
+	chunk_map_entry(c, /*create=*/false)->store(nullptr,
+						    std::memory_order_release);
+	free(c);
+      }
+    --nb_arenas_;
+  }
+
+public:
+
+  node_arena()
+    : cur_(), end_(), free_lists_(), nb_live_blocks_(), orphaned_()
+  {++nb_arenas_;}
+
+  /// Allocate a block from the arena.
+  ///
+  /// @param size the size of the block.  It must not be greater than
+  /// max_block_size.
+  ///
+  /// @return the new block, or nil if no chunk could be added to the
+  /// arena.
+  void*
+  allocate(size_t size)
+  {
+    size_t size_class = (size + granularity - 1) / granularity - 1;
+    size = (size_class + 1) * granularity;
+
+    std::lock_guard<std::mutex> l(lock_);
+    void* b = free_lists_[size_class];
+    if (b)
+      free_lists_[size_class] = *static_cast<void**>(b);
+    else
+      {
+	if (static_cast<size_t>(end_ - cur_) < size && !add_chunk())
+	  return nullptr;
+	b = cur_;
+	cur_ += size;
+      }
+    ++nb_live_blocks_;
+    return b;
+  }
+
+  /// Getter of the number of bytes reserved by the arena.
+  ///
+  /// @return the number of bytes of the chunks of the arena.
+  size_t
+  get_reserved_bytes()
+  {
+    std::lock_guard<std::mutex> l(lock_);
+    return chunks_.size() * chunk_size;
+  }
+
+  /// Getter of the number of blocks of the arena in use.
+  ///
+  /// @return the number of blocks in use.
+  size_t
+  get_nb_live_blocks()
+  {
+    std::lock_guard<std::mutex> l(lock_);
+    return nb_live_blocks_;
+  }
+
+  /// Release the arena on behalf of the environment that owns it.
+  ///
+  /// The arena is destroyed if none of its blocks is in use.
+  /// Otherwise, it's destroyed when its last block in use is
+  /// released.
+  void
+  release()
+  {
+    bool destroy = false;
+    {
+      std::lock_guard<std::mutex> l(lock_);
+      orphaned_ = true;
+      destroy = !nb_live_blocks_;
+    }
+    if (destroy)
+      delete this;
+  }
+
+  /// Allocate a block from the arena of the current @ref
+  /// arena_allocation_scope, or from the heap if there is no such
+  /// arena or if the block is too big.
+  ///
+  /// @param size the size of the block.
+  ///
+  /// @return the new block.
+  static void*
+  allocate_block(size_t size);
+
+  /// Release a block allocated by allocate_block.
+  ///
+  /// @param p the block to release.
+  ///
+  /// @param size the size that was given to allocate_block.
+  static void
+  release_block(void* p, size_t size)
+  {
+    if (nb_arenas_ && size <= max_block_size)
+      if (node_arena* a = lookup(p))
+	{
+	  size_t size_class = (size + granularity - 1) / granularity - 1;
+	  bool destroy = false;
+	  {
+	    std::lock_guard<std::mutex> l(a->lock_);
+	    *static_cast<void**>(p) = a->free_lists_[size_class];
+	    a->free_lists_[size_class] = p;
+	    --a->nb_live_blocks_;
+	    destroy = a->orphaned_ && !a->nb_live_blocks_;
+	  }
+	  if (destroy)
+	    delete a;
+	  return;
+	}
+    ::operator delete(p);
+  }
+}; // end class node_arena
+
+std::atomic<size_t> node_arena::nb_arenas_(0);
+
+std::atomic<node_arena::chunk_map_leaf*>
+node_arena::chunk_map_[node_arena::nb_leaves];
+
+/// The arena of the innermost @ref arena_allocation_scope of the
+/// current thread, if any.
+static thread_local node_arena* current_node_arena;
+
+void*
+node_arena::allocate_block(size_t size)
+{
+  if (current_node_arena && size <= max_block_size)
+    if (void* b = current_node_arena->allocate(size))
+      return b;
+  return ::operator new(size);
+}
+
+/// Allocate an instance of a type deriving from @ref
+/// arena_allocated.
+///
+/// @param size the size of the instance.
+///
+/// @return the memory of the instance.
+void*
+arena_allocated::operator new(size_t size)
+{return node_arena::allocate_block(size);}
+
+/// De-allocate an instance of a type deriving from @ref
+/// arena_allocated.
+///
+/// @param p the memory of the instance.
+///
+/// @param size the size of the instance.
+void
+arena_allocated::operator delete(void* p, size_t size)
+{node_arena::release_block(p, size);}
+
+/// Constructor of @ref arena_allocation_scope.
+///
+/// @param env the environment which arena to allocate IR nodes
+/// from, if it uses arena allocation.
+arena_allocation_scope::arena_allocation_scope(const environment& env)
+  : previous_(current_node_arena)
+{
+  current_node_arena =
+    env.priv_->use_arena_allocation_ ? env.priv_->node_arena_ : nullptr;
+}
+
+/// Destructor of @ref arena_allocation_scope.
+///
+/// The arena of the enclosing scope, if any, becomes the current
+/// arena again.
+arena_allocation_scope::~arena_allocation_scope()
+{current_node_arena = previous_;}
+
+// </node_arena stuff>
+
 // <environment stuff>
 
 /// Convenience typedef for a map of interned_string -> bool.
@@ -3179,14 +3718,112 @@ typedef unordered_map<interned_string,
 		      bool, hash_interned_string> interned_string_bool_map_type;
 
 
+/// Getter of the lock guarding the set of live environments.
+///
+/// @return the lock guarding the set of live environments.
+static std::mutex&
+live_environments_lock()
+{
+  // This is never destroyed, so that environments that are destroyed
+  // late during the termination of the process can still use it.
+  static std::mutex* lock = new std::mutex;
+  return *lock;
+}
+
+/// Getter of the set of live environments, keyed by their serial.
+///
+/// The threads that exit look up there the environments in which
+/// they have a type comparison state, to erase it.
+///
+/// @return the set of live environments.
+static unordered_map<uint64_t, const environment::priv*>&
+live_environments()
+{
+  static unordered_map<uint64_t, const environment::priv*>* envs =
+    new unordered_map<uint64_t, const environment::priv*>;
+  return *envs;
+}
+
+/// The serials of the environments in which the current thread got
+/// a type comparison state of its own.
+///
+/// When the thread exits, its states are erased from the
+/// environments that are still alive.
+struct thread_comparison_states
+{
+  vector<uint64_t> serials;
+
+  ~thread_comparison_states()
+  {
+    std::thread::id id = std::this_thread::get_id();
+    std::lock_guard<std::mutex> lock(live_environments_lock());
+    for (uint64_t serial : serials)
+      {
+	auto i = live_environments().find(serial);
+	if (i != live_environments().end())
+	  i->second->forget_comparison_state_of_thread(id);
+      }
+  }
+};
+
+/// Getter of the state of the type comparisons performed by the
+/// current thread, in the current environment.
+///
+/// The thread that created the environment uses a state that is
+/// embedded in the environment.  Other threads get their own state,
+/// created the first time they compare types of this environment,
+/// and erased when they exit.
+///
+/// This is the slow path of environment::priv::comparison_state.
+///
+/// @return the type comparison state of the current thread.
+type_comparison_state&
+environment::priv::get_comparison_state_of_current_thread() const
+{
+  std::thread::id id = std::this_thread::get_id();
+  if (id == main_thread_id_)
+    return const_cast<type_comparison_state&>(main_comparison_state_);
+
+  std::lock_guard<std::mutex> lock(comparison_states_lock_);
+  std::unique_ptr<type_comparison_state>& state = comparison_states_[id];
+  if (!state)
+    {
+      thread_local thread_comparison_states states_of_thread;
+      state.reset(new type_comparison_state);
+      states_of_thread.serials.push_back(serial_);
+    }
+  return *state;
+}
+
+/// Erase the type comparison state of a given thread.
+///
+/// @param id the identifier of the thread to consider.
+void
+environment::priv::forget_comparison_state_of_thread(std::thread::id id) const
+{
+  std::lock_guard<std::mutex> lock(comparison_states_lock_);
+  comparison_states_.erase(id);
+}
+
 /// Default constructor of the @ref environment type.
 environment::environment()
   :priv_(new priv)
-{}
+{
+  std::lock_guard<std::mutex> lock(live_environments_lock());
+  live_environments()[priv_->serial_] = priv_.get();
+}
 
 /// Destructor for the @ref environment type.
 environment::~environment()
-{}
+{
+  {
+    std::lock_guard<std::mutex> lock(live_environments_lock());
+    live_environments().erase(priv_->serial_);
+  }
+
+  if (priv_->node_arena_)
+    priv_->node_arena_->release();
+}
 
 /// Getter the map of canonical types.
 ///
@@ -3522,10 +4159,12 @@ sort_types(const canonical_type_sptr_set_type& types,
 const type_base_sptr&
 environment::get_void_type() const
 {
-  if (!priv_->void_type_)
-    priv_->void_type_.reset(new type_decl(*this,
-					  intern("void"),
-					  0, 0, location()));
+  std::call_once(priv_->void_type_once_, [this]()
+    {
+      priv_->void_type_.reset(new type_decl(*this,
+					    intern("void"),
+					    0, 0, location()));
+    });
   return priv_->void_type_;
 }
 
@@ -3537,10 +4176,12 @@ environment::get_void_type() const
 const type_base_sptr&
 environment::get_variadic_parameter_type() const
 {
-  if (!priv_->variadic_marker_type_)
-    priv_->variadic_marker_type_.
-      reset(new type_decl(*this, intern(get_variadic_parameter_type_name()),
-			  0, 0, location()));
+  std::call_once(priv_->variadic_marker_type_once_, [this]()
+    {
+      priv_->variadic_marker_type_.
+	reset(new type_decl(*this, intern(get_variadic_parameter_type_name()),
+			    0, 0, location()));
+    });
   return priv_->variadic_marker_type_;
 }
 
@@ -3561,7 +4202,11 @@ environment::get_variadic_parameter_type_name()
 /// environment is done.
 bool
 environment::canonicalization_is_done() const
-{return priv_->canonicalization_is_done_;}
+{
+  const abg_compat::optional<bool>& f =
+    priv_->comparison_state().canonicalization_is_done_;
+  return f.has_value() ? *f : priv_->canonicalization_is_done_;
+}
 
 /// Set a flag saying if the canonicalization of types created out of
 /// the current environment is done or not.
@@ -3572,10 +4217,20 @@ environment::canonicalization_is_done() const
 /// types out of it) and thus needs to canonicalize types to speed-up
 /// further type comparison.
 ///
+/// If the current thread is the one that created the environment,
+/// this sets the value of the flag for the environment.  Otherwise,
+/// this sets the value of the flag for the current thread only, so
+/// that several threads can read binaries into the same environment.
+///
 /// @param f the new value of the flag.
 void
 environment::canonicalization_is_done(bool f)
-{priv_->canonicalization_is_done_ = f;}
+{
+  if (priv_->current_thread_created_environment())
+    priv_->canonicalization_is_done_ = f;
+  else
+    priv_->comparison_state().canonicalization_is_done_ = f;
+}
 
 /// Getter for the "on-the-fly-canonicalization" flag.
 ///
@@ -3584,16 +4239,28 @@ environment::canonicalization_is_done(bool f)
 /// comparison.
 bool
 environment::do_on_the_fly_canonicalization() const
-{return priv_->do_on_the_fly_canonicalization_;}
+{
+  const abg_compat::optional<bool>& f =
+    priv_->comparison_state().do_on_the_fly_canonicalization_;
+  return f.has_value() ? *f : priv_->do_on_the_fly_canonicalization_;
+}
 
 /// Setter for the "on-the-fly-canonicalization" flag.
 ///
+/// Like for @ref canonicalization_is_done, the flag is set for the
+/// current thread only, unless that thread created the environment.
+///
 /// @param f If this is true then @ref OnTheFlyCanonicalization
 /// "on-the-fly-canonicalization" is to be performed during
 /// comparison.
 void
 environment::do_on_the_fly_canonicalization(bool f)
-{priv_->do_on_the_fly_canonicalization_ = f;}
+{
+  if (priv_->current_thread_created_environment())
+    priv_->do_on_the_fly_canonicalization_ = f;
+  else
+    priv_->comparison_state().do_on_the_fly_canonicalization_ = f;
+}
 
 /// Getter of the "decl-only-class-equals-definition" flag.
 ///
@@ -3617,7 +4284,11 @@ environment::do_on_the_fly_canonicalization(bool f)
 /// @return the value of the "decl-only-class-equals-definition" flag.
 bool
 environment::decl_only_class_equals_definition() const
-{return priv_->decl_only_class_equals_definition_;}
+{
+  const abg_compat::optional<bool>& f =
+    priv_->comparison_state().decl_only_class_equals_definition_;
+  return f.has_value() ? *f : priv_->decl_only_class_equals_definition_;
+}
 
 /// Setter of the "decl-only-class-equals-definition" flag.
 ///
@@ -3638,11 +4309,39 @@ environment::decl_only_class_equals_definition() const
 /// set to false, then the decalration is considered different from
 /// the declaration.
 ///
+/// Like for @ref canonicalization_is_done, the flag is set for the
+/// current thread only, unless that thread created the environment.
+///
 /// @param the new value of the "decl-only-class-equals-definition"
 /// flag.
 void
 environment::decl_only_class_equals_definition(bool f) const
-{priv_->decl_only_class_equals_definition_ = f;}
+{
+  if (priv_->current_thread_created_environment())
+    priv_->decl_only_class_equals_definition_ = f;
+  else
+    priv_->comparison_state().decl_only_class_equals_definition_ = f;
+}
+
+/// Getter of the lock that is held while types are canonicalized.
+///
+/// Several threads can read binaries into the same environment at
+/// once: the types of each binary are then canonicalized in turn,
+/// under this lock, against the canonical types of all the binaries
+/// read so far.  Holding the lock thus keeps other threads from
+/// canonicalizing types of the environment.
+///
+/// Canonicalizing a type can update its canonical type, which might
+/// come from another binary.  So the corpora of a shared environment
+/// should only be compared once no thread reads binaries into it
+/// anymore.  These corpora must also stay alive as long as the
+/// environment is used, as their types might be the canonical types
+/// of the types of other binaries.
+///
+/// @return the lock held while types are canonicalized.
+std::recursive_mutex&
+environment::get_canonicalization_lock() const
+{return priv_->canonicalization_lock_;}
 
 /// Test if a given type is a void type as defined in the current
 /// environment.
@@ -3709,6 +4408,9 @@ environment::is_variadic_parameter_type(const type_base_sptr& t) const
 /// pool and a new interned_string instance is created to point to
 /// that new intrerned string, and it's return.
 ///
+/// Unlike most of the other member functions of the environment,
+/// this can be called concurrently from several threads.
+///
 /// @param s the value of the string to intern.
 ///
 /// @return the interned string.
@@ -3759,6 +4461,93 @@ bool
 environment::analyze_exported_interfaces_only() const
 {return priv_->analyze_exported_interfaces_only_.value_or(false);}
 
+/// Getter of the registry of performance metrics of the environment.
+///
+/// The readers, the type canonicalizer, the comparison engine and the
+/// reporters working in this environment record their metrics into
+/// this registry, if it's enabled.
+///
+/// @return the registry of performance metrics.
+metrics::registry&
+environment::get_metrics() const
+{return priv_->metrics_;}
+
+/// Getter of the statistics about the pool of the strings interned by
+/// the environment.
+///
+/// See environment::intern.
+///
+/// @return the statistics of the interned string pool.
+interned_string_pool::stats
+environment::get_interned_string_pool_stats() const
+{return priv_->string_pool_.get_stats();}
+
+/// Setter of the flag that says if the IR nodes built by the readers
+/// in this environment are allocated from an arena owned by the
+/// environment.
+///
+/// Allocating the IR nodes (and their private data) from an arena
+/// makes their allocation cheaper, and lets their memory be given
+/// back to the system at once when the environment is destroyed.
+///
+/// Only the IR nodes built after this flag is set are allocated from
+/// the arena.
+///
+/// @param f the new value of the flag.
+void
+environment::use_arena_allocation(bool f)
+{
+  if (f && !priv_->node_arena_)
+    priv_->node_arena_ = new node_arena;
+  priv_->use_arena_allocation_ = f;
+}
+
+/// Getter of the flag that says if the IR nodes built by the readers
+/// in this environment are allocated from an arena owned by the
+/// environment.
+///
+/// @return the value of the flag.
+bool
+environment::use_arena_allocation() const
+{return priv_->use_arena_allocation_;}
+
+/// Record the memory used by the interned strings, by the map of
+/// canonical types and by the arena of the IR nodes of the
+/// environment.
+///
+/// The memory used by the canonical types themselves is recorded by
+/// corpus::get_memory_stats.
+///
+/// @param stats the memory statistics to record into.
+void
+environment::get_memory_stats(metrics::memory_stats& stats) const
+{
+  // Each interned string is made of its characters, of a
+  // std::string in the arena of the pool, and of a node of the map of
+  // the pool.
+  interned_string_pool::stats s = get_interned_string_pool_stats();
+  stats.record("env.interned-strings", s.nb_strings,
+	       s.nb_bytes
+	       + s.nb_strings * (sizeof(string) + sizeof(pool_key)
+				 + 3 * sizeof(void*)));
+
+  uint64_t nb_types = 0;
+  uint64_t nb_bytes =
+    metrics::estimate_hash_table_memory_usage(priv_->canonical_types_)
+    + metrics::estimate_memory_usage(priv_->sorted_canonical_types_);
+  for (const auto& entry : priv_->canonical_types_)
+    {
+      nb_types += entry.second.size();
+      nb_bytes += metrics::estimate_memory_usage(entry.second);
+    }
+  stats.record("env.canonical-types-map", nb_types, nb_bytes);
+
+  if (priv_->node_arena_)
+    stats.record("env.node-arena",
+		 priv_->node_arena_->get_nb_live_blocks(),
+		 priv_->node_arena_->get_reserved_bytes());
+}
+
 #ifdef WITH_DEBUG_SELF_COMPARISON
 /// Setter of the corpus of the input corpus of the self comparison
 /// that takes place when doing "abidw --debug-abidiff <binary>".
@@ -3869,7 +4658,7 @@ environment::debug_die_canonicalization_is_on() const
 vector<type_base_sptr>*
 environment::get_canonical_types(const char* name)
 {
-  auto ti = get_canonical_types_map().find(name);
+  auto ti = get_canonical_types_map().find(hashing::fnv_hash64(name));
   if (ti == get_canonical_types_map().end())
     return nullptr;
   return &ti->second;
@@ -4021,7 +4810,7 @@ environment::get_canonical_type_from_type_id(const char* type_id) const
 // <type_or_decl_base stuff>
 
 /// The private data of @ref type_or_decl_base.
-struct type_or_decl_base::priv
+struct type_or_decl_base::priv : public arena_allocated
 {
   // This holds the kind of dynamic type of particular instance.
   // Yes, this is part of the implementation of a "poor man" runtime
@@ -4134,6 +4923,28 @@ type_or_decl_base::type_or_decl_base(const environment& e,
 type_or_decl_base::~type_or_decl_base()
 {}
 
+/// Allocate an IR node.
+///
+/// The IR node is allocated from the arena of the current @ref
+/// arena_allocation_scope, if there is one.  Otherwise, it's
+/// allocated from the heap.
+///
+/// @param size the size of the IR node.
+///
+/// @return the memory of the IR node.
+void*
+type_or_decl_base::operator new(size_t size)
+{return node_arena::allocate_block(size);}
+
+/// De-allocate an IR node.
+///
+/// @param p the memory of the IR node.
+///
+/// @param size the size of the IR node.
+void
+type_or_decl_base::operator delete(void* p, size_t size)
+{node_arena::release_block(p, size);}
+
 /// Getter of the flag that says if the artefact is artificial.
 ///
 /// Being artificial means it was not explicitely mentionned in the
@@ -4424,7 +5235,7 @@ operator!=(const type_or_decl_base_sptr& l, const type_or_decl_base_sptr& r)
 
 // <Decl definition>
 
-struct decl_base::priv
+struct decl_base::priv : public arena_allocated
 {
   bool			in_pub_sym_tab_;
   bool			is_anonymous_;
@@ -7674,7 +8485,7 @@ size_t
 canonical_type_hash::operator()(const type_base *l) const
 {return reinterpret_cast<size_t>(l);}
 
-struct scope_decl::priv
+struct scope_decl::priv : public arena_allocated
 {
   declarations members_;
   declarations sorted_members_;
@@ -9777,9 +10588,9 @@ print_comp_stack(const environment& env)
 {
   std::ostringstream o;
   o << "left-operands: ";
-  debug_comp_vec(env.priv_->left_type_comp_operands_, o);
+  debug_comp_vec(env.priv_->comparison_state().left_type_comp_operands_, o);
   o << "\n" << "right-operands: ";
-  debug_comp_vec(env.priv_->right_type_comp_operands_, o);
+  debug_comp_vec(env.priv_->comparison_state().right_type_comp_operands_, o);
   o << "\n";
   return o.str();
 }
@@ -14028,6 +14839,94 @@ maybe_update_types_lookup_map(const type_base_sptr& type)
     ABG_ASSERT_NOT_REACHED;
 }
 
+/// Add the types of a map of a translation unit to the corresponding
+/// maps of a corpus.
+///
+/// @param types the map of the translation unit.
+///
+/// @param types_map the map of the corpus that associates the name
+/// of a type with the type.
+///
+/// @param types_per_loc_map the map of the corpus that associates the
+/// location of a type with the type, or nil if there is no such map
+/// for the kind of the types considered.
+template<typename TypeKind>
+static void
+add_types_to_lookup_maps(const istring_type_base_wptrs_map_type& types,
+			 istring_type_base_wptrs_map_type& types_map,
+			 istring_type_base_wptrs_map_type* types_per_loc_map)
+{
+  for (const auto& entry : types)
+    for (const type_base_wptr& t : entry.second)
+      if (shared_ptr<TypeKind> type = dynamic_pointer_cast<TypeKind>(t.lock()))
+	{
+	  maybe_update_types_lookup_map<TypeKind>(type, types_map);
+	  if (types_per_loc_map)
+	    maybe_update_types_lookup_map<TypeKind>(type, *types_per_loc_map,
+						    /*use_type_name_as_key*/
+						    false);
+	}
+}
+
+/// Add the types of a translation unit to the type lookup maps of its
+/// corpus, and of the group of that corpus, if any.
+///
+/// The maps of a corpus are updated as types are added to the scopes
+/// of its translation units.  So this is needed only for a
+/// translation unit that was built as part of a corpus and then added
+/// to another one.
+///
+/// @param tu the translation unit to consider.
+void
+add_types_to_corpus_lookup_maps(translation_unit& tu)
+{
+  corpus* corp = tu.get_corpus();
+  if (!corp)
+    return;
+
+  const type_maps& types = tu.get_types();
+  for (corpus* c : {corp, static_cast<corpus*>(corp->get_group())})
+    {
+      if (!c)
+	continue;
+
+      type_maps& m = c->priv_->get_types();
+      type_maps& l = c->get_type_per_loc_map();
+      add_types_to_lookup_maps<type_decl>(types.basic_types(),
+					  m.basic_types(),
+					  &l.basic_types());
+      add_types_to_lookup_maps<class_decl>(types.class_types(),
+					   m.class_types(),
+					   &l.class_types());
+      add_types_to_lookup_maps<union_decl>(types.union_types(),
+					   m.union_types(),
+					   &l.union_types());
+      add_types_to_lookup_maps<enum_type_decl>(types.enum_types(),
+					       m.enum_types(),
+					       &l.enum_types());
+      add_types_to_lookup_maps<typedef_decl>(types.typedef_types(),
+					     m.typedef_types(),
+					     &l.typedef_types());
+      add_types_to_lookup_maps<qualified_type_def>(types.qualified_types(),
+						   m.qualified_types(),
+						   nullptr);
+      add_types_to_lookup_maps<pointer_type_def>(types.pointer_types(),
+						 m.pointer_types(),
+						 nullptr);
+      add_types_to_lookup_maps<reference_type_def>(types.reference_types(),
+						   m.reference_types(),
+						   nullptr);
+      add_types_to_lookup_maps<array_type_def>(types.array_types(),
+					       m.array_types(),
+					       &l.array_types());
+      add_types_to_lookup_maps<array_type_def::subrange_type>
+	(types.subrange_types(), m.subrange_types(), &l.subrange_types());
+      add_types_to_lookup_maps<function_type>(types.function_types(),
+					      m.function_types(),
+					      nullptr);
+    }
+}
+
 //--------------------------------
 // </type and decls lookup stuff>
 // ------------------------------
@@ -14606,8 +15505,9 @@ type_base::get_canonical_type_for(type_base_sptr t)
 	     || !class_or_union->get_is_anonymous()
 	     || class_or_union->get_linkage_name().empty());
 
-  // We want the pretty representation of the type, but for an
-  // internal use, not for a user-facing purpose.
+  // We want the key of the type, which is the hash of its pretty
+  // representation for an internal use, not for a user-facing
+  // purpose.
   //
   // If two classe types Foo are declared, one as a class and the
   // other as a struct, but are otherwise equivalent, we want their
@@ -14616,7 +15516,10 @@ type_base::get_canonical_type_for(type_base_sptr t)
   // So in this case, the pretty representation of Foo is going to be
   // "class Foo", regardless of its struct-ness. This also applies to
   // composite types which would have "class Foo" as a sub-type.
-  string repr = t->get_cached_pretty_representation(/*internal=*/true);
+  //
+  // Note that computing the key doesn't require building (nor
+  // interning) the pretty representation string for most types.
+  uint64_t key = t->get_canonical_type_key();
 
   // If 't' already has a canonical type 'inside' its corpus
   // (t_corpus), then this variable is going to contain that canonical
@@ -14626,12 +15529,12 @@ type_base::get_canonical_type_for(type_base_sptr t)
     env.get_canonical_types_map();
 
   type_base_sptr result;
-  environment::canonical_types_map_type::iterator i = types.find(repr);
+  environment::canonical_types_map_type::iterator i = types.find(key);
   if (i == types.end())
     {
       vector<type_base_sptr> v;
       v.push_back(t);
-      types[repr] = v;
+      types[key] = v;
       result = t;
     }
   else
@@ -14686,7 +15589,7 @@ type_base::get_canonical_type_for(type_base_sptr t)
 			should_have_canonical_type =
 			  env.get_canonical_type_from_type_id(type_id.c_str());
 		      std::cerr << "error: wrong canonical type for '"
-				<< repr
+				<< t->get_cached_pretty_representation(true)
 				<< "' / type: @"
 				<< std::hex
 				<< t.get()
@@ -14723,7 +15626,7 @@ type_base::get_canonical_type_for(type_base_sptr t)
 		  // ones, because the later might well just be
 		  // consequences of the former.
 		  std::cerr << "error: wrong induced canonical type for '"
-			    << repr
+			    << t->get_cached_pretty_representation(true)
 			    << "' from second corpus"
 			    << ", ptr: " << std::hex << t.get()
 			    << " type-id: " << type_id
@@ -14844,9 +15747,18 @@ canonicalize(type_base_sptr t)
   if (t->get_canonical_type())
     return t->get_canonical_type();
 
+  // The candidate canonical types might come from binaries that
+  // other threads read into the same environment.
+  std::lock_guard<std::recursive_mutex>
+    guard(t->get_environment().priv_->canonicalization_lock_);
   type_base_sptr canonical = type_base::get_canonical_type_for(t);
   maybe_adjust_canonical_type(canonical, t);
 
+  environment::priv& env_priv = *t->get_environment().priv_;
+  env_priv.types_canonicalized_.increment();
+  if (canonical == t)
+    env_priv.canonical_types_created_.increment();
+
   t->priv_->canonical_type = canonical;
   t->priv_->naked_canonical_type = canonical.get();
 
@@ -15005,6 +15917,70 @@ type_base::get_cached_pretty_representation(bool internal) const
   return priv_->cached_repr_;
 }
 
+/// Get the key of the current type in the map of canonical types of
+/// the environment.
+///
+/// That key is the hash value of the internal pretty representation
+/// of the type, as returned by
+/// get_cached_pretty_representation(/*internal=*/true).  Two types
+/// that have the same internal pretty representation thus have the
+/// same key.
+///
+/// For the most common types (non-anonymous classes, unions and
+/// enums, typedefs, pointers and qualified types) the pretty
+/// representation is a prefix followed by the qualified name of the
+/// type.  For those, the key is computed from the (already interned)
+/// qualified name without building the pretty representation string.
+/// For the other types, the pretty representation is built but not
+/// interned.
+///
+/// @return the key of the current type in the map of canonical types.
+uint64_t
+type_base::get_canonical_type_key() const
+{
+  const char* prefix = nullptr;
+  const decl_base* d = get_type_declaration(this);
+  if (d)
+    {
+      if (is_class_type(this))
+	{
+	  if (!d->get_is_anonymous())
+	    prefix = "class ";
+	}
+      else if (is_union_type(this))
+	{
+	  if (!d->get_is_anonymous())
+	    prefix = "union ";
+	}
+      else if (is_enum_type(this))
+	{
+	  if (!d->get_is_anonymous())
+	    prefix = "enum ";
+	}
+      else if (is_typedef(this))
+	prefix = "typedef ";
+      else if (is_pointer_type(this) || is_qualified_type(this))
+	{
+	  // These use decl_base::get_pretty_representation.
+	  if (!(d->get_is_anonymous()
+		&& has_generic_anonymous_internal_type_name(d)))
+	    prefix = "";
+	}
+    }
+
+  if (prefix)
+    {
+      uint64_t h = hashing::fnv_hash64(prefix);
+      const interned_string& qname = d->get_qualified_name(/*internal=*/true);
+      if (!qname.empty())
+	h = hashing::fnv_hash64(*qname.raw(), h);
+      return h;
+    }
+
+  return hashing::fnv_hash64(ir::get_pretty_representation(this,
+							   /*internal=*/true));
+}
+
 /// Compares two instances of @ref type_base.
 ///
 /// If the two intances are different, set a bitfield to give some
@@ -16053,7 +17029,7 @@ namespace_decl::~namespace_decl()
 // <qualified_type_def>
 
 /// Type of the private data of qualified_type_def.
-class qualified_type_def::priv
+class qualified_type_def::priv : public arena_allocated
 {
   friend class qualified_type_def;
 
@@ -16559,7 +17535,7 @@ operator<<(std::ostream& o, qualified_type_def::CV cv)
 //<pointer_type_def definitions>
 
 /// Private data structure of the @ref pointer_type_def.
-struct pointer_type_def::priv
+struct pointer_type_def::priv : public arena_allocated
 {
   type_base_wptr pointed_to_type_;
   type_base* naked_pointed_to_type_;
@@ -17395,7 +18371,7 @@ array_type_def::subrange_type::bound_value::operator==(const bound_value& v) con
 
 // </array_type_def::subrante_type::bound_value>
 
-struct array_type_def::subrange_type::priv
+struct array_type_def::subrange_type::priv : public arena_allocated
 {
   bound_value		lower_bound_;
   bound_value		upper_bound_;
@@ -17810,7 +18786,7 @@ array_type_def::subrange_type::traverse(ir_node_visitor& v)
 
 // </array_type_def::subrange_type>
 
-struct array_type_def::priv
+struct array_type_def::priv : public arena_allocated
 {
   type_base_wptr	element_type_;
   subranges_type	subranges_;
@@ -18293,7 +19269,7 @@ array_type_def::~array_type_def()
 
 // <enum_type_decl definitions>
 
-class enum_type_decl::priv
+class enum_type_decl::priv : public arena_allocated
 {
   type_base_sptr	underlying_type_;
   enumerators		enumerators_;
@@ -18820,7 +19796,7 @@ operator!=(const enum_type_decl_sptr& l, const enum_type_decl_sptr& r)
 
 /// The type of the private data of an @ref
 /// enum_type_decl::enumerator.
-class enum_type_decl::enumerator::priv
+class enum_type_decl::enumerator::priv : public arena_allocated
 {
   string		name_;
   int64_t		value_;
@@ -18983,7 +19959,7 @@ enum_type_decl::enumerator::set_enum_type(enum_type_decl* e)
 // <typedef_decl definitions>
 
 /// Private data structure of the @ref typedef_decl.
-struct typedef_decl::priv
+struct typedef_decl::priv : public arena_allocated
 {
   type_base_wptr	underlying_type_;
   string		internal_qualified_name_;
@@ -19246,7 +20222,7 @@ typedef_decl::~typedef_decl()
 
 // <var_decl definitions>
 
-struct var_decl::priv
+struct var_decl::priv : public arena_allocated
 {
   type_base_wptr	type_;
   type_base*		naked_type_;
@@ -20353,7 +21329,7 @@ function_type::~function_type()
 
 // <method_type>
 
-struct method_type::priv
+struct method_type::priv : public arena_allocated
 {
   class_or_union_wptr class_type_;
   bool is_const;
@@ -20551,7 +21527,7 @@ method_type::~method_type()
 
 // <function_decl definitions>
 
-struct function_decl::priv
+struct function_decl::priv : public arena_allocated
 {
   bool			declared_inline_;
   decl_base::binding	binding_;
@@ -21247,7 +22223,7 @@ operator!=(const function_decl_sptr& l, const function_decl_sptr& r)
 
 // <function_decl::parameter definitions>
 
-struct function_decl::parameter::priv
+struct function_decl::parameter::priv : public arena_allocated
 {
   type_base_wptr	type_;
   unsigned		index_;
@@ -22813,7 +23789,7 @@ static void
 sort_virtual_member_functions(class_decl::member_functions& mem_fns);
 
 /// The private data for the class_decl type.
-struct class_decl::priv
+struct class_decl::priv : public arena_allocated
 {
   base_specs					bases_;
   unordered_map<string, base_spec_sptr>	bases_map_;
@@ -23213,7 +24189,7 @@ class_decl::insert_member_decl(decl_base_sptr d)
 }
 
 /// The private data structure of class_decl::base_spec.
-struct class_decl::base_spec::priv
+struct class_decl::base_spec::priv : public arena_allocated
 {
   class_decl_wptr	base_class_;
   long			offset_in_bits_;
@@ -25291,7 +26267,7 @@ operator!=(const union_decl_sptr& l, const union_decl_sptr& r)
 // <template_decl stuff>
 
 /// Data type of the private data of the @template_decl type.
-class template_decl::priv
+class template_decl::priv : public arena_allocated
 {
   friend class template_decl;
 
@@ -25393,7 +26369,7 @@ template_decl::operator==(const template_decl& o) const
 //<template_parameter>
 
 /// The type of the private data of the @ref template_parameter type.
-class template_parameter::priv
+class template_parameter::priv : public arena_allocated
 {
   friend class template_parameter;
 
@@ -25480,7 +26456,7 @@ template_parameter::~template_parameter()
 {}
 
 /// The type of the private data of the @ref type_tparameter type.
-class type_tparameter::priv
+class type_tparameter::priv : public arena_allocated
 {
   friend class type_tparameter;
 }; // end class type_tparameter::priv
@@ -25602,7 +26578,7 @@ type_tparameter::~type_tparameter()
 {}
 
 /// The type of the private data of the @ref non_type_tparameter type.
-class non_type_tparameter::priv
+class non_type_tparameter::priv : public arena_allocated
 {
   friend class non_type_tparameter;
 
@@ -25695,7 +26671,7 @@ non_type_tparameter::~non_type_tparameter()
 // <template_tparameter stuff>
 
 /// Type of the private data of the @ref template_tparameter type.
-class template_tparameter::priv
+class template_tparameter::priv : public arena_allocated
 {
 }; //end class template_tparameter::priv
 
@@ -25800,7 +26776,7 @@ template_tparameter::~template_tparameter()
 // <type_composition stuff>
 
 /// The type of the private data of the @ref type_composition type.
-class type_composition::priv
+class type_composition::priv : public arena_allocated
 {
   friend class type_composition;
 
@@ -25869,7 +26845,7 @@ type_composition::~type_composition()
 
 // <function_template>
 
-class function_tdecl::priv
+class function_tdecl::priv : public arena_allocated
 {
   friend class function_tdecl;
 
@@ -26051,7 +27027,7 @@ function_tdecl::~function_tdecl()
 // <class template>
 
 /// Type of the private data of the the @ref class_tdecl type.
-class class_tdecl::priv
+class class_tdecl::priv : public arena_allocated
 {
   friend class class_tdecl;
   class_decl_sptr pattern_;
@@ -26322,6 +27298,7 @@ void
 keep_type_alive(type_base_sptr t)
 {
   const environment& env = t->get_environment();
+  std::lock_guard<std::mutex> guard(env.priv_->extra_live_types_lock_);
   env.priv_->extra_live_types_.push_back(t);
 }
 
@@ -27235,6 +28212,178 @@ ir_node_visitor::visit_end(member_class_template* d)
 
 // </ir_node_visitor stuff>
 
+// <memory usage stuff>
+
+/// Record the memory used by an IR node.
+///
+/// The node is recorded in the category named after its kind, e.g,
+/// "ir.class-type", as given by type_or_decl_base::kind().  The
+/// number of bytes recorded accounts for the node, for the private
+/// data of each class of its hierarchy and for the arrays of its
+/// members, data members, member functions, parameters or
+/// enumerators.  It doesn't account for the control block of the
+/// shared pointer of the node, nor for its strings, which are
+/// interned in the environment.
+///
+/// @param node the IR node to consider.
+///
+/// @param stats the memory statistics to record into.
+void
+record_memory_usage(const type_or_decl_base& node,
+		    metrics::memory_stats& stats)
+{
+  typedef type_or_decl_base tod;
+  const tod::type_or_decl_kind k = node.kind();
+
+  size_t nb_bytes = sizeof(tod::priv);
+  if (k & tod::ABSTRACT_DECL_BASE)
+    nb_bytes += sizeof(decl_base::priv);
+  if (k & tod::ABSTRACT_TYPE_BASE)
+    nb_bytes += sizeof(type_base::priv);
+  if (k & tod::ABSTRACT_SCOPE_DECL)
+    {
+      const scope_decl::priv& p = *dynamic_cast<const scope_decl&>(node).priv_;
+      nb_bytes += sizeof(p)
+	+ metrics::estimate_memory_usage(p.members_)
+	+ metrics::estimate_memory_usage(p.sorted_members_)
+	+ metrics::estimate_memory_usage(p.member_types_)
+	+ metrics::estimate_memory_usage(p.sorted_member_types_)
+	+ metrics::estimate_memory_usage(p.member_scopes_)
+	+ metrics::estimate_memory_usage(p.sorted_canonical_types_);
+    }
+  if (k & (tod::CLASS_TYPE | tod::UNION_TYPE))
+    {
+      const class_or_union::priv& p =
+	*dynamic_cast<const class_or_union&>(node).priv_;
+      nb_bytes += sizeof(p)
+	+ metrics::estimate_memory_usage(p.data_members_)
+	+ metrics::estimate_memory_usage(p.non_static_data_members_)
+	+ metrics::estimate_memory_usage(p.member_functions_)
+	+ metrics::estimate_hash_table_memory_usage(p.mem_fns_map_)
+	+ metrics::estimate_hash_table_memory_usage(p.signature_2_mem_fn_map_);
+    }
+  if (k & tod::FUNCTION_TYPE)
+    {
+      const function_type::priv& p =
+	*dynamic_cast<const function_type&>(node).priv_;
+      nb_bytes += sizeof(p) + metrics::estimate_memory_usage(p.parms_);
+    }
+
+  const char* category = "ir.other";
+  if (k & tod::METHOD_TYPE)
+    {
+      category = "ir.method-type";
+      nb_bytes += sizeof(method_type) + sizeof(method_type::priv);
+    }
+  else if (k & tod::FUNCTION_TYPE)
+    {
+      category = "ir.function-type";
+      nb_bytes += sizeof(function_type);
+    }
+  else if (k & tod::CLASS_TYPE)
+    {
+      category = "ir.class-type";
+      nb_bytes += sizeof(class_decl) + sizeof(class_decl::priv)
+	+ metrics::estimate_memory_usage
+	(dynamic_cast<const class_decl&>(node).get_base_specifiers());
+    }
+  else if (k & tod::UNION_TYPE)
+    {
+      category = "ir.union-type";
+      nb_bytes += sizeof(union_decl);
+    }
+  else if (k & tod::ENUM_TYPE)
+    {
+      const enum_type_decl& e = dynamic_cast<const enum_type_decl&>(node);
+      category = "ir.enum-type";
+      nb_bytes += sizeof(enum_type_decl) + sizeof(enum_type_decl::priv)
+	+ metrics::estimate_memory_usage(e.get_enumerators());
+    }
+  else if (k & tod::TYPEDEF_TYPE)
+    {
+      category = "ir.typedef";
+      nb_bytes += sizeof(typedef_decl) + sizeof(typedef_decl::priv);
+    }
+  else if (k & tod::ARRAY_TYPE)
+    {
+      category = "ir.array-type";
+      nb_bytes += sizeof(array_type_def) + sizeof(array_type_def::priv);
+    }
+  else if (k & tod::REFERENCE_TYPE)
+    {
+      category = "ir.reference-type";
+      nb_bytes += sizeof(reference_type_def);
+    }
+  else if (k & tod::POINTER_TYPE)
+    {
+      category = "ir.pointer-type";
+      nb_bytes += sizeof(pointer_type_def) + sizeof(pointer_type_def::priv);
+    }
+  else if (k & tod::QUALIFIED_TYPE)
+    {
+      category = "ir.qualified-type";
+      nb_bytes += sizeof(qualified_type_def)
+	+ sizeof(qualified_type_def::priv);
+    }
+  else if (k & tod::BASIC_TYPE)
+    {
+      category = "ir.basic-type";
+      nb_bytes += sizeof(type_decl);
+    }
+  else if (k & tod::METHOD_DECL)
+    {
+      category = "ir.method-decl";
+      nb_bytes += sizeof(method_decl) + sizeof(function_decl::priv);
+    }
+  else if (k & tod::FUNCTION_DECL)
+    {
+      category = "ir.function-decl";
+      nb_bytes += sizeof(function_decl) + sizeof(function_decl::priv);
+    }
+  else if (k & tod::FUNCTION_PARAMETER_DECL)
+    {
+      category = "ir.function-parameter";
+      nb_bytes += sizeof(function_decl::parameter)
+	+ sizeof(function_decl::parameter::priv);
+    }
+  else if (k & tod::VAR_DECL)
+    {
+      category = "ir.var-decl";
+      nb_bytes += sizeof(var_decl) + sizeof(var_decl::priv);
+    }
+  else if (k & tod::NAMESPACE_DECL)
+    {
+      category = "ir.namespace";
+      nb_bytes += sizeof(namespace_decl);
+    }
+  else if (k & tod::GLOBAL_SCOPE_DECL)
+    {
+      category = "ir.global-scope";
+      nb_bytes += sizeof(global_scope);
+    }
+  else if (k & tod::TEMPLATE_DECL)
+    {
+      category = "ir.template";
+      nb_bytes += sizeof(template_decl);
+    }
+  else if (is_subrange_type(&node))
+    {
+      category = "ir.subrange-type";
+      nb_bytes += sizeof(array_type_def::subrange_type)
+	+ sizeof(array_type_def::subrange_type::priv);
+    }
+  else if (is_class_base_spec(&node))
+    {
+      category = "ir.base-spec";
+      nb_bytes += sizeof(class_decl::base_spec)
+	+ sizeof(class_decl::base_spec::priv);
+    }
+
+  stats.record(category, 1, nb_bytes);
+}
+
+// </memory usage stuff>
+
 // <debugging facilities>
 
 /// Generate a different string at each invocation.
@@ -0,0 +1,522 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2023 Red Hat, Inc.
+
+/// @file
+///
+/// This file implements the registry of performance metrics of
+/// libabigail.
+
+#include <sys/resource.h>
+#include <time.h>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "abg-internal.h"
+// <headers defining libabigail's API go under here>
+ABG_BEGIN_EXPORT_DECLARATIONS
+
+#include "abg-metrics.h"
+
+ABG_END_EXPORT_DECLARATIONS
+// </headers defining libabigail's API>
+
+namespace abigail
+{
+
+namespace metrics
+{
+
+/// The metrics recorded for a phase.
+struct phase_metrics
+{
+  std::string	name;
+  uint64_t	count		= 0;
+  double	wall_time	= 0;
+  double	cpu_time	= 0;
+  uint64_t	peak_rss	= 0;
+}; // end struct phase_metrics
+
+/// The private data of the @ref registry type.
+struct registry::priv
+{
+  mutable std::mutex				lock;
+  // This is read without taking the lock, on every attempt at
+  // recording a metric.
+  std::atomic<bool>				enabled{false};
+  std::chrono::steady_clock::time_point	creation_time;
+  // The phases, in the order in which they were first recorded.
+  std::vector<phase_metrics>			phases;
+  std::unordered_map<std::string, size_t>	phase_index;
+  // The counters, sorted by name.  They are never removed, so that
+  // the handles returned by registry::get_counter_handle remain
+  // valid.
+  std::map<std::string, std::unique_ptr<counter>> counters;
+
+  priv()
+    : creation_time(std::chrono::steady_clock::now())
+  {}
+
+  /// Get the metrics of a phase, creating them if necessary.
+  ///
+  /// The lock must be held by the caller.
+  ///
+  /// @param name the name of the phase.
+  ///
+  /// @return the metrics of the phase.
+  phase_metrics&
+  get_phase(const std::string& name)
+  {
+    auto i = phase_index.find(name);
+    if (i != phase_index.end())
+      return phases[i->second];
+
+    phase_index[name] = phases.size();
+    phases.push_back(phase_metrics());
+    phases.back().name = name;
+    return phases.back();
+  }
+
+  /// Get a counter, creating it if necessary.
+  ///
+  /// The lock must be held by the caller.
+  ///
+  /// @param name the name of the counter.
+  ///
+  /// @return the counter.
+  counter&
+  get_counter(const std::string& name)
+  {
+    std::unique_ptr<counter>& c = counters[name];
+    if (!c)
+      c.reset(new counter(enabled));
+    return *c;
+  }
+}; // end struct registry::priv
+
+/// Default constructor of the @ref registry type.
+///
+/// The registry is disabled by default.
+registry::registry()
+  : priv_(new priv)
+{}
+
+/// Test if the registry records metrics.
+///
+/// @return true iff the registry is enabled.
+bool
+registry::is_enabled() const
+{return priv_->enabled.load(std::memory_order_relaxed);}
+
+/// Enable or disable the registry.
+///
+/// @param f true to enable the registry.
+void
+registry::enable(bool f)
+{priv_->enabled.store(f, std::memory_order_relaxed);}
+
+/// Record that a phase was performed.
+///
+/// The high-water mark of the resident set size of the process is
+/// sampled at that point too.
+///
+/// @param name the name of the phase.
+///
+/// @param wall_time the wall clock time spent in the phase, in
+/// seconds.
+///
+/// @param cpu_time the CPU time spent in the phase, in seconds.
+void
+registry::record_phase(const std::string& name,
+		       double wall_time,
+		       double cpu_time)
+{
+  if (!is_enabled())
+    return;
+
+  uint64_t rss = get_peak_rss();
+  std::lock_guard<std::mutex> guard(priv_->lock);
+  phase_metrics& p = priv_->get_phase(name);
+  ++p.count;
+  p.wall_time += wall_time;
+  p.cpu_time += cpu_time;
+  if (rss > p.peak_rss)
+    p.peak_rss = rss;
+}
+
+/// Get the handle of a counter, creating the counter if necessary.
+///
+/// The handle remains valid for the lifetime of the registry.
+/// Incrementing a counter through its handle does not take the lock
+/// of the registry, so this is how counters are incremented on hot
+/// paths.
+///
+/// @param name the name of the counter.
+///
+/// @return the handle of the counter.
+counter&
+registry::get_counter_handle(const std::string& name)
+{
+  std::lock_guard<std::mutex> guard(priv_->lock);
+  return priv_->get_counter(name);
+}
+
+/// Increment a counter.
+///
+/// This looks the counter up by name.  On hot paths, prefer
+/// incrementing the handle returned by get_counter_handle.
+///
+/// @param name the name of the counter.
+///
+/// @param delta the value to add to the counter.
+void
+registry::increment_counter(const std::string& name, uint64_t delta)
+{
+  if (!is_enabled())
+    return;
+
+  get_counter_handle(name).increment(delta);
+}
+
+/// Increment a counter.
+///
+/// Unlike the overload that takes a std::string, this one costs no
+/// more than a test when the registry is disabled.
+///
+/// @param name the name of the counter.
+///
+/// @param delta the value to add to the counter.
+void
+registry::increment_counter(const char* name, uint64_t delta)
+{
+  if (!is_enabled())
+    return;
+
+  increment_counter(std::string(name), delta);
+}
+
+/// Getter of the value of a counter.
+///
+/// @param name the name of the counter.
+///
+/// @return the value of the counter, or zero if it was never
+/// incremented.
+uint64_t
+registry::get_counter(const std::string& name) const
+{
+  std::lock_guard<std::mutex> guard(priv_->lock);
+  auto i = priv_->counters.find(name);
+  if (i == priv_->counters.end())
+    return 0;
+  return i->second->get_value();
+}
+
+/// Add the metrics of another registry to this one.
+///
+/// This is useful for tools that use several environments.
+///
+/// @param other the registry to merge into this one.
+void
+registry::merge(const registry& other)
+{
+  if (!is_enabled() || &other == this)
+    return;
+
+  std::lock(priv_->lock, other.priv_->lock);
+  std::lock_guard<std::mutex> guard(priv_->lock, std::adopt_lock);
+  std::lock_guard<std::mutex> other_guard(other.priv_->lock,
+					  std::adopt_lock);
+
+  for (const phase_metrics& o : other.priv_->phases)
+    {
+      phase_metrics& p = priv_->get_phase(o.name);
+      p.count += o.count;
+      p.wall_time += o.wall_time;
+      p.cpu_time += o.cpu_time;
+      if (o.peak_rss > p.peak_rss)
+	p.peak_rss = o.peak_rss;
+    }
+
+  for (const auto& c : other.priv_->counters)
+    priv_->get_counter(c.first).increment(c.second->get_value());
+}
+
+/// Emit a string as a JSON string literal.
+///
+/// @param s the string to emit.
+///
+/// @param out the output stream to emit the literal to.
+static void
+emit_json_string(const std::string& s, std::ostream& out)
+{
+  out << '"';
+  for (char c : s)
+    switch (c)
+      {
+      case '"':
+	out << "\\\"";
+	break;
+      case '\\':
+	out << "\\\\";
+	break;
+      case '\n':
+	out << "\\n";
+	break;
+      case '\t':
+	out << "\\t";
+	break;
+      default:
+	if (static_cast<unsigned char>(c) < 0x20)
+	  out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+	      << static_cast<int>(c) << std::dec << std::setfill(' ');
+	else
+	  out << c;
+      }
+  out << '"';
+}
+
+/// Emit the content of the registry as a JSON document.
+///
+/// The document is an object with the following members:
+///
+///   - "wall_time": the wall clock time elapsed since the creation of
+///     the registry, in seconds.
+///
+///   - "cpu_time": the CPU time used by the process, in seconds.
+///
+///   - "peak_rss_kb": the high-water mark of the resident set size of
+///     the process, in kilobytes.
+///
+///   - "phases": an array of objects with the members "name",
+///     "count", "wall_time", "cpu_time" and "peak_rss_kb", in the
+///     order in which the phases were first recorded.
+///
+///   - "counters": an object mapping the name of each counter to its
+///     value.
+///
+/// @param out the output stream to emit the document to.
+void
+registry::emit_json(std::ostream& out) const
+{
+  std::lock_guard<std::mutex> guard(priv_->lock);
+
+  std::chrono::duration<double> wall_time =
+    std::chrono::steady_clock::now() - priv_->creation_time;
+
+  out << "{\n"
+      << "  \"wall_time\": " << wall_time.count() << ",\n"
+      << "  \"cpu_time\": " << get_cpu_time() << ",\n"
+      << "  \"peak_rss_kb\": " << get_peak_rss() << ",\n"
+      << "  \"phases\": [";
+
+  bool first = true;
+  for (const phase_metrics& p : priv_->phases)
+    {
+      out << (first ? "\n" : ",\n") << "    {\"name\": ";
+      emit_json_string(p.name, out);
+      out << ", \"count\": " << p.count
+	  << ", \"wall_time\": " << p.wall_time
+	  << ", \"cpu_time\": " << p.cpu_time
+	  << ", \"peak_rss_kb\": " << p.peak_rss
+	  << "}";
+      first = false;
+    }
+  out << (first ? "],\n" : "\n  ],\n")
+      << "  \"counters\": {";
+
+  first = true;
+  for (const auto& c : priv_->counters)
+    {
+      out << (first ? "\n" : ",\n") << "    ";
+      emit_json_string(c.first, out);
+      out << ": " << c.second->get_value();
+      first = false;
+    }
+  out << (first ? "}\n" : "\n  }\n")
+      << "}\n";
+}
+
+/// Emit the content of the registry as a JSON document into a file.
+///
+/// @param path the path to the file to write.
+///
+/// @return true iff the file could be written.
+bool
+registry::emit_json(const std::string& path) const
+{
+  std::ofstream out(path.c_str(), std::ofstream::out|std::ofstream::trunc);
+  if (!out.good())
+    return false;
+  emit_json(out);
+  out.close();
+  return !out.fail();
+}
+
+registry::~registry() = default;
+
+/// The private data of the @ref memory_stats type.
+struct memory_stats::priv
+{
+  // The categories, in the order in which they were first recorded.
+  std::vector<memory_usage>			usages;
+  std::unordered_map<std::string, size_t>	usage_index;
+}; // end struct memory_stats::priv
+
+/// Default constructor of the @ref memory_stats type.
+memory_stats::memory_stats()
+  : priv_(new priv)
+{}
+
+/// Record the memory used by some objects of a category.
+///
+/// The counts add up to those previously recorded for the category.
+///
+/// @param category the name of the category.
+///
+/// @param nb_objects the number of objects.
+///
+/// @param nb_bytes the number of bytes used by the objects.
+void
+memory_stats::record(const std::string& category,
+		     uint64_t nb_objects,
+		     uint64_t nb_bytes)
+{
+  auto i = priv_->usage_index.find(category);
+  if (i == priv_->usage_index.end())
+    {
+      i = priv_->usage_index.insert(std::make_pair(category,
+						   priv_->usages.size())).first;
+      priv_->usages.push_back(memory_usage(category));
+    }
+  memory_usage& u = priv_->usages[i->second];
+  u.nb_objects += nb_objects;
+  u.nb_bytes += nb_bytes;
+}
+
+/// Get the memory used by the objects of a category.
+///
+/// @param category the name of the category.
+///
+/// @return the memory used by the objects of @p category, or nil if
+/// nothing was recorded for that category.
+const memory_usage*
+memory_stats::get_usage(const std::string& category) const
+{
+  auto i = priv_->usage_index.find(category);
+  if (i == priv_->usage_index.end())
+    return nullptr;
+  return &priv_->usages[i->second];
+}
+
+/// Get the memory used by the objects of all the categories.
+///
+/// @return the memory used by each category, in the order in which
+/// the categories were first recorded.
+const std::vector<memory_usage>&
+memory_stats::get_usages() const
+{return priv_->usages;}
+
+/// Get the number of bytes used by the objects of all the
+/// categories.
+///
+/// @return the total number of bytes.
+uint64_t
+memory_stats::get_total_bytes() const
+{
+  uint64_t total = 0;
+  for (const memory_usage& u : priv_->usages)
+    total += u.nb_bytes;
+  return total;
+}
+
+/// Emit a human readable report of the memory used by each category,
+/// followed by the total.
+///
+/// @param out the output stream to emit the report to.
+void
+memory_stats::emit_report(std::ostream& out) const
+{
+  size_t width = 8;
+  for (const memory_usage& u : priv_->usages)
+    width = std::max(width, u.category.size());
+
+  out << std::left << std::setw(width) << "category" << std::right
+      << std::setw(14) << "objects"
+      << std::setw(16) << "bytes" << "\n";
+  for (const memory_usage& u : priv_->usages)
+    out << std::left << std::setw(width) << u.category << std::right
+	<< std::setw(14) << u.nb_objects
+	<< std::setw(16) << u.nb_bytes << "\n";
+  out << std::left << std::setw(width) << "total" << std::right
+      << std::setw(14) << ""
+      << std::setw(16) << get_total_bytes() << "\n";
+}
+
+memory_stats::~memory_stats() = default;
+
+/// Constructor of the @ref scoped_phase type.
+///
+/// This starts the phase.
+///
+/// @param r the registry to record the phase into.
+///
+/// @param name the name of the phase.
+scoped_phase::scoped_phase(registry& r, const std::string& name)
+  : registry_(r),
+    active_(r.is_enabled()),
+    cpu_start_(0)
+{
+  if (!active_)
+    return;
+  name_ = name;
+  wall_start_ = std::chrono::steady_clock::now();
+  cpu_start_ = get_cpu_time();
+}
+
+/// Destructor of the @ref scoped_phase type.
+///
+/// This ends the phase and records it into the registry.
+scoped_phase::~scoped_phase()
+{
+  if (!active_)
+    return;
+  std::chrono::duration<double> wall_time =
+    std::chrono::steady_clock::now() - wall_start_;
+  registry_.record_phase(name_, wall_time.count(),
+			 get_cpu_time() - cpu_start_);
+}
+
+/// Get the CPU time used by the process so far.
+///
+/// @return the CPU time used by all the threads of the process, in
+/// seconds.
+double
+get_cpu_time()
+{
+  struct timespec ts;
+  if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts))
+    return 0;
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/// Get the high-water mark of the resident set size of the process.
+///
+/// @return the peak resident set size of the process, in kilobytes.
+uint64_t
+get_peak_rss()
+{
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage))
+    return 0;
+  return usage.ru_maxrss;
+}
+
+}// end namespace metrics
+}// end namespace abigail
@@ -21,10 +21,12 @@
 #include <memory>
 #include <sstream>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "abg-suppression-priv.h"
 
 #include "abg-internal.h"
+#include "abg-ir-priv.h"
 #include "abg-symtab-reader.h"
 
 // <headers defining libabigail's API go under here>
@@ -51,6 +53,7 @@ using std::string;
 using std::deque;
 using std::shared_ptr;
 using std::unordered_map;
+using std::unordered_set;
 using std::dynamic_pointer_cast;
 using std::vector;
 using std::istream;
@@ -147,6 +150,7 @@ private:
   deque<shared_ptr<decl_base> >			m_decls_stack;
   bool							m_tracking_non_reachable_types;
   bool							m_drop_undefined_syms;
+  const unordered_set<string>*				m_units_to_read;
 #ifdef WITH_SHOW_TYPE_USE_IN_ABILINT
   unordered_map<type_or_decl_base*,
 		vector<type_or_decl_base*>>		m_artifact_used_by_map;
@@ -161,7 +165,8 @@ public:
       m_reader(reader),
       m_corp_node(),
       m_tracking_non_reachable_types(),
-      m_drop_undefined_syms()
+      m_drop_undefined_syms(),
+      m_units_to_read()
   {
   }
 
@@ -207,6 +212,24 @@ public:
   drop_undefined_syms(bool f)
   {m_drop_undefined_syms = f;}
 
+  /// Getter of the set of the absolute paths of the translation
+  /// units to read from a corpus.
+  ///
+  /// @return the set of the absolute paths of the translation units
+  /// to read, or nil if all of them are to be read.
+  const unordered_set<string>*
+  units_to_read() const
+  {return m_units_to_read;}
+
+  /// Setter of the set of the absolute paths of the translation
+  /// units to read from a corpus.
+  ///
+  /// @param u the set of the absolute paths of the translation units
+  /// to read, or nil if all of them are to be read.
+  void
+  units_to_read(const unordered_set<string>* u)
+  {m_units_to_read = u;}
+
   /// Getter of the path to the ABI file.
   ///
   /// @return the path to the native xml abi file.
@@ -1083,6 +1106,9 @@ public:
   virtual ir::corpus_sptr
   read_corpus(fe_iface::status& status)
   {
+    metrics::scoped_phase phase(get_environment().get_metrics(),
+				"abixml.read-corpus");
+    arena_allocation_scope arena_scope(get_environment());
     corpus_sptr nil;
 
     xml::reader_sptr xml_reader = get_libxml_reader();
@@ -1648,6 +1674,10 @@ read_translation_unit(fe_iface& iface, translation_unit& tu, xmlNodePtr node)
     tu.set_language(string_to_translation_unit_language
 		     (reinterpret_cast<char*>(language_str.get())));
 
+  xml::xml_char_sptr content_hash_str =
+    XML_NODE_GET_ATTRIBUTE(node, "content-hash");
+  if (content_hash_str)
+    tu.set_content_hash(reinterpret_cast<char*>(content_hash_str.get()));
 
   // We are at global scope, as we've just seen the top-most
   // "abi-instr" element.
@@ -1674,6 +1704,24 @@ read_translation_unit(fe_iface& iface, translation_unit& tu, xmlNodePtr node)
   return true;
 }
 
+/// Get the absolute path of the translation unit represented by an
+/// 'abi-instr' xml node.
+///
+/// @param node the 'abi-instr' xml node to consider.
+///
+/// @return the absolute path of the translation unit, that is, its
+/// path prefixed with its compilation directory, if any.
+static string
+get_translation_unit_abs_path(xmlNodePtr node)
+{
+  string path, comp_dir_path;
+  if (xml::xml_char_sptr s = XML_NODE_GET_ATTRIBUTE(node, "path"))
+    path = reinterpret_cast<char*>(s.get());
+  if (xml::xml_char_sptr s = XML_NODE_GET_ATTRIBUTE(node, "comp-dir-path"))
+    comp_dir_path = reinterpret_cast<char*>(s.get());
+  return comp_dir_path.empty() ? path : comp_dir_path + "/" + path;
+}
+
 /// Read a given xml node representing a tranlsation unit.
 ///
 /// If the current corpus already contains a translation unit of the
@@ -1693,8 +1741,12 @@ get_or_read_and_add_translation_unit(reader& rdr, xmlNodePtr node)
   corpus_sptr corp = rdr.corpus();
 
   translation_unit_sptr tu;
-  string tu_path;
+  string tu_path, comp_dir_path;
   xml::xml_char_sptr path_str = XML_NODE_GET_ATTRIBUTE(node, "path");
+  xml::xml_char_sptr comp_dir_path_str =
+    XML_NODE_GET_ATTRIBUTE(node, "comp-dir-path");
+  if (comp_dir_path_str)
+    comp_dir_path = reinterpret_cast<char*>(comp_dir_path_str.get());
 
   if (path_str)
     {
@@ -1702,13 +1754,18 @@ get_or_read_and_add_translation_unit(reader& rdr, xmlNodePtr node)
       ABG_ASSERT(!tu_path.empty());
 
       if (corp && !corp->is_empty())
-	tu = corp->find_translation_unit(tu_path);
+	tu = corp->find_translation_unit(comp_dir_path.empty()
+					 ? tu_path
+					 : comp_dir_path + "/" + tu_path);
 
       if (tu)
 	return tu;
     }
 
   tu.reset(new translation_unit(rdr.get_environment(), tu_path));
+  // The absolute path of the translation unit, which the corpus
+  // indexes it by, depends on its compilation directory.
+  tu->set_compilation_dir_path(comp_dir_path);
   if (corp && !corp->is_empty())
     corp->add(tu);
 
@@ -1763,6 +1820,9 @@ read_translation_unit_from_input(fe_iface& iface)
 	{
 	  if (!xmlStrEqual(n->name, BAD_CAST("abi-instr")))
 	    return nil;
+	  if (rdr.units_to_read()
+	      && !rdr.units_to_read()->count(get_translation_unit_abs_path(n)))
+	    continue;
 	  node = n;
 	  break;
 	}
@@ -2094,6 +2154,8 @@ read_corpus_group_from_input(fe_iface& iface)
   corpus_group_sptr nil;
 
   abixml::reader& rdr = dynamic_cast<abixml::reader&>(iface);
+  metrics::scoped_phase phase(rdr.get_environment().get_metrics(),
+			      "abixml.read-corpus-group");
   xml::reader_sptr reader = rdr.get_libxml_reader();
   if (!reader)
     return nil;
@@ -6222,6 +6284,353 @@ read_corpus_from_abixml_file(const string& path,
   return corp;
 }
 
+/// De-serialize some of the translation units of an ABI corpus from
+/// an XML document file which root node is 'abi-corpus'.
+///
+/// The other translation units of the document are not read, unless
+/// a type of a translation unit that is read refers to them.
+///
+/// @param path the path to the input file to read the XML document
+/// from.
+///
+/// @param env the environment to use.  Note that the life time of
+/// this environment must be greater than the lifetime of the
+/// resulting corpus as the corpus uses resources that are allocated
+/// in the environment.
+///
+/// @param unit_paths the absolute paths of the translation units to
+/// read.
+///
+/// @return the resulting corpus de-serialized from the parsing.  This
+/// is non-null if the parsing successfully resulted in a corpus.
+corpus_sptr
+read_corpus_from_abixml_file(const string& path,
+			     environment& env,
+			     const unordered_set<string>& unit_paths)
+{
+  fe_iface_sptr rdr = create_reader(path, env);
+  dynamic_cast<reader&>(*rdr).units_to_read(&unit_paths);
+  fe_iface::status sts;
+  corpus_sptr corp = rdr->read_corpus(sts);
+  return corp;
+}
+
+/// Find the translation units of an abixml document that would read
+/// the same if they were built again from a new version of the binary
+/// the document was emitted from.
+///
+/// A translation unit can be re-used if:
+///
+///   - it has the same content hash in the document (see
+///     translation_unit::get_content_hash) as in the new binary;
+///
+///   - none of the declaration-only classes, unions and enums it
+///     uses, directly or through other types of the document, is
+///     named like a type that is defined by a translation unit which
+///     content changed.  Otherwise, the declaration-only type could be
+///     resolved to a different definition in the new binary;
+///
+///   - it doesn't define a type which ID is defined by another
+///     translation unit of the document.  Such a type is emitted in
+///     several units when, e.g, a unit only declares it and the
+///     declaration was resolved to its definition.  The document then
+///     doesn't tell which unit really defines it, and reading the
+///     document merges all these definitions into the first one;
+///
+///   - the translation units that define the types it uses are
+///     re-usable as well.  Otherwise, it would refer to types that are
+///     not emitted anymore.
+///
+/// The types a translation unit uses are found by following the
+/// attributes of its elements that refer to type IDs, so this doesn't
+/// build any IR.
+///
+/// @param path the path to the abixml document to consider.
+///
+/// @param unit_hashes a map that associates the absolute path of
+/// each translation unit of the new binary to its content hash.
+///
+/// @param unit_type_names a map that associates the absolute path of
+/// each translation unit of the new binary to the names of the
+/// classes, unions and enums it defines.
+///
+/// @param reusable_units output parameter.  This is set to the
+/// absolute paths of the translation units of the abixml document
+/// that can be re-used.
+///
+/// @return true iff the abixml document could be read.
+bool
+find_reusable_translation_units(const string& path,
+				const unordered_map<string, string>& unit_hashes,
+				const unordered_map<string, unordered_set<string>>&
+				unit_type_names,
+				unordered_set<string>& reusable_units)
+{
+  xml::reader_sptr reader = xml::new_reader_from_file(path);
+  if (!reader)
+    return false;
+
+  // A type element of the document, i.e, an element with an "id"
+  // attribute.
+  struct type_node
+  {
+    string		name;
+    bool		is_decl_only_type;
+    size_t		unit;
+    vector<size_t>	used_types;
+  };
+
+  struct unit
+  {
+    string		abs_path;
+    string		content_hash;
+    unordered_set<string>	defined_type_names;
+    vector<size_t>	types;
+    vector<size_t>	used_types;
+    bool		shares_type_definitions = false;
+  };
+
+  vector<type_node> types;
+  vector<unit> units;
+  unordered_map<string, size_t> id_type_map;
+  // The IDs referred to by each type and by each unit.  They are
+  // resolved once all the types are known, as they can be referred to
+  // before being defined.
+  vector<vector<string>> type_refs, unit_refs;
+  // The stack of the type elements that contain the current element,
+  // along with their depth.
+  vector<std::pair<int, size_t>> type_stack;
+
+  int status = 1;
+  while ((status = xmlTextReaderRead(reader.get())) == 1)
+    {
+      if (XML_READER_GET_NODE_TYPE(reader) != XML_READER_TYPE_ELEMENT)
+	continue;
+
+      int depth = xmlTextReaderDepth(reader.get());
+      while (!type_stack.empty() && type_stack.back().first >= depth)
+	type_stack.pop_back();
+
+      const char* element =
+	reinterpret_cast<const char*>(xmlTextReaderConstName(reader.get()));
+      if (!strcmp(element, "abi-instr"))
+	{
+	  type_stack.clear();
+	  units.push_back(unit());
+	  unit_refs.push_back(vector<string>());
+	}
+
+      string id, name, unit_path, comp_dir_path, content_hash;
+      bool is_decl_only = false;
+      vector<string> refs;
+      for (int s = xmlTextReaderMoveToFirstAttribute(reader.get());
+	   s == 1;
+	   s = xmlTextReaderMoveToNextAttribute(reader.get()))
+	{
+	  string attr =
+	    reinterpret_cast<const char*>(xmlTextReaderConstName(reader.get()));
+	  string value =
+	    reinterpret_cast<const char*>(xmlTextReaderConstValue(reader.get()));
+	  if (attr == "id")
+	    id = value;
+	  else if (attr == "name")
+	    name = value;
+	  else if (attr == "path")
+	    unit_path = value;
+	  else if (attr == "comp-dir-path")
+	    comp_dir_path = value;
+	  else if (attr == "content-hash")
+	    content_hash = value;
+	  else if (attr == "is-declaration-only")
+	    is_decl_only = value == "yes";
+	  else if (attr != "elf-symbol-id"
+		   && tools_utils::string_ends_with(attr, "-id"))
+	    refs.push_back(value);
+	}
+      xmlTextReaderMoveToElement(reader.get());
+
+      if (!strcmp(element, "abi-instr"))
+	{
+	  unit& u = units.back();
+	  if (!unit_path.empty())
+	    u.abs_path = comp_dir_path.empty()
+	      ? unit_path
+	      : comp_dir_path + "/" + unit_path;
+	  u.content_hash = content_hash;
+	  continue;
+	}
+
+      if (units.empty())
+	// This is not an element of a translation unit, e.g, an ELF
+	// symbol.
+	continue;
+
+      bool is_named_type = (!strcmp(element, "class-decl")
+			    || !strcmp(element, "union-decl")
+			    || !strcmp(element, "enum-decl"));
+      if (is_named_type && !is_decl_only && !name.empty())
+	units.back().defined_type_names.insert(name);
+
+      if (!id.empty() && id_type_map.count(id))
+	{
+	  size_t first_unit = types[id_type_map[id]].unit;
+	  if (first_unit != units.size() - 1)
+	    {
+	      units[first_unit].shares_type_definitions = true;
+	      units.back().shares_type_definitions = true;
+	    }
+	}
+      else if (!id.empty())
+	{
+	  size_t t = types.size();
+	  types.push_back(type_node());
+	  type_refs.push_back(vector<string>());
+	  types[t].is_decl_only_type = is_named_type && is_decl_only;
+	  types[t].name = name;
+	  types[t].unit = units.size() - 1;
+	  id_type_map[id] = t;
+	  units.back().types.push_back(t);
+	  type_stack.push_back(std::make_pair(depth, t));
+	}
+
+      vector<string>& r = type_stack.empty()
+	? unit_refs.back()
+	: type_refs[type_stack.back().second];
+      r.insert(r.end(), refs.begin(), refs.end());
+    }
+
+  if (status != 0)
+    return false;
+
+  for (size_t t = 0; t < types.size(); ++t)
+    for (const string& id : type_refs[t])
+      {
+	unordered_map<string, size_t>::const_iterator i = id_type_map.find(id);
+	if (i != id_type_map.end())
+	  types[t].used_types.push_back(i->second);
+      }
+  for (size_t u = 0; u < units.size(); ++u)
+    for (const string& id : unit_refs[u])
+      {
+	unordered_map<string, size_t>::const_iterator i = id_type_map.find(id);
+	if (i != id_type_map.end())
+	  units[u].used_types.push_back(i->second);
+      }
+
+  // Find the units which content changed, and the names of the types
+  // they used to define.  Several units of the same path are all
+  // considered changed.
+  unordered_map<string, size_t> nb_units_per_path;
+  for (const unit& u : units)
+    ++nb_units_per_path[u.abs_path];
+
+  vector<bool> changed(units.size(), false);
+  unordered_set<string> unchanged_paths, unstable_type_names;
+  for (size_t u = 0; u < units.size(); ++u)
+    {
+      unordered_map<string, string>::const_iterator h =
+	unit_hashes.find(units[u].abs_path);
+      changed[u] = (units[u].abs_path.empty()
+		    || units[u].content_hash.empty()
+		    || nb_units_per_path[units[u].abs_path] > 1
+		    || h == unit_hashes.end()
+		    || h->second != units[u].content_hash);
+      if (changed[u])
+	unstable_type_names.insert(units[u].defined_type_names.begin(),
+				   units[u].defined_type_names.end());
+      else
+	unchanged_paths.insert(units[u].abs_path);
+    }
+
+  // The types defined by the new or changed units of the new binary
+  // are unstable too.
+  for (const auto& u : unit_type_names)
+    if (!unchanged_paths.count(u.first))
+      unstable_type_names.insert(u.second.begin(), u.second.end());
+
+  // Taint the declaration-only types which name is unstable, and the
+  // types that use them, directly or not.
+  vector<vector<size_t>> users(types.size());
+  for (size_t t = 0; t < types.size(); ++t)
+    for (size_t used : types[t].used_types)
+      users[used].push_back(t);
+
+  vector<bool> tainted(types.size(), false);
+  vector<size_t> to_visit;
+  for (size_t t = 0; t < types.size(); ++t)
+    if (types[t].is_decl_only_type
+	&& unstable_type_names.count(types[t].name))
+      {
+	tainted[t] = true;
+	to_visit.push_back(t);
+      }
+  while (!to_visit.empty())
+    {
+      size_t t = to_visit.back();
+      to_visit.pop_back();
+      for (size_t user : users[t])
+	if (!tainted[user])
+	  {
+	    tainted[user] = true;
+	    to_visit.push_back(user);
+	  }
+    }
+
+  vector<bool> reusable(units.size(), false);
+  for (size_t u = 0; u < units.size(); ++u)
+    {
+      if (changed[u] || units[u].shares_type_definitions)
+	continue;
+
+      bool is_tainted = false;
+      for (size_t t : units[u].types)
+	is_tainted |= tainted[t];
+      for (size_t t : units[u].used_types)
+	is_tainted |= tainted[t];
+      reusable[u] = !is_tainted;
+    }
+
+  // A re-used unit refers to the types of the document it uses by
+  // their IDs.  So the units that define these types must be re-used
+  // too.  Otherwise, these types wouldn't be emitted.
+  vector<vector<size_t>> dependent_units(units.size());
+  for (size_t u = 0; u < units.size(); ++u)
+    {
+      unordered_set<size_t> deps;
+      for (size_t t : units[u].used_types)
+	deps.insert(types[t].unit);
+      for (size_t t : units[u].types)
+	for (size_t used : types[t].used_types)
+	  deps.insert(types[used].unit);
+      deps.erase(u);
+      for (size_t d : deps)
+	dependent_units[d].push_back(u);
+    }
+
+  vector<size_t> not_reusable;
+  for (size_t u = 0; u < units.size(); ++u)
+    if (!reusable[u])
+      not_reusable.push_back(u);
+  while (!not_reusable.empty())
+    {
+      size_t u = not_reusable.back();
+      not_reusable.pop_back();
+      for (size_t dependent : dependent_units[u])
+	if (reusable[dependent])
+	  {
+	    reusable[dependent] = false;
+	    not_reusable.push_back(dependent);
+	  }
+    }
+
+  reusable_units.clear();
+  for (size_t u = 0; u < units.size(); ++u)
+    if (reusable[u])
+      reusable_units.insert(units[u].abs_path);
+
+  return true;
+}
+
 }//end namespace xml_reader
 
 #ifdef WITH_DEBUG_SELF_COMPARISON
@@ -12,6 +12,7 @@
 
 #include <sstream>
 #include <ostream>
+#include <unordered_set>
 
 #include "abg-internal.h"
 
@@ -53,6 +54,338 @@ sptr_utils::build_sptr<regex_t>()
 namespace regex
 {
 
+/// A matcher for the regular expressions that are alternations of
+/// literal strings, possibly anchored at the beginning or at the end
+/// of the string to match.  E.g, "^foo$", "^_Z.*", ".*Private$",
+/// "bar|baz" or "^(foo|bar)$".
+///
+/// Such regular expressions are the vast majority of those found in
+/// suppression specifications.  Matching them with this type rather
+/// than with regexec yields the same result, much faster.
+class literal_matcher
+{
+  // The alternatives that must be equal to the string to match.
+  std::unordered_set<std::string> exact_;
+  // The alternatives that must be a prefix of the string to match.
+  std::vector<std::string> prefixes_;
+  // The alternatives that must be a suffix of the string to match.
+  std::vector<std::string> suffixes_;
+  // The alternatives that must be a sub-string of the string to
+  // match.
+  std::vector<std::string> substrings_;
+
+  static bool
+  parse_literal(const std::string& str,
+		std::string::size_type begin,
+		std::string::size_type end,
+		std::string& literal);
+
+  static bool
+  parse_anchors(const std::string& str,
+		std::string::size_type& begin,
+		std::string::size_type& end,
+		bool& at_beginning,
+		bool& at_end);
+
+  static bool
+  split_alternatives(const std::string& str,
+		     std::string::size_type begin,
+		     std::string::size_type end,
+		     std::vector<std::string::size_type>& bars);
+
+  void
+  add_alternative(const std::string& literal, bool at_beginning, bool at_end);
+
+public:
+  static std::shared_ptr<literal_matcher>
+  create(const std::string& str);
+
+  bool
+  match(const std::string& str) const;
+}; // end class literal_matcher
+
+/// The deleter of the regex_t compiled by regex::compile.
+///
+/// Besides de-allocating the regex_t, it holds the @ref
+/// literal_matcher that regex::match uses in place of regexec, if the
+/// regular expression is simple enough.
+struct compiled_regex_deleter : public regex_t_deleter
+{
+  std::shared_ptr<literal_matcher> literals;
+}; // end struct compiled_regex_deleter
+
+/// Test if a character is special in a POSIX extended regular
+/// expression.
+///
+/// @param c the character to consider.
+///
+/// @return true iff @p c is special.
+static bool
+is_special(char c)
+{
+  static const std::string specials = "^.[]$()|*+?{}\\";
+  return specials.find(c) != std::string::npos;
+}
+
+/// Parse a part of a regular expression that is made of literal
+/// characters, possibly escaped.
+///
+/// @param str the regular expression to consider.
+///
+/// @param begin the index of the beginning of the part to parse.
+///
+/// @param end the index of the end of the part to parse.
+///
+/// @param literal out parameter.  The literal string matched by the
+/// part of the regular expression.
+///
+/// @return true iff the part of @p str is made of literal characters.
+bool
+literal_matcher::parse_literal(const std::string& str,
+			       std::string::size_type begin,
+			       std::string::size_type end,
+			       std::string& literal)
+{
+  literal.clear();
+  for (std::string::size_type i = begin; i < end; ++i)
+    {
+      char c = str[i];
+      if (c == '\\')
+	{
+	  // Only escaped special characters are literals; other
+	  // escape sequences have special meanings in GNU regexps.
+	  if (++i == end || !is_special(str[i]))
+	    return false;
+	  c = str[i];
+	}
+      else if (is_special(c))
+	return false;
+      literal += c;
+    }
+  return true;
+}
+
+/// Parse the anchors at the beginning and at the end of a part of a
+/// regular expression.
+///
+/// A leading '^' anchors the part at the beginning of the string to
+/// match, unless it's followed by ".*"; a trailing '$' anchors the
+/// part at the end of the string, unless it's preceded by ".*".
+///
+/// @param str the regular expression to consider.
+///
+/// @param begin the index of the beginning of the part to parse.  It
+/// is updated to the index of the beginning of what follows the
+/// leading anchors.
+///
+/// @param end the index of the end of the part to parse.  It is
+/// updated to the index of the end of what precedes the trailing
+/// anchors.
+///
+/// @param at_beginning out parameter.  Set to true iff the part is
+/// anchored at the beginning of the string to match.
+///
+/// @param at_end out parameter.  Set to true iff the part is
+/// anchored at the end of the string to match.
+///
+/// @return true iff the anchors could be parsed.
+bool
+literal_matcher::parse_anchors(const std::string& str,
+			       std::string::size_type& begin,
+			       std::string::size_type& end,
+			       bool& at_beginning,
+			       bool& at_end)
+{
+  at_beginning = false;
+  at_end = false;
+
+  if (begin < end && str[begin] == '^')
+    {
+      at_beginning = true;
+      ++begin;
+    }
+  if (begin < end && str[end - 1] == '$'
+      && !(end - begin >= 2 && str[end - 2] == '\\'))
+    {
+      at_end = true;
+      --end;
+    }
+  if (end - begin >= 2 && str.compare(begin, 2, ".*") == 0)
+    {
+      at_beginning = false;
+      begin += 2;
+    }
+  if (end - begin >= 2 && str.compare(end - 2, 2, ".*") == 0
+      && !(end - begin >= 3 && str[end - 3] == '\\'))
+    {
+      at_end = false;
+      end -= 2;
+    }
+  return begin <= end;
+}
+
+/// Find the '|' characters that separate the top-level alternatives
+/// of a part of a regular expression.
+///
+/// @param str the regular expression to consider.
+///
+/// @param begin the index of the beginning of the part to consider.
+///
+/// @param end the index of the end of the part to consider.
+///
+/// @param bars out parameter.  The indexes of the '|' characters.
+///
+/// @return true iff the part contains no bracket expression and its
+/// parenthesis are balanced.
+bool
+literal_matcher::split_alternatives(const std::string& str,
+				    std::string::size_type begin,
+				    std::string::size_type end,
+				    std::vector<std::string::size_type>& bars)
+{
+  int depth = 0;
+  for (std::string::size_type i = begin; i < end; ++i)
+    switch (str[i])
+      {
+      case '\\':
+	++i;
+	break;
+      case '[':
+	return false;
+      case '(':
+	++depth;
+	break;
+      case ')':
+	if (--depth < 0)
+	  return false;
+	break;
+      case '|':
+	if (depth == 0)
+	  bars.push_back(i);
+	break;
+      default:
+	break;
+      }
+  return depth == 0;
+}
+
+/// Add an alternative to the current matcher.
+///
+/// @param literal the literal string of the alternative.
+///
+/// @param at_beginning whether the alternative is anchored at the
+/// beginning of the string to match.
+///
+/// @param at_end whether the alternative is anchored at the end of
+/// the string to match.
+void
+literal_matcher::add_alternative(const std::string& literal,
+				 bool at_beginning,
+				 bool at_end)
+{
+  if (at_beginning && at_end)
+    exact_.insert(literal);
+  else if (at_beginning)
+    prefixes_.push_back(literal);
+  else if (at_end)
+    suffixes_.push_back(literal);
+  else
+    substrings_.push_back(literal);
+}
+
+/// Create a matcher for a regular expression, if it's simple enough.
+///
+/// The regular expression must either be a top-level alternation of
+/// literals, each of them possibly anchored, or a possibly anchored
+/// parenthesized alternation of literals.
+///
+/// @param str the regular expression to consider.
+///
+/// @return the matcher for @p str, or nil if @p str is not simple
+/// enough.
+std::shared_ptr<literal_matcher>
+literal_matcher::create(const std::string& str)
+{
+  std::shared_ptr<literal_matcher> result(new literal_matcher);
+  std::string literal;
+  std::vector<std::string::size_type> bars;
+
+  if (!split_alternatives(str, 0, str.size(), bars))
+    return std::shared_ptr<literal_matcher>();
+
+  if (bars.empty())
+    {
+      // Look for an alternation in parenthesis, like in
+      // "^(foo|bar)$".
+      std::string::size_type begin = 0, end = str.size();
+      bool at_beginning = false, at_end = false;
+      if (!parse_anchors(str, begin, end, at_beginning, at_end))
+	return std::shared_ptr<literal_matcher>();
+      if (end - begin >= 2 && str[begin] == '(' && str[end - 1] == ')'
+	  && str[end - 2] != '\\')
+	{
+	  ++begin;
+	  --end;
+	  if (!split_alternatives(str, begin, end, bars))
+	    return std::shared_ptr<literal_matcher>();
+	  bars.push_back(end);
+	  for (std::string::size_type bar : bars)
+	    {
+	      if (!parse_literal(str, begin, bar, literal)
+		  || (literal.empty() && bars.size() > 1))
+		return std::shared_ptr<literal_matcher>();
+	      result->add_alternative(literal, at_beginning, at_end);
+	      begin = bar + 1;
+	    }
+	  return result;
+	}
+    }
+
+  // This is a top-level alternation, like in "^foo$|^bar".
+  bars.push_back(str.size());
+  std::string::size_type begin = 0;
+  for (std::string::size_type bar : bars)
+    {
+      std::string::size_type b = begin, e = bar;
+      bool at_beginning = false, at_end = false;
+      if (!parse_anchors(str, b, e, at_beginning, at_end)
+	  || !parse_literal(str, b, e, literal)
+	  || (b == e && bars.size() > 1))
+	return std::shared_ptr<literal_matcher>();
+      result->add_alternative(literal, at_beginning, at_end);
+      begin = bar + 1;
+    }
+  return result;
+}
+
+/// Test if a string matches the regular expression of the current
+/// matcher.
+///
+/// @param str the string to consider.
+///
+/// @return true iff @p str matches.
+bool
+literal_matcher::match(const std::string& str) const
+{
+  if (!exact_.empty() && exact_.find(str) != exact_.end())
+    return true;
+
+  for (const std::string& p : prefixes_)
+    if (str.compare(0, p.size(), p) == 0)
+      return true;
+
+  for (const std::string& s : suffixes_)
+    if (str.size() >= s.size()
+	&& str.compare(str.size() - s.size(), s.size(), s) == 0)
+      return true;
+
+  for (const std::string& s : substrings_)
+    if (str.find(s) != std::string::npos)
+      return true;
+
+  return false;
+}
+
 /// Escape regex special charaters in input string.
 ///
 /// @param os the output stream being written to.
@@ -104,16 +437,23 @@ generate_from_strings(const std::vector<std::string>& strs)
 /// The result is held in a shared pointer. This will be null if regex
 /// compilation fails.
 ///
+/// If the regex is an alternation of literal strings, possibly
+/// anchored, a matcher that doesn't use regexec is created as well.
+/// It's then used by regex::match.
+///
 /// @param str the string representation of the regex.
 ///
 /// @return shared pointer holder of a compiled regex object.
 regex_t_sptr
 compile(const std::string& str)
 {
-  regex_t_sptr r = sptr_utils::build_sptr(new regex_t);
-  if (regcomp(r.get(), str.c_str(), REG_EXTENDED))
-    r.reset();
-  return r;
+  std::unique_ptr<regex_t> p(new regex_t);
+  if (regcomp(p.get(), str.c_str(), REG_EXTENDED))
+    return regex_t_sptr();
+
+  compiled_regex_deleter deleter;
+  deleter.literals = literal_matcher::create(str);
+  return regex_t_sptr(p.release(), deleter);
 }
 
 /// See if a string matches a regex.
@@ -126,6 +466,10 @@ compile(const std::string& str)
 bool
 match(const regex_t_sptr& r, const std::string& str)
 {
+  if (const compiled_regex_deleter* d =
+      std::get_deleter<compiled_regex_deleter>(r))
+    if (d->literals)
+      return d->literals->match(str);
   return !regexec(r.get(), str.c_str(), 0, NULL, 0);
 }
 
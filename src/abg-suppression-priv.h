@@ -13,6 +13,9 @@
 #ifndef __ABG_SUPPRESSION_PRIV_H__
 #define __ABG_SUPPRESSION_PRIV_H__
 
+#include <unordered_map>
+#include <vector>
+
 #include "abg-fwd.h"
 #include "abg-regex.h"
 #include "abg-sptr-utils.h"
@@ -32,6 +35,7 @@ class suppression_base::priv
   bool					is_artificial_;
   bool					drops_artifact_;
   string				label_;
+  uint64_t				source_hash_;
   string				file_name_regex_str_;
   mutable regex::regex_t_sptr		file_name_regex_;
   string				file_name_not_regex_str_;
@@ -44,13 +48,15 @@ class suppression_base::priv
 public:
   priv()
     : is_artificial_(),
-      drops_artifact_()
+      drops_artifact_(),
+      source_hash_()
   {}
 
   priv(const string& label)
     : is_artificial_(),
       drops_artifact_(),
-      label_(label)
+      label_(label),
+      source_hash_()
   {}
 
   priv(const string& label,
@@ -59,6 +65,7 @@ public:
     : is_artificial_(),
       drops_artifact_(),
       label_(label),
+      source_hash_(),
       file_name_regex_str_(file_name_regex_str),
       file_name_not_regex_str_(file_name_not_regex_str)
   {}
@@ -743,6 +750,83 @@ suppression_matches_type_name_or_location(const type_suppression& s,
 
 // </type_suppression stuff>
 
+// <suppressions_index stuff>
+
+/// An index of the function and variable suppression specifications
+/// used to compare two corpora.
+///
+/// For a given function, variable or ELF symbol, the index returns
+/// the suppression specifications that might suppress change reports
+/// about it, leaving out those that can't possibly suppress them:
+///
+///   - the suppression specifications which "file_name_*" or
+///     "soname_*" properties don't match the binaries being compared;
+///
+///   - the suppression specifications which "name" or "symbol_name"
+///     property is different from the name of the artifact.
+///
+/// The suppression specifications that are returned still need to be
+/// evaluated against the artifact; the index just avoids evaluating
+/// the others.  They are returned in the order in which they appear
+/// in the set of suppression specifications the index was built
+/// from.
+class suppressions_index
+{
+  typedef std::unordered_map<string, vector<size_t>> string_indexes_map_type;
+
+  vector<function_suppression_sptr>	fn_supprs_;
+  // Indexes into fn_supprs_ of the suppressions that have a "name"
+  // property, keyed by that property.
+  string_indexes_map_type		fns_per_name_;
+  // Indexes into fn_supprs_ of the suppressions that have a
+  // "symbol_name" property but no "name" property, keyed by
+  // "symbol_name".
+  string_indexes_map_type		fns_per_symbol_name_;
+  vector<size_t>			fns_with_symbol_name_;
+  vector<size_t>			other_fns_;
+  // Indexes into fn_supprs_ of the suppressions that have a
+  // "symbol_name" property, keyed by it, for matching ELF symbols.
+  string_indexes_map_type		fn_syms_per_symbol_name_;
+  vector<size_t>			other_fn_syms_;
+
+  vector<variable_suppression_sptr>	var_supprs_;
+  // Indexes into var_supprs_ of the suppressions that have a "name"
+  // property, keyed by that property.
+  string_indexes_map_type		vars_per_name_;
+  // Indexes into var_supprs_ of the suppressions that have a
+  // "symbol_name" property but no "name" property, keyed by
+  // "symbol_name".
+  string_indexes_map_type		vars_per_symbol_name_;
+  vector<size_t>			other_vars_;
+  // Indexes into var_supprs_ of the suppressions that have a "name"
+  // or a "symbol_name" property, keyed by the former or else by the
+  // latter, for matching ELF symbols.
+  string_indexes_map_type		var_syms_per_name_;
+  vector<size_t>			other_var_syms_;
+
+public:
+  suppressions_index(const suppressions_type& supprs,
+		     const comparison::diff_context& ctxt);
+
+  void
+  get_function_suppressions(const function_decl& fn,
+			    vector<function_suppression_sptr>& result) const;
+
+  void
+  get_function_symbol_suppressions
+  (const elf_symbol& sym, vector<function_suppression_sptr>& result) const;
+
+  void
+  get_variable_suppressions(const var_decl& var,
+			    vector<variable_suppression_sptr>& result) const;
+
+  void
+  get_variable_symbol_suppressions
+  (const elf_symbol& sym, vector<variable_suppression_sptr>& result) const;
+}; // end class suppressions_index
+
+// </suppressions_index stuff>
+
 }// end namespace suppr
 } // end namespace abigail
 
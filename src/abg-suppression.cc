@@ -11,6 +11,8 @@
 /// libabigail.
 
 #include <algorithm>
+#include <fstream>
+#include <sstream>
 
 #include "abg-internal.h"
 #include <memory>
@@ -20,6 +22,7 @@
 ABG_BEGIN_EXPORT_DECLARATIONS
 
 #include "abg-ini.h"
+#include "abg-hash.h"
 #include "abg-comp-filter.h"
 #include "abg-suppression.h"
 #include "abg-tools-utils.h"
@@ -151,6 +154,26 @@ void
 suppression_base::set_label(const string& label)
 {priv_->label_ = label;}
 
+/// Getter for the hash of the text this suppression specification
+/// was read from.
+///
+/// Suppression specifications read from the same file have the same
+/// hash, which changes whenever the content of the file changes.
+///
+/// @return the hash, or zero if the suppression specification was
+/// not read from a text.
+uint64_t
+suppression_base::get_source_hash() const
+{return priv_->source_hash_;}
+
+/// Setter for the hash of the text this suppression specification
+/// was read from.
+///
+/// @param h the new hash.
+void
+suppression_base::set_source_hash(uint64_t h)
+{priv_->source_hash_ = h;}
+
 /// Setter for the "file_name_regex" property of the current instance
 /// of @ref suppression_base.
 ///
@@ -447,8 +470,16 @@ void
 read_suppressions(std::istream& input,
 		  suppressions_type& suppressions)
 {
-    if (ini::config_sptr config = ini::read_config(input))
+  std::stringstream text;
+  text << input.rdbuf();
+
+  size_t first = suppressions.size();
+  if (ini::config_sptr config = ini::read_config(text))
     read_suppressions(*config, suppressions);
+
+  uint64_t hash = hashing::fnv_hash64(text.str());
+  for (size_t i = first; i < suppressions.size(); ++i)
+    suppressions[i]->set_source_hash(hash);
 }
 
 /// Read suppressions specifications from an input file on disk.
@@ -461,8 +492,18 @@ void
 read_suppressions(const string& file_path,
 		  suppressions_type& suppressions)
 {
+  size_t first = suppressions.size();
   if (ini::config_sptr config = ini::read_config(file_path))
     read_suppressions(*config, suppressions);
+  if (first == suppressions.size())
+    return;
+
+  std::ifstream input(file_path.c_str());
+  std::stringstream text;
+  text << input.rdbuf();
+  uint64_t hash = hashing::fnv_hash64(text.str());
+  for (size_t i = first; i < suppressions.size(); ++i)
+    suppressions[i]->set_source_hash(hash);
 }
 // </suppression_base stuff>
 
@@ -5151,5 +5192,218 @@ is_data_member_offset_in_range(const var_decl_sptr& dm,
   return true;
 }
 
+
+// <suppressions_index stuff>
+
+/// Test if a suppression specification can match artifacts of the
+/// binaries being compared in a given diff context, considering its
+/// "file_name_*" and "soname_*" properties.
+///
+/// @param s the suppression specification to consider.
+///
+/// @param ctxt the diff context to consider.
+///
+/// @return true iff @p s can match artifacts of the binaries being
+/// compared in @p ctxt.
+static bool
+suppression_matches_binaries(const suppression_base& s,
+			     const diff_context& ctxt)
+{
+  if (!ctxt.get_corpus_diff())
+    return true;
+
+  if (s.has_file_name_related_property()
+      && !names_of_binaries_match(s, ctxt))
+    return false;
+
+  if (s.has_soname_related_property()
+      && !sonames_of_binaries_match(s, ctxt))
+    return false;
+
+  return true;
+}
+
+/// Append the suppression specifications that are stored at some
+/// indexes of a vector of suppression specifications to a result
+/// vector, in the order of the indexes.
+///
+/// @param supprs the suppression specifications to consider.
+///
+/// @param indexes the indexes of the suppression specifications to
+/// append.  The vector is sorted and its duplicates are removed.
+///
+/// @param result the vector to append the suppression specifications
+/// to.
+template<typename suppression_sptr_type>
+static void
+get_suppressions_at(const vector<suppression_sptr_type>& supprs,
+		    vector<size_t>& indexes,
+		    vector<suppression_sptr_type>& result)
+{
+  std::sort(indexes.begin(), indexes.end());
+  indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+  for (size_t i : indexes)
+    result.push_back(supprs[i]);
+}
+
+/// Append the indexes stored under a key in a map to a vector.
+///
+/// @param m the map to consider.
+///
+/// @param key the key to look up in @p m.
+///
+/// @param indexes the vector to append the indexes to.
+static void
+append_indexes_of(const std::unordered_map<string, vector<size_t>>& m,
+		  const string& key,
+		  vector<size_t>& indexes)
+{
+  auto i = m.find(key);
+  if (i != m.end())
+    indexes.insert(indexes.end(), i->second.begin(), i->second.end());
+}
+
+/// Constructor of the @ref suppressions_index type.
+///
+/// @param supprs the suppression specifications to index.  Only the
+/// function and variable suppression specifications are considered.
+///
+/// @param ctxt the diff context in which the suppression
+/// specifications are going to be evaluated.  If a corpus diff is
+/// associated to it, the suppression specifications that can't match
+/// the binaries being compared are left out of the index.
+suppressions_index::suppressions_index(const suppressions_type& supprs,
+				       const diff_context& ctxt)
+{
+  for (const suppression_sptr& s : supprs)
+    {
+      if (!suppression_matches_binaries(*s, ctxt))
+	continue;
+
+      if (function_suppression_sptr fn_suppr = is_function_suppression(s))
+	{
+	  size_t i = fn_supprs_.size();
+	  fn_supprs_.push_back(fn_suppr);
+
+	  const string& name = fn_suppr->get_name();
+	  const string& symbol_name = fn_suppr->get_symbol_name();
+	  if (!name.empty())
+	    fns_per_name_[name].push_back(i);
+	  else if (!symbol_name.empty())
+	    {
+	      // A function that has no symbol is not filtered by the
+	      // "symbol_name" property.
+	      fns_per_symbol_name_[symbol_name].push_back(i);
+	      fns_with_symbol_name_.push_back(i);
+	    }
+	  else
+	    other_fns_.push_back(i);
+
+	  if (!symbol_name.empty())
+	    fn_syms_per_symbol_name_[symbol_name].push_back(i);
+	  else
+	    other_fn_syms_.push_back(i);
+	}
+      else if (variable_suppression_sptr var_suppr =
+	       is_variable_suppression(s))
+	{
+	  size_t i = var_supprs_.size();
+	  var_supprs_.push_back(var_suppr);
+
+	  const string& name = var_suppr->get_name();
+	  const string& symbol_name = var_suppr->get_symbol_name();
+	  if (!name.empty())
+	    vars_per_name_[name].push_back(i);
+	  else if (!symbol_name.empty())
+	    vars_per_symbol_name_[symbol_name].push_back(i);
+	  else
+	    other_vars_.push_back(i);
+
+	  // The "name" property of a variable suppression is matched
+	  // against the name of ELF symbols too.
+	  if (!name.empty())
+	    var_syms_per_name_[name].push_back(i);
+	  else if (!symbol_name.empty())
+	    var_syms_per_name_[symbol_name].push_back(i);
+	  else
+	    other_var_syms_.push_back(i);
+	}
+    }
+}
+
+/// Get the function suppression specifications that might suppress
+/// change reports about a given function.
+///
+/// @param fn the function to consider.
+///
+/// @param result out parameter.  The suppression specifications are
+/// appended to this vector.
+void
+suppressions_index::get_function_suppressions
+(const function_decl& fn, vector<function_suppression_sptr>& result) const
+{
+  vector<size_t> indexes = other_fns_;
+  append_indexes_of(fns_per_name_, fn.get_qualified_name(), indexes);
+  if (elf_symbol_sptr sym = fn.get_symbol())
+    append_indexes_of(fns_per_symbol_name_, sym->get_name(), indexes);
+  else
+    indexes.insert(indexes.end(),
+		   fns_with_symbol_name_.begin(),
+		   fns_with_symbol_name_.end());
+  get_suppressions_at(fn_supprs_, indexes, result);
+}
+
+/// Get the function suppression specifications that might suppress
+/// change reports about a given ELF symbol.
+///
+/// @param sym the ELF symbol to consider.
+///
+/// @param result out parameter.  The suppression specifications are
+/// appended to this vector.
+void
+suppressions_index::get_function_symbol_suppressions
+(const elf_symbol& sym, vector<function_suppression_sptr>& result) const
+{
+  vector<size_t> indexes = other_fn_syms_;
+  append_indexes_of(fn_syms_per_symbol_name_, sym.get_name(), indexes);
+  get_suppressions_at(fn_supprs_, indexes, result);
+}
+
+/// Get the variable suppression specifications that might suppress
+/// change reports about a given variable.
+///
+/// @param var the variable to consider.
+///
+/// @param result out parameter.  The suppression specifications are
+/// appended to this vector.
+void
+suppressions_index::get_variable_suppressions
+(const var_decl& var, vector<variable_suppression_sptr>& result) const
+{
+  vector<size_t> indexes = other_vars_;
+  append_indexes_of(vars_per_name_, var.get_qualified_name(), indexes);
+  if (elf_symbol_sptr sym = var.get_symbol())
+    append_indexes_of(vars_per_symbol_name_, sym->get_name(), indexes);
+  get_suppressions_at(var_supprs_, indexes, result);
+}
+
+/// Get the variable suppression specifications that might suppress
+/// change reports about a given ELF symbol.
+///
+/// @param sym the ELF symbol to consider.
+///
+/// @param result out parameter.  The suppression specifications are
+/// appended to this vector.
+void
+suppressions_index::get_variable_symbol_suppressions
+(const elf_symbol& sym, vector<variable_suppression_sptr>& result) const
+{
+  vector<size_t> indexes = other_var_syms_;
+  append_indexes_of(var_syms_per_name_, sym.get_name(), indexes);
+  get_suppressions_at(var_supprs_, indexes, result);
+}
+
+// </suppressions_index stuff>
+
 }// end namespace suppr
 } // end namespace abigail
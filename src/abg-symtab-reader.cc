@@ -86,12 +86,41 @@ const elf_symbols&
 symtab::lookup_symbol(const std::string& name) const
 {
   static const elf_symbols empty_result;
-  const auto it = name_symbol_map_.find(name);
-  if (it != name_symbol_map_.end())
-      return it->second;
+  const size_t hash = std::hash<std::string>()(name);
+  const auto range =
+    std::equal_range(name_symbol_index_.begin(), name_symbol_index_.end(),
+		     hash, name_symbol_index_entry_hash_less());
+  // Several names can have the same hash so compare the names of
+  // the candidate entries.
+  for (auto it = range.first; it != range.second; ++it)
+    if (it->symbols.front()->get_name() == name)
+      return it->symbols;
   return empty_result;
 }
 
+/// Lookup a symbol in an addr->symbol lookup index.
+///
+/// @param index the lookup index to consider.
+///
+/// @param addr the address of the symbol to look up.
+///
+/// @return an iterator to the entry of the symbol, or the end
+/// iterator of @p index if no symbol was found at @p addr.
+template<typename Index>
+static auto
+lookup_addr_symbol_index(Index& index, GElf_Addr addr)
+  -> decltype(index.begin())
+{
+  const auto it =
+    std::lower_bound(index.begin(), index.end(), addr,
+		     [](const std::pair<GElf_Addr, elf_symbol_sptr>& e,
+			GElf_Addr a)
+		     {return e.first < a;});
+  if (it != index.end() && it->first == addr)
+    return it;
+  return index.end();
+}
+
 /// Lookup a symbol by its address
 ///
 /// @param symbol_addr the starting address of the symbol
@@ -101,15 +130,17 @@ const elf_symbol_sptr&
 symtab::lookup_symbol(GElf_Addr symbol_addr) const
 {
   static const elf_symbol_sptr empty_result;
-  const auto addr_it = addr_symbol_map_.find(symbol_addr);
-  if (addr_it != addr_symbol_map_.end())
+  const auto addr_it =
+    lookup_addr_symbol_index(addr_symbol_index_, symbol_addr);
+  if (addr_it != addr_symbol_index_.end())
     return addr_it->second;
   else
     {
       // check for a potential entry address mapping instead,
       // relevant for ppc ELFv1 binaries
-      const auto entry_it = entry_addr_symbol_map_.find(symbol_addr);
-      if (entry_it != entry_addr_symbol_map_.end())
+      const auto entry_it =
+	lookup_addr_symbol_index(entry_addr_symbol_index_, symbol_addr);
+      if (entry_it != entry_addr_symbol_index_.end())
 	return entry_it->second;
     }
   return empty_result;
@@ -144,10 +175,15 @@ symtab::load(Elf*	      elf_handle,
 {
   ABG_ASSERT(elf_handle);
 
+  metrics::scoped_phase phase(env.get_metrics(), "symtab.load");
   symtab_ptr result(new symtab);
   if (!result->load_(elf_handle, env, is_suppressed))
     return {};
 
+  env.get_metrics().increment_counter("symtab.symbols",
+				      result->symbols_.size());
+  env.get_metrics().increment_counter("symtab.lookup-index-bytes",
+				      result->get_lookup_indexes_size());
   return result;
 }
 
@@ -401,18 +437,24 @@ symtab::load_(Elf*	       elf_handle,
 	setup_symbol_lookup_tables(elf_handle, sym, symbol_sptr);
     }
 
+  // From now on, the name->symbol(s) lookups are done with the
+  // lookup index.
+  build_name_symbol_index();
+
   add_alternative_address_lookups(elf_handle);
 
+  build_addr_symbol_indexes();
+
   is_kernel_binary_ = elf_helpers::is_linux_kernel(elf_handle);
 
   // Now apply the ksymtab_exported attribute to the symbols we collected.
   for (const auto& symbol : exported_kernel_symbols)
     {
-      const auto r = name_symbol_map_.find(symbol);
-      if (r == name_symbol_map_.end())
+      const elf_symbols& r = lookup_symbol(symbol);
+      if (r.empty())
 	continue;
 
-      for (const auto& elf_symbol : r->second)
+      for (const auto& elf_symbol : r)
 	  if (elf_symbol->is_public())
 	    elf_symbol->set_is_in_ksymtab(true);
       has_ksymtab_entries_ = true;
@@ -421,22 +463,16 @@ symtab::load_(Elf*	       elf_handle,
   // Now add the CRC values
   for (const auto& crc_entry : crc_values)
     {
-      const auto r = name_symbol_map_.find(crc_entry.first);
-      if (r == name_symbol_map_.end())
-	continue;
-
-      for (const auto& symbol : r->second)
+      const elf_symbols& r = lookup_symbol(crc_entry.first);
+      for (const auto& symbol : r)
 	symbol->set_crc(crc_entry.second);
     }
 
   // Now add the namespaces
   for (const auto& namespace_entry : namespaces)
     {
-      const auto r = name_symbol_map_.find(namespace_entry.first);
-      if (r == name_symbol_map_.end())
-	continue;
-
-      for (const auto& symbol : r->second)
+      const elf_symbols& r = lookup_symbol(namespace_entry.first);
+      for (const auto& symbol : r)
 	symbol->set_namespace(namespace_entry.second);
     }
 
@@ -484,6 +520,8 @@ symtab::load_(string_elf_symbols_map_sptr function_symbol_map,
 	ABG_ASSERT(name_symbol_map_.insert(symbol_map_entry).second);
       }
 
+  build_name_symbol_index();
+
   // sort the symbols for deterministic output
   std::sort(symbols_.begin(), symbols_.end(), symbol_sort);
 
@@ -518,7 +556,30 @@ symtab::update_main_symbol(GElf_Addr addr, const std::string& name)
 
   // also update the default symbol we return when looked up by address
   if (new_main)
-    addr_symbol_map_[addr] = new_main;
+    {
+      const auto it = lookup_addr_symbol_index(addr_symbol_index_, addr);
+      if (it != addr_symbol_index_.end())
+	it->second = new_main;
+    }
+}
+
+/// Getter of the size of the memory used by the lookup indexes of
+/// the symtab.
+///
+/// This does not account for the symbols themselves.
+///
+/// @return the size of the lookup indexes, in bytes.
+size_t
+symtab::get_lookup_indexes_size() const
+{
+  size_t result =
+    name_symbol_index_.capacity() * sizeof(name_symbol_index_entry)
+    + addr_symbol_index_.capacity() * sizeof(addr_symbol_index_type::value_type)
+    + entry_addr_symbol_index_.capacity()
+    * sizeof(addr_symbol_index_type::value_type);
+  for (const name_symbol_index_entry& e : name_symbol_index_)
+    result += e.symbols.capacity() * sizeof(elf_symbol_sptr);
+  return result;
 }
 
 /// Various adjustments and bookkeeping may be needed to provide a correct
@@ -736,5 +797,74 @@ symtab::add_alternative_address_lookups(Elf* elf_handle)
     }
 }
 
+/// Build the name->symbol(s) lookup index from the name->symbol(s)
+/// lookup map and release the map.
+///
+/// The index is a vector sorted by hash of the symbol names.  It
+/// uses a lot less memory than the map as it doesn't store the
+/// names, which are already owned by the symbols, nor the nodes and
+/// buckets of a hash table.  A lookup is a binary search.
+void
+symtab::build_name_symbol_index()
+{
+  name_symbol_index_.clear();
+  name_symbol_index_.reserve(name_symbol_map_.size());
+  std::hash<std::string> hash;
+  for (auto& entry : name_symbol_map_)
+    {
+      if (entry.second.empty())
+	continue;
+      name_symbol_index_.push_back(name_symbol_index_entry());
+      name_symbol_index_.back().hash = hash(entry.first);
+      name_symbol_index_.back().symbols.swap(entry.second);
+      name_symbol_index_.back().symbols.shrink_to_fit();
+    }
+  // Sort by hash, and by name for entries with the same hash so that
+  // the index doesn't depend on the order of the map.
+  std::sort(name_symbol_index_.begin(), name_symbol_index_.end(),
+	    [](const name_symbol_index_entry& l,
+	       const name_symbol_index_entry& r)
+	    {
+	      if (l.hash != r.hash)
+		return l.hash < r.hash;
+	      return (l.symbols.front()->get_name()
+		      < r.symbols.front()->get_name());
+	    });
+
+  name_symbol_map_type().swap(name_symbol_map_);
+}
+
+/// Build an addr->symbol lookup index from an addr->symbol lookup
+/// map and release the map.
+///
+/// @param map the map to build the index from.
+///
+/// @param index the resulting index, sorted by address.
+static void
+build_addr_symbol_index(std::unordered_map<GElf_Addr, elf_symbol_sptr>& map,
+			std::vector<std::pair<GElf_Addr,
+					      elf_symbol_sptr>>& index)
+{
+  index.assign(map.begin(), map.end());
+  std::sort(index.begin(), index.end(),
+	    [](const std::pair<GElf_Addr, elf_symbol_sptr>& l,
+	       const std::pair<GElf_Addr, elf_symbol_sptr>& r)
+	    {return l.first < r.first;});
+  std::unordered_map<GElf_Addr, elf_symbol_sptr>().swap(map);
+}
+
+/// Build the addr->symbol and function entry address->symbol lookup
+/// indexes from the corresponding lookup maps and release the maps.
+///
+/// Like for build_name_symbol_index, the indexes are sorted vectors
+/// that use less memory than the maps and that are looked up with a
+/// binary search.
+void
+symtab::build_addr_symbol_indexes()
+{
+  build_addr_symbol_index(addr_symbol_map_, addr_symbol_index_);
+  build_addr_symbol_index(entry_addr_symbol_map_, entry_addr_symbol_index_);
+}
+
 } // end namespace symtab_reader
 } // end namespace abigail
@@ -253,6 +253,9 @@ public:
   void
   update_main_symbol(GElf_Addr addr, const std::string& name);
 
+  size_t
+  get_lookup_indexes_size() const;
+
 private:
   /// Default constructor. Private to enforce creation by factory methods.
   symtab();
@@ -271,17 +274,59 @@ private:
   bool has_ksymtab_entries_;
 
   /// Lookup map name->symbol(s)
+  ///
+  /// This is only used while loading the symtab.  The name->symbol(s)
+  /// lookups are then done with name_symbol_index_.
   typedef std::unordered_map<std::string, std::vector<elf_symbol_sptr>>
 		       name_symbol_map_type;
   name_symbol_map_type name_symbol_map_;
 
+  /// An entry of the name->symbol(s) lookup index.  The name itself
+  /// is not stored as it's the name of the symbols.
+  struct name_symbol_index_entry
+  {
+    size_t	hash;
+    elf_symbols	symbols;
+  };
+
+  /// Compare the hashes of name_symbol_index_entry, to look them up
+  /// in name_symbol_index_ with a binary search.
+  struct name_symbol_index_entry_hash_less
+  {
+    bool
+    operator()(const name_symbol_index_entry& e, size_t h) const
+    {return e.hash < h;}
+
+    bool
+    operator()(size_t h, const name_symbol_index_entry& e) const
+    {return h < e.hash;}
+  };
+
+  /// Lookup index name->symbol(s), sorted by hash of the name.
+  typedef std::vector<name_symbol_index_entry> name_symbol_index_type;
+  name_symbol_index_type name_symbol_index_;
+
   /// Lookup map addr->symbol
+  ///
+  /// This is only used while loading the symtab.  The addr->symbol
+  /// lookups are then done with addr_symbol_index_.
   typedef std::unordered_map<GElf_Addr, elf_symbol_sptr> addr_symbol_map_type;
   addr_symbol_map_type addr_symbol_map_;
 
   /// Lookup map function entry address -> symbol
+  ///
+  /// This is only used while loading the symtab, like
+  /// addr_symbol_map_.
   addr_symbol_map_type entry_addr_symbol_map_;
 
+  /// Lookup index addr->symbol, sorted by address.
+  typedef std::vector<std::pair<GElf_Addr, elf_symbol_sptr>>
+		       addr_symbol_index_type;
+  addr_symbol_index_type addr_symbol_index_;
+
+  /// Lookup index function entry address -> symbol, sorted by address.
+  addr_symbol_index_type entry_addr_symbol_index_;
+
   bool
   load_(Elf* elf_handle,
 	const ir::environment& env,
@@ -303,6 +348,12 @@ private:
 
   void
   add_alternative_address_lookups(Elf* elf_handle);
+
+  void
+  build_name_symbol_index();
+
+  void
+  build_addr_symbol_indexes();
 };
 
 /// Helper class to allow range-for loops on symtabs for C++11 and later code.
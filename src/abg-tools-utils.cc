@@ -39,6 +39,8 @@
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <deque>
+#include <future>
 #include <iterator>
 #include <memory>
 #include <sstream>
@@ -51,7 +53,9 @@
 #include "abg-btf-reader.h"
 #endif
 #include "abg-internal.h"
+#include "abg-hash.h"
 #include "abg-regex.h"
+#include "abg-workers.h"
 
 // <headers defining libabigail's API go under here>
 ABG_BEGIN_EXPORT_DECLARATIONS
@@ -325,6 +329,34 @@ operator<<(ostream& o, const timer& t)
   return o;
 }
 
+/// Constructor of the @ref scoped_profile_emitter type.
+///
+/// @param r the registry of performance metrics to emit.  It's
+/// enabled if @p path is not empty.
+///
+/// @param path the path to the file to emit the metrics into.  If
+/// it's empty, nothing is emitted.
+scoped_profile_emitter::scoped_profile_emitter(metrics::registry& r,
+					       const string& path)
+  : registry_(r),
+    path_(path)
+{
+  if (!path_.empty())
+    registry_.enable(true);
+}
+
+/// Destructor of the @ref scoped_profile_emitter type.
+///
+/// This emits the metrics into the file, if any.
+scoped_profile_emitter::~scoped_profile_emitter()
+{
+  if (path_.empty())
+    return;
+
+  if (!registry_.emit_json(path_))
+    std::cerr << "could not write the profile to '" << path_ << "'\n";
+}
+
 /// Get the stat struct (as returned by the lstat() function of the C
 /// library) of a file.  Note that the function uses lstat, so that
 /// callers can detect symbolic links.
@@ -2195,6 +2227,9 @@ gen_suppr_spec_from_kernel_abi_whitelists
       // Build a regular expression representing the union of all
       // the function and variable names expressed in the white list.
       const std::string regex = regex::generate_from_strings(whitelisted_names);
+      // The suppressions are fully determined by the regular
+      // expression, so that's what their source is.
+      uint64_t source_hash = hashing::fnv_hash64(regex);
 
       // Build a suppression specification which *keeps* functions
       // whose ELF symbols match the regular expression contained
@@ -2205,6 +2240,7 @@ gen_suppr_spec_from_kernel_abi_whitelists
       fn_suppr->set_label("whitelist");
       fn_suppr->set_symbol_name_not_regex_str(regex);
       fn_suppr->set_drops_artifact_from_ir(true);
+      fn_suppr->set_source_hash(source_hash);
       result.push_back(fn_suppr);
 
       // Build a suppression specification which *keeps* variables
@@ -2216,6 +2252,7 @@ gen_suppr_spec_from_kernel_abi_whitelists
       var_suppr->set_label("whitelist");
       var_suppr->set_symbol_name_not_regex_str(regex);
       var_suppr->set_drops_artifact_from_ir(true);
+      var_suppr->set_source_hash(source_hash);
       result.push_back(var_suppr);
     }
   return result;
@@ -2265,6 +2302,39 @@ get_default_user_suppression_file_path()
   return default_user_suppr_path;
 }
 
+/// Get the path to the directory of the on-disk cache of ABI
+/// corpora.
+///
+/// The directory is set by the environment variable
+/// LIBABIGAIL_CORPUS_CACHE_DIR.
+///
+/// @return the path to the directory of the cache, or an empty
+/// string if the cache is not to be used.
+string
+get_corpus_cache_dir_path()
+{
+  const char *s = getenv("LIBABIGAIL_CORPUS_CACHE_DIR");
+  if (s == NULL)
+    return "";
+  return s;
+}
+
+/// Get the maximum size of the on-disk cache of ABI corpora.
+///
+/// The size is set, in mebibytes, by the environment variable
+/// LIBABIGAIL_CORPUS_CACHE_MAX_SIZE.
+///
+/// @return the maximum size of the cache, in bytes, or zero if the
+/// size of the cache is not limited.
+uint64_t
+get_corpus_cache_max_size()
+{
+  const char *s = getenv("LIBABIGAIL_CORPUS_CACHE_MAX_SIZE");
+  if (s == NULL)
+    return 0;
+  return strtoull(s, NULL, 10) * 1024 * 1024;
+}
+
 /// Load the default system suppression specification file and
 /// populate a vector of @ref suppression_sptr with its content.
 ///
@@ -2687,6 +2757,53 @@ get_binary_paths_from_kernel_dist(const string&	dist_root,
 					   module_paths);
 }
 
+/// Create a reader for a Linux kernel module, of the same kind as the
+/// reader that was used to read the vmlinux binary.
+///
+/// This opens the ELF file of the module and locates its split and
+/// alternate debug info files, but doesn't build any IR artifact.  It
+/// thus doesn't touch the environment and can be invoked from a
+/// worker thread.
+///
+/// Note that the corpus of a kernel module is built in the context
+/// of a corpus group, so it's never put in the cache of ABI corpora.
+/// The cache is thus not set up for the returned reader.
+///
+/// @param module_path the path to the kernel module.
+///
+/// @param di_roots the directories where to look for debug info.
+///
+/// @param env the environment the reader is to use.
+///
+/// @param vmlinux_origin the origin of the corpus of the vmlinux
+/// binary.  This designates the kind of front-end to create.
+///
+/// @return the newly created reader.
+static elf_based_reader_sptr
+create_kernel_module_reader(const string&		module_path,
+			    const vector<char**>&	di_roots,
+			    environment&		env,
+			    corpus::origin		vmlinux_origin)
+{
+  elf_based_reader_sptr result;
+#ifdef WITH_CTF
+  if (vmlinux_origin & corpus::CTF_ORIGIN)
+    result = ctf::create_reader(module_path, di_roots, env);
+#endif
+#ifdef WITH_BTF
+  if (vmlinux_origin & corpus::BTF_ORIGIN)
+    result = btf::create_reader(module_path, di_roots, env,
+				/*load_all_types=*/false,
+				/*linux_kernel_mode=*/true);
+#endif
+  if (!result)
+    result = dwarf::create_reader(module_path, di_roots, env,
+				  /*read_all_types=*/false,
+				  /*linux_kernel_mode=*/true);
+
+  return result;
+}
+
 /// It builds a @ref corpus_group made of vmlinux kernel file and
 /// the kernel modules found under @p root directory and under its
 /// sub-directories, recursively.
@@ -2724,6 +2841,17 @@ get_binary_paths_from_kernel_dist(const string&	dist_root,
 /// @param t time to trace time spent in each step.
 ///
 /// @param env the environment to create the corpus_group in.
+///
+/// @param on_corpus_added if non-nil, this is invoked each time a
+/// corpus is read and added to @p group.
+///
+/// @param nb_opener_threads the number of threads to use to open the
+/// kernel modules.  If it's greater than one, the readers of the
+/// kernel modules are created (i.e, the module files are opened and
+/// their debug info located) by worker threads ahead of the reading
+/// of the modules.  The modules are not read concurrently though:
+/// their corpora are built and added to @p group one after the
+/// other, on the calling thread, in the order of @p modules.
 static void
 load_vmlinux_corpus(elf_based_reader_sptr rdr,
                     corpus_group_sptr&  group,
@@ -2736,7 +2864,9 @@ load_vmlinux_corpus(elf_based_reader_sptr rdr,
                     suppressions_type&  supprs,
                     bool                verbose,
                     timer&              t,
-                    environment&        env)
+                    environment&        env,
+                    const corpus_added_handler& on_corpus_added,
+                    size_t              nb_opener_threads)
 {
   abigail::fe_iface::status status = abigail::fe_iface::STATUS_OK;
   rdr->options().do_log = verbose;
@@ -2772,6 +2902,23 @@ load_vmlinux_corpus(elf_based_reader_sptr rdr,
   if (group->is_empty())
     return;
 
+  if (on_corpus_added)
+    on_corpus_added(group);
+
+  // When several threads are requested, the readers of the modules
+  // are created by worker threads, at most 2 * nb_opener_threads modules
+  // ahead of the module being read.  Building the corpus of a module
+  // re-uses the types of the corpora previously added to the group,
+  // so the modules are read on this thread, in their order.
+  // Otherwise, the resulting group would depend on the scheduling of
+  // the threads.
+  std::unique_ptr<workers::queue> module_opener;
+  std::deque<std::future<elf_based_reader_sptr>> opened_modules;
+  vector<string>::const_iterator next_module_to_open = modules.begin();
+  corpus::origin vmlinux_origin = group->get_main_corpus()->get_origin();
+  if (nb_opener_threads > 1)
+    module_opener.reset(new workers::queue(nb_opener_threads));
+
   // Now add the corpora of the modules to the corpus group.
   int total_nb_modules = modules.size();
   int cur_module_index = 1;
@@ -2786,9 +2933,29 @@ load_vmlinux_corpus(elf_based_reader_sptr rdr,
          << "/" << total_nb_modules
          << ") ... " << std::flush;
 
-      rdr->initialize(*m, di_roots,
-                      /*read_all_types=*/false,
-                      /*linux_kernel_mode=*/true);
+      if (module_opener)
+        {
+          for (;
+               next_module_to_open != modules.end()
+                 && opened_modules.size() < 2 * nb_opener_threads;
+               ++next_module_to_open)
+            {
+              const string& path = *next_module_to_open;
+              opened_modules.push_back
+                (module_opener->schedule_function<elf_based_reader_sptr>
+                 ([&path, &di_roots, &env, vmlinux_origin]()
+                  {
+                    return create_kernel_module_reader(path, di_roots, env,
+                                                       vmlinux_origin);
+                  }));
+            }
+          rdr = opened_modules.front().get();
+          opened_modules.pop_front();
+        }
+      else
+        rdr = create_kernel_module_reader(*m, di_roots, env,
+                                          vmlinux_origin);
+      rdr->options().do_log = verbose;
 
       load_generate_apply_suppressions(*rdr, suppr_paths,
                                        kabi_wl_paths, supprs);
@@ -2803,7 +2970,13 @@ load_vmlinux_corpus(elf_based_reader_sptr rdr,
          << *m
          << "' reading DONE: "
          << t << "\n";
+
+      if (on_corpus_added)
+        on_corpus_added(group);
     }
+
+  if (module_opener)
+    module_opener->wait_for_workers_to_complete();
 }
 
 /// Walk a given directory and build an instance of @ref corpus_group
@@ -2843,6 +3016,16 @@ load_vmlinux_corpus(elf_based_reader_sptr rdr,
 ///
 /// @param requested_fe_kind the kind of front-end requested by the
 /// user.
+///
+/// @param on_corpus_added if non-nil, this is invoked each time a
+/// corpus is read and added to the resulting corpus group.  This
+/// lets callers process each corpus, e.g. serialize it, as soon as
+/// it's built.
+///
+/// @param nb_opener_threads the number of threads to use to open the
+/// kernel modules ahead of reading them.  The modules themselves are
+/// read one after the other, on the calling thread.  The resulting
+/// corpus group is the same whatever this number is.
 corpus_group_sptr
 build_corpus_group_from_kernel_dist_under(const string&	root,
 					  const string		debug_info_root,
@@ -2852,7 +3035,9 @@ build_corpus_group_from_kernel_dist_under(const string&	root,
 					  suppressions_type&	supprs,
 					  bool			verbose,
 					  environment&		env,
-					  corpus::origin	requested_fe_kind)
+					  corpus::origin	requested_fe_kind,
+					  const corpus_added_handler& on_corpus_added,
+					  size_t		nb_opener_threads)
 {
   string vmlinux = vmlinux_path;
   corpus_group_sptr group;
@@ -2904,7 +3089,8 @@ build_corpus_group_from_kernel_dist_under(const string&	root,
       load_vmlinux_corpus(reader, group, vmlinux,
                           modules, root, di_roots,
                           suppr_paths, kabi_wl_paths,
-                          supprs, verbose, t, env);
+                          supprs, verbose, t, env, on_corpus_added,
+                          nb_opener_threads);
     }
 
   return group;
@@ -3003,6 +3189,12 @@ create_best_elf_based_reader(const string& elf_file_path,
 				    linux_kernel_mode);
     }
 
+  if (result)
+    {
+      result->options().corpus_cache_dir = get_corpus_cache_dir_path();
+      result->options().corpus_cache_max_size = get_corpus_cache_max_size();
+    }
+
   return result;
 }
 
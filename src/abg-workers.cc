@@ -14,6 +14,9 @@
 #include <assert.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <queue>
 #include <vector>
 #include <iostream>
@@ -44,17 +47,25 @@ namespace workers
 /// threads (these are native posix threads) that sits there, idle,
 /// until at least one @ref task is added to the queue.
 ///
-/// When a @ref task is added to the @ref queue, one thread is woken
-/// up, picks the @ref task, removes it from the @ref queue, and
-/// executes the instructions it carries.  We say the worker thread
-/// performs the @ref task.
+/// Each worker thread owns a queue of tasks to perform, ordered by
+/// priority.  When a @ref task is added to the @ref queue, it's put
+/// into the queue of one worker thread and an idle thread is woken
+/// up.  A worker thread picks the @ref task of highest priority from
+/// its own queue, removes it from there, and executes the
+/// instructions it carries.  We say the worker thread performs the
+/// @ref task.  When the queue of a worker thread is empty, the
+/// worker thread steals the @ref task of highest priority from the
+/// queue of another worker thread.
 ///
 /// When the worker thread is done performing the @ref task, the
 /// performed @ref task is added to another queue, named as the "done
-/// queue".  Then the thread looks at the @ref queue of tasks to be
-/// performed again, and if there is at least one task in that queue,
-/// the same process as above is done.  Otherwise, the thread blocks,
-/// waiting for a new task to be added to the queue.
+/// queue".  Then the thread looks for another task to perform, as
+/// described above.  If there is none, the thread blocks, waiting for
+/// a new task to be added to the queue.
+///
+/// A @ref task being performed can itself add new tasks to the @ref
+/// queue.  Those are put into the queue of the worker thread
+/// performing the @ref task.
 ///
 /// By default, the number of worker threads is equal to the number of
 /// execution threads advertised by the underlying processor.
@@ -75,6 +86,32 @@ size_t
 get_number_of_threads()
 {return sysconf(_SC_NPROCESSORS_ONLN);}
 
+/// A task that is scheduled for execution, together with its
+/// scheduling order.
+struct scheduled_task
+{
+  task_sptr	t;
+  size_t	priority;
+  // The rank of the task in the sequence of scheduled tasks.  Among
+  // the tasks of the same priority, the ones that were scheduled
+  // first are performed first.
+  uint64_t	rank;
+
+  scheduled_task(const task_sptr& task, size_t p, uint64_t r)
+    : t(task), priority(p), rank(r)
+  {}
+
+  /// Ordering of the scheduled tasks of a std::priority_queue, whose
+  /// top is the task to perform next.
+  bool
+  operator<(const scheduled_task& o) const
+  {
+    if (priority != o.priority)
+      return priority < o.priority;
+    return rank > o.rank;
+  }
+}; // end struct scheduled_task
+
 /// The abstraction of a worker thread.
 ///
 /// This is an implementation detail of the @ref queue public
@@ -82,15 +119,33 @@ get_number_of_threads()
 struct worker
 {
   pthread_t tid;
-
-  worker()
-    : tid()
+  // The index of the worker in the vector of workers of the queue.
+  size_t index;
+  // The private data of the queue the worker belongs to.
+  queue::priv* queue_priv;
+  // A mutex that protects the tasks of this worker from being
+  // accessed by this worker and by thieves at the same time.
+  std::mutex tasks_mutex;
+  // The tasks to be performed by this worker, unless they get stolen.
+  std::priority_queue<scheduled_task> tasks;
+
+  worker(queue::priv* p, size_t i)
+    : tid(), index(i), queue_priv(p)
   {}
 
-  static queue::priv*
-  wait_to_execute_a_task(queue::priv*);
+  bool
+  push_task(const scheduled_task&);
+
+  bool
+  pop_task(task_sptr&);
+
+  static worker*
+  wait_to_execute_a_task(worker*);
 }; // end struct worker
 
+/// The worker thread the current thread is, if any.
+static thread_local worker* current_worker;
+
 // </worker declarations>
 
 // <queue stuff>
@@ -99,28 +154,36 @@ struct worker
 struct queue::priv
 {
   // A boolean to say if the user wants to shutdown the worker
-  // threads. guarded by tasks_todo_mutex.
-  // TODO: once we have std::atomic<bool>, use it and reconsider the
-  // synchronization around its reads and writes
-  bool				bring_workers_down;
+  // threads.
+  std::atomic<bool>		bring_workers_down;
   // The number of worker threads.
   size_t			num_workers;
-  // A mutex that protects the todo tasks queue from being accessed in
-  // read/write by two threads at the same time.
-  pthread_mutex_t		tasks_todo_mutex;
-  // The queue condition variable.  This condition is used to make the
-  // worker threads sleep until a new task is added to the queue of
-  // todo tasks.  Whenever a new task is added to that queue, a signal
-  // is sent to all a thread sleeping on this condition variable.
-  pthread_cond_t		tasks_todo_cond;
+  // The number of tasks that are scheduled but not yet picked up by
+  // a worker.
+  std::atomic<size_t>		num_tasks_todo;
+  // The number of tasks that are scheduled but not yet performed.
+  // This is guarded by tasks_done_mutex.
+  size_t			num_tasks_pending;
+  // The number of worker threads that are sleeping, waiting for a
+  // task to be scheduled.
+  std::atomic<size_t>		num_idle_workers;
+  // The number of tasks scheduled so far.  This is used to rank the
+  // tasks of the same priority.
+  std::atomic<uint64_t>		num_tasks_scheduled;
+  // A mutex used along with the idle_cond condition variable below.
+  std::mutex			idle_mutex;
+  // This condition is used to make the worker threads sleep until a
+  // new task is added to the queue of todo tasks.  Whenever a new
+  // task is added to that queue, a signal is sent to a thread
+  // sleeping on this condition variable, if any.
+  std::condition_variable	idle_cond;
   // A mutex that protects the done tasks queue from being accessed in
   // read/write by two threads at the same time.
-  pthread_mutex_t		tasks_done_mutex;
-  // A condition to be signalled whenever there is a task done. That is being
-  // used to wait for tasks completed when bringing the workers down.
-  pthread_cond_t		tasks_done_cond;
-  // The todo task queue itself.
-  std::queue<task_sptr>	tasks_todo;
+  std::mutex			tasks_done_mutex;
+  // A condition to be signalled whenever all the pending tasks are
+  // done. That is being used to wait for tasks completed when
+  // bringing the workers down.
+  std::condition_variable	tasks_done_cond;
   // The done task queue itself.
   std::vector<task_sptr>	tasks_done;
   // This functor is invoked to notify the user of this queue that a
@@ -134,7 +197,7 @@ struct queue::priv
   // default one.
   task_done_notify&		notify;
   // A vector of the worker threads.
-  std::vector<worker>		workers;
+  std::vector<std::unique_ptr<worker>> workers;
 
   /// A constructor of @ref queue::priv.
   ///
@@ -148,10 +211,10 @@ struct queue::priv
 	      task_done_notify& n = default_notify)
     : bring_workers_down(),
       num_workers(nb_workers),
-      tasks_todo_mutex(),
-      tasks_todo_cond(),
-      tasks_done_mutex(),
-      tasks_done_cond(),
+      num_tasks_todo(),
+      num_tasks_pending(),
+      num_idle_workers(),
+      num_tasks_scheduled(),
       notify(n)
   {create_workers();}
 
@@ -161,37 +224,58 @@ struct queue::priv
   create_workers()
   {
     for (unsigned i = 0; i < num_workers; ++i)
-      {
-	worker w;
-	ABG_ASSERT(pthread_create(&w.tid,
-			      /*attr=*/0,
-			      (void*(*)(void*))&worker::wait_to_execute_a_task,
-			      this) == 0);
-	workers.push_back(w);
-      }
+      workers.push_back(std::unique_ptr<worker>(new worker(this, i)));
+
+    for (auto& w : workers)
+      ABG_ASSERT(pthread_create(&w->tid,
+				/*attr=*/0,
+				(void*(*)(void*))&worker::wait_to_execute_a_task,
+				w.get()) == 0);
   }
 
   /// Submit a task to the queue of tasks to be performed.
   ///
-  /// This wakes up one thread from the pool which immediatly starts
-  /// performing the task.  When it's done with the task, it goes back
-  /// to be suspended, waiting for a new task to be scheduled.
+  /// If this is invoked by a worker thread of this queue (that is,
+  /// from within the task::perform member function of a task
+  /// performed by this queue), the task is queued on that worker
+  /// thread.  Otherwise, the tasks are spread on the worker threads
+  /// in a round robin manner.  An idle worker thread is then woken
+  /// up, if any.
   ///
   /// @param t the task to schedule.  Note that a nil task won't be
   /// scheduled.  If the queue is empty, the task @p t won't be
   /// scheduled either.
   ///
+  /// @param priority the priority of the task.  Tasks of greater
+  /// priority are performed first.
+  ///
   /// @return true iff the task @p t was successfully scheduled.
   bool
-  schedule_task(const task_sptr& t)
+  schedule_task(const task_sptr& t, size_t priority)
   {
     if (workers.empty() || !t)
       return false;
 
-    pthread_mutex_lock(&tasks_todo_mutex);
-    tasks_todo.push(t);
-    pthread_mutex_unlock(&tasks_todo_mutex);
-    pthread_cond_signal(&tasks_todo_cond);
+    {
+      std::lock_guard<std::mutex> lock(tasks_done_mutex);
+      ++num_tasks_pending;
+    }
+
+    uint64_t rank = num_tasks_scheduled++;
+    worker* w = current_worker;
+    if (!w || w->queue_priv != this)
+      w = workers[rank % workers.size()].get();
+    w->push_task(scheduled_task(t, priority, rank));
+
+    // Wake up an idle worker, if any.  The increment of
+    // num_tasks_todo by worker::push_task and the read of
+    // num_idle_workers below pair with the converse operations in
+    // worker::wait_to_execute_a_task so that no wake-up is lost.
+    if (num_idle_workers.load())
+      {
+	std::lock_guard<std::mutex> lock(idle_mutex);
+	idle_cond.notify_one();
+      }
     return true;
   }
 
@@ -207,21 +291,69 @@ struct queue::priv
   {
     bool is_ok= true;
     for (tasks_type::const_iterator t = tasks.begin(); t != tasks.end(); ++t)
-      is_ok &= schedule_task(*t);
+      is_ok &= schedule_task(*t, /*priority=*/0);
     return is_ok;
   }
 
-  /// Signal all the threads (of the pool) which are suspended and
-  /// waiting to perform a task, so that they wake up and end up their
-  /// execution.  If there is no task to perform, they just end their
-  /// execution.  If there are tasks to perform, they finish them and
-  /// then end their execution.
+  /// Pick the next task to perform by a given worker.
+  ///
+  /// The task is taken from the queue of the worker if it's not
+  /// empty, or stolen from the queue of another worker otherwise.
+  ///
+  /// @param w the worker to pick the task for.
+  ///
+  /// @param t out parameter.  This is set to the picked task, if
+  /// any.
+  ///
+  /// @return true iff a task was picked.
+  bool
+  pick_task(worker& w, task_sptr& t)
+  {
+    if (w.pop_task(t))
+      return true;
+
+    for (size_t i = 1; i < workers.size(); ++i)
+      if (workers[(w.index + i) % workers.size()]->pop_task(t))
+	return true;
+
+    return false;
+  }
+
+  /// Record that a task has been performed.
+  ///
+  /// The task is added to the vector of done tasks and the notifier
+  /// is invoked.
+  ///
+  /// Note that this (including the notification) is not happening in
+  /// parallel.  So the code performed by the notifier during the
+  /// notification is running sequentially, not in parallel with any
+  /// other task that was just done and that is notifying its
+  /// listeners.
+  ///
+  /// @param t the task that has been performed.
+  void
+  task_done(const task_sptr& t)
+  {
+    std::lock_guard<std::mutex> lock(tasks_done_mutex);
+    tasks_done.push_back(t);
+    notify(t);
+    if (--num_tasks_pending == 0)
+      tasks_done_cond.notify_all();
+  }
+
+  /// Wait for all the scheduled tasks to be performed, including
+  /// those that are scheduled by the tasks being performed.  Then
+  /// signal all the threads (of the pool) so that they wake up and
+  /// end up their execution.
   ///
   /// This function then joins all the tasks of the pool, waiting for
   /// them to finish, and then it returns.  In other words, this
   /// function suspends the thread of the caller, waiting for the
   /// worker threads to finish their tasks, and end their execution.
   ///
+  /// Note that this must not be invoked from within a task performed
+  /// by this queue.
+  ///
   /// If the user code wants to work with the thread pool again,
   /// she'll need to create them again, using the member function
   /// create_workers().
@@ -231,22 +363,20 @@ struct queue::priv
     if (workers.empty())
       return;
 
-    // Wait for the todo list to be empty to make sure all tasks got picked up
-    pthread_mutex_lock(&tasks_todo_mutex);
-    while (!tasks_todo.empty())
-      pthread_cond_wait(&tasks_done_cond, &tasks_todo_mutex);
-
-    bring_workers_down = true;
-    pthread_mutex_unlock(&tasks_todo_mutex);
+    {
+      std::unique_lock<std::mutex> lock(tasks_done_mutex);
+      while (num_tasks_pending)
+	tasks_done_cond.wait(lock);
+    }
 
-    // Now that the task queue is empty, drain the workers by waking them up,
-    // letting them finish their final task before termination.
-    ABG_ASSERT(pthread_cond_broadcast(&tasks_todo_cond) == 0);
+    {
+      std::lock_guard<std::mutex> lock(idle_mutex);
+      bring_workers_down = true;
+      idle_cond.notify_all();
+    }
 
-    for (std::vector<worker>::const_iterator i = workers.begin();
-	 i != workers.end();
-	 ++i)
-      ABG_ASSERT(pthread_join(i->tid, /*thread_return=*/0) == 0);
+    for (auto& w : workers)
+      ABG_ASSERT(pthread_join(w->tid, /*thread_return=*/0) == 0);
     workers.clear();
   }
 
@@ -299,7 +429,7 @@ queue::queue(unsigned number_of_workers,
 /// @return the number of task still present in the queue.
 size_t
 queue::get_size() const
-{return p_->tasks_todo.size();}
+{return p_->num_tasks_todo.load();}
 
 /// Submit a task to the queue of tasks to be performed.
 ///
@@ -307,13 +437,36 @@ queue::get_size() const
 /// performing the task.  When it's done with the task, it goes back
 /// to be suspended, waiting for a new task to be scheduled.
 ///
+/// This can be invoked from within the task::perform member function
+/// of a task performed by this queue.
+///
 /// @param t the task to schedule.  Note that if the queue is empty or
 /// if the task is nil, the task is not scheduled.
 ///
 /// @return true iff the task was successfully scheduled.
 bool
 queue::schedule_task(const task_sptr& t)
-{return p_->schedule_task(t);}
+{return p_->schedule_task(t, /*priority=*/0);}
+
+/// Submit a task of a given priority to the queue of tasks to be
+/// performed.
+///
+/// The priority is a scheduling hint: each worker thread performs
+/// the tasks of greater priority first.  Tasks of the same priority
+/// are performed in the order they were scheduled.
+///
+/// This can be invoked from within the task::perform member function
+/// of a task performed by this queue.
+///
+/// @param t the task to schedule.  Note that if the queue is empty or
+/// if the task is nil, the task is not scheduled.
+///
+/// @param priority the priority of the task.
+///
+/// @return true iff the task was successfully scheduled.
+bool
+queue::schedule_task(const task_sptr& t, size_t priority)
+{return p_->schedule_task(t, priority);}
 
 /// Submit a vector of tasks to the queue of tasks to be performed.
 ///
@@ -328,7 +481,8 @@ queue::schedule_tasks(const tasks_type& tasks)
 {return p_->schedule_tasks(tasks);}
 
 /// Suspends the current thread until all worker threads finish
-/// performing the tasks they are executing.
+/// performing the tasks they are executing, as well as the tasks
+/// that these scheduled in turn.
 ///
 /// If the worker threads were suspended waiting for a new task to
 /// perform, they are woken up and their execution ends.
@@ -363,67 +517,81 @@ queue::task_done_notify::operator()(const task_sptr&/*task_done*/)
 
 // <worker definitions>
 
-/// Wait to be woken up by a thread condition signal, then look if
-/// there is a task to be executed.  If there is, then pick one (in a
-/// FIFO manner), execute it, and put the executed task into the set
-/// of done tasks.
+/// Add a task to the queue of tasks of the worker.
 ///
-/// @param t the private data of the "task queue" type to consider.
+/// @param t the task to add.
 ///
-/// @param return the same private data of the task queue type we got
-/// in argument.
-queue::priv*
-worker::wait_to_execute_a_task(queue::priv* p)
+/// @return true.
+bool
+worker::push_task(const scheduled_task& t)
 {
+  std::lock_guard<std::mutex> lock(tasks_mutex);
+  tasks.push(t);
+  ++queue_priv->num_tasks_todo;
+  return true;
+}
+
+/// Remove the task of highest priority from the queue of tasks of
+/// the worker.
+///
+/// This is invoked by the worker itself as well as by other workers
+/// trying to steal a task from it.
+///
+/// @param t out parameter.  This is set to the removed task, if any.
+///
+/// @return true iff a task was removed.
+bool
+worker::pop_task(task_sptr& t)
+{
+  std::lock_guard<std::mutex> lock(tasks_mutex);
+  if (tasks.empty())
+    return false;
+  t = tasks.top().t;
+  tasks.pop();
+  --queue_priv->num_tasks_todo;
+  return true;
+}
+
+/// Look for a task to be executed, either in the queue of the worker
+/// or in the queues of the other workers.  If there is one, execute
+/// it and put the executed task into the set of done tasks.
+/// Otherwise, wait to be woken up by a thread condition signal.
+///
+/// @param w the worker to consider.
+///
+/// @param return the same worker we got in argument.
+worker*
+worker::wait_to_execute_a_task(worker* w)
+{
+  queue::priv* p = w->queue_priv;
+  current_worker = w;
+
   while (true)
     {
-      pthread_mutex_lock(&p->tasks_todo_mutex);
-      // If there is no more tasks to perform and the queue is not to
-      // be brought down then wait (sleep) for new tasks to come up.
-      while (p->tasks_todo.empty() && !p->bring_workers_down)
-	pthread_cond_wait(&p->tasks_todo_cond, &p->tasks_todo_mutex);
-
-      // We were woken up.  So maybe there are tasks to perform?  If
-      // so, get a task from the queue ...
       task_sptr t;
-      if (!p->tasks_todo.empty())
-	{
-	  t = p->tasks_todo.front();
-	  p->tasks_todo.pop();
-	}
-      pthread_mutex_unlock(&p->tasks_todo_mutex);
-
-      // If we've got a task to perform then perform it and when it's
-      // done then add to the set of tasks that are done.
-      if (t)
+      if (p->pick_task(*w, t))
 	{
+	  // We've got a task to perform so perform it and when it's
+	  // done then add to the set of tasks that are done.
 	  t->perform();
-
-	  // Add the task to the vector of tasks that are done and
-	  // notify listeners about the fact that the task is done.
-	  //
-	  // Note that this (including the notification) is not
-	  // happening in parallel.  So the code performed by the
-	  // notifier during the notification is running sequentially,
-	  // not in parallel with any other task that was just done
-	  // and that is notifying its listeners.
-	  pthread_mutex_lock(&p->tasks_done_mutex);
-	  p->tasks_done.push_back(t);
-	  p->notify(t);
-	  pthread_mutex_unlock(&p->tasks_done_mutex);
-	  pthread_cond_signal(&p->tasks_done_cond);
+	  p->task_done(t);
+	  continue;
 	}
 
-      // ensure we access bring_workers_down always guarded
-      bool drop_out = false;
-      pthread_mutex_lock(&p->tasks_todo_mutex);
-      drop_out = p->bring_workers_down;
-      pthread_mutex_unlock(&p->tasks_todo_mutex);
-      if (drop_out)
+      // If there is no more tasks to perform and the queue is not to
+      // be brought down then wait (sleep) for new tasks to come up.
+      std::unique_lock<std::mutex> lock(p->idle_mutex);
+      ++p->num_idle_workers;
+      while (p->num_tasks_todo.load() == 0 && !p->bring_workers_down)
+	p->idle_cond.wait(lock);
+      --p->num_idle_workers;
+
+      if (p->num_tasks_todo.load() == 0 && p->bring_workers_down)
 	break;
     }
 
-  return p;
+  current_worker = nullptr;
+  return w;
 }
 // </worker definitions>
 } //end namespace workers
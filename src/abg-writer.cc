@@ -871,6 +871,31 @@ public:
     m_referenced_fn_types_set.clear();
   }
 
+  /// Forget about the referenced types that were written out to the
+  /// XML output already.
+  ///
+  /// Those types are not going to be written out again, so there is
+  /// no need to keep track of them once a translation unit is
+  /// written out.  That way, the sets of referenced types only
+  /// contain the types that remain to be written out.
+  void
+  forget_emitted_referenced_types()
+  {
+    for (auto i = m_referenced_types_set.begin();
+	 i != m_referenced_types_set.end();)
+      if (type_is_emitted(*i))
+	i = m_referenced_types_set.erase(i);
+      else
+	++i;
+
+    for (auto i = m_referenced_fn_types_set.begin();
+	 i != m_referenced_fn_types_set.end();)
+      if (type_is_emitted(*i))
+	i = m_referenced_fn_types_set.erase(i);
+      else
+	++i;
+  }
+
   const string_elf_symbol_sptr_map_type&
   get_fun_symbol_map() const
   {return m_fun_symbol_map;}
@@ -2471,6 +2496,9 @@ write_translation_unit(write_context&		ctxt,
       << translation_unit_language_to_string(tu.get_language())
       <<"'";
 
+  if (!tu.get_content_hash().empty())
+    o << " content-hash='" << tu.get_content_hash() << "'";
+
   if (tu.is_empty() && !is_last)
     {
       o << "/>\n";
@@ -2537,6 +2565,8 @@ write_translation_unit(write_context&		ctxt,
   // the types they referenced.
   write_referenced_types(ctxt, tu, indent, is_last);
 
+  ctxt.forget_emitted_referenced_types();
+
   do_indent(o, indent);
   o << "</abi-instr>\n";
 
@@ -4541,6 +4571,9 @@ write_corpus(write_context&	ctxt,
   if (corpus->is_empty())
     return true;
 
+  metrics::scoped_phase phase(ctxt.get_environment().get_metrics(),
+			      "abixml.write-corpus");
+
   do_indent_to_level(ctxt, indent, 0);
 
   std::ostream& out = ctxt.get_ostream();
@@ -4638,28 +4671,25 @@ write_corpus(write_context&	ctxt,
   return true;
 }
 
-/// Serialize an ABI corpus group to a single native xml document.
-/// The root note of the resulting XML document is 'abi-corpus-group'.
+/// Serialize the opening tag of an ABI corpus group, without the
+/// closing '>' character.
+///
+/// This is a sub-routine of write_corpus_group and
+/// write_corpus_group_header.
 ///
 /// @param ctxt the write context to use.
 ///
-/// @param group the corpus group to serialize.
+/// @param group the corpus group to consider.
 ///
 /// @param indent the number of white space indentation to use.
-///
-/// @return true upon successful completion, false otherwise.
-bool
-write_corpus_group(write_context&	    ctxt,
-		   const corpus_group_sptr& group,
-		   unsigned		    indent)
-
+static void
+write_corpus_group_opening_tag(write_context&		ctxt,
+			       const corpus_group_sptr&	group,
+			       unsigned			indent)
 {
-  if (!group)
-    return false;
-
   do_indent_to_level(ctxt, indent, 0);
 
-std::ostream& out = ctxt.get_ostream();
+  std::ostream& out = ctxt.get_ostream();
 
   out << "<abi-corpus-group ";
   write_version_info(ctxt);
@@ -4671,27 +4701,109 @@ std::ostream& out = ctxt.get_ostream();
     out << " architecture='" << group->get_architecture_name()<< "'";
 
   write_tracking_non_reachable_types(group, out);
+}
+
+/// Serialize the header of a non-empty ABI corpus group.
+///
+/// Together with write_corpus_group_member and
+/// write_corpus_group_footer, this lets a corpus group be serialized
+/// progressively, e.g, each member corpus can be serialized as soon
+/// as it's built.  The result is the same as what write_corpus_group
+/// emits, provided that no corpus is serialized after being changed.
+///
+/// @param ctxt the write context to use.
+///
+/// @param group the corpus group to serialize.
+///
+/// @param indent the number of white space indentation to use.
+///
+/// @return true upon successful completion, false otherwise.
+bool
+write_corpus_group_header(write_context&	    ctxt,
+			  const corpus_group_sptr& group,
+			  unsigned		    indent)
+{
+  if (!group)
+    return false;
+
+  write_corpus_group_opening_tag(ctxt, group, indent);
+  ctxt.get_ostream() << ">\n";
+  return true;
+}
+
+/// Serialize a corpus that is a member of an ABI corpus group.
+///
+/// The corpus is to be serialized after the header of the group is
+/// serialized by write_corpus_group_header.
+///
+/// @param ctxt the write context to use.
+///
+/// @param corpus the member corpus to serialize.
+///
+/// @param indent the number of white space indentation used for the
+/// corpus group.
+///
+/// @return true upon successful completion, false otherwise.
+bool
+write_corpus_group_member(write_context&	ctxt,
+			  const corpus_sptr&	corpus,
+			  unsigned		indent)
+{
+  ABG_ASSERT(!ctxt.corpus_is_emitted(corpus));
+  return write_corpus(ctxt, corpus,
+		      get_indent_to_level(ctxt, indent, 1),
+		      /*member_of_group=*/true);
+}
+
+/// Serialize the footer of an ABI corpus group whose header was
+/// serialized by write_corpus_group_header.
+///
+/// @param ctxt the write context to use.
+///
+/// @param indent the number of white space indentation to use.
+void
+write_corpus_group_footer(write_context& ctxt, unsigned indent)
+{
+  do_indent_to_level(ctxt, indent, 0);
+  ctxt.get_ostream() << "</abi-corpus-group>\n";
+}
+
+/// Serialize an ABI corpus group to a single native xml document.
+/// The root note of the resulting XML document is 'abi-corpus-group'.
+///
+/// @param ctxt the write context to use.
+///
+/// @param group the corpus group to serialize.
+///
+/// @param indent the number of white space indentation to use.
+///
+/// @return true upon successful completion, false otherwise.
+bool
+write_corpus_group(write_context&	    ctxt,
+		   const corpus_group_sptr& group,
+		   unsigned		    indent)
+
+{
+  if (!group)
+    return false;
 
   if (group->is_empty())
     {
-      out << "/>\n";
+      write_corpus_group_opening_tag(ctxt, group, indent);
+      ctxt.get_ostream() << "/>\n";
       return true;
     }
 
-  out << ">\n";
+  write_corpus_group_header(ctxt, group, indent);
 
   // Write the list of corpora
   for (corpus_group::corpora_type::const_iterator c =
 	 group->get_corpora().begin();
        c != group->get_corpora().end();
        ++c)
-    {
-      ABG_ASSERT(!ctxt.corpus_is_emitted(*c));
-      write_corpus(ctxt, *c, get_indent_to_level(ctxt, indent, 1), true);
-    }
+    write_corpus_group_member(ctxt, *c, indent);
 
-  do_indent_to_level(ctxt, indent, 0);
-  out << "</abi-corpus-group>\n";
+  write_corpus_group_footer(ctxt, indent);
 
   return true;
 }
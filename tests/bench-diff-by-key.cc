@@ -0,0 +1,172 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2023 Red Hat, Inc.
+
+/// @file
+///
+/// This file implements a simple command line utility that compares
+/// the time taken by diff_utils::compute_diff and
+/// diff_utils::compute_diff_by_key to diff two sequences of keyed
+/// elements, for an increasing number of changed elements.
+///
+/// The elements mimic the functions of a corpus: they are keyed by a
+/// name, like functions are keyed by the ID of their symbol, and two
+/// elements of the same key are different if their values differ,
+/// like functions whose type changed.
+///
+/// The resulting binary name is benchdiffbykey.  Run it with the
+/// --help option to see how to use it.
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "abg-diff-utils.h"
+
+using std::cout;
+using std::string;
+using std::vector;
+
+using abigail::diff_utils::edit_script;
+using abigail::diff_utils::compute_diff;
+using abigail::diff_utils::compute_diff_by_key;
+
+/// An element of the sequences to diff.
+struct record
+{
+  string	key;
+  unsigned	value;
+
+  record(const string& k, unsigned v)
+    : key(k), value(v)
+  {}
+};
+
+/// The equality functor of the elements of the sequences to diff.
+struct record_eq
+{
+  bool
+  operator()(const record* l, const record* r) const
+  {return l->key == r->key && l->value == r->value;}
+};
+
+/// The key functor of the elements of the sequences to diff.
+struct record_key
+{
+  const string&
+  operator()(const record* r) const
+  {return r->key;}
+};
+
+typedef vector<const record*>::const_iterator records_it_type;
+
+/// Time a function.
+///
+/// @param f the function to time.
+///
+/// @return the wall clock time spent in @p f, in milliseconds.
+template<typename F>
+static double
+time_it(F f)
+{
+  std::chrono::steady_clock::time_point start =
+    std::chrono::steady_clock::now();
+  f();
+  std::chrono::duration<double, std::milli> d =
+    std::chrono::steady_clock::now() - start;
+  return d.count();
+}
+
+static void
+show_help(const string& progname)
+{
+  cout << "usage: " << progname << " [nb-elements]\n"
+       << "\n"
+       << "Diff two sequences of nb-elements elements (10000 by default)\n"
+       << "in which an increasing number of elements changed, and\n"
+       << "display the time taken by compute_diff and compute_diff_by_key,\n"
+       << "in milliseconds.\n";
+}
+
+int
+main(int argc, char* argv[])
+{
+  unsigned nb_elements = 10000;
+  if (argc > 1)
+    {
+      if (argc > 2
+	  || !strcmp(argv[1], "--help")
+	  || !strcmp(argv[1], "-h")
+	  || !(nb_elements = strtoul(argv[1], 0, 10)))
+	{
+	  show_help(argv[0]);
+	  return 1;
+	}
+    }
+
+  vector<record> first_records, second_records;
+  for (unsigned i = 0; i < nb_elements; ++i)
+    first_records.push_back(record("fn_" + std::to_string(i), 0));
+
+  cout << std::setw(10) << "changes"
+       << std::setw(16) << "compute_diff"
+       << std::setw(24) << "compute_diff_by_key"
+       << "\n";
+
+  for (unsigned nb_changes = 0;; nb_changes = nb_changes ? nb_changes * 2 : 1)
+    {
+      if (nb_changes > nb_elements)
+	nb_changes = nb_elements;
+
+      // Change the value of nb_changes elements spread evenly over
+      // the second sequence, like functions whose type changed.
+      second_records = first_records;
+      for (unsigned i = 0; i < nb_changes; ++i)
+	second_records[(unsigned long) i * nb_elements / nb_changes].value = 1;
+
+      vector<const record*> a, b;
+      for (const record& r : first_records)
+	a.push_back(&r);
+      for (const record& r : second_records)
+	b.push_back(&r);
+
+      edit_script ses, ses_by_key;
+      double t = time_it([&]()
+			 {
+			   compute_diff<records_it_type, record_eq>
+			     (a.begin(), a.end(), b.begin(), b.end(), ses);
+			 });
+      double t_by_key = time_it([&]()
+				{
+				  compute_diff_by_key<records_it_type,
+						      record_key,
+						      record_eq>
+				    (a.begin(), a.end(),
+				     b.begin(), b.end(),
+				     ses_by_key);
+				});
+
+      if (ses.num_deletions() != ses_by_key.num_deletions()
+	  || ses.num_insertions() != ses_by_key.num_insertions())
+	{
+	  std::cerr << "the edit scripts differ for "
+		    << nb_changes << " changes\n";
+	  return 1;
+	}
+
+      cout << std::setw(10) << nb_changes
+	   << std::fixed << std::setprecision(2)
+	   << std::setw(16) << t
+	   << std::setw(24) << t_by_key
+	   << "\n";
+
+      if (nb_changes == nb_elements)
+	break;
+    }
+
+  return 0;
+}
@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2023 Red Hat, Inc.
+
+/// @file
+///
+/// This file implements a simple command line utility that compares
+/// the time taken to build the ABI corpus of a binary or of an abixml
+/// file, and then to destroy it along with its environment, when the
+/// IR nodes are allocated from the heap and when they are allocated
+/// from the arena of the environment.
+///
+/// See environment::use_arena_allocation.
+///
+/// The resulting binary name is benchirarena.  Run it with the --help
+/// option to see how to use it.
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "abg-corpus.h"
+#include "abg-reader.h"
+#include "abg-tools-utils.h"
+
+using std::cout;
+using std::cerr;
+using std::string;
+using std::vector;
+
+using abigail::ir::environment;
+using abigail::ir::corpus;
+using abigail::ir::corpus_sptr;
+using abigail::tools_utils::file_type;
+using abigail::tools_utils::guess_file_type;
+
+/// The time taken to read a corpus and to tear it down.
+struct timings
+{
+  double	read;
+  double	teardown;
+
+  timings()
+    : read(), teardown()
+  {}
+};
+
+/// Read the corpus of a file and tear it down.
+///
+/// @param path the path to the binary or abixml file to read.
+///
+/// @param use_arena if true, the IR nodes are allocated from the
+/// arena of the environment.
+///
+/// @param t the timings to add the time spent to.
+///
+/// @return true iff the corpus could be read.
+static bool
+read_and_teardown(const string& path, bool use_arena, timings& t)
+{
+  std::chrono::steady_clock::time_point start =
+    std::chrono::steady_clock::now();
+
+  std::unique_ptr<environment> env(new environment);
+  env->use_arena_allocation(use_arena);
+
+  corpus_sptr corp;
+  if (guess_file_type(path) == abigail::tools_utils::FILE_TYPE_ELF)
+    {
+      vector<char**> di_roots;
+      abigail::elf_based_reader_sptr rdr =
+	abigail::tools_utils::create_best_elf_based_reader(path, di_roots,
+							   *env,
+							   corpus::DWARF_ORIGIN,
+							   /*show_all_types=*/false);
+      abigail::fe_iface::status status = abigail::fe_iface::STATUS_UNKNOWN;
+      if (rdr)
+	corp = rdr->read_corpus(status);
+    }
+  else
+    corp = abigail::abixml::read_corpus_from_abixml_file(path, *env);
+  if (!corp)
+    return false;
+
+  std::chrono::steady_clock::time_point read_end =
+    std::chrono::steady_clock::now();
+
+  corp.reset();
+  env.reset();
+
+  std::chrono::steady_clock::time_point end =
+    std::chrono::steady_clock::now();
+
+  t.read += std::chrono::duration<double, std::milli>(read_end - start).count();
+  t.teardown += std::chrono::duration<double, std::milli>(end - read_end).count();
+  return true;
+}
+
+static void
+show_help(const string& progname)
+{
+  cout << "usage: " << progname << " [--iterations <N>] <file>...\n"
+       << "\n"
+       << "Read the ABI corpus of each binary or abixml file N times (1 by\n"
+       << "default) with the IR nodes allocated from the heap, and N times\n"
+       << "with the IR nodes allocated from an arena, and display the time\n"
+       << "taken to read the corpora and to tear them down, in milliseconds.\n";
+}
+
+int
+main(int argc, char* argv[])
+{
+  size_t nb_iterations = 1;
+  vector<string> paths;
+  for (int i = 1; i < argc; ++i)
+    {
+      if (!strcmp(argv[i], "--iterations") && i + 1 < argc)
+	nb_iterations = strtoul(argv[++i], 0, 10);
+      else if (argv[i][0] == '-')
+	{
+	  show_help(argv[0]);
+	  return 1;
+	}
+      else
+	paths.push_back(argv[i]);
+    }
+
+  if (paths.empty())
+    {
+      show_help(argv[0]);
+      return 1;
+    }
+
+  cout << std::setw(10) << "nodes"
+       << std::setw(14) << "read"
+       << std::setw(14) << "teardown"
+       << std::setw(14) << "total"
+       << "\n";
+
+  const char* labels[] = {"heap", "arena"};
+  for (int use_arena = 0; use_arena < 2; ++use_arena)
+    {
+      timings t;
+      for (size_t i = 0; i < nb_iterations; ++i)
+	for (const string& path : paths)
+	  if (!read_and_teardown(path, use_arena, t))
+	    {
+	      cerr << "could not read " << path << "\n";
+	      return 1;
+	    }
+
+      cout << std::setw(10) << labels[use_arena]
+	   << std::fixed << std::setprecision(2)
+	   << std::setw(14) << t.read
+	   << std::setw(14) << t.teardown
+	   << std::setw(14) << t.read + t.teardown
+	   << "\n";
+    }
+
+  return 0;
+}
@@ -0,0 +1,198 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2023 Red Hat, Inc.
+
+/// @file
+///
+/// This file implements a simple command line utility that compares
+/// the time taken by regexec and by regex::match to match the regular
+/// expressions of suppression specification files against a set of
+/// names.
+///
+/// The regular expressions are the values of the properties which
+/// names end with "_regexp" in the suppression specification files
+/// given on the command line, e.g, tests/data/test-diff-suppr/*.suppr.
+/// A regular expression generated from a list of names, like the one
+/// generated from a kABI whitelist, is matched as well.
+///
+/// The resulting binary name is benchregex.  Run it with the --help
+/// option to see how to use it.
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "abg-ini.h"
+#include "abg-regex.h"
+#include "abg-tools-utils.h"
+
+using std::cout;
+using std::cerr;
+using std::string;
+using std::vector;
+
+using abigail::ini::config;
+using abigail::ini::read_config;
+using abigail::ini::simple_property_sptr;
+using abigail::ini::is_simple_property;
+using abigail::regex::regex_t_sptr;
+using abigail::tools_utils::string_ends_with;
+
+/// Read the regular expressions of a suppression specification file.
+///
+/// @param path the path to the file to read.
+///
+/// @param regexps the vector to append the regular expressions to.
+///
+/// @return true iff the file could be read.
+static bool
+read_regexps(const string& path, vector<string>& regexps)
+{
+  config conf;
+  if (!read_config(path, conf))
+    return false;
+
+  for (const config::section_sptr& section : conf.get_sections())
+    for (const abigail::ini::property_sptr& p : section->get_properties())
+      if (simple_property_sptr prop = is_simple_property(p))
+	if (string_ends_with(prop->get_name(), "_regexp"))
+	  regexps.push_back(prop->get_value()->as_string());
+  return true;
+}
+
+/// Time the matching of a set of regular expressions against a set
+/// of names.
+///
+/// @param regexps the compiled regular expressions.
+///
+/// @param names the names to match.
+///
+/// @param use_regexec if true, use regexec; otherwise use
+/// regex::match.
+///
+/// @param nb_matches out parameter.  The number of matches.
+///
+/// @return the wall clock time spent, in milliseconds.
+static double
+time_matches(const vector<regex_t_sptr>& regexps,
+	     const vector<string>& names,
+	     bool use_regexec,
+	     size_t& nb_matches)
+{
+  nb_matches = 0;
+  std::chrono::steady_clock::time_point start =
+    std::chrono::steady_clock::now();
+  for (const regex_t_sptr& r : regexps)
+    for (const string& n : names)
+      if (use_regexec
+	  ? !regexec(r.get(), n.c_str(), 0, NULL, 0)
+	  : abigail::regex::match(r, n))
+	++nb_matches;
+  std::chrono::duration<double, std::milli> d =
+    std::chrono::steady_clock::now() - start;
+  return d.count();
+}
+
+static void
+show_help(const string& progname)
+{
+  cout << "usage: " << progname << " [--names <N>] <suppr-file>...\n"
+       << "\n"
+       << "Match the regular expressions of the suppression files, and\n"
+       << "a regular expression generated from N names (1000 by default),\n"
+       << "against N names with regexec and with regex::match, and\n"
+       << "display the time taken by each, in milliseconds.\n";
+}
+
+int
+main(int argc, char* argv[])
+{
+  size_t nb_names = 1000;
+  vector<string> paths;
+  for (int i = 1; i < argc; ++i)
+    {
+      if (!strcmp(argv[i], "--names") && i + 1 < argc)
+	nb_names = strtoul(argv[++i], 0, 10);
+      else if (argv[i][0] == '-')
+	{
+	  show_help(argv[0]);
+	  return 1;
+	}
+      else
+	paths.push_back(argv[i]);
+    }
+
+  vector<string> patterns;
+  for (const string& path : paths)
+    if (!read_regexps(path, patterns))
+      {
+	cerr << "could not read " << path << "\n";
+	return 1;
+      }
+
+  // The names to match: a mix of C, C++ and mangled names, some of
+  // them "private".
+  vector<string> names;
+  for (size_t i = 0; i < nb_names; ++i)
+    {
+      string n = std::to_string(i);
+      switch (i % 5)
+	{
+	case 0: names.push_back("function" + n); break;
+	case 1: names.push_back("__private_fn" + n); break;
+	case 2: names.push_back("std::vector" + n); break;
+	case 3: names.push_back("_Z3bar" + n + "v"); break;
+	default: names.push_back("var" + n); break;
+	}
+    }
+
+  vector<string> whitelisted(names.begin(), names.begin() + nb_names / 2);
+
+  struct
+  {
+    const char* label;
+    vector<string> patterns;
+  } sets[] =
+  {
+    {"suppression files", patterns},
+    {"generated from names",
+     vector<string>(1, abigail::regex::generate_from_strings(whitelisted))}
+  };
+
+  cout << std::setw(22) << "regexps"
+       << std::setw(10) << "count"
+       << std::setw(14) << "regexec"
+       << std::setw(14) << "regex::match"
+       << "\n";
+
+  for (const auto& set : sets)
+    {
+      vector<regex_t_sptr> regexps;
+      for (const string& p : set.patterns)
+	if (regex_t_sptr r = abigail::regex::compile(p))
+	  regexps.push_back(r);
+
+      size_t nb_regexec_matches = 0, nb_matches = 0;
+      double t_regexec = time_matches(regexps, names, true,
+				      nb_regexec_matches);
+      double t_match = time_matches(regexps, names, false, nb_matches);
+      if (nb_regexec_matches != nb_matches)
+	{
+	  cerr << "regexec and regex::match disagree on "
+	       << set.label << "\n";
+	  return 1;
+	}
+
+      cout << std::setw(22) << set.label
+	   << std::setw(10) << regexps.size()
+	   << std::fixed << std::setprecision(2)
+	   << std::setw(14) << t_regexec
+	   << std::setw(14) << t_match
+	   << "\n";
+    }
+
+  return 0;
+}
@@ -0,0 +1,254 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2023 Red Hat, Inc.
+
+/// @file
+///
+/// This file implements a simple command line utility that compares
+/// the time taken to compare the ABIs of a set of binaries when each
+/// comparison is performed in an environment of its own, and when all
+/// the binaries are read concurrently in an environment they share
+/// and then compared one after the other, as done by abipkgdiff
+/// --shared-environment.
+///
+/// Each input file is read twice, as the old and the new version of a
+/// binary, and the two resulting corpora are compared.
+///
+/// The resulting binary name is benchsharedenv.  Run it with the
+/// --help option to see how to use it.
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "abg-comparison.h"
+#include "abg-corpus.h"
+#include "abg-reader.h"
+#include "abg-workers.h"
+
+using std::cout;
+using std::cerr;
+using std::string;
+using std::vector;
+
+using abigail::ir::environment;
+using abigail::ir::corpus_sptr;
+using abigail::comparison::corpus_diff_sptr;
+using abigail::comparison::diff_context_sptr;
+using abigail::comparison::diff_context;
+using abigail::comparison::compute_diff;
+using abigail::abixml::read_corpus_from_abixml_file;
+
+/// The task comparing an abixml file to itself.
+class compare_task : public abigail::workers::task
+{
+  string	path_;
+  environment*	shared_env_;
+  std::mutex*	corpora_lock_;
+  vector<corpus_sptr>* corpora_;
+  corpus_sptr	c1_;
+  corpus_sptr	c2_;
+
+  /// Keep a corpus read in the shared environment, if any, until
+  /// the end of all the comparisons.
+  ///
+  /// @param corp the corpus to keep.
+  void
+  keep_corpus(const corpus_sptr& corp)
+  {
+    if (!shared_env_ || !corp)
+      return;
+    std::lock_guard<std::mutex> guard(*corpora_lock_);
+    corpora_->push_back(corp);
+  }
+
+  /// Read the file twice in a given environment.
+  ///
+  /// @param env the environment to read the file in.
+  void
+  read(environment& env)
+  {
+    c1_ = read_corpus_from_abixml_file(path_, env);
+    keep_corpus(c1_);
+    c2_ = read_corpus_from_abixml_file(path_, env);
+    keep_corpus(c2_);
+    if (!c1_ || !c2_)
+      failed = true;
+  }
+
+public:
+  bool failed;
+
+  compare_task(const string& path,
+	       environment* shared_env,
+	       std::mutex* corpora_lock,
+	       vector<corpus_sptr>* corpora)
+    : path_(path),
+      shared_env_(shared_env),
+      corpora_lock_(corpora_lock),
+      corpora_(corpora),
+      failed()
+  {}
+
+  /// Compare the two corpora read from the file and release them.
+  void
+  compare()
+  {
+    if (!failed)
+      {
+	diff_context_sptr ctxt(new diff_context);
+	corpus_diff_sptr d = compute_diff(c1_, c2_, ctxt);
+	if (d->has_net_changes())
+	  failed = true;
+      }
+    c1_.reset();
+    c2_.reset();
+  }
+
+  /// Read the file twice.  Unless the environment is shared, the two
+  /// corpora are then compared right away.
+  virtual void
+  perform()
+  {
+    if (shared_env_)
+      read(*shared_env_);
+    else
+      {
+	environment env;
+	read(env);
+	compare();
+      }
+  }
+}; // end class compare_task
+
+/// Compare each file to itself.
+///
+/// The files are read concurrently.  If the environment is shared,
+/// they are compared one after the other once they have all been
+/// read.
+///
+/// @param paths the paths to the abixml files to compare.
+///
+/// @param nb_threads the number of threads to use.
+///
+/// @param share_env if true, all the files are read in the same
+/// environment.
+///
+/// @param wall_time output parameter.  Set to the wall clock time
+/// taken by the comparisons, in milliseconds.
+///
+/// @param cpu_time output parameter.  Set to the CPU time taken by
+/// the comparisons, in milliseconds.
+///
+/// @return true iff all the comparisons succeeded.
+static bool
+compare_files(const vector<string>& paths, size_t nb_threads, bool share_env,
+	      double& wall_time, double& cpu_time)
+{
+  std::chrono::steady_clock::time_point start =
+    std::chrono::steady_clock::now();
+  double cpu_start = abigail::metrics::get_cpu_time();
+
+  bool ok = true;
+  {
+    std::unique_ptr<environment> env;
+    if (share_env)
+      env.reset(new environment);
+    std::mutex corpora_lock;
+    vector<corpus_sptr> corpora;
+
+    abigail::workers::queue q(nb_threads);
+    vector<std::shared_ptr<compare_task>> tasks;
+    for (const string& path : paths)
+      {
+	tasks.push_back(std::make_shared<compare_task>(path, env.get(),
+							 &corpora_lock,
+							 &corpora));
+	q.schedule_task(tasks.back());
+      }
+    q.wait_for_workers_to_complete();
+
+    for (const auto& t : tasks)
+      {
+	if (share_env)
+	  t->compare();
+	if (t->failed)
+	  ok = false;
+      }
+
+    // The corpora must be destroyed before their environment.
+    corpora.clear();
+  }
+
+  wall_time =
+    std::chrono::duration<double, std::milli>
+    (std::chrono::steady_clock::now() - start).count();
+  cpu_time = (abigail::metrics::get_cpu_time() - cpu_start) * 1000;
+  return ok;
+}
+
+static void
+show_help(const string& progname)
+{
+  cout << "usage: " << progname << " [--jobs <N>] <abixml-file>...\n"
+       << "\n"
+       << "Compare each abixml file to itself on N threads (1 by default),\n"
+       << "first with an environment per comparison, then with one\n"
+       << "environment shared by all the comparisons, and display the\n"
+       << "wall clock time and the CPU time taken, in milliseconds.\n";
+}
+
+int
+main(int argc, char* argv[])
+{
+  size_t nb_threads = 1;
+  vector<string> paths;
+  for (int i = 1; i < argc; ++i)
+    {
+      if (!strcmp(argv[i], "--jobs") && i + 1 < argc)
+	nb_threads = strtoul(argv[++i], 0, 10);
+      else if (argv[i][0] == '-')
+	{
+	  show_help(argv[0]);
+	  return 1;
+	}
+      else
+	paths.push_back(argv[i]);
+    }
+
+  if (paths.empty() || !nb_threads)
+    {
+      show_help(argv[0]);
+      return 1;
+    }
+
+  cout << std::setw(12) << "environment"
+       << std::setw(14) << "wall"
+       << std::setw(14) << "cpu"
+       << "\n";
+
+  const char* labels[] = {"per-binary", "shared"};
+  for (int share_env = 0; share_env < 2; ++share_env)
+    {
+      double wall_time = 0, cpu_time = 0;
+      if (!compare_files(paths, nb_threads, share_env, wall_time, cpu_time))
+	{
+	  cerr << "could not compare the input files\n";
+	  return 1;
+	}
+
+      cout << std::setw(12) << labels[share_env]
+	   << std::fixed << std::setprecision(2)
+	   << std::setw(14) << wall_time
+	   << std::setw(14) << cpu_time
+	   << "\n";
+    }
+
+  return 0;
+}
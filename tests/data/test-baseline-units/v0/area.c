@@ -0,0 +1,7 @@
+#include "shape.h"
+
+int
+area_of_box(struct point top_left, struct point bottom_right)
+{
+  return (bottom_right.x - top_left.x) * (bottom_right.y - top_left.y);
+}
@@ -0,0 +1,15 @@
+#include "shape.h"
+
+struct offset
+{
+  int dx;
+  int dy;
+};
+
+struct point
+point_move(struct point p, struct offset o)
+{
+  p.x += o.dx;
+  p.y += o.dy;
+  return p;
+}
@@ -0,0 +1,33 @@
+// Compile with:
+// gcc -g -shared -fPIC -fdebug-prefix-map=$PWD=/src -o libshape.so shape.c move.c area.c
+
+#include <stdlib.h>
+#include "shape.h"
+
+struct shape
+{
+  struct point origin;
+  unsigned nb_points;
+  struct point* points;
+};
+
+shape_handle
+shape_new(struct point origin)
+{
+  shape_handle s = calloc(1, sizeof(struct shape));
+  s->origin = origin;
+  return s;
+}
+
+void
+shape_delete(shape_handle s)
+{
+  free(s->points);
+  free(s);
+}
+
+int
+shape_is_null(shape_handle s)
+{
+  return s == 0;
+}
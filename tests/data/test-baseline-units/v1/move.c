@@ -0,0 +1,24 @@
+#include "shape.h"
+
+struct offset
+{
+  int dx;
+  int dy;
+  int scale;
+};
+
+struct point
+point_move(struct point p, struct offset o)
+{
+  p.x = p.x * o.scale + o.dx;
+  p.y = p.y * o.scale + o.dy;
+  return p;
+}
+
+struct point
+point_scale(struct point p, int scale)
+{
+  p.x *= scale;
+  p.y *= scale;
+  return p;
+}
@@ -0,0 +1,11 @@
+// The types shared by the translation units of libshape.so.
+
+struct point
+{
+  int x;
+  int y;
+};
+
+struct shape;
+
+typedef struct shape* shape_handle;
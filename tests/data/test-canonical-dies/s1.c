@@ -0,0 +1,3 @@
+struct s {int a;};
+struct s s1_var;
+struct s* s1(void) {return &s1_var;}
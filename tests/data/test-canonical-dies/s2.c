@@ -0,0 +1,5 @@
+/* This struct s has the same name as the one of s1.c and s3.c, but
+   a different layout.  */
+struct s {long b; char c;};
+struct s s2_var;
+struct s* s2(void) {return &s2_var;}
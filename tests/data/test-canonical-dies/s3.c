@@ -0,0 +1,3 @@
+struct s {int a;};
+struct s s3_var;
+struct s* s3(void) {return &s3_var;}
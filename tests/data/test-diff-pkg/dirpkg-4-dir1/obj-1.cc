@@ -0,0 +1,17 @@
+// Compile with:
+// g++ -g -shared -fPIC -o libobj-1.so obj-1.cc
+
+#include "common.h"
+
+unsigned
+registry_size(const registry& r)
+{return r.entries.size();}
+
+const entry*
+registry_find(const registry& r, const std::string& name)
+{
+  for (const entry& e : r.entries)
+    if (e.name == name)
+      return &e;
+  return 0;
+}
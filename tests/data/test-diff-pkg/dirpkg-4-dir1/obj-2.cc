@@ -0,0 +1,13 @@
+// Compile with:
+// g++ -g -shared -fPIC -o libobj-2.so obj-2.cc
+
+#include "common.h"
+
+int
+entry_sum(const entry& e)
+{
+  int sum = 0;
+  for (int v : e.values)
+    sum += v;
+  return sum;
+}
@@ -0,0 +1,15 @@
+// The types shared by the binaries of the package.
+
+#include <string>
+#include <vector>
+
+struct entry
+{
+  std::string name;
+  std::vector<int> values;
+};
+
+struct registry
+{
+  std::vector<entry> entries;
+};
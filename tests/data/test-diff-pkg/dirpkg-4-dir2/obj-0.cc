@@ -0,0 +1,19 @@
+// Compile with:
+// g++ -g -shared -fPIC -o libobj-0.so obj-0.cc
+
+#include "common.h"
+
+struct cursor
+{
+  registry* reg;
+  unsigned index;
+  bool reversed;
+};
+
+void
+registry_add(registry& r, const entry& e)
+{r.entries.push_back(e);}
+
+bool
+cursor_next(cursor& c)
+{return ++c.index < c.reg->entries.size();}
@@ -0,0 +1,54 @@
+; The C++ compilation unit of libnameindex.so.  It's written in LLVM
+; IR because llc emits a DWARF 5 .debug_names section and GCC doesn't.
+; It's the IR of:
+;
+;   template<typename T> void foo(T) {}
+;   template void foo<int>(int);
+;
+;   namespace ns
+;   {
+;     inline namespace __cxx11 {}
+;     int __attribute__((abi_tag("cxx11"))) bar() {return 0;}
+;     int v;
+;   }
+;
+; See libnameindex.so.README for how to build libnameindex.so.
+
+source_filename = "name-index-a.cc"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@_ZN2ns1vE = dso_local global i32 0, align 4, !dbg !30
+
+define weak_odr dso_local void @_Z3fooIiEvT_(i32 %x) !dbg !10 {
+  ret void, !dbg !20
+}
+
+define dso_local i32 @_ZN2ns3barB5cxx11Ev() !dbg !21 {
+  ret i32 0, !dbg !25
+}
+
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!2, !3}
+!0 = distinct !DICompileUnit(language: DW_LANG_C_plus_plus, file: !1, producer: "hand written", isOptimized: false, runtimeVersion: 0, emissionKind: FullDebug, globals: !32)
+!1 = !DIFile(filename: "name-index-a.cc", directory: "/src")
+!2 = !{i32 7, !"Dwarf Version", i32 5}
+!3 = !{i32 2, !"Debug Info Version", i32 3}
+!4 = !DIBasicType(name: "int", size: 32, encoding: DW_ATE_signed)
+!5 = !DINamespace(name: "ns", scope: null)
+!10 = distinct !DISubprogram(name: "foo<int>", linkageName: "_Z3fooIiEvT_", scope: !1, file: !1, line: 1, type: !11, scopeLine: 1, flags: DIFlagPrototyped, spFlags: DISPFlagDefinition, unit: !0, templateParams: !13, retainedNodes: !14)
+!11 = !DISubroutineType(types: !12)
+!12 = !{null, !4}
+!13 = !{!15}
+!15 = !DITemplateTypeParameter(name: "T", type: !4)
+!14 = !{!16}
+!16 = !DILocalVariable(name: "x", arg: 1, scope: !10, file: !1, line: 1, type: !4)
+!20 = !DILocation(line: 1, column: 1, scope: !10)
+!21 = distinct !DISubprogram(name: "bar", linkageName: "_ZN2ns3barB5cxx11Ev", scope: !5, file: !1, line: 7, type: !22, scopeLine: 7, flags: DIFlagPrototyped, spFlags: DISPFlagDefinition, unit: !0, retainedNodes: !24)
+!22 = !DISubroutineType(types: !23)
+!23 = !{!4}
+!24 = !{}
+!25 = !DILocation(line: 7, column: 1, scope: !21)
+!30 = !DIGlobalVariableExpression(var: !31, expr: !DIExpression())
+!31 = distinct !DIGlobalVariable(name: "v", linkageName: "_ZN2ns1vE", scope: !5, file: !1, line: 8, type: !4, isLocal: false, isDefinition: true)
+!32 = !{!30}
@@ -0,0 +1,36 @@
+; A C compilation unit of libnameindex.so, written in LLVM IR because
+; llc emits a DWARF 5 .debug_names section and GCC doesn't.  It's the
+; IR of:
+;
+;   struct S {int m;};
+;   int baz(struct S* s) {return 0;}
+;
+; See libnameindex.so.README for how to build libnameindex.so.
+
+source_filename = "name-index-b.c"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+%struct.S = type { i32 }
+
+define dso_local i32 @baz(%struct.S* %s) !dbg !10 {
+  ret i32 0, !dbg !20
+}
+
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!2, !3}
+!0 = distinct !DICompileUnit(language: DW_LANG_C99, file: !1, producer: "hand written", isOptimized: false, runtimeVersion: 0, emissionKind: FullDebug)
+!1 = !DIFile(filename: "name-index-b.c", directory: "/src")
+!2 = !{i32 7, !"Dwarf Version", i32 5}
+!3 = !{i32 2, !"Debug Info Version", i32 3}
+!4 = !DIBasicType(name: "int", size: 32, encoding: DW_ATE_signed)
+!5 = distinct !DICompositeType(tag: DW_TAG_structure_type, name: "S", file: !1, line: 1, size: 32, elements: !6)
+!6 = !{!7}
+!7 = !DIDerivedType(tag: DW_TAG_member, name: "m", scope: !5, file: !1, line: 1, baseType: !4, size: 32)
+!8 = !DIDerivedType(tag: DW_TAG_pointer_type, baseType: !5, size: 64)
+!10 = distinct !DISubprogram(name: "baz", scope: !1, file: !1, line: 2, type: !11, scopeLine: 2, flags: DIFlagPrototyped, spFlags: DISPFlagDefinition, unit: !0, retainedNodes: !14)
+!11 = !DISubroutineType(types: !12)
+!12 = !{!4, !8}
+!14 = !{!16}
+!16 = !DILocalVariable(name: "s", arg: 1, scope: !10, file: !1, line: 2, type: !8)
+!20 = !DILocation(line: 2, column: 1, scope: !10)
@@ -0,0 +1,41 @@
+; A C compilation unit of libnameindex.so that has no exported
+; declaration, written in LLVM IR because llc emits a DWARF 5
+; .debug_names section and GCC doesn't.  It's the IR of:
+;
+;   static int helper(int i) {return i;}
+;   int (*get_helper(void))(int) __attribute__((visibility("hidden")));
+;   int (*get_helper(void))(int) {return helper;}
+;
+; See libnameindex.so.README for how to build libnameindex.so.
+
+source_filename = "name-index-c.c"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+define internal i32 @helper(i32 %i) !dbg !10 {
+  ret i32 %i, !dbg !20
+}
+
+define hidden i32 (i32)* @get_helper() !dbg !21 {
+  ret i32 (i32)* @helper, !dbg !25
+}
+
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!2, !3}
+!0 = distinct !DICompileUnit(language: DW_LANG_C99, file: !1, producer: "hand written", isOptimized: false, runtimeVersion: 0, emissionKind: FullDebug)
+!1 = !DIFile(filename: "name-index-c.c", directory: "/src")
+!2 = !{i32 7, !"Dwarf Version", i32 5}
+!3 = !{i32 2, !"Debug Info Version", i32 3}
+!4 = !DIBasicType(name: "int", size: 32, encoding: DW_ATE_signed)
+!10 = distinct !DISubprogram(name: "helper", scope: !1, file: !1, line: 1, type: !11, scopeLine: 1, flags: DIFlagPrototyped, spFlags: DISPFlagLocalToUnit | DISPFlagDefinition, unit: !0, retainedNodes: !14)
+!11 = !DISubroutineType(types: !12)
+!12 = !{!4, !4}
+!14 = !{!16}
+!16 = !DILocalVariable(name: "i", arg: 1, scope: !10, file: !1, line: 1, type: !4)
+!20 = !DILocation(line: 1, column: 1, scope: !10)
+!21 = distinct !DISubprogram(name: "get_helper", scope: !1, file: !1, line: 3, type: !22, scopeLine: 3, flags: DIFlagPrototyped, spFlags: DISPFlagDefinition, unit: !0, retainedNodes: !24)
+!22 = !DISubroutineType(types: !23)
+!23 = !{!26}
+!24 = !{}
+!25 = !DILocation(line: 3, column: 1, scope: !21)
+!26 = !DIDerivedType(tag: DW_TAG_pointer_type, baseType: !11, size: 64)
@@ -0,0 +1,17 @@
+/* A compilation unit of libnameindex.so that is compiled by GCC,
+   which doesn't emit a .debug_names section.  So the name index of
+   libnameindex.so doesn't cover this unit.
+
+   See libnameindex.so.README for how to build libnameindex.so.  */
+
+struct U
+{
+  char c;
+  long l;
+};
+
+long
+qux(struct U* u)
+{
+  return u->l;
+}
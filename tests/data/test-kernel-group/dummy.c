@@ -0,0 +1,18 @@
+#include "net.h"
+
+MODULE("dummy");
+
+// This defines the type that netcore.ko only declares.
+struct opaque_stats {unsigned long rx, tx;};
+
+static int
+dummy_open(struct net_device* nd)
+{return nd->mtu;}
+
+struct net_device_ops dummy_ops = {dummy_open, 0};
+EXPORT_SYMBOL(dummy_ops);
+
+unsigned long
+dummy_rx(struct net_device* nd)
+{return netdev_stats(nd)->rx + driver_register(0);}
+EXPORT_SYMBOL(dummy_rx);
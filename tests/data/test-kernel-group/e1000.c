@@ -0,0 +1,10 @@
+#include "net.h"
+
+MODULE("e1000");
+
+struct e1000_adapter {struct net_device* netdev; unsigned long flags;};
+
+int
+e1000_probe(struct e1000_adapter* a)
+{return register_netdev(a->netdev);}
+EXPORT_SYMBOL(e1000_probe);
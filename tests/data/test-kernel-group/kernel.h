@@ -0,0 +1,33 @@
+// A tiny stand-in for the headers of the Linux Kernel, to build the
+// vmlinux and modules under dist/ with:
+//
+//   gcc -g -nostdlib -static -Wl,-e,start_kernel -o vmlinux vmlinux.c
+//   gcc -g -c -o <module>.ko <module>.c
+
+#ifndef KERNEL_H
+#define KERNEL_H
+
+struct kernel_symbol {unsigned long value; const char* name;};
+
+#define EXPORT_SYMBOL(sym)					\
+  static const char __kstrtab_##sym[]				\
+  __attribute__((section("__ksymtab_strings"), used)) = #sym;	\
+  const struct kernel_symbol __ksymtab_##sym			\
+  __attribute__((section("__ksymtab"), used)) =			\
+  {(unsigned long) &sym, __kstrtab_##sym}
+
+#define MODULE(n)							\
+  static const char __modinfo_license[]				\
+  __attribute__((section(".modinfo"), used)) = "license=GPL";	\
+  struct module {char name[56];};					\
+  struct module __this_module						\
+  __attribute__((section(".gnu.linkonce.this_module"))) = {n}
+
+struct list_head {struct list_head *next, *prev;};
+struct device {const char* name; struct list_head node; int id;};
+struct device_driver {const char* name; int (*probe)(struct device*);};
+
+int device_register(struct device*);
+int driver_register(struct device_driver*);
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef NET_H
+#define NET_H
+
+#include "kernel.h"
+
+struct net_device;
+struct opaque_stats;
+struct net_device_ops
+{
+  int (*open)(struct net_device*);
+  int (*stop)(struct net_device*);
+};
+struct net_device
+{
+  struct device dev;
+  const struct net_device_ops* ops;
+  unsigned mtu;
+};
+
+int register_netdev(struct net_device*);
+struct opaque_stats* netdev_stats(struct net_device*);
+
+#endif
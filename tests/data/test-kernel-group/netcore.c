@@ -0,0 +1,13 @@
+#include "net.h"
+
+MODULE("netcore");
+
+int
+register_netdev(struct net_device* nd)
+{return device_register(&nd->dev) + nd->ops->open(nd);}
+EXPORT_SYMBOL(register_netdev);
+
+struct opaque_stats*
+netdev_stats(struct net_device* nd)
+{return (struct opaque_stats*) nd;}
+EXPORT_SYMBOL(netdev_stats);
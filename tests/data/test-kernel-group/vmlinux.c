@@ -0,0 +1,17 @@
+#include "kernel.h"
+
+struct device root_device;
+
+int
+device_register(struct device* d)
+{return d->id;}
+EXPORT_SYMBOL(device_register);
+
+int
+driver_register(struct device_driver* drv)
+{return drv->probe(&root_device);}
+EXPORT_SYMBOL(driver_register);
+
+void
+start_kernel(void)
+{}
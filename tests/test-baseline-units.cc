@@ -0,0 +1,272 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2023 Red Hat, Inc.
+
+/// @file
+///
+/// This program tests the selection of the translation units of a
+/// baseline abixml file that can be re-used when reading a new
+/// version of its binary, as done by abidw --baseline.
+
+#include <sys/wait.h>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "lib/catch.hpp"
+#include "test-utils.h"
+
+#include "abg-corpus.h"
+#include "abg-reader.h"
+#include "abg-tools-utils.h"
+#include "abg-writer.h"
+
+using std::string;
+using std::unordered_map;
+using std::unordered_set;
+
+using abigail::ir::environment;
+using abigail::ir::corpus_sptr;
+using abigail::ir::translation_unit_sptr;
+using abigail::abixml::find_reusable_translation_units;
+using abigail::abixml::read_corpus_from_abixml_file;
+using abigail::tests::get_build_dir;
+using abigail::tests::get_src_dir;
+using abigail::tools_utils::ensure_parent_dir_created;
+
+static const string baseline_path =
+  string(get_src_dir())
+  + "/tests/data/test-baseline-units/baseline.abi";
+
+/// The hashes of the translation units of a new binary which units
+/// are all the same as in the baseline.
+static const unordered_map<string, string> same_hashes =
+{
+  {"/src/a.c", "00000000000000a1"},
+  {"/src/b.c", "00000000000000b1"},
+  {"/src/c.c", "00000000000000c1"},
+  {"/src/d.c", "00000000000000d1"}
+};
+
+/// The names of the types defined by the translation units of a new
+/// binary which units are all the same as in the baseline.
+static const unordered_map<string, unordered_set<string>> same_type_names =
+{
+  {"/src/a.c", {"S"}}
+};
+
+TEST_CASE("UnchangedUnitsAreReused", "[baseline]")
+{
+  unordered_set<string> reusable;
+  REQUIRE(find_reusable_translation_units(baseline_path,
+					  same_hashes,
+					  same_type_names,
+					  reusable));
+  // d.c has no content hash in the baseline, so it's not re-used.
+  CHECK(reusable == unordered_set<string>({"/src/a.c", "/src/b.c",
+					   "/src/c.c"}));
+}
+
+TEST_CASE("ChangedUnitsAreNotReused", "[baseline]")
+{
+  unordered_map<string, string> hashes = same_hashes;
+  hashes["/src/c.c"] = "00000000000000c2";
+  hashes.erase("/src/b.c");
+
+  unordered_set<string> reusable;
+  REQUIRE(find_reusable_translation_units(baseline_path,
+					  hashes,
+					  same_type_names,
+					  reusable));
+  CHECK(reusable == unordered_set<string>({"/src/a.c"}));
+}
+
+TEST_CASE("UsersOfChangedDefinitionsAreNotReused", "[baseline]")
+{
+  // a.c defines S, which b.c only declares, so b.c must be read
+  // again when a.c changed.  c.c must be read again too, as the type
+  // 'int' it uses is defined in a.c in the baseline.
+  unordered_map<string, string> hashes = same_hashes;
+  hashes["/src/a.c"] = "00000000000000a2";
+
+  unordered_set<string> reusable;
+  REQUIRE(find_reusable_translation_units(baseline_path,
+					  hashes,
+					  same_type_names,
+					  reusable));
+  CHECK(reusable.empty());
+
+  // c.c only declares T, which is used through a typedef.  A new
+  // unit that defines T taints c.c.
+  unordered_map<string, unordered_set<string>> type_names = same_type_names;
+  type_names["/src/e.c"] = {"T"};
+  hashes = same_hashes;
+  hashes["/src/e.c"] = "00000000000000e1";
+  REQUIRE(find_reusable_translation_units(baseline_path,
+					  hashes,
+					  type_names,
+					  reusable));
+  CHECK(reusable == unordered_set<string>({"/src/a.c", "/src/b.c"}));
+}
+
+TEST_CASE("MissingBaseline", "[baseline]")
+{
+  unordered_set<string> reusable;
+  CHECK(!find_reusable_translation_units(baseline_path + ".missing",
+					 same_hashes,
+					 same_type_names,
+					 reusable));
+}
+
+TEST_CASE("ContentHashRoundTrip", "[baseline]")
+{
+  environment env;
+  corpus_sptr corp = read_corpus_from_abixml_file(baseline_path, env);
+  REQUIRE(corp);
+
+  unordered_map<string, string> hashes;
+  for (const translation_unit_sptr& tu : corp->get_translation_units())
+    hashes[tu->get_absolute_path()] = tu->get_content_hash();
+  CHECK(hashes["/src/a.c"] == "00000000000000a1");
+  CHECK(hashes["/src/c.c"] == "00000000000000c1");
+  CHECK(hashes["/src/d.c"].empty());
+
+  std::ostringstream o;
+  abigail::xml_writer::write_context_sptr ctxt =
+    abigail::xml_writer::create_write_context(env, o);
+  REQUIRE(abigail::xml_writer::write_corpus(*ctxt, corp, 0));
+  CHECK(o.str().find("content-hash='00000000000000b1'") != string::npos);
+}
+
+/// The directory of the binaries that are read with a baseline.
+static const string in_dir =
+  string(get_src_dir()) + "/tests/data/";
+
+/// The directory of the output of the tests that run abidw.
+static const string out_dir =
+  string(get_build_dir()) + "/tests/output/test-baseline-units/";
+
+/// Run a command and return its exit status, or -1 if it didn't exit
+/// normally.
+///
+/// @param cmd the command to run.
+///
+/// @return the exit status of @p cmd.
+static int
+run(const string& cmd)
+{
+  int code = system(cmd.c_str());
+  if (!WIFEXITED(code))
+    return -1;
+  return WEXITSTATUS(code);
+}
+
+/// Read a binary with abidw, using an abixml file as a baseline, and
+/// compare the result with a full read of the binary.
+///
+/// @param binary the path to the binary, relative to tests/data.
+///
+/// @param baseline the path to the baseline abixml file.
+///
+/// @param log the path to the file where to save the output of abidw
+/// --verbose.
+///
+/// @return the path to the abixml file emitted with the baseline.
+static string
+read_with_baseline_and_compare(const string& binary,
+			       const string& baseline,
+			       const string& log)
+{
+  string abidw = string(get_build_dir()) + "/tools/abidw";
+  string abidiff = string(get_build_dir()) + "/tools/abidiff";
+  string full = out_dir + binary + ".full.abi";
+  string incremental = out_dir + binary + ".incremental.abi";
+  REQUIRE(ensure_parent_dir_created(full));
+
+  REQUIRE(run(abidw + " --hash-translation-units " + in_dir + binary
+	      + " > " + full) == 0);
+  REQUIRE(run(abidw + " --verbose --baseline " + baseline + " "
+	      + in_dir + binary + " > " + incremental
+	      + " 2> " + log) == 0);
+
+  // The abixml writer doesn't emit the types of a translation unit
+  // that was read from abixml in the same order as the types of a
+  // translation unit read from DWARF, so the two files are compared
+  // as ABIs, not as text.
+  CHECK(run(abidiff + " " + full + " " + incremental + " > /dev/null")
+	== abigail::tools_utils::ABIDIFF_OK);
+  return incremental;
+}
+
+/// Test if a file contains a string.
+///
+/// @param path the path to the file.
+///
+/// @param str the string to look for.
+///
+/// @return true iff the file at @p path contains @p str.
+static bool
+file_contains(const string& path, const string& str)
+{
+  std::ifstream in(path);
+  std::ostringstream o;
+  o << in.rdbuf();
+  return o.str().find(str) != string::npos;
+}
+
+TEST_CASE("BaselineOfPreviousVersion", "[baseline]")
+{
+  // move.c changed between v0 and v1 of libshape.so, shape.c and
+  // area.c didn't.
+  string abidw = string(get_build_dir()) + "/tools/abidw";
+  string abidiff = string(get_build_dir()) + "/tools/abidiff";
+  string old_abi = out_dir + "test-baseline-units/v0/libshape.so.abi";
+  string log = out_dir + "test-baseline-units/v1/libshape.so.log";
+  REQUIRE(ensure_parent_dir_created(old_abi));
+  REQUIRE(run(abidw + " --hash-translation-units "
+	      + in_dir + "test-baseline-units/v0/libshape.so > "
+	      + old_abi) == 0);
+
+  string incremental =
+    read_with_baseline_and_compare("test-baseline-units/v1/libshape.so",
+				   old_abi, log);
+  CHECK(file_contains(log, "re-using 2 of 3 translation units"));
+
+  // The change of move.c is seen.
+  int status = run(abidiff + " " + old_abi + " " + incremental
+		   + " > /dev/null");
+  REQUIRE(status >= 0);
+  CHECK(status & abigail::tools_utils::ABIDIFF_ABI_CHANGE);
+}
+
+TEST_CASE("BaselineOfSameVersion", "[baseline]")
+{
+  // Using the output of abidw on a binary as the baseline to read the
+  // same binary again.
+  const char* binaries[] =
+    {
+      "test-read-dwarf/test0",
+      "test-read-dwarf/test9-pr18818-clang.so",
+      "test-read-dwarf/test13-pr18894.so",
+      "test-read-dwarf/test14-pr18893.so",
+      "test-read-dwarf/test16-pr18904.so",
+      "test-read-dwarf/test17-pr19027.so",
+    };
+
+  for (const char* binary : binaries)
+    {
+      INFO(binary);
+      string baseline = out_dir + binary + ".baseline.abi";
+      REQUIRE(ensure_parent_dir_created(baseline));
+      REQUIRE(run(string(get_build_dir()) + "/tools/abidw"
+		  + " --hash-translation-units " + in_dir + binary
+		  + " > " + baseline) == 0);
+      read_with_baseline_and_compare(binary, baseline,
+				     out_dir + binary + ".log");
+      CHECK(file_contains(out_dir + binary + ".log", "re-using"));
+    }
+}
@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2023 Red Hat, Inc.
+
+/// @file
+///
+/// This program tests the canonicalization of DIEs by the DWARF
+/// reader.
+
+#include <string>
+#include <vector>
+
+#include "lib/catch.hpp"
+#include "test-utils.h"
+
+#include "abg-corpus.h"
+#include "abg-dwarf-reader.h"
+
+using std::string;
+using std::vector;
+
+using abigail::ir::environment;
+using abigail::ir::corpus_sptr;
+using abigail::elf_based_reader_sptr;
+using abigail::fe_iface;
+using abigail::metrics::memory_stats;
+using abigail::metrics::memory_usage;
+
+static const string test_data_dir =
+  string(abigail::tests::get_src_dir()) + "/tests/data/test-canonical-dies/";
+
+/// Read the corpus of an ELF file of the test data, recording the
+/// metrics of the reading.
+///
+/// @param name the name of the ELF file.
+///
+/// @param env the environment to read the corpus into.  Its metrics
+/// registry is enabled.
+///
+/// @param stats output parameter.  The memory used by the reader.
+static void
+read_corpus(const string& name, environment& env, memory_stats& stats)
+{
+  env.get_metrics().enable(true);
+  vector<char**> di_roots;
+  elf_based_reader_sptr rdr =
+    abigail::dwarf::create_reader(test_data_dir + name, di_roots, env);
+  fe_iface::status status = fe_iface::STATUS_UNKNOWN;
+  corpus_sptr corp = rdr->read_corpus(status);
+  REQUIRE(corp);
+  rdr->get_memory_stats(stats);
+}
+
+/// Get the number of structural hashes of DIEs computed by a reader.
+///
+/// @param stats the memory used by the reader.
+///
+/// @return the number of structural hashes.
+static uint64_t
+get_number_of_die_hashes(const memory_stats& stats)
+{
+  const memory_usage* u = stats.get_usage("dwarf.die-structural-hashes");
+  return u ? u->nb_objects : 0;
+}
+
+TEST_CASE("CDiesArePartitionedByHash", "[canonical-dies]")
+{
+  // libs.so has three 'struct s', one per translation unit, that
+  // have the same string representation.  The one of s2.c has a
+  // different layout from the other two, so it has a different
+  // structural hash, and so do the pointers to it.  Looking up the
+  // canonical DIE of those types thus considers fewer candidates
+  // than their representation buckets hold.
+  environment env;
+  memory_stats stats;
+  read_corpus("libs.so", env, stats);
+
+  const abigail::metrics::registry& m = env.get_metrics();
+  CHECK(m.get_counter("dwarf.canonical-die-lookups") > 0);
+  CHECK(m.get_counter("dwarf.canonical-die-candidates-by-hash")
+	< m.get_counter("dwarf.canonical-die-candidates-by-repr"));
+  CHECK(get_number_of_die_hashes(stats) > 0);
+}
+
+TEST_CASE("CxxDiesAreNotHashed", "[canonical-dies]")
+{
+  // libs-cxx.so is libs.so built as C++.  The One Definition Rule
+  // makes the structural hashes unreliable, so they are not computed
+  // and each DIE is compared to its whole representation bucket.
+  environment env;
+  memory_stats stats;
+  read_corpus("libs-cxx.so", env, stats);
+
+  const abigail::metrics::registry& m = env.get_metrics();
+  CHECK(m.get_counter("dwarf.canonical-die-lookups") > 0);
+  CHECK(m.get_counter("dwarf.canonical-die-candidates-by-hash")
+	== m.get_counter("dwarf.canonical-die-candidates-by-repr"));
+  CHECK(get_number_of_die_hashes(stats) == 0);
+}
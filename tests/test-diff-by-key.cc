@@ -0,0 +1,237 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2023 Red Hat, Inc.
+
+/// @file
+///
+/// This program tests the diff_utils::compute_diff_by_key algorithm
+/// declared and defined in abg-diff-utils.h.
+
+#include <string>
+#include <vector>
+
+#include "lib/catch.hpp"
+
+#include "abg-diff-utils.h"
+
+using std::string;
+using std::vector;
+
+using abigail::diff_utils::compute_diff;
+using abigail::diff_utils::compute_diff_by_key;
+using abigail::diff_utils::deletion;
+using abigail::diff_utils::edit_script;
+using abigail::diff_utils::insertion;
+using abigail::diff_utils::point;
+
+/// An element of the sequences to diff, made of a key and a value.
+struct elem
+{
+  string	key;
+  int		value;
+
+  elem(const string& k, int v = 0)
+    : key(k), value(v)
+  {}
+}; // end struct elem
+
+/// The functor computing the key of an @ref elem.
+struct elem_key
+{
+  const string&
+  operator()(const elem& e) const
+  {return e.key;}
+}; // end struct elem_key
+
+/// The functor comparing two instances of @ref elem.
+struct elem_equal
+{
+  bool
+  operator()(const elem& l, const elem& r) const
+  {return l.key == r.key && l.value == r.value;}
+}; // end struct elem_equal
+
+/// Build a sequence of elements from a string, each character being
+/// the key of an element, with a value of zero.
+///
+/// @param keys the keys of the elements of the sequence.
+///
+/// @return the sequence.
+static vector<elem>
+make_sequence(const string& keys)
+{
+  vector<elem> result;
+  for (char c : keys)
+    result.push_back(elem(string(1, c)));
+  return result;
+}
+
+/// Compute the edit script of two sequences with compute_diff_by_key.
+///
+/// @param a the first sequence.
+///
+/// @param b the second sequence.
+///
+/// @param ses output parameter.  The resulting edit script.
+static void
+diff_by_key(const vector<elem>& a, const vector<elem>& b, edit_script& ses)
+{
+  compute_diff_by_key<vector<elem>::const_iterator,
+		      elem_key, elem_equal>(a.begin(), a.end(),
+					    b.begin(), b.end(),
+					    ses);
+}
+
+/// Get the indexes of the deleted elements of an edit script.
+///
+/// @param ses the edit script to consider.
+///
+/// @return the indexes of the deleted elements, in order.
+static vector<int>
+deleted_indexes(const edit_script& ses)
+{
+  vector<int> result;
+  for (const deletion& d : ses.deletions())
+    result.push_back(d.index());
+  return result;
+}
+
+/// Get the insertion point of each inserted element of an edit
+/// script.
+///
+/// @param ses the edit script to consider.
+///
+/// @return a vector of pairs made of the index of an inserted
+/// element and of its insertion point, in the order of the inserted
+/// elements.
+static vector<std::pair<unsigned, int>>
+inserted_indexes(const edit_script& ses)
+{
+  vector<std::pair<unsigned, int>> result;
+  for (const insertion& i : ses.insertions())
+    for (unsigned j : i.inserted_indexes())
+      result.push_back(std::make_pair(j, i.insertion_point_index()));
+  return result;
+}
+
+TEST_CASE("SameSequences", "[diff-by-key]")
+{
+  vector<elem> a = make_sequence("abcdef");
+  edit_script ses;
+  diff_by_key(a, a, ses);
+  CHECK(ses.deletions().empty());
+  CHECK(ses.insertions().empty());
+}
+
+TEST_CASE("ReorderedElementsAreMatched", "[diff-by-key]")
+{
+  // The order of the elements doesn't matter to the matching of
+  // elements having the same key.
+  edit_script ses;
+  diff_by_key(make_sequence("abcdef"), make_sequence("fedcba"), ses);
+  CHECK(ses.deletions().empty());
+  CHECK(ses.insertions().empty());
+}
+
+TEST_CASE("DuplicateKeys", "[diff-by-key]")
+{
+  // Two elements of A have the key "k".  They are matched with the
+  // elements of B that have the same key and are equal to them, in
+  // whatever order they appear in B.
+  vector<elem> a = {elem("k", 1), elem("x"), elem("k", 2)};
+  vector<elem> b = {elem("k", 2), elem("x"), elem("k", 1)};
+  {
+    edit_script ses;
+    diff_by_key(a, b, ses);
+    CHECK(ses.deletions().empty());
+    CHECK(ses.insertions().empty());
+  }
+
+  // Only one element of B has the key "k".  It is equal to the
+  // second element of A having that key, so the first one is
+  // deleted.
+  b = {elem("k", 2), elem("x")};
+  {
+    edit_script ses;
+    diff_by_key(a, b, ses);
+    CHECK(deleted_indexes(ses) == vector<int>({0}));
+    CHECK(ses.insertions().empty());
+  }
+
+  // An element of B is not matched twice: the two elements of B
+  // that are equal to the first element of A only match it once.
+  a = {elem("k", 1)};
+  b = {elem("k", 1), elem("k", 1)};
+  {
+    edit_script ses;
+    diff_by_key(a, b, ses);
+    CHECK(ses.deletions().empty());
+    CHECK(inserted_indexes(ses)
+	  == (vector<std::pair<unsigned, int>>({{1, 0}})));
+  }
+}
+
+TEST_CASE("SameKeyUnequalElements", "[diff-by-key]")
+{
+  // The element of key "b" changed.  It's reported as the deletion of
+  // the element of A and the insertion of the element of B, after the
+  // element of A that is matched with the element preceding it in B.
+  vector<elem> a = {elem("a"), elem("b", 1), elem("c")};
+  vector<elem> b = {elem("a"), elem("b", 2), elem("c")};
+  edit_script ses;
+  diff_by_key(a, b, ses);
+  CHECK(deleted_indexes(ses) == vector<int>({1}));
+  CHECK(inserted_indexes(ses)
+	== (vector<std::pair<unsigned, int>>({{1, 0}})));
+
+  // Elements having the same key but that are different are not
+  // handed to the sequence diff algorithm, even if they could be
+  // matched with elements having another key.
+  a = {elem("a", 1), elem("z")};
+  b = {elem("a", 2), elem("y")};
+  edit_script ses2;
+  diff_by_key(a, b, ses2);
+  CHECK(deleted_indexes(ses2) == vector<int>({0, 1}));
+  CHECK(inserted_indexes(ses2)
+	== (vector<std::pair<unsigned, int>>({{0, -1}, {1, -1}})));
+}
+
+TEST_CASE("InsertionPointsMatchComputeDiff", "[diff-by-key]")
+{
+  // When each key is unique and the matched elements are in the same
+  // order in both sequences, the elements deleted from A, the
+  // elements inserted from B and their insertion points are the ones
+  // computed by compute_diff.
+  const vector<std::pair<string, string>> cases =
+    {
+      {"abcdef", "abcdef"},
+      {"abcdef", "xabcdef"},
+      {"abcdef", "abcdefx"},
+      {"abcdef", "abxydef"},
+      {"abcdef", "acdf"},
+      {"abcdef", "xyz"},
+      {"", "abc"},
+      {"abc", ""},
+      {"abcdefgh", "axcyegz"},
+      {"abcdefgh", "bcdxyzfh"},
+    };
+
+  for (const auto& c : cases)
+    {
+      INFO(c.first << " -> " << c.second);
+      vector<elem> a = make_sequence(c.first), b = make_sequence(c.second);
+
+      edit_script by_key_ses;
+      diff_by_key(a, b, by_key_ses);
+
+      vector<point> lcs;
+      edit_script ses;
+      compute_diff<vector<elem>::const_iterator,
+		   elem_equal>(a.begin(), a.end(), b.begin(), b.end(),
+			       lcs, ses);
+
+      CHECK(deleted_indexes(by_key_ses) == deleted_indexes(ses));
+      CHECK(inserted_indexes(by_key_ses) == inserted_indexes(ses));
+    }
+}
@@ -149,6 +149,47 @@ static InOutSpec in_out_specs[] =
     "data/test-diff-pkg/dirpkg-3-report-2.txt",
     "output/test-diff-pkg/dirpkg-3-report-2.txt"
   },
+  // Several binaries using the same types.
+  {
+    "data/test-diff-pkg/dirpkg-4-dir1",
+    "data/test-diff-pkg/dirpkg-4-dir2",
+    "--no-default-suppression --no-show-locs",
+    "",
+    "",
+    "",
+    "",
+    "",
+    "data/test-diff-pkg/dirpkg-4-report-0.txt",
+    "output/test-diff-pkg/dirpkg-4-report-0.txt"
+  },
+  // Just like the previous test, but the binaries are read in the
+  // same environment.  The report must be the same.
+  {
+    "data/test-diff-pkg/dirpkg-4-dir1",
+    "data/test-diff-pkg/dirpkg-4-dir2",
+    "--no-default-suppression --no-show-locs --shared-environment",
+    "",
+    "",
+    "",
+    "",
+    "",
+    "data/test-diff-pkg/dirpkg-4-report-0.txt",
+    "output/test-diff-pkg/dirpkg-4-report-0-shared-env.txt"
+  },
+  // Just like the test of dirpkg-3 above, with the binaries read in
+  // the same environment.
+  {
+    "data/test-diff-pkg/dirpkg-3-dir1",
+    "data/test-diff-pkg/dirpkg-3-dir2",
+    "--no-default-suppression --no-show-locs --shared-environment",
+    "data/test-diff-pkg/dirpkg-3.suppr",
+    "",
+    "",
+    "",
+    "",
+    "data/test-diff-pkg/dirpkg-3-report-0.txt",
+    "output/test-diff-pkg/dirpkg-3-report-0-shared-env.txt"
+  },
   {
     "data/test-diff-pkg/symlink-dir-test1/dir1/symlinks",
     "data/test-diff-pkg/symlink-dir-test1/dir2/symlinks",
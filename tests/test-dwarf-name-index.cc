@@ -0,0 +1,307 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2023 Red Hat, Inc.
+
+/// @file
+///
+/// This program tests libabigail's reader of the .debug_names and
+/// .gdb_index name indexes, and the use of these indexes by the DWARF
+/// reader.
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <libelf.h>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "lib/catch.hpp"
+#include "test-utils.h"
+
+#include "abg-corpus.h"
+#include "abg-dwarf-reader.h"
+#include "abg-writer.h"
+#include "abg-dwarf-name-index.h"
+
+using abigail::dwarf_name_index::get_lookup_names_of_demangled_name;
+using abigail::dwarf_name_index::name_index;
+using abigail::dwarf_name_index::name_index_sptr;
+using abigail::ir::corpus_sptr;
+using abigail::ir::environment;
+using abigail::elf_based_reader_sptr;
+using abigail::fe_iface;
+
+static const std::string test_data_dir =
+  std::string(abigail::tests::get_src_dir()) + "/tests/data/test-read-dwarf/";
+
+static const std::string name_index_data_dir =
+  std::string(abigail::tests::get_src_dir())
+  + "/tests/data/test-dwarf-name-index/";
+
+/// The name index of an ELF file of the test data.
+///
+/// The ELF file is kept open as long as the index is used, as the
+/// index refers to its content.
+struct loaded_name_index
+{
+  int			fd;
+  Elf*			elf;
+  name_index_sptr	index;
+
+  /// Load the name index of an ELF file of the test data.
+  ///
+  /// @param name the name of the ELF file, relative to @p dir.
+  ///
+  /// @param dir the directory of the ELF file.
+  loaded_name_index(const std::string& name,
+		    const std::string& dir = test_data_dir)
+    : fd(-1), elf()
+  {
+    elf_version(EV_CURRENT);
+    fd = open((dir + name).c_str(), O_RDONLY);
+    REQUIRE(fd >= 0);
+    elf = elf_begin(fd, ELF_C_READ_MMAP, nullptr);
+    REQUIRE(elf);
+    index = name_index::load(elf);
+  }
+
+  ~loaded_name_index()
+  {
+    index.reset();
+    if (elf)
+      elf_end(elf);
+    if (fd >= 0)
+      close(fd);
+  }
+}; // end struct loaded_name_index
+
+TEST_CASE("NameIndex::GdbIndex", "[dwarf_name_index]")
+{
+  loaded_name_index l("test9-pr18818-clang.so");
+  name_index_sptr index = l.index;
+  REQUIRE(index);
+  CHECK(index->get_kind() == name_index::GDB_INDEX_KIND);
+  CHECK(index->get_number_of_names() == 955);
+
+  // This is only in the second compilation unit.
+  name_index::entries_type entries;
+  REQUIRE(index->lookup("boost::filesystem::detail::create_directory",
+			entries));
+  REQUIRE(entries.size() == 1);
+  CHECK(entries[0].unit_offset == 0x2787);
+  CHECK(entries[0].die_offset == 0);
+
+  // This is in seven compilation units.
+  REQUIRE(index->lookup("uint64_t", entries));
+  CHECK(entries.size() == 7);
+
+  CHECK(!index->lookup("no_such_name", entries));
+
+  CHECK(index->get_number_of_covered_units() == 8);
+  CHECK(index->covers_unit(0x2787));
+  CHECK(!index->covers_unit(0x2788));
+}
+
+TEST_CASE("NameIndex::NoIndex", "[dwarf_name_index]")
+{
+  CHECK(!loaded_name_index("test0").index);
+}
+
+TEST_CASE("NameIndex::DebugNames", "[dwarf_name_index]")
+{
+  // A .debug_names section with one name index for a compilation
+  // unit at offset 0x100, naming the DIEs "foo" and "bar".  The
+  // second entry of "bar" is in a type unit and is ignored.
+  const unsigned char debug_str[] = "foo\0bar";
+  const unsigned char debug_names[] =
+  {
+    0x57, 0, 0, 0,		// unit_length
+    5, 0, 0, 0,			// version, padding
+    1, 0, 0, 0,			// comp_unit_count
+    0, 0, 0, 0,			// local_type_unit_count
+    0, 0, 0, 0,			// foreign_type_unit_count
+    0, 0, 0, 0,			// bucket_count
+    2, 0, 0, 0,			// name_count
+    17, 0, 0, 0,		// abbrev_table_size
+    0, 0, 0, 0,			// augmentation_string_size
+    0, 1, 0, 0,			// the compilation unit
+    0, 0, 0, 0,   4, 0, 0, 0,	// the offsets of the names
+    0, 0, 0, 0,   6, 0, 0, 0,	// the offsets of the entries
+    // Abbreviation 1: DW_TAG_subprogram, DW_IDX_die_offset
+    // DW_FORM_ref4, DW_IDX_parent DW_FORM_flag_present.
+    1, 0x2e, 3, 0x13, 4, 0x19, 0, 0,
+    // Abbreviation 2: DW_TAG_structure_type, DW_IDX_type_unit
+    // DW_FORM_data1, DW_IDX_die_offset DW_FORM_ref4.
+    2, 0x13, 2, 0x0b, 3, 0x13, 0, 0,
+    0,
+    // The entries of "foo".
+    1, 0x2a, 0, 0, 0,   0,
+    // The entries of "bar".
+    1, 0x40, 0, 0, 0,   2, 0, 0x99, 0, 0, 0,   0
+  };
+
+  name_index_sptr index =
+    name_index::read_debug_names(debug_names, sizeof(debug_names),
+				 debug_str, sizeof(debug_str),
+				 /*is_big_endian=*/false);
+  REQUIRE(index);
+  CHECK(index->get_kind() == name_index::DEBUG_NAMES_KIND);
+  CHECK(index->get_number_of_names() == 2);
+  CHECK(index->get_number_of_covered_units() == 1);
+  CHECK(index->covers_unit(0x100));
+
+  name_index::entries_type entries;
+  REQUIRE(index->lookup("foo", entries));
+  REQUIRE(entries.size() == 1);
+  CHECK(entries[0].unit_offset == 0x100);
+  CHECK(entries[0].die_offset == 0x12a);
+
+  REQUIRE(index->lookup("bar", entries));
+  REQUIRE(entries.size() == 1);
+  CHECK(entries[0].die_offset == 0x140);
+
+  // A truncated section is rejected.
+  for (size_t size = 1; size < sizeof(debug_names); ++size)
+    CHECK(!name_index::read_debug_names(debug_names, size,
+					debug_str, sizeof(debug_str),
+					/*is_big_endian=*/false));
+}
+
+TEST_CASE("NameIndex::DebugNamesOfLinkedObjects", "[dwarf_name_index]")
+{
+  // The name indexes of the three units of libnameindex.so that were
+  // compiled by llc are merged by the linker.  The unit compiled by
+  // GCC is not covered.
+  loaded_name_index l("libnameindex.so", name_index_data_dir);
+  name_index_sptr index = l.index;
+  REQUIRE(index);
+  CHECK(index->get_kind() == name_index::DEBUG_NAMES_KIND);
+  CHECK(index->get_number_of_covered_units() == 3);
+  CHECK(index->covers_unit(0));
+  CHECK(index->covers_unit(0x62));
+  CHECK(index->covers_unit(0xb6));
+  CHECK(!index->covers_unit(0x115));
+
+  // The DIEs are indexed by their names and their linkage names.
+  name_index::entries_type entries;
+  REQUIRE(index->lookup("foo<int>", entries));
+  REQUIRE(entries.size() == 1);
+  CHECK(entries[0].unit_offset == 0);
+  REQUIRE(index->lookup("_ZN2ns3barB5cxx11Ev", entries));
+  CHECK(entries[0].unit_offset == 0);
+  REQUIRE(index->lookup("baz", entries));
+  CHECK(entries[0].unit_offset == 0x62);
+  CHECK(!index->lookup("qux", entries));
+
+  // "int" is in the three units.
+  REQUIRE(index->lookup("int", entries));
+  CHECK(entries.size() == 3);
+}
+
+/// Test if the names to look up for a demangled name contain a given
+/// name.
+///
+/// @param demangled_name the demangled name to consider.
+///
+/// @param name the name to look for.
+///
+/// @return true iff @p name is one of the names to look up for @p
+/// demangled_name.
+static bool
+lookup_names_contain(const std::string& demangled_name,
+		     const std::string& name)
+{
+  std::vector<std::string> names;
+  get_lookup_names_of_demangled_name(demangled_name, names);
+  return std::find(names.begin(), names.end(), name) != names.end();
+}
+
+TEST_CASE("NameIndex::LookupNamesOfDemangledNames", "[dwarf_name_index]")
+{
+  // Return types and parameters are stripped.
+  CHECK(lookup_names_contain("void foo<int>(int)", "foo<int>"));
+  CHECK(lookup_names_contain("std::vector<int, std::allocator<int> > "
+			     "ns::make<int>(int)", "ns::make<int>"));
+  CHECK(lookup_names_contain("std::vector<int, std::allocator<int> > "
+			     "ns::make<int>(int)", "make<int>"));
+  CHECK(lookup_names_contain("unsigned long ns::f<char>(char const*)",
+			     "ns::f<char>"));
+
+  // ABI tags are stripped.
+  CHECK(lookup_names_contain("ns::bar[abi:cxx11]()", "ns::bar"));
+  CHECK(lookup_names_contain("ns::bar[abi:cxx11]()", "bar"));
+  CHECK(lookup_names_contain("ns::S[abi:a][abi:b]::g() const",
+			     "ns::S::g"));
+
+  // Operators are not split.
+  CHECK(lookup_names_contain("ns::S::operator<(ns::S const&) const",
+			     "ns::S::operator<"));
+  CHECK(lookup_names_contain("bool ns::operator< <int>(ns::T<int>, int)",
+			     "ns::operator< <int>"));
+  CHECK(lookup_names_contain("ns::S::operator()(int)",
+			     "ns::S::operator()"));
+  CHECK(lookup_names_contain("ns::S::operator new(unsigned long)",
+			     "ns::S::operator new"));
+  CHECK(lookup_names_contain("ns::S::operator unsigned int() const",
+			     "ns::S::operator unsigned int"));
+  CHECK(!lookup_names_contain("ns::S::operator unsigned int() const",
+			      "int"));
+
+  // Variables.
+  CHECK(lookup_names_contain("(anonymous namespace)::v",
+			     "(anonymous namespace)::v"));
+  CHECK(lookup_names_contain("(anonymous namespace)::v", "v"));
+  CHECK(lookup_names_contain("ns::v", "ns::v"));
+}
+
+/// Read the corpus of libnameindex.so, only looking at its exported
+/// interfaces, and serialize it into abixml.
+///
+/// @param lazily true iff the exported interfaces are to be read
+/// lazily, which uses the name index.
+///
+/// @param nb_skipped_units output parameter.  The number of units
+/// that the name index made the reader skip.
+///
+/// @return the abixml of the corpus.
+static std::string
+read_libnameindex(bool lazily, uint64_t& nb_skipped_units)
+{
+  environment env;
+  env.analyze_exported_interfaces_only(true);
+  env.get_metrics().enable(true);
+  std::vector<char**> di_roots;
+  elf_based_reader_sptr rdr =
+    abigail::dwarf::create_reader(name_index_data_dir + "libnameindex.so",
+				  di_roots, env);
+  rdr->options().read_exported_interfaces_lazily = lazily;
+  fe_iface::status status = fe_iface::STATUS_UNKNOWN;
+  corpus_sptr corp = rdr->read_corpus(status);
+  REQUIRE(corp);
+  nb_skipped_units =
+    env.get_metrics().get_counter("dwarf.units-skipped-by-name-index");
+
+  std::ostringstream o;
+  abigail::xml_writer::write_context_sptr ctxt =
+    abigail::xml_writer::create_write_context(env, o);
+  REQUIRE(abigail::xml_writer::write_corpus(*ctxt, corp, 0));
+  return o.str();
+}
+
+TEST_CASE("NameIndex::LazyReadingIsComplete", "[dwarf_name_index]")
+{
+  uint64_t nb_skipped_units = 0;
+  std::string full = read_libnameindex(/*lazily=*/false, nb_skipped_units);
+  CHECK(nb_skipped_units == 0);
+  std::string lazy = read_libnameindex(/*lazily=*/true, nb_skipped_units);
+  // Only the unit of name-index-c.ll, which has no exported
+  // declaration, is skipped.  The unit of name-index-d.c is not
+  // covered by the index so it's read.
+  CHECK(nb_skipped_units == 1);
+  CHECK(lazy == full);
+
+  for (const char* name : {"'foo&lt;int&gt;'", "'baz'", "'qux'"})
+    CHECK(lazy.find(std::string("name=") + name) != std::string::npos);
+}
@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2023 Red Hat, Inc.
+
+/// @file
+///
+/// This program tests libabigail's interned string pool.
+
+#include <cstring>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "lib/catch.hpp"
+
+#include "abg-interned-str.h"
+#include "abg-workers.h"
+
+using std::string;
+using std::vector;
+
+using abigail::interned_string;
+using abigail::interned_string_pool;
+using abigail::workers::queue;
+
+TEST_CASE("EqualStringsAreInternedOnce", "[interned_string]")
+{
+  interned_string_pool pool;
+  interned_string foo = pool.create_string("foo");
+  interned_string bar = pool.create_string("bar");
+  CHECK(foo == pool.create_string(string("fo") + "o"));
+  CHECK(foo != bar);
+  CHECK(foo == string("foo"));
+  CHECK(bar == string("bar"));
+
+  CHECK(pool.has_string("foo"));
+  CHECK(!pool.has_string("baz"));
+  CHECK(!strcmp(pool.get_string("bar"), "bar"));
+  CHECK(pool.get_string("bar") == bar.raw()->c_str());
+  CHECK(!pool.get_string("baz"));
+
+  // The empty string is always in the pool, and is represented by an
+  // empty interned_string.
+  CHECK(pool.has_string(""));
+  CHECK(!strcmp(pool.get_string(""), ""));
+  CHECK(pool.create_string("").empty());
+
+  interned_string_pool::stats s = pool.get_stats();
+  CHECK(s.nb_strings == 2);
+  CHECK(s.nb_bytes == 8);
+  CHECK(s.nb_lookups == 3);
+  CHECK(s.nb_hits == 1);
+  CHECK(s.hit_rate() == Approx(1.0 / 3));
+}
+
+TEST_CASE("InternedStringsDontMove", "[interned_string]")
+{
+  interned_string_pool pool;
+  vector<interned_string> strings;
+  for (size_t i = 0; i < 10000; ++i)
+    strings.push_back(pool.create_string("string-" + std::to_string(i)));
+  for (size_t i = 0; i < strings.size(); ++i)
+    {
+      CHECK(strings[i] == "string-" + std::to_string(i));
+      CHECK(strings[i] == pool.create_string("string-" + std::to_string(i)));
+    }
+  CHECK(pool.get_stats().nb_strings == 10000);
+}
+
+TEST_CASE("StringsAreInternedConcurrently", "[interned_string]")
+{
+  interned_string_pool pool;
+  queue q(8);
+  vector<std::future<vector<interned_string>>> results;
+  // Each task interns the same strings, in a different order.
+  for (size_t t = 0; t < 8; ++t)
+    results.push_back(q.schedule_function<vector<interned_string>>
+		      ([&pool, t]()
+		       {
+			 vector<interned_string> r(1000);
+			 for (size_t j = 0; j < r.size(); ++j)
+			   {
+			     size_t i = (j * 7 + t * 131) % r.size();
+			     r[i] = pool.create_string("s" + std::to_string(i));
+			   }
+			 return r;
+		       }));
+
+  vector<vector<interned_string>> strings;
+  for (auto& r : results)
+    strings.push_back(r.get());
+  q.wait_for_workers_to_complete();
+
+  for (const vector<interned_string>& s : strings)
+    CHECK(s == strings.front());
+  interned_string_pool::stats s = pool.get_stats();
+  CHECK(s.nb_strings == 1000);
+  CHECK(s.nb_lookups == 8000);
+  CHECK(s.nb_hits == 7000);
+}
@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2023 Red Hat, Inc.
+
+/// @file
+///
+/// This program tests the allocation of the IR nodes from the arena
+/// of their environment.
+
+#include <sstream>
+#include <string>
+
+#include "lib/catch.hpp"
+#include "test-utils.h"
+
+#include "abg-corpus.h"
+#include "abg-reader.h"
+#include "abg-writer.h"
+
+using std::string;
+
+using abigail::ir::environment;
+using abigail::ir::corpus_sptr;
+using abigail::abixml::read_corpus_from_abixml_file;
+
+static const string abixml_path =
+  string(abigail::tests::get_src_dir())
+  + "/tests/data/test-read-write/test28.xml";
+
+/// Read an abixml file and serialize the resulting corpus back.
+///
+/// @param env the environment to read the corpus in.
+///
+/// @return the serialization of the corpus.
+static string
+read_and_write(environment& env)
+{
+  corpus_sptr corp = read_corpus_from_abixml_file(abixml_path, env);
+  REQUIRE(corp);
+
+  std::ostringstream o;
+  abigail::xml_writer::write_context_sptr ctxt =
+    abigail::xml_writer::create_write_context(env, o);
+  REQUIRE(abigail::xml_writer::write_corpus(*ctxt, corp, 0));
+  return o.str();
+}
+
+TEST_CASE("ArenaAllocationIsOptIn", "[arena]")
+{
+  environment env;
+  CHECK(!env.use_arena_allocation());
+  env.use_arena_allocation(true);
+  CHECK(env.use_arena_allocation());
+  env.use_arena_allocation(false);
+  CHECK(!env.use_arena_allocation());
+}
+
+TEST_CASE("ArenaAllocatedCorpusIsTheSame", "[arena]")
+{
+  string heap_abixml;
+  {
+    environment env;
+    heap_abixml = read_and_write(env);
+  }
+
+  string arena_abixml;
+  {
+    environment env;
+    env.use_arena_allocation(true);
+    arena_abixml = read_and_write(env);
+    // The canonical types held by the environment are destroyed after
+    // the environment released its arena.  The arena is then
+    // destroyed along with the last of them.
+  }
+  CHECK(arena_abixml == heap_abixml);
+}
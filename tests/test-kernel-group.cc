@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2023 Red Hat, Inc.
+
+/// @file
+///
+/// This program tests that serializing the corpus group of a Linux
+/// Kernel tree as its corpora are built, like abidw --linux-tree
+/// does, emits the same abixml as serializing the whole group once
+/// it's built.
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "lib/catch.hpp"
+#include "test-utils.h"
+
+#include "abg-corpus.h"
+#include "abg-tools-utils.h"
+#include "abg-writer.h"
+
+using std::string;
+using std::vector;
+
+using abigail::ir::environment;
+using abigail::ir::corpus_sptr;
+using abigail::ir::corpus_group_sptr;
+using abigail::suppr::suppressions_type;
+using abigail::tools_utils::build_corpus_group_from_kernel_dist_under;
+using abigail::xml_writer::write_context_sptr;
+using abigail::xml_writer::create_write_context;
+
+/// The root of a kernel tree made of a vmlinux and three modules.
+/// The modules re-use types of the vmlinux and of one another.
+static const string dist_root =
+  string(abigail::tests::get_src_dir())
+  + "/tests/data/test-kernel-group/dist";
+
+/// Build the corpus group of the kernel tree under dist_root.
+///
+/// @param env the environment to build the group in.
+///
+/// @param on_corpus_added the handler to invoke each time a corpus is
+/// added to the group.
+///
+/// @return the corpus group.
+static corpus_group_sptr
+build_group(environment& env,
+	    const abigail::tools_utils::corpus_added_handler& on_corpus_added)
+{
+  vector<string> suppr_paths, kabi_wl_paths;
+  suppressions_type supprs;
+  return build_corpus_group_from_kernel_dist_under(dist_root,
+						   /*debug_info_root=*/"",
+						   /*vmlinux_path=*/"",
+						   suppr_paths, kabi_wl_paths,
+						   supprs, /*verbose=*/false,
+						   env,
+						   abigail::corpus::DWARF_ORIGIN,
+						   on_corpus_added);
+}
+
+TEST_CASE("StreamedGroupIsTheWholeGroup", "[kernel-group]")
+{
+  string whole;
+  {
+    environment env;
+    corpus_group_sptr group = build_group(env, nullptr);
+    REQUIRE(group);
+    REQUIRE(group->get_corpora().size() == 4);
+
+    std::ostringstream o;
+    write_context_sptr ctxt = create_write_context(env, o);
+    REQUIRE(abigail::xml_writer::write_corpus_group(*ctxt, group, 0));
+    whole = o.str();
+  }
+
+  environment env;
+  std::ostringstream o;
+  write_context_sptr ctxt = create_write_context(env, o);
+  bool header_written = false, members_written = true;
+  corpus_group_sptr group =
+    build_group(env, [&](const corpus_group_sptr& g)
+    {
+      if (!header_written)
+	header_written =
+	  abigail::xml_writer::write_corpus_group_header(*ctxt, g, 0);
+      const corpus_sptr& corp = g->get_corpora().back();
+      members_written &=
+	abigail::xml_writer::write_corpus_group_member(*ctxt, corp, 0);
+      corp->drop_symbols_and_exported_decls();
+    });
+  REQUIRE(group);
+  REQUIRE(header_written);
+  REQUIRE(members_written);
+  abigail::xml_writer::write_corpus_group_footer(*ctxt, 0);
+
+  CHECK(o.str() == whole);
+
+  // The corpora that were emitted don't hold on to their symbols
+  // anymore.
+  for (const corpus_sptr& corp : group->get_corpora())
+    {
+      CHECK(!corp->get_symtab());
+      CHECK(corp->get_functions().empty());
+      CHECK(corp->get_sorted_fun_symbols().empty());
+    }
+}
@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2023 Red Hat, Inc.
+
+/// @file
+///
+/// This program tests the reports of the memory used by the ABI
+/// corpora.
+
+#include <sstream>
+#include <string>
+
+#include "lib/catch.hpp"
+#include "test-utils.h"
+
+#include "abg-corpus.h"
+#include "abg-reader.h"
+
+using std::string;
+
+using abigail::ir::environment;
+using abigail::ir::corpus_sptr;
+using abigail::metrics::memory_stats;
+using abigail::metrics::memory_usage;
+using abigail::abixml::read_corpus_from_abixml_file;
+
+TEST_CASE("MemoryUsagesAccumulatePerCategory", "[mem-stats]")
+{
+  memory_stats s;
+  CHECK(!s.get_usage("a"));
+  s.record("a", 1, 10);
+  s.record("b", 2, 20);
+  s.record("a", 3, 30);
+
+  const memory_usage* a = s.get_usage("a");
+  REQUIRE(a);
+  CHECK(a->nb_objects == 4);
+  CHECK(a->nb_bytes == 40);
+  CHECK(s.get_usages().size() == 2);
+  CHECK(s.get_total_bytes() == 60);
+
+  std::ostringstream o;
+  s.emit_report(o);
+  CHECK(o.str().find("total") != string::npos);
+}
+
+TEST_CASE("CorpusMemoryUsage", "[mem-stats]")
+{
+  environment env;
+  corpus_sptr corp =
+    read_corpus_from_abixml_file(string(abigail::tests::get_src_dir())
+				 + "/tests/data/test-read-write/test28.xml",
+				 env);
+  REQUIRE(corp);
+
+  memory_stats s;
+  corp->get_memory_stats(s);
+
+  const memory_usage* fns = s.get_usage("ir.function-decl");
+  REQUIRE(fns);
+  CHECK(fns->nb_objects > 0);
+  CHECK(fns->nb_bytes >= fns->nb_objects * sizeof(abigail::ir::function_decl));
+
+  const memory_usage* strings = s.get_usage("env.interned-strings");
+  REQUIRE(strings);
+  CHECK(strings->nb_objects > 0);
+
+  CHECK(s.get_usage("ir.global-scope"));
+  CHECK(s.get_usage("env.canonical-types-map"));
+
+  // Recording the same corpus again doubles the counts.
+  memory_stats s2;
+  corp->get_memory_stats(s2);
+  corp->get_memory_stats(s2);
+  CHECK(s2.get_usage("ir.function-decl")->nb_objects == 2 * fns->nb_objects);
+  CHECK(s2.get_total_bytes() == 2 * s.get_total_bytes());
+}
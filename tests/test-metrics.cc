@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2023 Red Hat, Inc.
+
+/// @file
+///
+/// This program tests libabigail's registry of performance metrics.
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lib/catch.hpp"
+
+#include "abg-metrics.h"
+
+using abigail::metrics::counter;
+using abigail::metrics::registry;
+using abigail::metrics::scoped_phase;
+
+TEST_CASE("DisabledRegistryRecordsNothing", "[metrics]")
+{
+  registry r;
+  r.increment_counter("c");
+  {
+    scoped_phase p(r, "phase");
+  }
+  CHECK(r.get_counter("c") == 0);
+
+  std::ostringstream o;
+  r.emit_json(o);
+  CHECK(o.str().find("\"phase\"") == std::string::npos);
+}
+
+TEST_CASE("EnabledRegistryRecordsPhasesAndCounters", "[metrics]")
+{
+  registry r;
+  r.enable(true);
+  r.increment_counter("c");
+  r.increment_counter("c", 41);
+  for (int i = 0; i < 3; ++i)
+    scoped_phase p(r, "phase \"one\"");
+  CHECK(r.get_counter("c") == 42);
+
+  std::ostringstream o;
+  r.emit_json(o);
+  const std::string json = o.str();
+  CHECK(json.find("\"c\": 42") != std::string::npos);
+  CHECK(json.find("{\"name\": \"phase \\\"one\\\"\", \"count\": 3")
+	!= std::string::npos);
+}
+
+TEST_CASE("CountersAreNamedByStringsOrCStrings", "[metrics]")
+{
+  registry r;
+  r.increment_counter(std::string("c"));
+  CHECK(r.get_counter("c") == 0);
+
+  r.enable(true);
+  r.increment_counter("c", 2);
+  r.increment_counter(std::string("c"), 3);
+  CHECK(r.get_counter("c") == 5);
+}
+
+TEST_CASE("RegistriesAreMerged", "[metrics]")
+{
+  registry r1, r2;
+  r1.enable(true);
+  r2.enable(true);
+  r1.increment_counter("c", 1);
+  r2.increment_counter("c", 2);
+  r2.increment_counter("d", 3);
+  r1.merge(r2);
+  CHECK(r1.get_counter("c") == 3);
+  CHECK(r1.get_counter("d") == 3);
+  CHECK(r2.get_counter("c") == 2);
+}
+
+TEST_CASE("CounterHandlesFollowTheRegistry", "[metrics]")
+{
+  registry r;
+  counter& c = r.get_counter_handle("c");
+  CHECK(&c == &r.get_counter_handle("c"));
+
+  // A handle got while the registry is disabled doesn't count until
+  // the registry is enabled.
+  c.increment();
+  CHECK(r.get_counter("c") == 0);
+
+  r.enable(true);
+  c.increment(2);
+  r.increment_counter("c", 3);
+  CHECK(c.get_value() == 5);
+  CHECK(r.get_counter("c") == 5);
+
+  // Registering other counters doesn't invalidate the handle.
+  for (int i = 0; i < 100; ++i)
+    r.get_counter_handle("c" + std::to_string(i));
+  c.increment();
+  CHECK(r.get_counter("c") == 6);
+
+  registry r2;
+  r2.enable(true);
+  r2.merge(r);
+  CHECK(r2.get_counter_handle("c").get_value() == 6);
+}
+
+TEST_CASE("CounterHandlesAreIncrementedConcurrently", "[metrics]")
+{
+  registry r;
+  r.enable(true);
+  counter& c = r.get_counter_handle("c");
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+    threads.push_back(std::thread([&c]
+				  {
+				    for (int i = 0; i < 10000; ++i)
+				      c.increment();
+				  }));
+  for (std::thread& t : threads)
+    t.join();
+  CHECK(r.get_counter("c") == 40000);
+}
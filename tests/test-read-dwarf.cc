@@ -573,6 +573,98 @@ static InOutSpec in_out_specs[] =
     NULL,
 #endif
   },
+  // Computing the canonical DIEs before building the IR must not
+  // change the resulting abixml.
+  {
+    "data/test-read-dwarf/test9-pr18818-clang.so",
+    "",
+    "",
+    SEQUENCE_TYPE_ID_STYLE,
+    "data/test-read-dwarf/test9-pr18818-clang.so.abi",
+    "output/test-read-dwarf/test9-pr18818-clang.so.precompute-canonical-dies.abi",
+    "--precompute-canonical-dies",
+  },
+  {
+    "data/test-read-dwarf/test10-pr18818-gcc.so",
+    "",
+    "",
+    SEQUENCE_TYPE_ID_STYLE,
+    "data/test-read-dwarf/test10-pr18818-gcc.so.abi",
+    "output/test-read-dwarf/test10-pr18818-gcc.so.precompute-canonical-dies.abi",
+    "--precompute-canonical-dies",
+  },
+  {
+    "data/test-read-dwarf/test12-pr18844.so",
+    "",
+    "",
+    SEQUENCE_TYPE_ID_STYLE,
+    "data/test-read-dwarf/test12-pr18844.so.abi",
+    "output/test-read-dwarf/test12-pr18844.so.precompute-canonical-dies.abi",
+    "--precompute-canonical-dies",
+  },
+  {
+    "data/test-read-dwarf/test13-pr18894.so",
+    "",
+    "",
+    SEQUENCE_TYPE_ID_STYLE,
+    "data/test-read-dwarf/test13-pr18894.so.abi",
+    "output/test-read-dwarf/test13-pr18894.so.precompute-canonical-dies.abi",
+    "--precompute-canonical-dies",
+  },
+  {
+    "data/test-read-dwarf/test16-pr18904.so",
+    "",
+    "",
+    SEQUENCE_TYPE_ID_STYLE,
+    "data/test-read-dwarf/test16-pr18904.so.abi",
+    "output/test-read-dwarf/test16-pr18904.so.precompute-canonical-dies.abi",
+    "--precompute-canonical-dies",
+  },
+  {
+    "data/test-read-dwarf/test17-pr19027.so",
+    "",
+    "",
+    SEQUENCE_TYPE_ID_STYLE,
+    "data/test-read-dwarf/test17-pr19027.so.abi",
+    "output/test-read-dwarf/test17-pr19027.so.precompute-canonical-dies.abi",
+    "--precompute-canonical-dies",
+  },
+  {
+    "data/test-read-dwarf/test18-pr19037-libvtkRenderingLIC-6.1.so",
+    "",
+    "",
+    SEQUENCE_TYPE_ID_STYLE,
+    "data/test-read-dwarf/test18-pr19037-libvtkRenderingLIC-6.1.so.abi",
+    "output/test-read-dwarf/test18-pr19037-libvtkRenderingLIC-6.1.so.precompute-canonical-dies.abi",
+    "--precompute-canonical-dies",
+  },
+  {
+    "data/test-read-dwarf/test19-pr19023-libtcmalloc_and_profiler.so",
+    "",
+    "",
+    SEQUENCE_TYPE_ID_STYLE,
+    "data/test-read-dwarf/test19-pr19023-libtcmalloc_and_profiler.so.abi",
+    "output/test-read-dwarf/test19-pr19023-libtcmalloc_and_profiler.so.precompute-canonical-dies.abi",
+    "--precompute-canonical-dies",
+  },
+  {
+    "data/test-read-dwarf/test21-pr19092.so",
+    "",
+    "",
+    SEQUENCE_TYPE_ID_STYLE,
+    "data/test-read-dwarf/test21-pr19092.so.abi",
+    "output/test-read-dwarf/test21-pr19092.so.precompute-canonical-dies.abi",
+    "--precompute-canonical-dies",
+  },
+  {
+    "data/test-read-dwarf/PR22015-libboost_iostreams.so",
+    "",
+    "",
+    SEQUENCE_TYPE_ID_STYLE,
+    "data/test-read-dwarf/PR22015-libboost_iostreams.so.abi",
+    "output/test-read-dwarf/PR22015-libboost_iostreams.so.precompute-canonical-dies.abi",
+    "--precompute-canonical-dies",
+  },
 
   // This should be the last entry.
   {NULL, NULL, NULL, SEQUENCE_TYPE_ID_STYLE, NULL, NULL, NULL}
@@ -592,11 +684,30 @@ struct test_task_dwarf : public test_task
   virtual void
   perform();
 
+  string
+  abidw_command(const string& extra_options, const string& out_path);
+
   virtual
   ~test_task_dwarf()
   {}
 }; // end struct test_task_dwarf
 
+/// Task specialization to check that reading the DWARF of a binary
+/// lazily in exported-interfaces-only mode builds the same ABI as
+/// reading it eagerly.
+struct test_task_dwarf_lazy : public test_task_dwarf
+{
+  test_task_dwarf_lazy(const InOutSpec &s,
+		       string& a_out_abi_base,
+		       string& a_in_elf_base,
+		       string& a_in_abi_base)
+    : test_task_dwarf(s, a_out_abi_base, a_in_elf_base, a_in_abi_base)
+  {}
+
+  virtual void
+  perform();
+}; // end struct test_task_dwarf_lazy
+
 /// Constructor.
 ///
 /// Task to be executed for each DWARF test entry in @ref
@@ -633,6 +744,35 @@ test_task_dwarf::perform()
       || in_elf_path.empty())
     return;
 
+  string cmd = abidw_command("", out_abi_path);
+  if (system(cmd.c_str()))
+    {
+      error_message = string("abidw failed:\n")
+	+ "command was: '" + cmd + "'\n";
+      return;
+    }
+
+  if (!(is_ok = run_abidw()))
+    return;
+
+  if (!(is_ok = run_diff()))
+      return;
+}
+
+/// Build the command that runs abidw on the input binary of the
+/// test, with the options of the test.
+///
+/// @param extra_options the options to pass to abidw on top of the
+/// options of the test.
+///
+/// @param out_path the path of the file where to save the output of
+/// abidw.
+///
+/// @return the command.
+string
+test_task_dwarf::abidw_command(const string& extra_options,
+			       const string& out_path)
+{
   string abidw = string(get_build_dir()) + "/tools/abidw";
   string drop_private_types;
   if (!in_public_headers_path.empty())
@@ -642,12 +782,33 @@ test_task_dwarf::perform()
   if (spec.type_id_style == HASH_TYPE_ID_STYLE)
     type_id_style = "hash";
 
-  string cmd = abidw + " --no-architecture "
+  string spec_options = spec.options ? spec.options : "";
+  return abidw + " --no-architecture "
     + " --type-id-style " + type_id_style
     + " --no-corpus-path "
+    + spec_options + " " + extra_options + " "
     + drop_private_types + " " + in_elf_path
-    +" > " + out_abi_path;
+    +" > " + out_path;
+}
+
+/// Read the input binary of the test with abidw
+/// --exported-interfaces-only, with and without
+/// --lazy-exported-interfaces, and compare the two abixml files.
+void
+test_task_dwarf_lazy::perform()
+{
+  set_in_elf_path();
+  set_in_suppr_spec_path();
+  set_in_public_headers_path();
 
+  if (!set_out_abi_path()
+      || in_elf_path.empty())
+    return;
+
+  string eager_abi_path = out_abi_path + ".exported-interfaces-only";
+  string lazy_abi_path = out_abi_path + ".lazy-exported-interfaces";
+
+  string cmd = abidw_command("--exported-interfaces-only", eager_abi_path);
   if (system(cmd.c_str()))
     {
       error_message = string("abidw failed:\n")
@@ -655,11 +816,27 @@ test_task_dwarf::perform()
       return;
     }
 
-  if (!(is_ok = run_abidw()))
-    return;
-
-  if (!(is_ok = run_diff()))
+  cmd = abidw_command("--exported-interfaces-only "
+		      "--lazy-exported-interfaces",
+		      lazy_abi_path);
+  if (system(cmd.c_str()))
+    {
+      error_message = string("abidw failed:\n")
+	+ "command was: '" + cmd + "'\n";
       return;
+    }
+
+  cmd = "diff -u " + eager_abi_path + " " + lazy_abi_path;
+  if (system(cmd.c_str()))
+    {
+      error_message = string("ABI files differ:\n")
+	+ eager_abi_path
+	+ "\nand:\n"
+	+ lazy_abi_path
+	+ "\n"
+	+ "command was: '" + cmd + "'\n";
+      is_ok = false;
+    }
 }
 
 /// Create a new DWARF instance for task to be execute by the testsuite.
@@ -682,6 +859,27 @@ new_task(const InOutSpec* s, string& a_out_abi_base,
                              a_in_elf_base, a_in_abi_base);
 }
 
+/// Create a new task that compares the lazy and eager reading of the
+/// DWARF of a binary in exported-interfaces-only mode.
+///
+/// @param s the @ref abigail::tests::read_common::InOutSpec
+/// tests container.
+///
+/// @param a_out_abi_base the output base directory for abixml files.
+///
+/// @param a_in_elf_base the input base directory for object files.
+///
+/// @param a_in_abi_base the input base directory for abixml files.
+///
+/// @return abigail::tests::read_common::test_task instance.
+static test_task*
+new_lazy_task(const InOutSpec* s, string& a_out_abi_base,
+	      string& a_in_elf_base, string& a_in_abi_base)
+{
+  return new test_task_dwarf_lazy(*s, a_out_abi_base,
+				  a_in_elf_base, a_in_abi_base);
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -698,5 +896,7 @@ main(int argc, char *argv[])
   // compute number of tests to be executed.
   const size_t num_tests = sizeof(in_out_specs) / sizeof(InOutSpec) - 1;
 
-  return run_tests(num_tests, in_out_specs, opts, new_task);
+  bool failed = run_tests(num_tests, in_out_specs, opts, new_task);
+  failed |= run_tests(num_tests, in_out_specs, opts, new_lazy_task);
+  return failed;
 }
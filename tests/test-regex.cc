@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2023 Red Hat, Inc.
+
+/// @file
+///
+/// This program tests that libabigail's regex::match yields the same
+/// results as regexec, including for the regular expressions it
+/// matches without using regexec.
+
+#include <string>
+#include <vector>
+
+#include "lib/catch.hpp"
+
+#include "abg-regex.h"
+
+using std::string;
+using std::vector;
+
+using abigail::regex::regex_t_sptr;
+using abigail::regex::compile;
+using abigail::regex::match;
+using abigail::regex::generate_from_strings;
+
+/// Test that matching a regular expression against some strings with
+/// regex::match yields the same results as with regexec.
+///
+/// @param pattern the regular expression to consider.
+///
+/// @param strs the strings to match against @p pattern.
+static void
+check_same_matches(const string& pattern, const vector<string>& strs)
+{
+  regex_t_sptr r = compile(pattern);
+  REQUIRE(r);
+  for (const string& s : strs)
+    {
+      INFO("pattern: '" << pattern << "', string: '" << s << "'");
+      CHECK(match(r, s) == !regexec(r.get(), s.c_str(), 0, NULL, 0));
+    }
+}
+
+static const vector<string> strings =
+{
+  "", "foo", "bar", "baz", "foobar", "barfoo", "xfoo", "foox", "fo",
+  "__private_fn", "private_fn", "function1", "function3", "var0", "var1",
+  "std::vector", "hidden::S", "libapp::S0", "MyPrivate", "Private",
+  "_Z3barv", "_Z3bazv", "VERSION_1.0", "VERSION_1x0", "a.b", "a|b",
+  "a$b", "a\\b", "a*", "(foo)"
+};
+
+TEST_CASE("LiteralRegexMatches", "[regex]")
+{
+  const vector<string> patterns =
+  {
+    "", "^", "$", "^$", "foo", "^foo", "foo$", "^foo$", ".*foo", "foo.*",
+    "^.*foo$", "^foo.*$", ".*", "^.*$", "bar|baz", "^bar$|^baz$",
+    "^(bar|baz)$", "(bar|baz)", "^(foo|bar)", ".*(foo|bar)$",
+    "^__private_.*", ".*Private$", "std::.*", "hidden::.*", "var.$",
+    "^VERSION_1.*$", "a\\.b", "a\\|b", "a\\$b", "a\\\\b", "a\\*",
+    "\\(foo\\)", "^\\(foo\\)$"
+  };
+
+  for (const string& p : patterns)
+    check_same_matches(p, strings);
+}
+
+TEST_CASE("NonLiteralRegexMatches", "[regex]")
+{
+  const vector<string> patterns =
+  {
+    "fo+", "fo?o", "^function[12]", "_Z.(baz|foobar)v", "(^foo|bar$)",
+    "^__private_.*|^function.", "a|", "(a)(b)", "^_^", "foo\\\\$",
+    "a\\.*", "[fb]oo", "x{2}", "^(foo|)$"
+  };
+
+  for (const string& p : patterns)
+    check_same_matches(p, strings);
+}
+
+TEST_CASE("GeneratedRegexMatches", "[regex]")
+{
+  vector<string> names = {"foo", "bar", "a.b", "a|b", "std::vector"};
+  check_same_matches(generate_from_strings(names), strings);
+  check_same_matches(generate_from_strings(vector<string>()), strings);
+}
@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2023 Red Hat, Inc.
+
+/// @file
+///
+/// This program tests the reading of several abixml files into the
+/// same environment, from several threads at once, as done by
+/// abipkgdiff --shared-environment.
+
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lib/catch.hpp"
+#include "test-utils.h"
+
+#include "abg-comparison.h"
+#include "abg-corpus.h"
+#include "abg-ir-priv.h"
+#include "abg-reader.h"
+#include "abg-workers.h"
+
+using std::string;
+using std::vector;
+
+using abigail::ir::environment;
+using abigail::ir::corpus_sptr;
+using abigail::comparison::corpus_diff_sptr;
+using abigail::comparison::diff_context_sptr;
+using abigail::comparison::diff_context;
+using abigail::comparison::compute_diff;
+using abigail::abixml::read_corpus_from_abixml_file;
+using abigail::workers::queue;
+
+static const char* abixml_files[] =
+{
+  "tests/data/test-read-dwarf/test9-pr18818-clang.so.abi",
+  "tests/data/test-read-dwarf/test10-pr18818-gcc.so.abi",
+  "tests/data/test-read-dwarf/test11-pr18828.so.abi",
+  "tests/data/test-read-dwarf/test13-pr18894.so.abi",
+};
+
+TEST_CASE("ComparisonFlagsArePerThread", "[shared_env]")
+{
+  environment env;
+  env.do_on_the_fly_canonicalization(false);
+  env.decl_only_class_equals_definition(true);
+
+  // The flags set by the thread that created the environment are the
+  // defaults of the other threads.  The flags set by the other
+  // threads only apply to them.
+  queue q(1);
+  std::future<bool> flags = q.schedule_function<bool>
+    ([&env]()
+     {
+       bool r = !env.do_on_the_fly_canonicalization()
+	 && env.decl_only_class_equals_definition()
+	 && !env.canonicalization_is_done();
+       env.canonicalization_is_done(true);
+       env.do_on_the_fly_canonicalization(true);
+       return r
+	 && env.canonicalization_is_done()
+	 && env.do_on_the_fly_canonicalization();
+     });
+  CHECK(flags.get());
+  q.wait_for_workers_to_complete();
+
+  CHECK(!env.do_on_the_fly_canonicalization());
+  CHECK(env.decl_only_class_equals_definition());
+  CHECK(!env.canonicalization_is_done());
+}
+
+TEST_CASE("ComparisonStatesOfExitedThreadsAreErased", "[shared_env]")
+{
+  environment env;
+  string path =
+    string(abigail::tests::get_src_dir()) + "/" + abixml_files[0];
+  corpus_sptr corp;
+  std::thread t([&]()
+		{
+		  corp = read_corpus_from_abixml_file(path, env);
+		  CHECK(env.priv_->comparison_states_.size() == 1);
+		});
+  t.join();
+  REQUIRE(corp);
+  CHECK(env.priv_->comparison_states_.empty());
+
+  // A thread that outlives the environments it used must not touch
+  // them when it exits.
+  std::unique_ptr<environment> short_lived(new environment);
+  std::thread t2([&]()
+		 {
+		   CHECK(read_corpus_from_abixml_file(path, *short_lived));
+		   short_lived.reset();
+		 });
+  t2.join();
+  CHECK(!short_lived);
+}
+
+TEST_CASE("ConcurrentReadsInSharedEnvironment", "[shared_env]")
+{
+  environment env;
+  std::mutex corpora_lock;
+  vector<corpus_sptr> corpora;
+
+  queue q(4);
+  vector<std::future<bool>> results;
+  // Each file is read twice, as the two versions of a binary that
+  // did not change.
+  for (const char* f : abixml_files)
+    results.push_back(q.schedule_function<bool>
+		      ([&, f]()
+		       {
+			 string path =
+			   string(abigail::tests::get_src_dir()) + "/" + f;
+			 corpus_sptr c1 = read_corpus_from_abixml_file(path,
+								       env);
+			 corpus_sptr c2 = read_corpus_from_abixml_file(path,
+								       env);
+			 if (!c1 || !c2)
+			   return false;
+			 std::lock_guard<std::mutex> guard(corpora_lock);
+			 corpora.push_back(c1);
+			 corpora.push_back(c2);
+			 return true;
+		       }));
+
+  for (auto& r : results)
+    CHECK(r.get());
+  q.wait_for_workers_to_complete();
+  REQUIRE(corpora.size() == 2 * results.size());
+
+  // The corpora are compared once they have all been read, as done by
+  // abipkgdiff.
+  for (size_t i = 0; i < corpora.size(); i += 2)
+    {
+      diff_context_sptr ctxt(new diff_context);
+      corpus_diff_sptr d = compute_diff(corpora[i], corpora[i + 1], ctxt);
+      CHECK(!d->has_net_changes());
+    }
+
+  // The corpora must be destroyed before their environment.
+  corpora.clear();
+}
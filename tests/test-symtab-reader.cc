@@ -9,7 +9,59 @@
 ///
 /// This program tests libabigail's symtab reader.
 
+#include <string>
+#include <vector>
+
 #include "lib/catch.hpp"
+#include "test-utils.h"
 
+#include "abg-corpus.h"
+#include "abg-dwarf-reader.h"
 #include "abg-symtab-reader.h"
 
+using abigail::ir::environment;
+using abigail::ir::corpus_sptr;
+using abigail::ir::elf_symbol_sptr;
+using abigail::ir::elf_symbols;
+using abigail::ir::string_elf_symbols_map_type;
+using abigail::elf_based_reader_sptr;
+using abigail::fe_iface;
+
+TEST_CASE("Symtab::LookupSymbolByName", "[symtab_reader]")
+{
+  // Every function and variable symbol of the corpus must be found
+  // by name in the symtab the corpus was built from.
+  const std::string path =
+    std::string(abigail::tests::get_src_dir())
+    + "/tests/data/test-read-dwarf/test-libandroid.so";
+
+  environment env;
+  std::vector<char**> di_roots;
+  elf_based_reader_sptr rdr =
+    abigail::dwarf::create_reader(path, di_roots, env);
+  fe_iface::status status = fe_iface::STATUS_UNKNOWN;
+  corpus_sptr corp = rdr->read_corpus(status);
+  REQUIRE(corp);
+
+  const string_elf_symbols_map_type& fns = corp->get_fun_symbol_map();
+  const string_elf_symbols_map_type& vars = corp->get_var_symbol_map();
+  REQUIRE(fns.size() > 100);
+
+  for (const auto& e : fns)
+    {
+      elf_symbol_sptr sym = rdr->function_symbol_is_exported(e.first);
+      REQUIRE(sym);
+      CHECK(sym->get_name() == e.first);
+    }
+
+  for (const auto& e : vars)
+    {
+      elf_symbol_sptr sym = rdr->variable_symbol_is_exported(e.first);
+      REQUIRE(sym);
+      CHECK(sym->get_name() == e.first);
+    }
+
+  CHECK(!rdr->function_symbol_is_exported("not_a_symbol_of_the_binary"));
+  CHECK(!rdr->function_symbol_is_exported(""));
+  CHECK(!rdr->variable_symbol_is_exported(""));
+}
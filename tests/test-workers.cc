@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+// -*- Mode: C++ -*-
+//
+// Copyright (C) 2023 Red Hat, Inc.
+
+/// @file
+///
+/// This program tests libabigail's worker threads pool.
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "lib/catch.hpp"
+
+#include "abg-workers.h"
+
+using abigail::workers::queue;
+using abigail::workers::task;
+using abigail::workers::task_sptr;
+
+/// A task that increments a counter and schedules a given number of
+/// sub-tasks of the same kind on its queue.
+struct counting_task : public task
+{
+  queue& q;
+  std::atomic<size_t>& counter;
+  size_t depth;
+
+  counting_task(queue& qu, std::atomic<size_t>& c, size_t d)
+    : q(qu), counter(c), depth(d)
+  {}
+
+  virtual void
+  perform()
+  {
+    ++counter;
+    if (depth)
+      for (size_t i = 0; i < 2; ++i)
+	q.schedule_task(task_sptr(new counting_task(q, counter, depth - 1)));
+  }
+};
+
+/// A task that records its identifier into a vector when performed.
+struct recording_task : public task
+{
+  std::mutex& lock;
+  std::vector<int>& performed;
+  int id;
+
+  recording_task(std::mutex& l, std::vector<int>& p, int i)
+    : lock(l), performed(p), id(i)
+  {}
+
+  virtual void
+  perform()
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    performed.push_back(id);
+  }
+};
+
+/// A task that schedules recording tasks of various priorities on
+/// its queue.
+struct spawning_task : public task
+{
+  queue& q;
+  std::mutex& lock;
+  std::vector<int>& performed;
+
+  spawning_task(queue& qu, std::mutex& l, std::vector<int>& p)
+    : q(qu), lock(l), performed(p)
+  {}
+
+  virtual void
+  perform()
+  {
+    int priorities[] = {1, 3, 2, 3, 0};
+    for (int i = 0; i < 5; ++i)
+      q.schedule_task(task_sptr(new recording_task(lock, performed, i)),
+		      priorities[i]);
+  }
+};
+
+TEST_CASE("AllTasksArePerformed", "[workers]")
+{
+  queue q(4);
+  std::atomic<size_t> counter(0);
+  queue::tasks_type tasks;
+  for (size_t i = 0; i < 100; ++i)
+    tasks.push_back(task_sptr(new counting_task(q, counter, 0)));
+  REQUIRE(q.schedule_tasks(tasks));
+  q.wait_for_workers_to_complete();
+  CHECK(counter == 100);
+  CHECK(q.get_completed_tasks().size() == 100);
+  CHECK(q.get_size() == 0);
+}
+
+TEST_CASE("NestedTasksArePerformed", "[workers]")
+{
+  queue q(4);
+  std::atomic<size_t> counter(0);
+  // A tree of tasks of depth 6 has 2^7 - 1 nodes.
+  REQUIRE(q.schedule_task(task_sptr(new counting_task(q, counter, 6))));
+  q.wait_for_workers_to_complete();
+  CHECK(counter == 127);
+  CHECK(q.get_completed_tasks().size() == 127);
+}
+
+TEST_CASE("TasksArePerformedByPriority", "[workers]")
+{
+  queue q(1);
+  std::mutex lock;
+  std::vector<int> performed;
+  REQUIRE(q.schedule_task(task_sptr(new spawning_task(q, lock, performed))));
+  q.wait_for_workers_to_complete();
+  std::vector<int> expected = {1, 3, 2, 0, 4};
+  CHECK(performed == expected);
+}
+
+TEST_CASE("FunctionResultsAreFutures", "[workers]")
+{
+  queue q(2);
+  std::vector<std::future<int>> results;
+  for (int i = 0; i < 10; ++i)
+    results.push_back(q.schedule_function<int>([i]() {return i * i;}));
+  for (int i = 0; i < 10; ++i)
+    CHECK(results[i].get() == i * i);
+  q.wait_for_workers_to_complete();
+
+  // The queue has no more workers now, so the function can't be
+  // scheduled.
+  std::future<int> f = q.schedule_function<int>([]() {return 0;});
+  CHECK_THROWS_AS(f.get(), std::future_error);
+}
@@ -85,6 +85,7 @@ public:
 #ifdef WITH_CTF
   bool			use_ctf;
 #endif
+  string		profile_path;
 
   options(const char* program_name)
     :prog_name(program_name),
@@ -134,6 +135,7 @@ display_usage(const string& prog_name, ostream& out)
     << "  --redundant  display redundant changes (this is the default)\n"
     << "  --weak-mode  check compatibility between the application and "
     "just one version of the library.\n"
+    << "  --profile <path>  write performance metrics as JSON into path\n"
 #ifdef WITH_CTF
     << "  --ctf use CTF instead of DWARF in ELF files\n"
 #endif
@@ -240,6 +242,18 @@ parse_command_line(int argc, char* argv[], options& opts)
 	}
       else if (!strcmp(argv[i], "--weak-mode"))
 	opts.weak_mode = true;
+      else if (!strcmp(argv[i], "--profile")
+	       || !strncmp(argv[i], "--profile=", 10))
+	{
+	  const char* path = argv[i] + 9;
+	  if (*path == '=')
+	    ++path;
+	  else if (++i < argc)
+	    path = argv[i];
+	  else
+	    return false;
+	  opts.profile_path = path;
+	}
 #ifdef WITH_CTF
       else if (!strcmp(argv[i], "--ctf"))
         opts.use_ctf = true;
@@ -787,6 +801,8 @@ main(int argc, char* argv[])
   app_di_roots.push_back(&app_di_root);
   abigail::fe_iface::status status = abigail::fe_iface::STATUS_UNKNOWN;
   environment env;
+  tools_utils::scoped_profile_emitter profile(env.get_metrics(),
+					      opts.profile_path);
 
   corpus_sptr app_corpus = read_corpus(opts, status,
 				       app_di_roots, env,
@@ -8,6 +8,7 @@
 /// @file
 
 #include "config.h"
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <memory>
@@ -118,6 +119,9 @@ struct options
   bool			dump_diff_tree;
   bool			show_stats;
   bool			do_log;
+  string		profile_path;
+  string		corpus_cache_dir;
+  uint64_t		corpus_cache_max_size;
 #ifdef WITH_DEBUG_SELF_COMPARISON
   bool			do_debug_self_comparison;
 #endif
@@ -174,7 +178,9 @@ struct options
       perform_change_categorization(true),
       dump_diff_tree(),
       show_stats(),
-      do_log()
+      do_log(),
+      corpus_cache_dir(abigail::tools_utils::get_corpus_cache_dir_path()),
+      corpus_cache_max_size(abigail::tools_utils::get_corpus_cache_max_size())
 #ifdef WITH_DEBUG_SELF_COMPARISON
     ,
       do_debug_self_comparison()
@@ -285,6 +291,11 @@ display_usage(const string& prog_name, ostream& out)
     << " --dump-diff-tree  emit a debug dump of the internal diff tree to "
     "the error output stream\n"
     <<  " --stats  show statistics about various internal stuff\n"
+    << " --profile <path>  write performance metrics as JSON into path\n"
+    << " --corpus-cache-dir <path>  cache the ABI corpora of the binaries "
+    "in the directory path\n"
+    << " --corpus-cache-max-size <size>  limit the size of the cache of "
+    "ABI corpora to size mebibytes\n"
 #ifdef WITH_CTF
     << " --ctf use CTF instead of DWARF in ELF files\n"
 #endif
@@ -654,6 +665,43 @@ parse_command_line(int argc, char* argv[], options& opts)
 	opts.dump_diff_tree = true;
       else if (!strcmp(argv[i], "--stats"))
 	opts.show_stats = true;
+      else if (!strcmp(argv[i], "--profile")
+	       || !strncmp(argv[i], "--profile=", 10))
+	{
+	  const char* path = argv[i] + 9;
+	  if (*path == '=')
+	    ++path;
+	  else if (++i < argc)
+	    path = argv[i];
+	  else
+	    return false;
+	  opts.profile_path = path;
+	}
+      else if (!strcmp(argv[i], "--corpus-cache-dir"))
+	{
+	  int j = i + 1;
+	  if (j >= argc)
+	    {
+	      opts.missing_operand = true;
+	      opts.wrong_option = argv[i];
+	      return true;
+	    }
+	  opts.corpus_cache_dir = argv[j];
+	  ++i;
+	}
+      else if (!strcmp(argv[i], "--corpus-cache-max-size"))
+	{
+	  int j = i + 1;
+	  if (j >= argc)
+	    {
+	      opts.missing_operand = true;
+	      opts.wrong_option = argv[i];
+	      return true;
+	    }
+	  opts.corpus_cache_max_size =
+	    strtoull(argv[j], NULL, 10) * 1024 * 1024;
+	  ++i;
+	}
       else if (!strcmp(argv[i], "--verbose"))
 	opts.do_log = true;
 #ifdef WITH_CTF
@@ -857,6 +905,8 @@ set_generic_options(abigail::elf_based_reader& rdr, options& opts)
     opts.leverage_dwarf_factorization;
   rdr.options().assume_odr_for_cplusplus =
     opts.assume_odr_for_cplusplus;
+  rdr.options().corpus_cache_dir = opts.corpus_cache_dir;
+  rdr.options().corpus_cache_max_size = opts.corpus_cache_max_size;
 }
 
 /// Set suppression specifications to the @p read_context used to load
@@ -1215,6 +1265,8 @@ main(int argc, char* argv[])
       t2_type = guess_file_type(opts.file2);
 
       environment env;
+      abigail::tools_utils::scoped_profile_emitter
+	profile(env.get_metrics(), opts.profile_path);
       if (opts.exported_interfaces_only.has_value())
 	env.analyze_exported_interfaces_only(*opts.exported_interfaces_only);
 
@@ -125,8 +125,15 @@ struct options
   bool			drop_undefined_syms;
   bool			assume_odr_for_cplusplus;
   bool			leverage_dwarf_factorization;
+  bool			precompute_canonical_dies;
+  bool			lazy_exported_interfaces;
+  bool			hash_translation_units;
+  bool			arena_allocation;
+  bool			mem_stats;
+  string		baseline_path;
   optional<bool>	exported_interfaces_only;
   type_id_style_kind	type_id_style;
+  string		profile_path;
 #ifdef WITH_DEBUG_SELF_COMPARISON
   string		type_id_file_path;
 #endif
@@ -169,6 +176,11 @@ struct options
       drop_undefined_syms(false),
       assume_odr_for_cplusplus(true),
       leverage_dwarf_factorization(true),
+      precompute_canonical_dies(false),
+      lazy_exported_interfaces(false),
+      hash_translation_units(false),
+      arena_allocation(false),
+      mem_stats(false),
       type_id_style(SEQUENCE_TYPE_ID_STYLE)
   {}
 
@@ -207,6 +219,12 @@ display_usage(const string& prog_name, ostream& out)
     << "  --exported-interfaces-only  analyze exported interfaces only\n"
     << "  --allow-non-exported-interfaces  analyze interfaces that "
     "might not be exported\n"
+    << "  --lazy-exported-interfaces  only read the debug info reachable "
+    "from exported interfaces\n"
+    << "  --hash-translation-units  record the hash of the content of "
+    "each translation unit\n"
+    << "  --baseline <abixml-path>  re-use the translation units of "
+    "abixml-path that did not change\n"
     << "  --no-comp-dir-path  do not show compilation path information\n"
     << "  --no-elf-needed  do not show the DT_NEEDED information\n"
     << "  --no-write-default-sizes  do not emit pointer size when it equals"
@@ -243,11 +261,18 @@ display_usage(const string& prog_name, ostream& out)
     "speed-up the analysis of the binary\n"
     << "  --no-assume-odr-for-cplusplus  do not assume the ODR to speed-up the "
     "analysis of the binary\n"
+    << "  --precompute-canonical-dies  canonicalize all DWARF types "
+    "before building the ABI representation\n"
+    << "  --arena-allocation  allocate the ABI representation "
+    "from an arena\n"
 #ifdef WITH_BTF
     << "  --btf use BTF instead of DWARF in ELF files\n"
 #endif
     << "  --annotate  annotate the ABI artifacts emitted in the output\n"
     << "  --stats  show statistics about various internal stuff\n"
+    << "  --mem-stats  show the memory used by the ABI representation "
+    "and by the internal data structures\n"
+    << "  --profile <path>  write performance metrics as JSON into path\n"
     << "  --verbose show verbose messages about internal stuff\n";
   ;
 }
@@ -403,6 +428,24 @@ parse_command_line(int argc, char* argv[], options& opts)
 	opts.exported_interfaces_only = true;
       else if (!strcmp(argv[i], "--allow-non-exported-interfaces"))
 	opts.exported_interfaces_only = false;
+      else if (!strcmp(argv[i], "--lazy-exported-interfaces"))
+	opts.lazy_exported_interfaces = true;
+      else if (!strcmp(argv[i], "--hash-translation-units"))
+	opts.hash_translation_units = true;
+      else if (!strcmp(argv[i], "--baseline"))
+	{
+	  if (argc <= i + 1
+	      || argv[i + 1][0] == '-'
+	      || !opts.baseline_path.empty())
+	    return false;
+
+	  opts.baseline_path = argv[i + 1];
+	  // The translation units of the baseline are compared to the
+	  // new ones through their hashes, and the result embeds the
+	  // hashes so that it can be used as a baseline in turn.
+	  opts.hash_translation_units = true;
+	  ++i;
+	}
       else if (!strcmp(argv[i], "--no-linux-kernel-mode"))
 	opts.linux_kernel_mode = false;
       else if (!strcmp(argv[i], "--abidiff"))
@@ -426,10 +469,28 @@ parse_command_line(int argc, char* argv[], options& opts)
 	opts.assume_odr_for_cplusplus = false;
       else if (!strcmp (argv[i], "--no-leverage-dwarf-factorization"))
 	opts.leverage_dwarf_factorization = false;
+      else if (!strcmp(argv[i], "--precompute-canonical-dies"))
+	opts.precompute_canonical_dies = true;
+      else if (!strcmp(argv[i], "--arena-allocation"))
+	opts.arena_allocation = true;
       else if (!strcmp(argv[i], "--annotate"))
 	opts.annotate = true;
       else if (!strcmp(argv[i], "--stats"))
 	opts.show_stats = true;
+      else if (!strcmp(argv[i], "--mem-stats"))
+	opts.mem_stats = true;
+      else if (!strcmp(argv[i], "--profile")
+	       || !strncmp(argv[i], "--profile=", 10))
+	{
+	  const char* path = argv[i] + 9;
+	  if (*path == '=')
+	    ++path;
+	  else if (++i < argc)
+	    path = argv[i];
+	  else
+	    return false;
+	  opts.profile_path = path;
+	}
       else if (!strcmp(argv[i], "--verbose"))
 	opts.do_log = true;
       else if (!strcmp(argv[i], "--help")
@@ -564,6 +625,24 @@ set_generic_options(abigail::elf_based_reader& rdr, options& opts)
     opts.leverage_dwarf_factorization;
   rdr.options().assume_odr_for_cplusplus =
     opts.assume_odr_for_cplusplus;
+  rdr.options().precompute_canonical_dies = opts.precompute_canonical_dies;
+  rdr.options().read_exported_interfaces_lazily =
+    opts.lazy_exported_interfaces;
+  rdr.options().hash_translation_units = opts.hash_translation_units;
+  rdr.options().baseline_abixml_path = opts.baseline_path;
+}
+
+/// Emit a report of the memory used by the ABI representation and by
+/// the internal data structures of the tool, on the standard error.
+///
+/// @param prog_name the name of the program.
+///
+/// @param stats the memory statistics to report.
+static void
+emit_memory_stats(const char* prog_name, const metrics::memory_stats& stats)
+{
+  emit_prefix(prog_name, cerr) << "memory usage:\n";
+  stats.emit_report(cerr);
 }
 
 /// Load an ABI @ref corpus (the internal representation of the ABI of
@@ -623,6 +702,11 @@ load_corpus_and_write_abixml(char* argv[],
   // ...
   set_generic_options(*reader, opts);
   set_suppressions(*reader, opts);
+  if (opts.abidiff)
+    // The corpus must be built from the binary, not re-read from an
+    // abixml file of the cache of ABI corpora; otherwise, it would
+    // be compared to its own abixml round trip.
+    reader->options().corpus_cache_dir.clear();
 
   // If the user asked us to check if we found the "alternate debug
   // info file" associated to the input binary, then proceed to do so
@@ -720,6 +804,18 @@ load_corpus_and_write_abixml(char* argv[],
       return 1;
     }
 
+  // The maps of the reader are still populated at this point, so
+  // the memory they use is recorded along with the memory used by
+  // the corpus.
+  metrics::memory_stats mem_stats;
+  if (opts.mem_stats)
+    {
+      corp->get_memory_stats(mem_stats);
+      reader->get_memory_stats(mem_stats);
+      if (!opts.abidiff)
+	emit_memory_stats(argv[0], mem_stats);
+    }
+
   // Clear some resources to gain back some space.
   t.start();
   reader.reset();
@@ -787,6 +883,12 @@ load_corpus_and_write_abixml(char* argv[],
         emit_prefix(argv[0], cerr)
           << "computed diff in: " << t << "\n";
 
+      if (opts.mem_stats)
+	{
+	  ctxt->get_memory_stats(mem_stats);
+	  emit_memory_stats(argv[0], mem_stats);
+	}
+
       bool has_error = diff->has_changes();
       if (has_error)
         {
@@ -879,6 +981,46 @@ load_kernel_corpus_group_and_write_abixml(char* argv[],
     emit_prefix(argv[0], cerr)
       << "going to build ABI representation of the Linux Kernel ...\n";
 
+  ofstream of;
+  ostream* out = &cout;
+  xml_writer::write_context_sptr ctxt;
+  if (!opts.noout)
+    {
+      if (!opts.out_file_path.empty())
+	{
+	  of.open(opts.out_file_path.c_str(), std::ios_base::trunc);
+	  if (!of.is_open())
+	    {
+	      emit_prefix(argv[0], cerr)
+		<< "could not open output file '"
+		<< opts.out_file_path << "'\n";
+	      return 1;
+	    }
+	  out = &of;
+	}
+      ctxt = xml_writer::create_write_context(env, *out);
+      set_common_options(*ctxt, opts);
+    }
+
+  // Each corpus of the group is written out as soon as it's built,
+  // rather than once the whole group is built.  Its symbols and
+  // tables of exported declarations are then released.  Its types
+  // and declarations are kept, as the corpora that are built
+  // afterwards re-use them.
+  bool group_header_written = false;
+  tools_utils::corpus_added_handler on_corpus_added;
+  if (ctxt)
+    on_corpus_added = [&](const corpus_group_sptr& g)
+      {
+	if (!group_header_written)
+	  group_header_written =
+	    xml_writer::write_corpus_group_header(*ctxt, g, 0);
+	const corpus_sptr& corp = g->get_corpora().back();
+	if (!xml_writer::write_corpus_group_member(*ctxt, corp, 0))
+	  exit_code = 1;
+	corp->drop_symbols_and_exported_decls();
+      };
+
   global_timer.start();
   t.start();
   corpus::origin requested_fe_kind =
@@ -893,7 +1035,8 @@ load_kernel_corpus_group_and_write_abixml(char* argv[],
 					      opts.suppression_paths,
 					      opts.kabi_whitelist_paths,
 					      supprs, opts.do_log, env,
-					      requested_fe_kind);
+					      requested_fe_kind,
+					      on_corpus_added);
   t.stop();
 
   if (opts.do_log)
@@ -906,48 +1049,18 @@ load_kernel_corpus_group_and_write_abixml(char* argv[],
   if (!group)
     return 1;
 
-  if (!opts.noout)
+  if (opts.mem_stats)
     {
-      const xml_writer::write_context_sptr& ctxt
-	  = xml_writer::create_write_context(env, cout);
-      set_common_options(*ctxt, opts);
-
-      if (!opts.out_file_path.empty())
-	{
-	  ofstream of(opts.out_file_path.c_str(), std::ios_base::trunc);
-	  if (!of.is_open())
-	    {
-	      emit_prefix(argv[0], cerr)
-		<< "could not open output file '"
-		<< opts.out_file_path << "'\n";
-	      return 1;
-	    }
-
-	  if (opts.do_log)
-	    emit_prefix(argv[0], cerr)
-	      << "emitting the abixml output ...\n";
-	  set_ostream(*ctxt, of);
-	  t.start();
-	  exit_code = !write_corpus_group(*ctxt, group, 0);
-	  t.stop();
-	  if (opts.do_log)
-	    emit_prefix(argv[0], cerr)
-	      << "emitted abixml output in: " << t << "\n";
-	}
-      else
-	{
-	  if (opts.do_log)
-	    emit_prefix(argv[0], cerr)
-	      << "emitting the abixml output ...\n";
-	  t.start();
-	  exit_code = !write_corpus_group(*ctxt, group, 0);
-	  t.stop();
-	  if (opts.do_log)
-	    emit_prefix(argv[0], cerr)
-	      << "emitted abixml output in: " << t << "\n";
-	}
+      metrics::memory_stats mem_stats;
+      group->get_memory_stats(mem_stats);
+      emit_memory_stats(argv[0], mem_stats);
     }
 
+  if (group_header_written)
+    xml_writer::write_corpus_group_footer(*ctxt, 0);
+  else if (ctxt)
+    exit_code = !xml_writer::write_corpus_group(*ctxt, group, 0);
+
   global_timer.stop();
   if (opts.do_log)
     emit_prefix(argv[0], cerr)
@@ -1032,6 +1145,10 @@ main(int argc, char* argv[])
     }
 
   environment env;
+  if (opts.arena_allocation)
+    env.use_arena_allocation(true);
+  tools_utils::scoped_profile_emitter profile(env.get_metrics(),
+					      opts.profile_path);
   int exit_code = 0;
 
   if (tools_utils::is_regular_file(opts.in_file_path))
@@ -88,6 +88,7 @@ struct options
   vector<string>		suppression_paths;
   string			headers_dir;
   vector<string>		header_files;
+  string			profile_path;
 #if WITH_SHOW_TYPE_USE_IN_ABILINT
   string			type_id_to_show;
 #endif
@@ -495,6 +496,7 @@ display_usage(const string& prog_name, ostream& out)
     << "  --noout  do not display anything on stdout\n"
     << "  --stdin  read abi-file content from stdin\n"
     << "  --tu  expect a single translation unit file\n"
+    << "  --profile <path>  write performance metrics as JSON into path\n"
 #ifdef WITH_CTF
     << "  --ctf use CTF instead of DWARF in ELF files\n"
 #endif
@@ -583,6 +585,18 @@ parse_command_line(int argc, char* argv[], options& opts)
 	  opts.diff = true;
 	else if (!strcmp(argv[i], "--noout"))
 	  opts.noout = true;
+	else if (!strcmp(argv[i], "--profile")
+		 || !strncmp(argv[i], "--profile=", 10))
+	  {
+	    const char* path = argv[i] + 9;
+	    if (*path == '=')
+	      ++path;
+	    else if (++i < argc)
+	      path = argv[i];
+	    else
+	      return false;
+	    opts.profile_path = path;
+	  }
 #ifdef WITH_SHOW_TYPE_USE_IN_ABILINT
       else if (!strcmp(argv[i], "--show-type-use"))
 	{
@@ -702,6 +716,8 @@ main(int argc, char* argv[])
     return 1;
 
   abigail::ir::environment env;
+  abigail::tools_utils::scoped_profile_emitter
+    profile(env.get_metrics(), opts.profile_path);
   if (opts.read_from_stdin)
     {
       if (!cin.good())
@@ -78,6 +78,7 @@
 #include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -159,6 +160,10 @@ using abigail::xml_writer::write_corpus;
 
 using namespace abigail;
 
+/// The performance metrics gathered from all the environments used by
+/// this program.  This is enabled by the --profile option.
+static metrics::registry gathered_metrics;
+
 class package;
 
 /// Convenience typedef for a shared pointer to a @ref package.
@@ -179,6 +184,7 @@ public:
   bool		nonexistent_file;
   bool		abignore;
   bool		parallel;
+  bool		share_environment;
   string	package1;
   string	package2;
   vector<string> debug_packages1;
@@ -225,6 +231,9 @@ public:
   suppressions_type kabi_suppressions;
   package_sptr  pkg1;
   package_sptr  pkg2;
+  string	profile_path;
+  string	corpus_cache_dir;
+  uint64_t	corpus_cache_max_size;
 
   options(const string& program_name)
     : prog_name(program_name),
@@ -234,6 +243,7 @@ public:
       nonexistent_file(),
       abignore(true),
       parallel(true),
+      share_environment(),
       verbose(),
       drop_private_types(),
       show_relative_offset_changes(true),
@@ -258,7 +268,9 @@ public:
       show_identical_binaries(),
       leverage_dwarf_factorization(true),
       assume_odr_for_cplusplus(true),
-      self_check()
+      self_check(),
+      corpus_cache_dir(abigail::tools_utils::get_corpus_cache_dir_path()),
+      corpus_cache_max_size(abigail::tools_utils::get_corpus_cache_max_size())
 #ifdef WITH_CTF
       ,
       use_ctf()
@@ -758,6 +770,64 @@ public:
   }
 }; // end class package.
 
+/// The environment shared by the tasks comparing the binaries of a
+/// package, along with the corpora they read into it.
+///
+/// This is used when the --shared-environment option is given.  The
+/// types defined by several binaries of the package are then
+/// canonicalized once and the strings are interned once.
+///
+/// The corpora are kept until the end of the comparison of the
+/// package because their types might be the canonical types of the
+/// types of the binaries read after them.
+class shared_environment
+{
+  abigail::ir::environment	env_;
+  std::mutex			corpora_lock_;
+  vector<corpus_sptr>		corpora_;
+
+public:
+  /// Constructor of the @ref shared_environment type.
+  ///
+  /// @param opts the options the current program has been called
+  /// with.
+  shared_environment(const options& opts)
+  {
+    if (opts.exported_interfaces_only.has_value())
+      env_.analyze_exported_interfaces_only(*opts.exported_interfaces_only);
+    env_.get_metrics().enable(gathered_metrics.is_enabled());
+  }
+
+  /// Getter of the shared environment.
+  ///
+  /// @return the shared environment.
+  abigail::ir::environment&
+  get_environment()
+  {return env_;}
+
+  /// Keep a corpus read into the shared environment until the end of
+  /// the comparison of the package.
+  ///
+  /// @param corp the corpus to keep.  It can be nil.
+  void
+  keep_corpus(const corpus_sptr& corp)
+  {
+    if (!corp)
+      return;
+    std::lock_guard<std::mutex> guard(corpora_lock_);
+    corpora_.push_back(corp);
+  }
+
+  /// Destructor of the @ref shared_environment type.
+  ///
+  /// This gathers the performance metrics of the environment.
+  ~shared_environment()
+  {
+    corpora_.clear();
+    gathered_metrics.merge(env_.get_metrics());
+  }
+}; // end class shared_environment
+
 /// Arguments passed to the comparison tasks.
 struct compare_args
 {
@@ -768,6 +838,9 @@ struct compare_args
   const string&		debug_dir2;
   const suppressions_type	private_types_suppr2;
   const options&		opts;
+  // The environment to read the binaries in, if it's shared with
+  // the other comparison tasks.
+  shared_environment*		shared_env;
 
   /// Constructor for compare_args, which is used to pass
   /// information to the comparison threads.
@@ -783,16 +856,21 @@ struct compare_args
   /// elf2 is stored.
   ///
   /// @param opts the options the current program has been called with.
+  ///
+  /// @param shared_env the environment shared with the other
+  /// comparison tasks, if any.
   compare_args(const elf_file &elf1, const string& debug_dir1,
 	       const suppressions_type& priv_types_suppr1,
 	       const elf_file &elf2, const string& debug_dir2,
 	       const suppressions_type& priv_types_suppr2,
-	       const options& opts)
+	       const options& opts,
+	       shared_environment* shared_env = nullptr)
     : elf1(elf1), debug_dir1(debug_dir1),
       private_types_suppr1(priv_types_suppr1),
       elf2(elf2), debug_dir2(debug_dir2),
       private_types_suppr2(priv_types_suppr2),
-      opts(opts)
+      opts(opts),
+      shared_env(shared_env)
   {}
 }; // end struct compare_args
 
@@ -911,6 +989,8 @@ display_usage(const string& prog_name, ostream& out)
     << " --no-added-binaries            do not display added binaries\n"
     << " --no-abignore                  do not look for *.abignore files\n"
     << " --no-parallel                  do not execute in parallel\n"
+    << " --shared-environment           read all the binaries of a package "
+    "in the same environment\n"
     << " --fail-no-dbg                  fail if no debug info was found\n"
     << " --show-identical-binaries      show the names of identical binaries\n"
     << " --no-leverage-dwarf-factorization  do not use DWZ optimisations to "
@@ -918,6 +998,12 @@ display_usage(const string& prog_name, ostream& out)
     << " --no-assume-odr-for-cplusplus  do not assume the ODR to speed-up the"
     "analysis of the binary\n"
     << " --verbose                      emit verbose progress messages\n"
+    << " --profile <path>               write performance metrics as JSON "
+    "into path\n"
+    << " --corpus-cache-dir <path>      cache the ABI corpora of the "
+    "binaries in the directory path\n"
+    << " --corpus-cache-max-size <size> limit the size of the cache of ABI "
+    "corpora to size mebibytes\n"
     << " --self-check                   perform a sanity check by comparing "
     "binaries inside the input package against their ABIXML representation\n"
 #ifdef WITH_CTF
@@ -1303,6 +1389,8 @@ set_generic_options(abigail::elf_based_reader& rdr, const options& opts)
     opts.leverage_dwarf_factorization;
   rdr.options().assume_odr_for_cplusplus =
     opts.assume_odr_for_cplusplus;
+  rdr.options().corpus_cache_dir = opts.corpus_cache_dir;
+  rdr.options().corpus_cache_max_size = opts.corpus_cache_max_size;
 }
 
 /// Emit an error message on standard error about alternate debug info
@@ -1367,47 +1455,65 @@ emit_alt_debug_info_not_found_error(abigail::elf_based_reader&	reader,
     << "debug info file, using an additional --d1/--d2 switch\n";
 }
 
-/// Compare the ABI two elf files, using their associated debug info.
-///
-/// The result of the comparison is emitted to standard output.
+/// Read the ABI corpora of two elf files, using their associated
+/// debug info, in order to compare them.
 ///
 /// @param elf1 the first elf file to consider.
 ///
 /// @param debug_dir1 the directory where the debug info file for @p
 /// elf1 is stored.
-/// The result of the comparison is saved to a global corpus map.
+///
+/// @param priv_types_supprs1 the private type suppressions of the
+/// package of @p elf1.
 ///
 /// @param elf2 the second eld file to consider.
-/// @args the list of argument sets used for comparison
 ///
 /// @param debug_dir2 the directory where the debug info file for @p
 /// elf2 is stored.
 ///
+/// @param priv_types_supprs2 the private type suppressions of the
+/// package of @p elf2.
+///
 /// @param opts the options the current program has been called with.
 ///
-/// @param env the environment encapsulating the entire comparison.
+/// @param env the environment to read the corpora in.
 ///
-/// @param diff the shared pointer to be set to the result of the comparison.
+/// @param shared_env if non-nil, @p env is the environment of this
+/// @ref shared_environment.  The corpora read are then kept by it.
+///
+/// @param corpus1 output parameter.  The corpus read from @p elf1.
+///
+/// @param corpus2 output parameter.  The corpus read from @p elf2.
+///
+/// @param ctxt output parameter.  The diff context to use to compare
+/// @p corpus1 and @p corpus2.
+///
+/// @param out the output stream to emit error messages to.
 ///
 /// @param detailed_error_status is this pointer is non-null and if
 /// the function returns ABIDIFF_ERROR, then the function sets the
 /// pointed-to parameter to the abigail::fe_iface::status value
 /// that gives details about the rror.
 ///
-/// @return the status of the comparison.
+/// @return ABIDIFF_ERROR if the corpora could not be read properly,
+/// ABIDIFF_OK otherwise.  Note that if one of the two files is
+/// suppressed, none of them is read and @p corpus1 and @p corpus2
+/// are left nil.
 static abidiff_status
-compare(const elf_file&		elf1,
-	const string&			debug_dir1,
-	const suppressions_type&	priv_types_supprs1,
-	const elf_file&		elf2,
-	const string&			debug_dir2,
-	const suppressions_type&	priv_types_supprs2,
-	const options&			opts,
-	abigail::ir::environment&	env,
-	corpus_diff_sptr&		diff,
-	diff_context_sptr&		ctxt,
-	ostream&			out,
-	abigail::fe_iface::status*	detailed_error_status = 0)
+read_corpora(const elf_file&		elf1,
+	     const string&		debug_dir1,
+	     const suppressions_type&	priv_types_supprs1,
+	     const elf_file&		elf2,
+	     const string&		debug_dir2,
+	     const suppressions_type&	priv_types_supprs2,
+	     const options&		opts,
+	     abigail::ir::environment&	env,
+	     shared_environment*	shared_env,
+	     corpus_sptr&		corpus1,
+	     corpus_sptr&		corpus2,
+	     diff_context_sptr&		ctxt,
+	     ostream&			out,
+	     abigail::fe_iface::status*	detailed_error_status = 0)
 {
   char *di_dir1 = (char*) debug_dir1.c_str(),
 	*di_dir2 = (char*) debug_dir2.c_str();
@@ -1465,7 +1571,6 @@ compare(const elf_file&		elf1,
       << " ...\n";
 
   abigail::elf_based_reader_sptr reader;
-  corpus_sptr corpus1;
   {
     corpus::origin requested_fe_kind = corpus::DWARF_ORIGIN;
 #ifdef WITH_CTF
@@ -1487,6 +1592,8 @@ compare(const elf_file&		elf1,
     set_generic_options(*reader, opts);
 
     corpus1 = reader->read_corpus(c1_status);
+    if (shared_env)
+      shared_env->keep_corpus(corpus1);
 
     bool bail_out = false;
     if (!(c1_status & abigail::fe_iface::STATUS_OK))
@@ -1552,7 +1659,6 @@ compare(const elf_file&		elf1,
       << elf2.path
       << " ...\n";
 
-  corpus_sptr corpus2;
   {
     corpus::origin requested_fe_kind = corpus::DWARF_ORIGIN;
 
@@ -1576,6 +1682,8 @@ compare(const elf_file&		elf1,
     set_generic_options(*reader, opts);
 
     corpus2 = reader->read_corpus(c2_status);
+    if (shared_env)
+      shared_env->keep_corpus(corpus2);
 
     bool bail_out = false;
     if (!(c2_status & abigail::fe_iface::STATUS_OK))
@@ -1633,6 +1741,35 @@ compare(const elf_file&		elf1,
     emit_prefix("abipkgdiff", cerr)
       << " DONE reading file " << elf2.path << "\n";
 
+  return abigail::tools_utils::ABIDIFF_OK;
+}
+
+/// Compare the ABI corpora of two elf files.
+///
+/// @param elf1 the first elf file to consider.
+///
+/// @param elf2 the second elf file to consider.
+///
+/// @param opts the options the current program has been called with.
+///
+/// @param corpus1 the corpus read from @p elf1.
+///
+/// @param corpus2 the corpus read from @p elf2.
+///
+/// @param ctxt the diff context to use for the comparison.
+///
+/// @param diff the shared pointer to be set to the result of the comparison.
+///
+/// @return the status of the comparison.
+static abidiff_status
+compare_corpora(const elf_file&		elf1,
+		const elf_file&		elf2,
+		const options&			opts,
+		const corpus_sptr&		corpus1,
+		const corpus_sptr&		corpus2,
+		diff_context_sptr&		ctxt,
+		corpus_diff_sptr&		diff)
+{
   if (opts.verbose)
     emit_prefix("abipkgdiff", cerr)
       << "  Comparing the ABIs of: \n"
@@ -1658,6 +1795,60 @@ compare(const elf_file&		elf1,
   return s;
 }
 
+/// Compare the ABI two elf files, using their associated debug info.
+///
+/// The result of the comparison is emitted to standard output.
+///
+/// @param elf1 the first elf file to consider.
+///
+/// @param debug_dir1 the directory where the debug info file for @p
+/// elf1 is stored.
+/// The result of the comparison is saved to a global corpus map.
+///
+/// @param elf2 the second eld file to consider.
+/// @args the list of argument sets used for comparison
+///
+/// @param debug_dir2 the directory where the debug info file for @p
+/// elf2 is stored.
+///
+/// @param opts the options the current program has been called with.
+///
+/// @param env the environment encapsulating the entire comparison.
+///
+/// @param diff the shared pointer to be set to the result of the comparison.
+///
+/// @param detailed_error_status is this pointer is non-null and if
+/// the function returns ABIDIFF_ERROR, then the function sets the
+/// pointed-to parameter to the abigail::fe_iface::status value
+/// that gives details about the rror.
+///
+/// @return the status of the comparison.
+static abidiff_status
+compare(const elf_file&		elf1,
+	const string&			debug_dir1,
+	const suppressions_type&	priv_types_supprs1,
+	const elf_file&		elf2,
+	const string&			debug_dir2,
+	const suppressions_type&	priv_types_supprs2,
+	const options&			opts,
+	abigail::ir::environment&	env,
+	corpus_diff_sptr&		diff,
+	diff_context_sptr&		ctxt,
+	ostream&			out,
+	abigail::fe_iface::status*	detailed_error_status = 0)
+{
+  corpus_sptr corpus1, corpus2;
+  abidiff_status s = read_corpora(elf1, debug_dir1, priv_types_supprs1,
+				  elf2, debug_dir2, priv_types_supprs2,
+				  opts, env, /*shared_env=*/nullptr,
+				  corpus1, corpus2, ctxt, out,
+				  detailed_error_status);
+  if (s != abigail::tools_utils::ABIDIFF_OK || !corpus1 || !corpus2)
+    return s;
+
+  return compare_corpora(elf1, elf2, opts, corpus1, corpus2, ctxt, diff);
+}
+
 /// Compare an ELF file to its ABIXML representation.
 ///
 /// @param elf the ELF file to compare.
@@ -1725,6 +1916,10 @@ compare_to_self(const elf_file&		elf,
 				   env, requested_fe_kind,
 				   opts.show_all_types);
     ABG_ASSERT(reader);
+    // The corpus must be built from the binary, not re-read from an
+    // abixml file of the cache of ABI corpora; otherwise, it would
+    // be compared to its own abixml round trip.
+    reader->options().corpus_cache_dir.clear();
 
     corp = reader->read_corpus(c_status);
 
@@ -2170,14 +2365,22 @@ public:
   abidiff_status status;
   ostringstream out;
   string pretty_output;
+  // The corpora read by the task in a shared environment and the
+  // context to compare them with.
+  corpus_sptr corpus1;
+  corpus_sptr corpus2;
+  diff_context_sptr ctxt;
+  abigail::fe_iface::status detailed_status;
 
   compare_task()
-    : status(abigail::tools_utils::ABIDIFF_OK)
+    : status(abigail::tools_utils::ABIDIFF_OK),
+      detailed_status(abigail::fe_iface::STATUS_UNKNOWN)
   {}
 
   compare_task(const compare_args_sptr& a)
     : args(a),
-      status(abigail::tools_utils::ABIDIFF_OK)
+      status(abigail::tools_utils::ABIDIFF_OK),
+      detailed_status(abigail::fe_iface::STATUS_UNKNOWN)
   {}
 
   void
@@ -2238,25 +2441,68 @@ public:
   ///
   /// This compares two ELF files, gets the resulting test report and
   /// stores it in an output stream.
+  ///
+  /// If the task uses a shared environment, this only reads the two
+  /// ELF files.  The corpora read are then compared by
+  /// compare_read_corpora.
   virtual void
   perform()
   {
+    if (args->shared_env)
+      {
+	status |= read_corpora(args->elf1, args->debug_dir1,
+			       args->private_types_suppr1,
+			       args->elf2, args->debug_dir2,
+			       args->private_types_suppr2,
+			       args->opts,
+			       args->shared_env->get_environment(),
+			       args->shared_env, corpus1, corpus2, ctxt,
+			       out, &detailed_status);
+	return;
+      }
+
     abigail::ir::environment env;
     diff_context_sptr ctxt;
     corpus_diff_sptr diff;
 
-    abigail::fe_iface::status detailed_status =
-      abigail::fe_iface::STATUS_UNKNOWN;
-
     if (args->opts.exported_interfaces_only.has_value())
       env.analyze_exported_interfaces_only
 	(*args->opts.exported_interfaces_only);
 
+    env.get_metrics().enable(gathered_metrics.is_enabled());
+
     status |= compare(args->elf1, args->debug_dir1, args->private_types_suppr1,
 		      args->elf2, args->debug_dir2, args->private_types_suppr2,
 		      args->opts, env, diff, ctxt, out, &detailed_status);
 
     maybe_emit_pretty_error_message_to_output(diff, detailed_status);
+
+    gathered_metrics.merge(env.get_metrics());
+  }
+
+  /// Compare the corpora read by the task in a shared environment and
+  /// get the resulting report.
+  ///
+  /// This must be called once no task reads any binary in the shared
+  /// environment anymore.  Comparing two corpora updates the types
+  /// they share with the corpora of the other binaries, so this must
+  /// not be called concurrently with the reading or the comparison
+  /// of other binaries in the same environment.
+  void
+  compare_read_corpora()
+  {
+    corpus_diff_sptr diff;
+    if (status == abigail::tools_utils::ABIDIFF_OK && corpus1 && corpus2)
+      status |= compare_corpora(args->elf1, args->elf2, args->opts,
+				corpus1, corpus2, ctxt, diff);
+
+    maybe_emit_pretty_error_message_to_output(diff, detailed_status);
+
+    // The corpora must not outlive the shared environment.
+    diff.reset();
+    ctxt.reset();
+    corpus1.reset();
+    corpus2.reset();
   }
 }; // end class compare_task
 
@@ -2290,9 +2536,12 @@ public:
     abigail::fe_iface::status detailed_status =
       abigail::fe_iface::STATUS_UNKNOWN;
 
+    env.get_metrics().enable(gathered_metrics.is_enabled());
+
     status |= compare_to_self(args->elf1, args->debug_dir1,
 			      args->opts, env, diff, ctxt, out,
 			      &detailed_status);
+    gathered_metrics.merge(env.get_metrics());
 
     string name = args->elf1.name;
     if (status == abigail::tools_utils::ABIDIFF_OK)
@@ -2788,6 +3037,40 @@ elf_size_is_greater(const task_sptr &task1,
 
 }
 
+/// Compute the priority of a comparison task that compares a pair of
+/// ELF files.
+///
+/// When there are lots of ELF files to compare, and there are both
+/// large and small ELFs, it is often more efficient to start working
+/// on the larger ones first.  So the priority of the task is the sum
+/// of the sizes of the two ELF files.
+///
+/// @param t the comparison task to consider.
+///
+/// @return the priority of @p t.
+static size_t
+compare_task_priority(const task_sptr& t)
+{
+  compare_task_sptr task = dynamic_pointer_cast<compare_task>(t);
+  ABG_ASSERT(task->args);
+  return task->args->elf1.size + task->args->elf2.size;
+}
+
+/// Schedule comparison tasks on a queue, with the larger ELF files
+/// being compared first.
+///
+/// @param tasks the comparison tasks to schedule.
+///
+/// @param q the queue to schedule the tasks on.
+static void
+schedule_compare_tasks(const queue::tasks_type& tasks, queue& q)
+{
+  for (queue::tasks_type::const_iterator t = tasks.begin();
+       t != tasks.end();
+       ++t)
+    q.schedule_task(*t, compare_task_priority(*t));
+}
+
 /// This type is used to notify the calling thread that the comparison
 /// of two ELF files is done.
 class comparison_done_notify : public abigail::workers::queue::task_done_notify
@@ -2889,6 +3172,10 @@ compare_prepared_userspace_packages(package& first_package,
 	relative_debug_path;
     }
 
+  std::unique_ptr<shared_environment> shared_env;
+  if (opts.share_environment)
+    shared_env.reset(new shared_environment(opts));
+
   for (map<string, elf_file_sptr>::iterator it =
 	 first_package.path_elf_file_sptr_map().begin();
        it != first_package.path_elf_file_sptr_map().end();
@@ -2917,7 +3204,8 @@ compare_prepared_userspace_packages(package& first_package,
 				  *iter->second,
 				  debug_dir2,
 				  create_private_types_suppressions
-				  (second_package, opts), opts));
+				  (second_package, opts), opts,
+				  shared_env.get()));
 	      compare_task_sptr t(new compare_task(args));
 	      compare_tasks.push_back(t);
 	    }
@@ -2938,11 +3226,6 @@ compare_prepared_userspace_packages(package& first_package,
   comparison_done_notify notifier(diff);
   if (!compare_tasks.empty())
     {
-      // Larger elfs are processed first, since it's usually safe to assume
-      // their debug-info is larger as well, but the results are still
-      // in a map ordered by looked up in elf.name order.
-      std::sort(compare_tasks.begin(), compare_tasks.end(), elf_size_is_greater);
-
       // There's no reason to spawn more workers than there are ELF pairs
       // to be compared.
       size_t num_workers = (opts.parallel
@@ -2950,15 +3233,34 @@ compare_prepared_userspace_packages(package& first_package,
 			    : 1);
       assert(num_workers >= 1);
 
-      abigail::workers::queue comparison_queue(num_workers, notifier);
+      // In a shared environment, the tasks only read the binaries.
+      // They are compared below, once they have all been read.
+      std::unique_ptr<abigail::workers::queue> comparison_queue
+	(shared_env
+	 ? new abigail::workers::queue(num_workers)
+	 : new abigail::workers::queue(num_workers, notifier));
 
       // Compare all the binaries, in parallel and then wait for the
-      // comparisons to complete.
-      comparison_queue.schedule_tasks(compare_tasks);
-      comparison_queue.wait_for_workers_to_complete();
+      // comparisons to complete.  Larger elfs are processed first,
+      // since it's usually safe to assume their debug-info is larger
+      // as well, but the results are still in a map ordered by
+      // looked up in elf.name order.
+      schedule_compare_tasks(compare_tasks, *comparison_queue);
+      comparison_queue->wait_for_workers_to_complete();
 
       // Get the set of comparison tasks that were perform and sort them.
-      queue::tasks_type& done_tasks = comparison_queue.get_completed_tasks();
+      queue::tasks_type& done_tasks = comparison_queue->get_completed_tasks();
+
+      if (shared_env)
+	for (queue::tasks_type::const_iterator i = done_tasks.begin();
+	     i != done_tasks.end();
+	     ++i)
+	  {
+	    compare_task_sptr t = dynamic_pointer_cast<compare_task>(*i);
+	    t->compare_read_corpora();
+	    notifier(t);
+	  }
+
       std::sort(done_tasks.begin(), done_tasks.end(), elf_size_is_greater);
 
       // Print the reports of the comparison to standard output.
@@ -3088,13 +3390,6 @@ self_compare_prepared_userspace_package(package&	pkg,
       return abigail::tools_utils::ABIDIFF_OK;
     }
 
-  // Larger elfs are processed first, since it's usually safe to assume
-  // their debug-info is larger as well, but the results are still
-  // in a map ordered by looked up in elf.name order.
-  std::sort(self_compare_tasks.begin(),
-	    self_compare_tasks.end(),
-	    elf_size_is_greater);
-
   // There's no reason to spawn more workers than there are ELF pairs
   // to be compared.
   size_t num_workers = (opts.parallel
@@ -3106,8 +3401,11 @@ self_compare_prepared_userspace_package(package&	pkg,
   abigail::workers::queue comparison_queue(num_workers, notifier);
 
   // Compare all the binaries, in parallel and then wait for the
-  // comparisons to complete.
-  comparison_queue.schedule_tasks(self_compare_tasks);
+  // comparisons to complete.  Larger elfs are processed first, since
+  // it's usually safe to assume their debug-info is larger as well,
+  // but the results are still in a map ordered by looked up in
+  // elf.name order.
+  schedule_compare_tasks(self_compare_tasks, comparison_queue);
   comparison_queue.wait_for_workers_to_complete();
 
   // Get the set of comparison tasks that were perform and sort them.
@@ -3200,6 +3498,8 @@ compare_prepared_linux_kernel_packages(package& first_package,
     env.analyze_exported_interfaces_only
       (*opts.exported_interfaces_only);
 
+  env.get_metrics().enable(gathered_metrics.is_enabled());
+
   suppressions_type supprs;
   corpus_group_sptr corpus1, corpus2;
 
@@ -3257,6 +3557,8 @@ compare_prepared_linux_kernel_packages(package& first_package,
 	   << second_package.path() << "' ===\n\n";
     }
 
+  gathered_metrics.merge(env.get_metrics());
+
   return status;
 }
 
@@ -3547,10 +3849,53 @@ parse_command_line(int argc, char* argv[], options& opts)
 	opts.assume_odr_for_cplusplus = false;
       else if (!strcmp(argv[i], "--verbose"))
 	opts.verbose = true;
+      else if (!strcmp(argv[i], "--profile")
+	       || !strncmp(argv[i], "--profile=", 10))
+	{
+	  const char* path = argv[i] + 9;
+	  if (*path == '=')
+	    ++path;
+	  else if (++i < argc)
+	    path = argv[i];
+	  else
+	    {
+	      opts.missing_operand = true;
+	      opts.wrong_option = argv[i - 1];
+	      return true;
+	    }
+	  opts.profile_path = path;
+	}
+      else if (!strcmp(argv[i], "--corpus-cache-dir"))
+	{
+	  int j = i + 1;
+	  if (j >= argc)
+	    {
+	      opts.missing_operand = true;
+	      opts.wrong_option = argv[i];
+	      return true;
+	    }
+	  opts.corpus_cache_dir = argv[j];
+	  ++i;
+	}
+      else if (!strcmp(argv[i], "--corpus-cache-max-size"))
+	{
+	  int j = i + 1;
+	  if (j >= argc)
+	    {
+	      opts.missing_operand = true;
+	      opts.wrong_option = argv[i];
+	      return true;
+	    }
+	  opts.corpus_cache_max_size =
+	    strtoull(argv[j], NULL, 10) * 1024 * 1024;
+	  ++i;
+	}
       else if (!strcmp(argv[i], "--no-abignore"))
 	opts.abignore = false;
       else if (!strcmp(argv[i], "--no-parallel"))
 	opts.parallel = false;
+      else if (!strcmp(argv[i], "--shared-environment"))
+	opts.share_environment = true;
       else if (!strcmp(argv[i], "--show-identical-binaries"))
 	opts.show_identical_binaries = true;
       else if (!strcmp(argv[i], "--self-check"))
@@ -3657,6 +4002,9 @@ main(int argc, char* argv[])
 	      | abigail::tools_utils::ABIDIFF_ERROR);
     }
 
+  abigail::tools_utils::scoped_profile_emitter
+    profile(gathered_metrics, opts.profile_path);
+
   if (opts.nonexistent_file)
     {
       string input_file;
@@ -12,6 +12,8 @@
 #include "config.h"
 #include <sys/types.h>
 #include <dirent.h>
+#include <cctype>
+#include <cstdlib>
 #include <cstring>
 #include <string>
 #include <vector>
@@ -23,6 +25,7 @@
 #include "abg-dwarf-reader.h"
 #include "abg-reader.h"
 #include "abg-comparison.h"
+#include "abg-workers.h"
 
 using std::string;
 using std::vector;
@@ -79,6 +82,8 @@ struct options
   suppressions_type	diff_time_supprs;
   shared_ptr<char>	di_root_path1;
   shared_ptr<char>	di_root_path2;
+  size_t		nb_threads;
+  string		profile_path;
 
   options()
     : display_usage(),
@@ -89,7 +94,8 @@ struct options
       leaf_changes_only(true),
       show_hexadecimal_values(true),
       show_offsets_sizes_in_bits(false),
-      show_impacted_interfaces(false)
+      show_impacted_interfaces(false),
+      nb_threads(1)
 #ifdef WITH_CTF
       ,
       use_ctf(false)
@@ -115,6 +121,7 @@ display_usage(const string& prog_name, ostream& out)
     << " --help|-h  display this message\n"
     << " --version|-v  display program version information and exit\n"
     << " --verbose  display verbose messages\n"
+    << " --profile <path>  write performance metrics as JSON into path\n"
     << " --debug-info-dir1|--d1 <path> the root for the debug info of "
 	"the first kernel\n"
     << " --debug-info-dir2|--d2 <path> the root for the debug info of "
@@ -130,6 +137,8 @@ display_usage(const string& prog_name, ostream& out)
 #ifdef WITH_BTF
     << " --btf use BTF instead of DWARF in ELF files\n"
 #endif
+    << " --jobs|-j <N>  use N threads to open the kernel modules; "
+    "0 means one thread per processor\n"
     << " --no-change-categorization | -x don't perform categorization "
     "of changes, for speed purposes\n"
     << " --impacted-interfaces|-i  show interfaces impacted by ABI changes\n"
@@ -174,6 +183,22 @@ parse_command_line(int argc, char* argv[], options& opts)
 	}
       else if (!strcmp(argv[i], "--verbose"))
 	  opts.verbose = true;
+      else if (!strcmp(argv[i], "--profile")
+	       || !strncmp(argv[i], "--profile=", 10))
+	{
+	  const char* path = argv[i] + 9;
+	  if (*path == '=')
+	    ++path;
+	  else if (++i < argc)
+	    path = argv[i];
+	  else
+	    {
+	      opts.missing_operand = true;
+	      opts.wrong_option = argv[i - 1];
+	      return true;
+	    }
+	  opts.profile_path = path;
+	}
       else if (!strcmp(argv[i], "--version")
 	       || !strcmp(argv[i], "-v"))
 	{
@@ -278,6 +303,26 @@ parse_command_line(int argc, char* argv[], options& opts)
       else if (!strcmp(argv[i], "--btf"))
 	opts.use_btf = true;
 #endif
+      else if (!strcmp(argv[i], "--jobs")
+	       || !strcmp(argv[i], "-j"))
+	{
+	  int j = i + 1;
+	  if (j >= argc)
+	    {
+	      opts.missing_operand = true;
+	      opts.wrong_option = argv[i];
+	      return true;
+	    }
+	  if (!isdigit(argv[j][0]))
+	    {
+	      opts.wrong_option = argv[i];
+	      return false;
+	    }
+	  opts.nb_threads = strtoul(argv[j], NULL, 10);
+	  if (opts.nb_threads == 0)
+	    opts.nb_threads = abigail::workers::get_number_of_threads();
+	  ++i;
+	}
       else if (!strcmp(argv[i], "--no-change-categorization")
 	       || !strcmp(argv[i], "-x"))
 	opts.perform_change_categorization = false;
@@ -437,6 +482,8 @@ main(int argc, char* argv[])
     }
 
   environment env;
+  abigail::tools_utils::scoped_profile_emitter
+    profile(env.get_metrics(), opts.profile_path);
 
   if (opts.exported_interfaces_only.has_value())
     env.analyze_exported_interfaces_only(*opts.exported_interfaces_only);
@@ -470,7 +517,9 @@ main(int argc, char* argv[])
 						      opts.kabi_whitelist_paths,
 						      opts.read_time_supprs,
 						      opts.verbose, env,
-						      requested_fe_kind);
+						      requested_fe_kind,
+						      /*on_corpus_added=*/nullptr,
+						      opts.nb_threads);
 	  print_kernel_dist_binary_paths_under(opts.kernel_dist_root1, opts);
 	}
       else if (ftype == FILE_TYPE_XML_CORPUS_GROUP)
@@ -496,7 +545,9 @@ main(int argc, char* argv[])
 						      opts.kabi_whitelist_paths,
 						      opts.read_time_supprs,
 						      opts.verbose, env,
-						      requested_fe_kind);
+						      requested_fe_kind,
+						      /*on_corpus_added=*/nullptr,
+						      opts.nb_threads);
 	  print_kernel_dist_binary_paths_under(opts.kernel_dist_root2, opts);
 	}
       else if (ftype == FILE_TYPE_XML_CORPUS_GROUP)